@@ -17,7 +17,10 @@ static const LZ4F_preferences_t lz4_preferences = {
       0 /* content size unknown */, 0 /* no dictID */ , LZ4F_noBlockChecksum },
     0,   /* compression level */
     0,   /* autoflush */
-    { 0, 0, 0, 0 },  /* reserved, must be set to 0 */
+    0,   /* nbWorkers : compress within calling thread */
+    0,   /* nbBlocksInFlight */
+    0,   /* seekTable */
+    0,   /* favorDecSpeed */
 };
 
 static size_t compress_file(FILE *in, FILE *out, size_t *size_in, size_t *size_out) {
@@ -84,11 +84,41 @@
 #  define LZ4_FORCE_SW_BITCOUNT
 #endif
 
+/*
+ * LZ4_COUNT_DISPATCH
+ * On x86-64 with gcc or clang, match length counting can use SSE2, AVX2 or AVX-512BW
+ * kernels, selected once at runtime depending on CPU capabilities.
+ * Define this parameter to 0 to only use the portable scalar code.
+ */
+#ifndef LZ4_COUNT_DISPATCH
+#  if defined(__x86_64__) && !defined(LZ4_FORCE_SW_BITCOUNT)    && ( (defined(__clang__) && (__clang_major__ >= 5)) || (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 6)) )
+#    define LZ4_COUNT_DISPATCH 1
+#  else
+#    define LZ4_COUNT_DISPATCH 0
+#  endif
+#endif
+
+/*
+ * LZ4_PATTERN_DISPATCH
+ * On x86-64 with gcc or clang, decompression of overlapping matches (offset < 16)
+ * can expand the repeated pattern with SSSE3 or AVX2 shuffles, writing 16 or 32 bytes per store.
+ * The kernel is selected once at runtime depending on CPU capabilities.
+ * Define this parameter to 0 to only use the portable scalar code.
+ */
+#ifndef LZ4_PATTERN_DISPATCH
+#  if defined(__x86_64__) && ( (defined(__clang__) && (__clang_major__ >= 5)) || (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 6)) )
+#    define LZ4_PATTERN_DISPATCH 1
+#  else
+#    define LZ4_PATTERN_DISPATCH 0
+#  endif
+#endif
+
 
 
 /*-************************************
 *  Dependency
 **************************************/
+#define LZ4_STATIC_LINKING_ONLY   /* LZ4_streamLazy_t */
 #include "lz4.h"
 /* see also "memory routines" below */
 
@@ -149,6 +179,18 @@
 #define likely(expr)     expect((expr) != 0, 1)
 #define unlikely(expr)   expect((expr) != 0, 0)
 
+#if defined(__GNUC__) || defined(__clang__)
+#  define LZ4_PREFETCH(ptr)       __builtin_prefetch((ptr), 0, 3)
+#  define LZ4_PREFETCH_WRITE(ptr) __builtin_prefetch((ptr), 1, 3)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <mmintrin.h>   /* _mm_prefetch */
+#  define LZ4_PREFETCH(ptr)       _mm_prefetch((const char*)(ptr), _MM_HINT_T0)
+#  define LZ4_PREFETCH_WRITE(ptr) _mm_prefetch((const char*)(ptr), _MM_HINT_T0)
+#else
+#  define LZ4_PREFETCH(ptr)       ((void)(ptr))
+#  define LZ4_PREFETCH_WRITE(ptr) ((void)(ptr))
+#endif
+
 
 /*-************************************
 *  Memory routines
@@ -413,18 +455,10 @@ static unsigned LZ4_NbCommonBytes (reg_t val)
 
 #define STEPSIZE sizeof(reg_t)
 LZ4_FORCE_INLINE
-unsigned LZ4_count(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
+unsigned LZ4_count_scalar(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
 {
     const BYTE* const pStart = pIn;
 
-    if (likely(pIn < pInLimit-(STEPSIZE-1))) {
-        reg_t const diff = LZ4_read_ARCH(pMatch) ^ LZ4_read_ARCH(pIn);
-        if (!diff) {
-            pIn+=STEPSIZE; pMatch+=STEPSIZE;
-        } else {
-            return LZ4_NbCommonBytes(diff);
-    }   }
-
     while (likely(pIn < pInLimit-(STEPSIZE-1))) {
         reg_t const diff = LZ4_read_ARCH(pMatch) ^ LZ4_read_ARCH(pIn);
         if (!diff) { pIn+=STEPSIZE; pMatch+=STEPSIZE; continue; }
@@ -438,6 +472,28 @@ unsigned LZ4_count(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
     return (unsigned)(pIn - pStart);
 }
 
+#if LZ4_COUNT_DISPATCH
+/* LZ4_countLong() :
+ * counts common bytes beyond the first STEPSIZE ones, using the kernel selected for this CPU.
+ * Direct call, no function pointer involved.
+ * Defined in lz4.c, shared with lz4hc.c */
+unsigned LZ4_countLong(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit);
+#else
+#  define LZ4_countLong LZ4_count_scalar
+#endif
+
+LZ4_FORCE_INLINE
+unsigned LZ4_count(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
+{
+    if (likely(pIn < pInLimit-(STEPSIZE-1))) {
+        reg_t const diff = LZ4_read_ARCH(pMatch) ^ LZ4_read_ARCH(pIn);
+        if (diff) return LZ4_NbCommonBytes(diff);
+        /* short matches are resolved above; long ones go to the wide kernel */
+        return (unsigned)STEPSIZE + LZ4_countLong(pIn+STEPSIZE, pMatch+STEPSIZE, pInLimit);
+    }
+    return LZ4_count_scalar(pIn, pMatch, pInLimit);
+}
+
 
 #ifndef LZ4_COMMONDEFS_ONLY
 /*-************************************
@@ -453,8 +509,14 @@ static const U32 LZ4_skipTrigger = 6;  /* Increase this value ==> compression ru
 typedef enum { notLimited = 0, limitedOutput = 1 } limitedOutput_directive;
 typedef enum { byPtr, byU32, byU16 } tableType_t;
 
-typedef enum { noDict = 0, withPrefix64k, usingExtDict } dict_directive;
+typedef enum { noDict = 0, withPrefix64k, usingExtDict, usingDictCtx } dict_directive;
 typedef enum { noDictIssue = 0, dictSmall } dictIssue_directive;
+typedef enum { freshTable = 0, taggedTable } tableTag_directive;
+
+/* LZ4_stream_t_internal.tableState */
+typedef enum { tableCleared = 0,   /* all entries are zero */
+               tableTagged,        /* byU16 entries, all < currentOffset */
+               tableDirty } tableState_e;
 
 typedef enum { endOnOutputSize = 0, endOnInputSize = 1 } endCondition_directive;
 typedef enum { full = 0, partial = 1 } earlyEnd_directive;
@@ -469,6 +531,268 @@ int LZ4_compressBound(int isize)  { return LZ4_COMPRESSBOUND(isize); }
 int LZ4_sizeofState() { return LZ4_STREAMSIZE; }
 
 
+/*-************************************
+*  Match length counting kernels
+**************************************/
+#if LZ4_COUNT_DISPATCH
+
+#include <immintrin.h>
+
+/* kernel identifiers, in increasing order of width */
+typedef enum { LZ4_count_k_scalar = 0, LZ4_count_k_sse2 = 1, LZ4_count_k_avx2 = 2, LZ4_count_k_avx512bw = 3 } LZ4_countKernel_e;
+
+/* SSE2 is part of x86-64 baseline : no target attribute needed, can be inlined anywhere */
+LZ4_FORCE_INLINE
+unsigned LZ4_countLong_sse2(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
+{
+    const BYTE* const pStart = pIn;
+    while (likely(pIn < pInLimit-15)) {
+        __m128i const a = _mm_loadu_si128((const __m128i*)(const void*)pIn);
+        __m128i const b = _mm_loadu_si128((const __m128i*)(const void*)pMatch);
+        U32 const neq = (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xFFFFU;
+        if (!neq) { pIn+=16; pMatch+=16; continue; }
+        return (unsigned)(pIn - pStart) + (unsigned)__builtin_ctz(neq);
+    }
+    return (unsigned)(pIn - pStart) + LZ4_count_scalar(pIn, pMatch, pInLimit);
+}
+
+__attribute__((target("avx2")))
+static unsigned LZ4_countLong_avx2(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
+{
+    const BYTE* const pStart = pIn;
+    while (likely(pIn < pInLimit-31)) {
+        __m256i const a = _mm256_loadu_si256((const __m256i*)(const void*)pIn);
+        __m256i const b = _mm256_loadu_si256((const __m256i*)(const void*)pMatch);
+        U32 const neq = ~(U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+        if (!neq) { pIn+=32; pMatch+=32; continue; }
+        return (unsigned)(pIn - pStart) + (unsigned)__builtin_ctz(neq);
+    }
+    return (unsigned)(pIn - pStart) + LZ4_countLong_sse2(pIn, pMatch, pInLimit);
+}
+
+__attribute__((target("avx512bw")))
+static unsigned LZ4_countLong_avx512bw(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
+{
+    const BYTE* const pStart = pIn;
+    while (likely(pIn < pInLimit-63)) {
+        __m512i const a = _mm512_loadu_si512((const void*)pIn);
+        __m512i const b = _mm512_loadu_si512((const void*)pMatch);
+        U64 const neq = (U64)_mm512_cmpneq_epi8_mask(a, b);
+        if (!neq) { pIn+=64; pMatch+=64; continue; }
+        return (unsigned)(pIn - pStart) + (unsigned)__builtin_ctzll(neq);
+    }
+    return (unsigned)(pIn - pStart) + LZ4_countLong_sse2(pIn, pMatch, pInLimit);
+}
+
+/* LZ4_count_k() :
+ * same as LZ4_count(), using `kernel` for long matches.
+ * LZ4_compress_generic() reads `kernel` once per block : its counting loop stays inlined,
+ * with a well-predicted branch instead of an indirect call. */
+LZ4_FORCE_INLINE
+unsigned LZ4_count_k(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit, int kernel)
+{
+    if (likely(pIn < pInLimit-(STEPSIZE-1))) {
+        reg_t const diff = LZ4_read_ARCH(pMatch) ^ LZ4_read_ARCH(pIn);
+        if (diff) return LZ4_NbCommonBytes(diff);
+        pIn += STEPSIZE; pMatch += STEPSIZE;
+        switch (kernel)
+        {
+        case LZ4_count_k_avx512bw: return (unsigned)STEPSIZE + LZ4_countLong_avx512bw(pIn, pMatch, pInLimit);
+        case LZ4_count_k_avx2:     return (unsigned)STEPSIZE + LZ4_countLong_avx2(pIn, pMatch, pInLimit);
+        case LZ4_count_k_sse2:     return (unsigned)STEPSIZE + LZ4_countLong_sse2(pIn, pMatch, pInLimit);
+        default:                   return (unsigned)STEPSIZE + LZ4_count_scalar(pIn, pMatch, pInLimit);
+        }
+    }
+    return LZ4_count_scalar(pIn, pMatch, pInLimit);
+}
+
+static int LZ4_count_bestKernel(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) return LZ4_count_k_avx512bw;
+    if (__builtin_cpu_supports("avx2")) return LZ4_count_k_avx2;
+    return LZ4_count_k_sse2;
+}
+
+/* Resolved on first use. Only accessed atomically :
+ * concurrent first calls are race-free, and all store the same value. */
+static int LZ4_count_selected = -1;
+
+/* LZ4_count_kernel() :
+ * @return : identifier of the kernel selected for this CPU */
+static int LZ4_count_kernel(void)
+{
+    int kernel = __atomic_load_n(&LZ4_count_selected, __ATOMIC_RELAXED);
+    if (unlikely(kernel < 0)) {
+        kernel = LZ4_count_bestKernel();
+        __atomic_store_n(&LZ4_count_selected, kernel, __ATOMIC_RELAXED);
+    }
+    return kernel;
+}
+
+/* LZ4_count_selectKernel() :
+ * hidden function, used by tests and benchmarks.
+ * kernel < 0 selects the best kernel for this CPU.
+ * Requests beyond CPU capabilities are downgraded.
+ * @return : identifier of the kernel effectively selected */
+int LZ4_count_selectKernel(int kernel)
+{
+    int const best = LZ4_count_bestKernel();
+    if ((kernel < 0) || (kernel > best)) kernel = best;
+    __atomic_store_n(&LZ4_count_selected, kernel, __ATOMIC_RELAXED);
+    return kernel;
+}
+
+unsigned LZ4_countLong(const BYTE* pIn, const BYTE* pMatch, const BYTE* pInLimit)
+{
+    switch (LZ4_count_kernel())
+    {
+    case LZ4_count_k_avx512bw: return LZ4_countLong_avx512bw(pIn, pMatch, pInLimit);
+    case LZ4_count_k_avx2:     return LZ4_countLong_avx2(pIn, pMatch, pInLimit);
+    case LZ4_count_k_sse2:     return LZ4_countLong_sse2(pIn, pMatch, pInLimit);
+    default:                   return LZ4_count_scalar(pIn, pMatch, pInLimit);
+    }
+}
+
+#else
+
+#define LZ4_count_kernel() 0
+#define LZ4_count_k(pIn, pMatch, pInLimit, kernel) ((void)(kernel), LZ4_count(pIn, pMatch, pInLimit))
+
+int LZ4_count_selectKernel(int kernel) { (void)kernel; return 0; }
+
+#endif  /* LZ4_COUNT_DISPATCH */
+
+
+/*-************************************
+*  Pattern copy kernels
+**************************************/
+#if LZ4_PATTERN_DISPATCH
+
+#if !LZ4_COUNT_DISPATCH
+#  include <immintrin.h>
+#endif
+
+/* LZ4_copyPattern_*() :
+ * copy an overlapping match, where 1 <= op-match <= 15, up to `cpy`.
+ * Kernels may write up to 31 bytes beyond `cpy` : caller must ensure `cpy <= oend-32` */
+
+typedef enum { LZ4_pattern_k_scalar = 0, LZ4_pattern_k_ssse3 = 1, LZ4_pattern_k_avx2 = 2 } LZ4_patternKernel_e;
+
+/* row `offset` : byte `i` of a repeated pattern of period `offset` is source byte `i % offset` */
+static const BYTE LZ4_patternMasks[16][32] = {
+    {  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },   /*  0 */
+    {  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },   /*  1 */
+    {  0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1 },   /*  2 */
+    {  0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1 },   /*  3 */
+    {  0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3 },   /*  4 */
+    {  0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 0, 1 },   /*  5 */
+    {  0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 0, 1 },   /*  6 */
+    {  0, 1, 2, 3, 4, 5, 6, 0, 1, 2, 3, 4, 5, 6, 0, 1, 2, 3, 4, 5, 6, 0, 1, 2, 3, 4, 5, 6, 0, 1, 2, 3 },   /*  7 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 },   /*  8 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 0, 1, 2, 3, 4, 5, 6, 7, 8, 0, 1, 2, 3, 4, 5, 6, 7, 8, 0, 1, 2, 3, 4 },   /*  9 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1 },   /* 10 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 },   /* 11 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11, 0, 1, 2, 3, 4, 5, 6, 7 },   /* 12 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12, 0, 1, 2, 3, 4, 5 },   /* 13 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13, 0, 1, 2, 3 },   /* 14 */
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14, 0, 1 },   /* 15 */
+};
+
+/* largest multiple of `offset` fitting into a 16 / 32 bytes store */
+static const BYTE LZ4_patternSteps16[16] = { 0, 16, 16, 15, 16, 15, 12, 14, 16,  9, 10, 11, 12, 13, 14, 15 };
+static const BYTE LZ4_patternSteps32[16] = { 0, 32, 32, 30, 32, 30, 30, 28, 32, 27, 30, 22, 24, 26, 28, 30 };
+
+/* same algorithm as the generic decoder : 8 bytes at a time, with offset < 8 spread first */
+static void LZ4_copyPattern_scalar(BYTE* op, const BYTE* match, BYTE* const cpy)
+{
+    static const unsigned inc32table[8] = {0, 1, 2,  1,  0,  4, 4, 4};
+    static const int      dec64table[8] = {0, 0, 0, -1, -4,  1, 2, 3};
+    size_t const offset = (size_t)(op - match);
+    if (offset < 8) {
+        op[0] = match[0];
+        op[1] = match[1];
+        op[2] = match[2];
+        op[3] = match[3];
+        match += inc32table[offset];
+        memcpy(op+4, match, 4);
+        match -= dec64table[offset];
+    } else { LZ4_copy8(op, match); match+=8; }
+    op += 8;
+    LZ4_wildCopy(op, match, cpy);
+}
+
+__attribute__((target("ssse3")))
+static void LZ4_copyPattern_ssse3(BYTE* op, const BYTE* match, BYTE* const cpy)
+{
+    size_t const offset = (size_t)(op - match);
+    size_t const step = LZ4_patternSteps16[offset];
+    __m128i const mask = _mm_loadu_si128((const __m128i*)(const void*)LZ4_patternMasks[offset]);
+    __m128i const pattern = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(const void*)match), mask);
+    do {
+        _mm_storeu_si128((__m128i*)(void*)op, pattern);
+        op += step;
+    } while (op < cpy);
+}
+
+__attribute__((target("avx2")))
+static void LZ4_copyPattern_avx2(BYTE* op, const BYTE* match, BYTE* const cpy)
+{
+    size_t const offset = (size_t)(op - match);
+    size_t const step = LZ4_patternSteps32[offset];
+    __m256i const mask = _mm256_loadu_si256((const __m256i*)(const void*)LZ4_patternMasks[offset]);
+    __m256i const src = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(const void*)match));
+    __m256i const pattern = _mm256_shuffle_epi8(src, mask);   /* shuffles within each 128-bit lane */
+    do {
+        _mm256_storeu_si256((__m256i*)(void*)op, pattern);
+        op += step;
+    } while (op < cpy);
+}
+
+static int LZ4_pattern_bestKernel(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return LZ4_pattern_k_avx2;
+    if (__builtin_cpu_supports("ssse3")) return LZ4_pattern_k_ssse3;
+    return LZ4_pattern_k_scalar;
+}
+
+/* Resolved on first use. Only accessed atomically :
+ * concurrent first calls are race-free, and all store the same value. */
+static int LZ4_copyPattern_selected = -1;
+
+/* LZ4_copyPattern_kernel() :
+ * @return : identifier of the kernel selected for this CPU */
+static int LZ4_copyPattern_kernel(void)
+{
+    int kernel = __atomic_load_n(&LZ4_copyPattern_selected, __ATOMIC_RELAXED);
+    if (unlikely(kernel < 0)) {
+        kernel = LZ4_pattern_bestKernel();
+        __atomic_store_n(&LZ4_copyPattern_selected, kernel, __ATOMIC_RELAXED);
+    }
+    return kernel;
+}
+
+/* LZ4_copyPattern_selectKernel() :
+ * hidden function, used by tests and benchmarks.
+ * kernel < 0 selects the best kernel for this CPU.
+ * Requests beyond CPU capabilities are downgraded.
+ * @return : identifier of the kernel effectively selected */
+int LZ4_copyPattern_selectKernel(int kernel)
+{
+    int const best = LZ4_pattern_bestKernel();
+    if ((kernel < 0) || (kernel > best)) kernel = best;
+    __atomic_store_n(&LZ4_copyPattern_selected, kernel, __ATOMIC_RELAXED);
+    return kernel;
+}
+
+#else
+
+int LZ4_copyPattern_selectKernel(int kernel) { (void)kernel; return 0; }
+
+#endif  /* LZ4_PATTERN_DISPATCH */
+
+
 /*-******************************
 *  Compression functions
 ********************************/
@@ -513,11 +837,11 @@ LZ4_FORCE_INLINE void LZ4_putPosition(const BYTE* p, void* tableBase, tableType_
     LZ4_putPositionOnHash(p, h, tableBase, tableType, srcBase);
 }
 
-static const BYTE* LZ4_getPositionOnHash(U32 h, void* tableBase, tableType_t tableType, const BYTE* srcBase)
+static const BYTE* LZ4_getPositionOnHash(U32 h, const void* tableBase, tableType_t tableType, const BYTE* srcBase)
 {
-    if (tableType == byPtr) { const BYTE** hashTable = (const BYTE**) tableBase; return hashTable[h]; }
-    if (tableType == byU32) { const U32* const hashTable = (U32*) tableBase; return hashTable[h] + srcBase; }
-    { const U16* const hashTable = (U16*) tableBase; return hashTable[h] + srcBase; }   /* default, to ensure a return */
+    if (tableType == byPtr) { const BYTE* const* hashTable = (const BYTE* const*) tableBase; return hashTable[h]; }
+    if (tableType == byU32) { const U32* const hashTable = (const U32*) tableBase; return hashTable[h] + srcBase; }
+    { const U16* const hashTable = (const U16*) tableBase; return hashTable[h] + srcBase; }   /* default, to ensure a return */
 }
 
 LZ4_FORCE_INLINE const BYTE* LZ4_getPosition(const BYTE* p, void* tableBase, tableType_t tableType, const BYTE* srcBase)
@@ -539,15 +863,19 @@ LZ4_FORCE_INLINE int LZ4_compress_generic(
                  const tableType_t tableType,
                  const dict_directive dict,
                  const dictIssue_directive dictIssue,
+                 const tableTag_directive tableTag,
                  const U32 acceleration)
 {
     const BYTE* ip = (const BYTE*) source;
     const BYTE* base;
     const BYTE* lowLimit;
-    const BYTE* const lowRefLimit = ip - cctx->dictSize;
-    const BYTE* const dictionary = cctx->dictionary;
-    const BYTE* const dictEnd = dictionary + cctx->dictSize;
+    const LZ4_stream_t_internal* const dictCtx = cctx->dictCtx;   /* only if dict==usingDictCtx */
+    const BYTE* const dictionary = (dict==usingDictCtx) ? dictCtx->dictionary : cctx->dictionary;
+    U32 const dictSize = (dict==usingDictCtx) ? dictCtx->dictSize : cctx->dictSize;
+    const BYTE* const lowRefLimit = ip - dictSize;
+    const BYTE* const dictEnd = dictionary + dictSize;
     const ptrdiff_t dictDelta = dictEnd - (const BYTE*)source;
+    const BYTE* const dictBase = (dict==usingDictCtx) ? dictEnd - dictCtx->currentOffset : NULL;   /* dictCtx->hashTable positions */
     const BYTE* anchor = (const BYTE*) source;
     const BYTE* const iend = ip + inputSize;
     const BYTE* const mflimit = iend - MFLIMIT;
@@ -555,16 +883,19 @@ LZ4_FORCE_INLINE int LZ4_compress_generic(
 
     BYTE* op = (BYTE*) dest;
     BYTE* const olimit = op + maxOutputSize;
+    int const countKernel = LZ4_count_kernel();   /* dispatched once per block */
 
     U32 forwardH;
 
     /* Init conditions */
     if ((U32)inputSize > (U32)LZ4_MAX_INPUT_SIZE) return 0;   /* Unsupported inputSize, too large (or negative) */
+    if (tableTag==freshTable) cctx->tableState = tableDirty;
     switch(dict)
     {
     case noDict:
     default:
-        base = (const BYTE*)source;
+        /* tagged table : entries below currentOffset come from previous calls */
+        base = (tableTag==taggedTable) ? (const BYTE*)source - cctx->currentOffset : (const BYTE*)source;
         lowLimit = (const BYTE*)source;
         break;
     case withPrefix64k:
@@ -572,6 +903,7 @@ LZ4_FORCE_INLINE int LZ4_compress_generic(
         lowLimit = (const BYTE*)source - cctx->dictSize;
         break;
     case usingExtDict:
+    case usingDictCtx:
         base = (const BYTE*)source - cctx->currentOffset;
         lowLimit = (const BYTE*)source;
         break;
@@ -602,8 +934,11 @@ LZ4_FORCE_INLINE int LZ4_compress_generic(
                 if (unlikely(forwardIp > mflimit)) goto _last_literals;
 
                 match = LZ4_getPositionOnHash(h, cctx->hashTable, tableType, base);
-                if (dict==usingExtDict) {
+                if ((tableTag==taggedTable) && (match < (const BYTE*)source)) match = (const BYTE*)source;   /* stale entry : same as a fresh one */
+                if ((dict==usingExtDict) || (dict==usingDictCtx)) {
                     if (match < (const BYTE*)source) {
+                        /* attached dictionary : local entries below source belong to previous streams */
+                        if (dict==usingDictCtx) match = LZ4_getPositionOnHash(h, dictCtx->hashTable, byU32, dictBase) - dictDelta;
                         refDelta = dictDelta;
                         lowLimit = dictionary;
                     } else {
@@ -647,20 +982,20 @@ _next_match:
         /* Encode MatchLength */
         {   unsigned matchCode;
 
-            if ((dict==usingExtDict) && (lowLimit==dictionary)) {
+            if (((dict==usingExtDict) || (dict==usingDictCtx)) && (lowLimit==dictionary)) {
                 const BYTE* limit;
                 match += refDelta;
                 limit = ip + (dictEnd-match);
                 if (limit > matchlimit) limit = matchlimit;
-                matchCode = LZ4_count(ip+MINMATCH, match+MINMATCH, limit);
+                matchCode = LZ4_count_k(ip+MINMATCH, match+MINMATCH, limit, countKernel);
                 ip += MINMATCH + matchCode;
                 if (ip==limit) {
-                    unsigned const more = LZ4_count(ip, (const BYTE*)source, matchlimit);
+                    unsigned const more = LZ4_count_k(ip, (const BYTE*)source, matchlimit, countKernel);
                     matchCode += more;
                     ip += more;
                 }
             } else {
-                matchCode = LZ4_count(ip+MINMATCH, match+MINMATCH, matchlimit);
+                matchCode = LZ4_count_k(ip+MINMATCH, match+MINMATCH, matchlimit, countKernel);
                 ip += MINMATCH + matchCode;
             }
 
@@ -691,8 +1026,13 @@ _next_match:
         LZ4_putPosition(ip-2, cctx->hashTable, tableType, base);
 
         /* Test next position */
-        match = LZ4_getPosition(ip, cctx->hashTable, tableType, base);
-        if (dict==usingExtDict) {
+        {   U32 const h = LZ4_hashPosition(ip, tableType);
+            match = LZ4_getPositionOnHash(h, cctx->hashTable, tableType, base);
+            if ((dict==usingDictCtx) && (match < (const BYTE*)source))
+                match = LZ4_getPositionOnHash(h, dictCtx->hashTable, byU32, dictBase) - dictDelta;
+        }
+        if ((tableTag==taggedTable) && (match < (const BYTE*)source)) match = (const BYTE*)source;
+        if ((dict==usingExtDict) || (dict==usingDictCtx)) {
             if (match < (const BYTE*)source) {
                 refDelta = dictDelta;
                 lowLimit = dictionary;
@@ -733,23 +1073,151 @@ _last_literals:
 }
 
 
+/*-******************************
+*  Specialized instantiations
+********************************/
+/* Each reachable combination of LZ4_compress_generic() directives is instantiated once,
+ * with acceleration either fixed to 1 or left as a runtime parameter.
+ * Entry points select an instantiation through LZ4_compress_specializations[],
+ * so the main loop never tests these flags at runtime. */
+typedef int (*LZ4_compress_specialized_f)(LZ4_stream_t_internal* cctx, const char* source, char* dest, int inputSize, int maxOutputSize, U32 acceleration);
+
+#define LZ4_COMPRESS_SPECIALIZE(name, outputLimited, tableType, dict, dictIssue, tableTag)                                    \
+static int LZ4_compress_##name(LZ4_stream_t_internal* cctx, const char* source, char* dest, int inputSize, int maxOutputSize, U32 acceleration) \
+{   return LZ4_compress_generic(cctx, source, dest, inputSize, maxOutputSize, outputLimited, tableType, dict, dictIssue, tableTag, acceleration); } \
+static int LZ4_compress_##name##_a1(LZ4_stream_t_internal* cctx, const char* source, char* dest, int inputSize, int maxOutputSize, U32 acceleration) \
+{   (void)acceleration;                                                                                                    \
+    return LZ4_compress_generic(cctx, source, dest, inputSize, maxOutputSize, outputLimited, tableType, dict, dictIssue, tableTag, 1); }
+
+#define LZ4_TABLETYPE_LARGE ((sizeof(void*)==8) ? byU32 : byPtr)
+
+LZ4_COMPRESS_SPECIALIZE(small,                notLimited,    byU16,               noDict,        noDictIssue, freshTable)
+LZ4_COMPRESS_SPECIALIZE(small_limited,        limitedOutput, byU16,               noDict,        noDictIssue, freshTable)
+LZ4_COMPRESS_SPECIALIZE(large,                notLimited,    LZ4_TABLETYPE_LARGE, noDict,        noDictIssue, freshTable)
+LZ4_COMPRESS_SPECIALIZE(large_limited,        limitedOutput, LZ4_TABLETYPE_LARGE, noDict,        noDictIssue, freshTable)
+LZ4_COMPRESS_SPECIALIZE(prefix,               limitedOutput, byU32,               withPrefix64k, noDictIssue, freshTable)
+LZ4_COMPRESS_SPECIALIZE(prefix_dictSmall,     limitedOutput, byU32,               withPrefix64k, dictSmall,   freshTable)
+LZ4_COMPRESS_SPECIALIZE(extDict,              limitedOutput, byU32,               usingExtDict,  noDictIssue, freshTable)
+LZ4_COMPRESS_SPECIALIZE(extDict_dictSmall,    limitedOutput, byU32,               usingExtDict,  dictSmall,   freshTable)
+LZ4_COMPRESS_SPECIALIZE(dictCtx,              limitedOutput, byU32,               usingDictCtx,  dictSmall,   freshTable)
+LZ4_COMPRESS_SPECIALIZE(small_tagged,         notLimited,    byU16,               noDict,        noDictIssue, taggedTable)
+LZ4_COMPRESS_SPECIALIZE(small_limited_tagged, limitedOutput, byU16,               noDict,        noDictIssue, taggedTable)
+
+typedef enum {
+    LZ4_spec_small = 0, LZ4_spec_small_limited, LZ4_spec_large, LZ4_spec_large_limited,      /* single block */
+    LZ4_spec_prefix, LZ4_spec_prefix_dictSmall, LZ4_spec_extDict, LZ4_spec_extDict_dictSmall,  /* streaming */
+    LZ4_spec_small_tagged, LZ4_spec_small_limited_tagged,                                       /* single block, fast reset */
+    LZ4_spec_dictCtx,                                                                           /* attached dictionary */
+    LZ4_spec_count
+} LZ4_compress_specialization_e;
+
+/* second index : acceleration==1 */
+static const LZ4_compress_specialized_f LZ4_compress_specializations[LZ4_spec_count][2] = {
+    { LZ4_compress_small,             LZ4_compress_small_a1 },
+    { LZ4_compress_small_limited,     LZ4_compress_small_limited_a1 },
+    { LZ4_compress_large,             LZ4_compress_large_a1 },
+    { LZ4_compress_large_limited,     LZ4_compress_large_limited_a1 },
+    { LZ4_compress_prefix,            LZ4_compress_prefix_a1 },
+    { LZ4_compress_prefix_dictSmall,  LZ4_compress_prefix_dictSmall_a1 },
+    { LZ4_compress_extDict,           LZ4_compress_extDict_a1 },
+    { LZ4_compress_extDict_dictSmall, LZ4_compress_extDict_dictSmall_a1 },
+    { LZ4_compress_small_tagged,         LZ4_compress_small_tagged_a1 },
+    { LZ4_compress_small_limited_tagged, LZ4_compress_small_limited_tagged_a1 },
+    { LZ4_compress_dictCtx,           LZ4_compress_dictCtx_a1 }
+};
+
+LZ4_FORCE_INLINE int LZ4_compress_specialized(LZ4_compress_specialization_e spec,
+                        LZ4_stream_t_internal* cctx, const char* source, char* dest, int inputSize, int maxOutputSize, int acceleration)
+{
+    return LZ4_compress_specializations[spec][acceleration==1](cctx, source, dest, inputSize, maxOutputSize, (U32)acceleration);
+}
+
+static LZ4_compress_specialization_e LZ4_compress_singleBlockSpecialization(int inputSize, int maxOutputSize)
+{
+    int const limited = (maxOutputSize < LZ4_compressBound(inputSize));
+    if (inputSize < LZ4_64Klimit) return limited ? LZ4_spec_small_limited : LZ4_spec_small;
+    return limited ? LZ4_spec_large_limited : LZ4_spec_large;
+}
+
+
 int LZ4_compress_fast_extState(void* state, const char* source, char* dest, int inputSize, int maxOutputSize, int acceleration)
 {
     LZ4_stream_t_internal* ctx = &((LZ4_stream_t*)state)->internal_donotuse;
     LZ4_resetStream((LZ4_stream_t*)state);
     if (acceleration < 1) acceleration = ACCELERATION_DEFAULT;
 
-    if (maxOutputSize >= LZ4_compressBound(inputSize)) {
-        if (inputSize < LZ4_64Klimit)
-            return LZ4_compress_generic(ctx, source, dest, inputSize,             0,    notLimited,                        byU16, noDict, noDictIssue, acceleration);
-        else
-            return LZ4_compress_generic(ctx, source, dest, inputSize,             0,    notLimited, (sizeof(void*)==8) ? byU32 : byPtr, noDict, noDictIssue, acceleration);
-    } else {
-        if (inputSize < LZ4_64Klimit)
-            return LZ4_compress_generic(ctx, source, dest, inputSize, maxOutputSize, limitedOutput,                        byU16, noDict, noDictIssue, acceleration);
+    return LZ4_compress_specialized(LZ4_compress_singleBlockSpecialization(inputSize, maxOutputSize),
+                                    ctx, source, dest, inputSize, maxOutputSize, acceleration);
+}
+
+
+/* LZ4_compress_fastReset_small() :
+ * inputSize < LZ4_64Klimit, acceleration >= 1 */
+LZ4_FORCE_INLINE int LZ4_compress_fastReset_small(LZ4_stream_t* state, const char* source, char* dest, int inputSize, int maxOutputSize, int acceleration)
+{
+    LZ4_stream_t_internal* const ctx = &state->internal_donotuse;
+    int result;
+
+    if ( (ctx->tableState != tableCleared)
+      && ((ctx->tableState != tableTagged) || (ctx->currentOffset + (U32)inputSize > 0xFFFF)) )
+        LZ4_resetStream(state);
+    if (ctx->tableState == tableCleared) ctx->currentOffset = 0;
+
+    result = LZ4_compress_specialized((maxOutputSize < LZ4_compressBound(inputSize)) ? LZ4_spec_small_limited_tagged : LZ4_spec_small_tagged,
+                                      ctx, source, dest, inputSize, maxOutputSize, acceleration);
+    /* next call must ignore all entries written by this one, even after an error */
+    ctx->tableState = tableTagged;
+    ctx->currentOffset += (U32)inputSize;
+    return result;
+}
+
+int LZ4_compress_fast_extState_fastReset(void* state, const char* source, char* dest, int inputSize, int maxOutputSize, int acceleration)
+{
+    /* large inputs : wiping the table is comparatively cheap */
+    if ((U32)inputSize >= (U32)LZ4_64Klimit)
+        return LZ4_compress_fast_extState(state, source, dest, inputSize, maxOutputSize, acceleration);
+    if (acceleration < 1) acceleration = ACCELERATION_DEFAULT;
+    return LZ4_compress_fastReset_small((LZ4_stream_t*)state, source, dest, inputSize, maxOutputSize, acceleration);
+}
+
+
+int LZ4_compress_batch(void* state, const char* const* srcs, const int* srcSizes,
+                       char* const* dsts, const int* dstCapacities, int* dstSizes,
+                       int nbRecords, int acceleration)
+{
+    int nbErrors = 0;
+    int n;
+    if (acceleration < 1) acceleration = ACCELERATION_DEFAULT;
+
+    for (n = 0; n < nbRecords; n++) {
+        int const srcSize = srcSizes[n];
+        int cSize;
+        if (n+1 < nbRecords) {   /* next record's first lines arrive while this one compresses */
+            LZ4_PREFETCH(srcs[n+1]);
+            LZ4_PREFETCH_WRITE(dsts[n+1]);
+        }
+        if ((U32)srcSize < (U32)LZ4_64Klimit)
+            cSize = LZ4_compress_fastReset_small((LZ4_stream_t*)state, srcs[n], dsts[n], srcSize, dstCapacities[n], acceleration);
         else
-            return LZ4_compress_generic(ctx, source, dest, inputSize, maxOutputSize, limitedOutput, (sizeof(void*)==8) ? byU32 : byPtr, noDict, noDictIssue, acceleration);
+            cSize = LZ4_compress_fast_extState(state, srcs[n], dsts[n], srcSize, dstCapacities[n], acceleration);
+        dstSizes[n] = cSize;
+        nbErrors += (cSize == 0);
     }
+    return nbErrors;
+}
+
+
+/* hidden debug function, to benchmark a single block specialization :
+ * specialization 0:small, 1:small_limited, 2:large, 3:large_limited */
+int LZ4_compress_fast_extState_specialized(void* state, const char* source, char* dest, int inputSize, int maxOutputSize, int acceleration, int specialization)
+{
+    LZ4_stream_t_internal* ctx = &((LZ4_stream_t*)state)->internal_donotuse;
+    if ((specialization < LZ4_spec_small) || (specialization > LZ4_spec_large_limited)) return 0;
+    if ((specialization <= LZ4_spec_small_limited) && (inputSize >= LZ4_64Klimit)) return 0;
+    if (!(specialization & 1) && (maxOutputSize < LZ4_compressBound(inputSize))) return 0;
+    LZ4_resetStream((LZ4_stream_t*)state);
+    if (acceleration < 1) acceleration = ACCELERATION_DEFAULT;
+    return LZ4_compress_specialized((LZ4_compress_specialization_e)specialization, ctx, source, dest, inputSize, maxOutputSize, acceleration);
 }
 
 
@@ -785,9 +1253,280 @@ int LZ4_compress_fast_force(const char* source, char* dest, int inputSize, int m
     LZ4_resetStream(&ctx);
 
     if (inputSize < LZ4_64Klimit)
-        return LZ4_compress_generic(&ctx.internal_donotuse, source, dest, inputSize, maxOutputSize, limitedOutput, byU16,                        noDict, noDictIssue, acceleration);
+        return LZ4_compress_generic(&ctx.internal_donotuse, source, dest, inputSize, maxOutputSize, limitedOutput, byU16,                        noDict, noDictIssue, freshTable, acceleration);
     else
-        return LZ4_compress_generic(&ctx.internal_donotuse, source, dest, inputSize, maxOutputSize, limitedOutput, sizeof(void*)==8 ? byU32 : byPtr, noDict, noDictIssue, acceleration);
+        return LZ4_compress_generic(&ctx.internal_donotuse, source, dest, inputSize, maxOutputSize, limitedOutput, sizeof(void*)==8 ? byU32 : byPtr, noDict, noDictIssue, freshTable, acceleration);
+}
+
+
+/*-******************************
+*  Lazy compression
+********************************/
+/* Intermediate levels, between LZ4_compress_fast() and LZ4_compress_HC().
+ * Before emitting a match, the parser checks whether next position starts a longer one.
+ * lazyLevel 1 uses the table of LZ4_compress_fast() (same positions, same hash) :
+ * it's compatible with LZ4_loadDict() and LZ4_saveDict().
+ * lazyLevel 2 adds a second table, indexed by a hash of 8 bytes,
+ * which keeps long matches that would otherwise be evicted by short ones.
+ * Entries are always U32 indexes, relative to source - currentOffset, as in streaming mode. */
+#define LZ4_LAZY_MINLONG 8   /* lazyLevel 2 : long candidate is good enough, skip the short one */
+
+static U32 LZ4_lazy_hash8(const BYTE* p)
+{
+    static const U64 prime8bytes = 11400714785074694791ULL;
+    U64 const sequence = ((U64)LZ4_read32(p+4) << 32) | LZ4_read32(p);
+    return (U32)((sequence * prime8bytes) >> (64 - LZ4_HASHLOG));
+}
+
+/* LZ4_lazy_insert() :
+ * references position `p` (index `idx`) ; reads up to 8 bytes at `p` */
+LZ4_FORCE_INLINE void LZ4_lazy_insert(U32* hashTable, U32* longTable, const BYTE* p, U32 idx, int lazyLevel)
+{
+    hashTable[LZ4_hashPosition(p, byU32)] = idx;
+    if (lazyLevel >= 2) longTable[LZ4_lazy_hash8(p)] = idx;
+}
+
+typedef struct {
+    const BYTE* base;        /* local positions : base + index */
+    U32 startIndex;          /* index of source ; lower indexes belong to dictionary */
+    U32 lowIndex;            /* lowest valid index */
+    const BYTE* dictEnd;     /* usingExtDict : dictionary positions are dictEnd - (startIndex - index) */
+    const BYTE* source;
+    const BYTE* matchlimit;
+} LZ4_lazyWindow_t;
+
+/* LZ4_lazy_count() :
+ * any table entry is accepted : it's validated against the window, then compared.
+ * @return : length of match between `ip` and `matchIndex`, 0 if there is none */
+LZ4_FORCE_INLINE unsigned LZ4_lazy_count(const LZ4_lazyWindow_t* w, const BYTE* ip, U32 ipIndex, U32 matchIndex,
+                                         const dict_directive dict)
+{
+    if ((matchIndex < w->lowIndex) || (matchIndex >= ipIndex) || (ipIndex - matchIndex > MAX_DISTANCE)) return 0;
+    if ((dict==usingExtDict) && (matchIndex < w->startIndex)) {
+        const BYTE* const match = w->dictEnd - (w->startIndex - matchIndex);
+        const BYTE* limit = ip + (w->dictEnd - match);
+        unsigned length;
+        if (LZ4_read32(match) != LZ4_read32(ip)) return 0;
+        if (limit > w->matchlimit) limit = w->matchlimit;
+        length = MINMATCH + LZ4_count(ip+MINMATCH, match+MINMATCH, limit);
+        if (ip+length == limit) length += LZ4_count(limit, w->source, w->matchlimit);   /* continues into source */
+        return length;
+    }
+    {   const BYTE* const match = w->base + matchIndex;
+        if (LZ4_read32(match) != LZ4_read32(ip)) return 0;
+        return MINMATCH + LZ4_count(ip+MINMATCH, match+MINMATCH, w->matchlimit);
+    }
+}
+
+/* LZ4_lazy_search() :
+ * finds the longest match among candidates of `ip`, then references `ip`.
+ * @return : match length (0 if none), and its index into *matchIndexPtr */
+LZ4_FORCE_INLINE unsigned LZ4_lazy_search(const LZ4_lazyWindow_t* w, U32* hashTable, U32* longTable,
+                                          const BYTE* ip, U32* matchIndexPtr,
+                                          const dict_directive dict, const int lazyLevel)
+{
+    U32 const ipIndex = (U32)(ip - w->base);
+    U32 const h = LZ4_hashPosition(ip, byU32);
+    U32 const matchIndex = hashTable[h];
+    hashTable[h] = ipIndex;
+    if (lazyLevel >= 2) {
+        U32 const h8 = LZ4_lazy_hash8(ip);
+        U32 const longIndex = longTable[h8];
+        unsigned const longLength = LZ4_lazy_count(w, ip, ipIndex, longIndex, dict);
+        longTable[h8] = ipIndex;
+        if (longLength >= LZ4_LAZY_MINLONG) { *matchIndexPtr = longIndex; return longLength; }
+        {   unsigned const length = LZ4_lazy_count(w, ip, ipIndex, matchIndex, dict);
+            if (length > longLength) { *matchIndexPtr = matchIndex; return length; }
+            *matchIndexPtr = longIndex;
+            return longLength;
+    }   }
+    *matchIndexPtr = matchIndex;
+    return LZ4_lazy_count(w, ip, ipIndex, matchIndex, dict);
+}
+
+/** LZ4_compress_lazy_generic() :
+ *  dict : noDict, withPrefix64k or usingExtDict, as set up by LZ4_compress_lazy_continue().
+ *  `longTable` is only used by lazyLevel 2. */
+LZ4_FORCE_INLINE int LZ4_compress_lazy_generic(
+                 LZ4_stream_t_internal* const cctx,
+                 U32* const longTable,
+                 const char* const source,
+                 char* const dest,
+                 const int inputSize,
+                 const int maxOutputSize,
+                 const limitedOutput_directive outputLimited,
+                 const dict_directive dict,
+                 const int lazyLevel)
+{
+    const BYTE* ip = (const BYTE*) source;
+    const BYTE* anchor = ip;
+    const BYTE* const iend = ip + inputSize;
+    const BYTE* const mflimit = iend - MFLIMIT;
+    U32 const dictSize = (dict==noDict) ? 0 : cctx->dictSize;
+    U32* const hashTable = cctx->hashTable;
+    LZ4_lazyWindow_t w;
+
+    BYTE* op = (BYTE*) dest;
+    BYTE* const olimit = op + maxOutputSize;
+    unsigned searchMatchNb = 1 << LZ4_skipTrigger;
+
+    /* Init conditions */
+    if ((U32)inputSize > (U32)LZ4_MAX_INPUT_SIZE) return 0;   /* Unsupported inputSize, too large (or negative) */
+    cctx->tableState = tableDirty;
+    w.base = (const BYTE*)source - cctx->currentOffset;
+    w.startIndex = cctx->currentOffset;
+    w.lowIndex = cctx->currentOffset - dictSize;
+    w.dictEnd = cctx->dictionary + dictSize;
+    w.source = (const BYTE*)source;
+    w.matchlimit = iend - LASTLITERALS;
+    if (inputSize<LZ4_minLength) goto _last_literals;         /* Input too small, no compression (all literals) */
+
+    /* Main Loop */
+    while (ip <= mflimit) {
+        U32 matchIndex;
+        unsigned matchLength = LZ4_lazy_search(&w, hashTable, longTable, ip, &matchIndex, dict, lazyLevel);
+        BYTE* token;
+
+        if (matchLength == 0) {
+            ip += (searchMatchNb++ >> LZ4_skipTrigger);   /* skip faster over incompressible data */
+            continue;
+        }
+        searchMatchNb = 1 << LZ4_skipTrigger;
+
+        /* Lazy evaluation : prefer a longer match starting at next position */
+        while (ip+1 <= mflimit) {
+            U32 nextIndex;
+            unsigned const nextLength = LZ4_lazy_search(&w, hashTable, longTable, ip+1, &nextIndex, dict, lazyLevel);
+            if (nextLength <= matchLength) break;
+            ip++; matchIndex = nextIndex; matchLength = nextLength;
+        }
+
+        /* Catch up */
+        {   U32 const offset = (U32)(ip - w.base) - matchIndex;
+            int const inDict = (dict==usingExtDict) && (matchIndex < w.startIndex);
+            const BYTE* match = inDict ? w.dictEnd - (w.startIndex - matchIndex) : w.base + matchIndex;
+            const BYTE* const matchLow = inDict ? w.dictEnd - dictSize :
+                                         (dict==usingExtDict) ? w.source : w.base + w.lowIndex;
+            while ((ip > anchor) & (match > matchLow) && (ip[-1] == match[-1])) { ip--; match--; matchLength++; }
+
+            /* Encode Literals */
+            {   unsigned const litLength = (unsigned)(ip - anchor);
+                token = op++;
+                if ((outputLimited) &&  /* Check output buffer overflow */
+                    (unlikely(op + litLength + (2 + 1 + LASTLITERALS) + (litLength/255) > olimit)))
+                    return 0;
+                if (litLength >= RUN_MASK) {
+                    int len = (int)litLength-RUN_MASK;
+                    *token = (RUN_MASK<<ML_BITS);
+                    for(; len >= 255 ; len-=255) *op++ = 255;
+                    *op++ = (BYTE)len;
+                }
+                else *token = (BYTE)(litLength<<ML_BITS);
+
+                /* Copy Literals */
+                LZ4_wildCopy(op, anchor, op+litLength);
+                op+=litLength;
+            }
+
+            /* Encode Offset */
+            LZ4_writeLE16(op, (U16)offset); op+=2;
+        }
+
+        /* Encode MatchLength */
+        {   unsigned matchCode = matchLength - MINMATCH;
+            if ( outputLimited &&    /* Check output buffer overflow */
+                (unlikely(op + (1 + LASTLITERALS) + (matchCode>>8) > olimit)) )
+                return 0;
+            if (matchCode >= ML_MASK) {
+                *token += ML_MASK;
+                matchCode -= ML_MASK;
+                for(; matchCode >= 255 ; matchCode-=255) *op++ = 255;
+                *op++ = (BYTE)matchCode;
+            } else
+                *token += (BYTE)(matchCode);
+        }
+
+        /* Fill table : 2 positions within the match */
+        {   const BYTE* const matchEnd = ip + matchLength;
+            if (matchEnd <= mflimit) {
+                LZ4_lazy_insert(hashTable, longTable, ip+2, (U32)(ip+2 - w.base), lazyLevel);
+                LZ4_lazy_insert(hashTable, longTable, matchEnd-2, (U32)(matchEnd-2 - w.base), lazyLevel);
+            }
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+_last_literals:
+    /* Encode Last Literals */
+    {   size_t const lastRun = (size_t)(iend - anchor);
+        if ( (outputLimited) &&  /* Check output buffer overflow */
+            ((op - (BYTE*)dest) + lastRun + 1 + ((lastRun+255-RUN_MASK)/255) > (U32)maxOutputSize) )
+            return 0;
+        if (lastRun >= RUN_MASK) {
+            size_t accumulator = lastRun - RUN_MASK;
+            *op++ = RUN_MASK << ML_BITS;
+            for(; accumulator >= 255 ; accumulator-=255) *op++ = 255;
+            *op++ = (BYTE) accumulator;
+        } else {
+            *op++ = (BYTE)(lastRun<<ML_BITS);
+        }
+        memcpy(op, anchor, lastRun);
+        op += lastRun;
+    }
+
+    /* End */
+    return (int) (((char*)op)-dest);
+}
+
+/* one specialization per (dict, lazyLevel), dispatched at run time through LZ4_compress_lazy_select() */
+#define LZ4_COMPRESS_LAZY_SPECIALIZE(name, dict, lazyLevel)                                                    \
+static int LZ4_compress_lazy_##name(LZ4_streamLazy_t* state, const char* source, char* dest, int inputSize, int maxOutputSize) \
+{   return LZ4_compress_lazy_generic(&state->stream.internal_donotuse, state->longTable,                      \
+                                     source, dest, inputSize, maxOutputSize, limitedOutput, dict, lazyLevel); }
+
+LZ4_COMPRESS_LAZY_SPECIALIZE(noDict1,  noDict,        1)
+LZ4_COMPRESS_LAZY_SPECIALIZE(noDict2,  noDict,        2)
+LZ4_COMPRESS_LAZY_SPECIALIZE(prefix1,  withPrefix64k, 1)
+LZ4_COMPRESS_LAZY_SPECIALIZE(prefix2,  withPrefix64k, 2)
+LZ4_COMPRESS_LAZY_SPECIALIZE(extDict1, usingExtDict,  1)
+LZ4_COMPRESS_LAZY_SPECIALIZE(extDict2, usingExtDict,  2)
+
+typedef int (*LZ4_compressLazy_f)(LZ4_streamLazy_t* state, const char* source, char* dest, int inputSize, int maxOutputSize);
+
+static LZ4_compressLazy_f LZ4_compress_lazy_select(dict_directive dict, int lazyLevel)
+{
+    switch (dict) {
+    case withPrefix64k: return (lazyLevel >= 2) ? LZ4_compress_lazy_prefix2  : LZ4_compress_lazy_prefix1;
+    case usingExtDict:  return (lazyLevel >= 2) ? LZ4_compress_lazy_extDict2 : LZ4_compress_lazy_extDict1;
+    case noDict:
+    case usingDictCtx:
+    default:            return (lazyLevel >= 2) ? LZ4_compress_lazy_noDict2  : LZ4_compress_lazy_noDict1;
+    }
+}
+
+int LZ4_compress_lazy_extState(void* state, const char* source, char* dest, int inputSize, int maxOutputSize, int lazyLevel)
+{
+    if (lazyLevel >= 2) LZ4_resetStreamLazy((LZ4_streamLazy_t*)state);
+    else LZ4_resetStream((LZ4_stream_t*)state);   /* longTable is not used, and may not even exist */
+    return LZ4_compress_lazy_select(noDict, lazyLevel)((LZ4_streamLazy_t*)state, source, dest, inputSize, maxOutputSize);
+}
+
+int LZ4_compress_lazy(const char* source, char* dest, int inputSize, int maxOutputSize, int lazyLevel)
+{
+#if (LZ4_HEAPMODE)
+    void* ctxPtr = ALLOCATOR(1, sizeof(LZ4_streamLazy_t));   /* malloc-calloc always properly aligned */
+#else
+    LZ4_streamLazy_t ctx;
+    void* const ctxPtr = &ctx;
+#endif
+
+    int const result = LZ4_compress_lazy_extState(ctxPtr, source, dest, inputSize, maxOutputSize, lazyLevel);
+
+#if (LZ4_HEAPMODE)
+    FREEMEM(ctxPtr);
+#endif
+    return result;
 }
 
 
@@ -824,6 +1563,7 @@ static int LZ4_compress_destSize_generic(
     if (targetDstSize < 1) return 0;                                     /* Impossible to store anything */
     if ((U32)*srcSizePtr > (U32)LZ4_MAX_INPUT_SIZE) return 0;            /* Unsupported input size, too large (or negative) */
     if ((tableType == byU16) && (*srcSizePtr>=LZ4_64Klimit)) return 0;   /* Size too large (not within 64K limit) */
+    ctx->tableState = tableDirty;
     if (*srcSizePtr<LZ4_minLength) goto _last_literals;                  /* Input too small, no compression (all literals) */
 
     /* First Byte */
@@ -1011,6 +1751,18 @@ int LZ4_freeStream (LZ4_stream_t* LZ4_stream)
 }
 
 
+/* LZ4_stream_needsReset() :
+ * tells if entries already in the table can't be kept when the stream starts using a dictionary.
+ * Streaming leaves byU32 entries, all below currentOffset : they are simply ignored.
+ * One-shot compression leaves byU16 or byPtr entries, or byU32 entries relative to a currentOffset of 0 :
+ * once currentOffset moves up, they would look like valid, or even future, positions. */
+static int LZ4_stream_needsReset(const LZ4_stream_t_internal* ctx)
+{
+    return (ctx->initCheck) || (ctx->currentOffset > 1 GB)                 /* Uninitialized structure, or reuse overflow */
+        || (ctx->tableState == tableTagged)                                /* byU16 entries from LZ4_compress_fast_extState_fastReset() */
+        || ((ctx->tableState == tableDirty) && (ctx->currentOffset == 0)); /* one-shot compression : extState, destSize, lazy */
+}
+
 #define HASH_UNIT sizeof(reg_t)
 int LZ4_loadDict (LZ4_stream_t* LZ4_dict, const char* dictionary, int dictSize)
 {
@@ -1019,8 +1771,9 @@ int LZ4_loadDict (LZ4_stream_t* LZ4_dict, const char* dictionary, int dictSize)
     const BYTE* const dictEnd = p + dictSize;
     const BYTE* base;
 
-    if ((dict->initCheck) || (dict->currentOffset > 1 GB))  /* Uninitialized structure, or reuse overflow */
-        LZ4_resetStream(LZ4_dict);
+    if (LZ4_stream_needsReset(dict)) LZ4_resetStream(LZ4_dict);
+    dict->tableState = tableDirty;
+    dict->dictCtx = NULL;
 
     if (dictSize < (int)HASH_UNIT) {
         dict->dictionary = NULL;
@@ -1044,7 +1797,26 @@ int LZ4_loadDict (LZ4_stream_t* LZ4_dict, const char* dictionary, int dictSize)
 }
 
 
-static void LZ4_renormDictT(LZ4_stream_t_internal* LZ4_dict, const BYTE* src)
+void LZ4_attach_dictionary(LZ4_stream_t* working_stream, const LZ4_stream_t* dictionary_stream)
+{
+    LZ4_stream_t_internal* const ctx = &working_stream->internal_donotuse;
+
+    if (LZ4_stream_needsReset(ctx)) LZ4_resetStream(working_stream);
+
+    /* new stream : entries already in the table lie below next block, hence are ignored.
+     * a cleared table must not look like it points at the beginning of next block */
+    if (ctx->currentOffset == 0) ctx->currentOffset = 64 KB;
+    ctx->dictionary = NULL;
+    ctx->dictSize = 0;
+    ctx->dictCtx = NULL;
+    if ((dictionary_stream != NULL) && (dictionary_stream->internal_donotuse.dictSize > 0))
+        ctx->dictCtx = &dictionary_stream->internal_donotuse;
+}
+
+
+/* LZ4_renormDictT() :
+ * `longTable` : second table of LZ4_streamLazy_t, rescaled alongside ; NULL if none */
+static void LZ4_renormDictT(LZ4_stream_t_internal* LZ4_dict, U32* longTable, const BYTE* src)
 {
     if ((LZ4_dict->currentOffset > 0x80000000) ||
         ((uptrval)LZ4_dict->currentOffset > (uptrval)src)) {   /* address space overflow */
@@ -1056,6 +1828,11 @@ static void LZ4_renormDictT(LZ4_stream_t_internal* LZ4_dict, const BYTE* src)
             if (LZ4_dict->hashTable[i] < delta) LZ4_dict->hashTable[i]=0;
             else LZ4_dict->hashTable[i] -= delta;
         }
+        if (longTable) {
+            for (i=0; i<LZ4_HASH_SIZE_U32; i++) {
+                if (longTable[i] < delta) longTable[i]=0;
+                else longTable[i] -= delta;
+        }   }
         LZ4_dict->currentOffset = 64 KB;
         if (LZ4_dict->dictSize > 64 KB) LZ4_dict->dictSize = 64 KB;
         LZ4_dict->dictionary = dictEnd - LZ4_dict->dictSize;
@@ -1071,9 +1848,19 @@ int LZ4_compress_fast_continue (LZ4_stream_t* LZ4_stream, const char* source, ch
     const BYTE* smallest = (const BYTE*) source;
     if (streamPtr->initCheck) return 0;   /* Uninitialized structure detected */
     if ((streamPtr->dictSize>0) && (smallest>dictEnd)) smallest = dictEnd;
-    LZ4_renormDictT(streamPtr, smallest);
+    LZ4_renormDictT(streamPtr, NULL, smallest);
     if (acceleration < 1) acceleration = ACCELERATION_DEFAULT;
 
+    /* attached dictionary : only used by first block, which becomes the dictionary of next one */
+    if (streamPtr->dictCtx != NULL) {
+        int const result = LZ4_compress_specialized(LZ4_spec_dictCtx, streamPtr, source, dest, inputSize, maxOutputSize, acceleration);
+        streamPtr->dictCtx = NULL;
+        streamPtr->dictionary = (const BYTE*)source;
+        streamPtr->dictSize = (U32)inputSize;
+        streamPtr->currentOffset += (U32)inputSize;
+        return result;
+    }
+
     /* Check overlapping input/dictionary space */
     {   const BYTE* sourceEnd = (const BYTE*) source + inputSize;
         if ((sourceEnd > streamPtr->dictionary) && (sourceEnd < dictEnd)) {
@@ -1088,9 +1875,9 @@ int LZ4_compress_fast_continue (LZ4_stream_t* LZ4_stream, const char* source, ch
     if (dictEnd == (const BYTE*)source) {
         int result;
         if ((streamPtr->dictSize < 64 KB) && (streamPtr->dictSize < streamPtr->currentOffset))
-            result = LZ4_compress_generic(streamPtr, source, dest, inputSize, maxOutputSize, limitedOutput, byU32, withPrefix64k, dictSmall, acceleration);
+            result = LZ4_compress_specialized(LZ4_spec_prefix_dictSmall, streamPtr, source, dest, inputSize, maxOutputSize, acceleration);
         else
-            result = LZ4_compress_generic(streamPtr, source, dest, inputSize, maxOutputSize, limitedOutput, byU32, withPrefix64k, noDictIssue, acceleration);
+            result = LZ4_compress_specialized(LZ4_spec_prefix, streamPtr, source, dest, inputSize, maxOutputSize, acceleration);
         streamPtr->dictSize += (U32)inputSize;
         streamPtr->currentOffset += (U32)inputSize;
         return result;
@@ -1099,9 +1886,9 @@ int LZ4_compress_fast_continue (LZ4_stream_t* LZ4_stream, const char* source, ch
     /* external dictionary mode */
     {   int result;
         if ((streamPtr->dictSize < 64 KB) && (streamPtr->dictSize < streamPtr->currentOffset))
-            result = LZ4_compress_generic(streamPtr, source, dest, inputSize, maxOutputSize, limitedOutput, byU32, usingExtDict, dictSmall, acceleration);
+            result = LZ4_compress_specialized(LZ4_spec_extDict_dictSmall, streamPtr, source, dest, inputSize, maxOutputSize, acceleration);
         else
-            result = LZ4_compress_generic(streamPtr, source, dest, inputSize, maxOutputSize, limitedOutput, byU32, usingExtDict, noDictIssue, acceleration);
+            result = LZ4_compress_specialized(LZ4_spec_extDict, streamPtr, source, dest, inputSize, maxOutputSize, acceleration);
         streamPtr->dictionary = (const BYTE*)source;
         streamPtr->dictSize = (U32)inputSize;
         streamPtr->currentOffset += (U32)inputSize;
@@ -1110,6 +1897,95 @@ int LZ4_compress_fast_continue (LZ4_stream_t* LZ4_stream, const char* source, ch
 }
 
 
+void LZ4_resetStreamLazy (LZ4_streamLazy_t* LZ4_stream)
+{
+    DEBUGLOG(4, "LZ4_resetStreamLazy");
+    MEM_INIT(LZ4_stream, 0, sizeof(LZ4_streamLazy_t));
+}
+
+/* LZ4_lazy_fillLongTable() :
+ * references dictionary of `ctx` into `longTable`, at the same positions as LZ4_loadDict() */
+static void LZ4_lazy_fillLongTable(U32* longTable, const LZ4_stream_t_internal* ctx)
+{
+    const BYTE* const dictEnd = ctx->dictionary + ctx->dictSize;
+    const BYTE* p = ctx->dictionary;
+    if (ctx->dictSize < 8) return;
+    while (p <= dictEnd-8) {   /* LZ4_lazy_hash8() reads 8 bytes */
+        longTable[LZ4_lazy_hash8(p)] = ctx->currentOffset - (U32)(dictEnd - p);
+        p+=3;
+    }
+}
+
+int LZ4_loadDictLazy (LZ4_streamLazy_t* LZ4_dict, const char* dictionary, int dictSize)
+{
+    int const loaded = LZ4_loadDict(&LZ4_dict->stream, dictionary, dictSize);
+    LZ4_dict->dictStream = NULL;
+    MEM_INIT(LZ4_dict->longTable, 0, sizeof(LZ4_dict->longTable));
+    LZ4_lazy_fillLongTable(LZ4_dict->longTable, &LZ4_dict->stream.internal_donotuse);
+    return loaded;
+}
+
+void LZ4_attach_dictionaryLazy(LZ4_streamLazy_t* working_stream, const LZ4_streamLazy_t* dictionary_stream)
+{
+    LZ4_attach_dictionary(&working_stream->stream, (dictionary_stream != NULL) ? &dictionary_stream->stream : NULL);
+    working_stream->dictStream = (working_stream->stream.internal_donotuse.dictCtx != NULL) ? dictionary_stream : NULL;
+}
+
+int LZ4_compress_lazy_continue (LZ4_streamLazy_t* LZ4_stream, const char* source, char* dest, int inputSize, int maxOutputSize, int lazyLevel)
+{
+    LZ4_stream_t_internal* const streamPtr = &LZ4_stream->stream.internal_donotuse;
+    U32* const longTable = (lazyLevel >= 2) ? LZ4_stream->longTable : NULL;
+    const BYTE* dictEnd;
+    const BYTE* smallest = (const BYTE*) source;
+    int result;
+
+    if (streamPtr->initCheck) return 0;   /* Uninitialized structure detected */
+
+    /* attached dictionary : tables are copied, since the lazy parser doesn't read them by reference */
+    if (streamPtr->dictCtx != NULL) {
+        const LZ4_streamLazy_t* const dictStream = LZ4_stream->dictStream;
+        int const hasLongTable = (dictStream != NULL) && (&dictStream->stream.internal_donotuse == streamPtr->dictCtx);
+        memcpy(streamPtr, streamPtr->dictCtx, sizeof(*streamPtr));
+        if (longTable) {
+            if (hasLongTable) {   /* LZ4_attach_dictionaryLazy() : already built by LZ4_loadDictLazy() */
+                memcpy(longTable, dictStream->longTable, sizeof(LZ4_stream->longTable));
+            } else {
+                MEM_INIT(longTable, 0, sizeof(LZ4_stream->longTable));
+                LZ4_lazy_fillLongTable(longTable, streamPtr);
+    }   }   }
+    LZ4_stream->dictStream = NULL;
+
+    dictEnd = streamPtr->dictionary + streamPtr->dictSize;
+    if ((streamPtr->dictSize>0) && (smallest>dictEnd)) smallest = dictEnd;
+    LZ4_renormDictT(streamPtr, longTable, smallest);
+
+    /* Check overlapping input/dictionary space */
+    {   const BYTE* sourceEnd = (const BYTE*) source + inputSize;
+        if ((sourceEnd > streamPtr->dictionary) && (sourceEnd < dictEnd)) {
+            streamPtr->dictSize = (U32)(dictEnd - sourceEnd);
+            if (streamPtr->dictSize > 64 KB) streamPtr->dictSize = 64 KB;
+            if (streamPtr->dictSize < 4) streamPtr->dictSize = 0;
+            streamPtr->dictionary = dictEnd - streamPtr->dictSize;
+        }
+    }
+
+    /* prefix mode : source data follows dictionary */
+    if (dictEnd == (const BYTE*)source) {
+        result = LZ4_compress_lazy_select(withPrefix64k, lazyLevel)(LZ4_stream, source, dest, inputSize, maxOutputSize);
+        streamPtr->dictSize += (U32)inputSize;
+        streamPtr->currentOffset += (U32)inputSize;
+        return result;
+    }
+
+    /* external dictionary mode */
+    result = LZ4_compress_lazy_select(usingExtDict, lazyLevel)(LZ4_stream, source, dest, inputSize, maxOutputSize);
+    streamPtr->dictionary = (const BYTE*)source;
+    streamPtr->dictSize = (U32)inputSize;
+    streamPtr->currentOffset += (U32)inputSize;
+    return result;
+}
+
+
 /* Hidden debug function, to force external dictionary mode */
 int LZ4_compress_forceExtDict (LZ4_stream_t* LZ4_dict, const char* source, char* dest, int inputSize)
 {
@@ -1119,9 +1995,9 @@ int LZ4_compress_forceExtDict (LZ4_stream_t* LZ4_dict, const char* source, char*
 
     const BYTE* smallest = dictEnd;
     if (smallest > (const BYTE*) source) smallest = (const BYTE*) source;
-    LZ4_renormDictT(streamPtr, smallest);
+    LZ4_renormDictT(streamPtr, NULL, smallest);
 
-    result = LZ4_compress_generic(streamPtr, source, dest, inputSize, 0, notLimited, byU32, usingExtDict, noDictIssue, 1);
+    result = LZ4_compress_generic(streamPtr, source, dest, inputSize, 0, notLimited, byU32, usingExtDict, noDictIssue, freshTable, 1);
 
     streamPtr->dictionary = (const BYTE*)source;
     streamPtr->dictSize = (U32)inputSize;
@@ -1196,6 +2072,13 @@ LZ4_FORCE_INLINE int LZ4_decompress_generic(
     const int safeDecode = (endOnInput==endOnInputSize);
     const int checkOffset = ((safeDecode) && (dictSize < (int)(64 KB)));
 
+    /* bounds for the two-stage shortcut : max literals (14, or 8 in fast mode), then offset, then max match (18) */
+    const BYTE* const shortiend = iend - (endOnInput ? 14 : 8) /*maxLL*/ - 2 /*offset*/;
+    const BYTE* const shortoend = oend - (endOnInput ? 14 : 8) /*maxLL*/ - 18 /*maxML*/;
+#if LZ4_PATTERN_DISPATCH
+    int const patternKernel = LZ4_copyPattern_kernel();   /* dispatched once per block */
+#endif
+
 
     /* Special cases */
     if ((partialDecoding) && (oexit > oend-MFLIMIT)) oexit = oend-MFLIMIT;                      /* targetOutputSize too high => just decode everything */
@@ -1209,27 +2092,42 @@ LZ4_FORCE_INLINE int LZ4_decompress_generic(
         size_t offset;
 
         unsigned const token = *ip++;
+        length = token >> ML_BITS;   /* literal length */
 
-        /* shortcut for common case :
+        /* two-stage shortcut for the most common case :
          * in most circumstances, we expect to decode small matches (<= 18 bytes) separated by few literals (<= 14 bytes).
-         * this shortcut was tested on x86 and x64, where it improves decoding speed.
-         * it has not yet been benchmarked on ARM, Power, mips, etc. */
-        if (((ip + 14 /*maxLL*/ + 2 /*offset*/ <= iend)
-          & (op + 14 /*maxLL*/ + 18 /*maxML*/ <= oend))
-          & ((token < (15<<ML_BITS)) & ((token & ML_MASK) != 15)) ) {
-            size_t const ll = token >> ML_BITS;
-            size_t const off = LZ4_readLE16(ip+ll);
-            const BYTE* const matchPtr = op + ll - off;  /* pointer underflow risk ? */
-            if ((off >= 18) /* do not deal with overlapping matches */ & (matchPtr >= lowPrefix)) {
-                size_t const ml = (token & ML_MASK) + MINMATCH;
-                memcpy(op, ip, 16); op += ll; ip += ll + 2 /*offset*/;
-                memcpy(op, matchPtr, 18); op += ml;
-                continue;
+         * 1) if literal length fits into the token, and there is enough room in input and output,
+         *    copy 16 bytes on behalf of the literals (only 8 in fast mode, which can't check input).
+         * 2) then, if match length also fits into the token, and match doesn't overlap nor require a dictionary,
+         *    copy 18 bytes on behalf of the match.
+         * A single combined check at entry guarantees enough room for both stages.
+         * When stage 2 doesn't apply, offset and match length are already decoded : jump straight to match copy.
+         * An external dictionary may be located right after the output (decoder-side ring buffer) :
+         * when the match needs it, nothing is written speculatively, and the generic path is used instead. */
+        if ( (endOnInput ? length != RUN_MASK : length <= 8)
+          && likely((endOnInput ? ip < shortiend : 1) & (op <= shortoend)) ) {
+            offset = LZ4_readLE16(ip+length);
+            match = op + length - offset;
+            if ((dict!=usingExtDict) || (match >= lowPrefix)) {
+                memcpy(op, ip, endOnInput ? 16 : 8);
+                op += length; ip += length + 2 /*offset*/;
+
+                length = token & ML_MASK;   /* match length */
+                if ( (length != ML_MASK)
+                  && (offset >= 8)
+                  && ((dict==withPrefix64k) || (match >= lowPrefix)) ) {
+                    memcpy(op + 0, match + 0, 8);
+                    memcpy(op + 8, match + 8, 8);
+                    memcpy(op +16, match +16, 2);
+                    op += length + MINMATCH;
+                    continue;
+                }
+                goto _copy_match;
             }
         }
 
         /* decode literal length */
-        if ((length=(token>>ML_BITS)) == RUN_MASK) {
+        if (length == RUN_MASK) {
             unsigned s;
             do {
                 s = *ip++;
@@ -1262,11 +2160,14 @@ LZ4_FORCE_INLINE int LZ4_decompress_generic(
         /* get offset */
         offset = LZ4_readLE16(ip); ip+=2;
         match = op - offset;
-        if ((checkOffset) && (unlikely(match + dictSize < lowPrefix))) goto _output_error;   /* Error : offset outside buffers */
-        LZ4_write32(op, (U32)offset);   /* costs ~1%; silence an msan warning when offset==0 */
 
         /* get matchlength */
         length = token & ML_MASK;
+
+_copy_match:
+        if ((checkOffset) && (unlikely(match + dictSize < lowPrefix))) goto _output_error;   /* Error : offset outside buffers */
+        LZ4_write32(op, (U32)offset);   /* costs ~1%; silence an msan warning when offset==0 */
+
         if (length == ML_MASK) {
             unsigned s;
             do {
@@ -1305,6 +2206,19 @@ LZ4_FORCE_INLINE int LZ4_decompress_generic(
 
         /* copy match within block */
         cpy = op + length;
+#if LZ4_PATTERN_DISPATCH
+        /* long overlapping match : expand its pattern with wide stores */
+        if (unlikely((offset-1 < 15) & (length > 16)) && likely(cpy <= oend-32)) {
+            switch (patternKernel)
+            {
+            case LZ4_pattern_k_avx2:  LZ4_copyPattern_avx2(op, match, cpy); break;
+            case LZ4_pattern_k_ssse3: LZ4_copyPattern_ssse3(op, match, cpy); break;
+            default:                  LZ4_copyPattern_scalar(op, match, cpy);
+            }
+            op = cpy;
+            continue;
+        }
+#endif
         if (unlikely(offset<8)) {
             op[0] = match[0];
             op[1] = match[1];
@@ -1350,6 +2264,218 @@ int LZ4_decompress_safe(const char* source, char* dest, int compressedSize, int
     return LZ4_decompress_generic(source, dest, compressedSize, maxDecompressedSize, endOnInputSize, full, 0, noDict, (BYTE*)dest, NULL, 0);
 }
 
+LZ4_FORCE_O2_GCC_PPC64LE
+int LZ4_decompress_safe_batch(const char* const* srcs, const int* srcSizes,
+                              char* const* dsts, const int* dstCapacities, int* dstSizes,
+                              int nbRecords)
+{
+    int nbErrors = 0;
+    int n;
+    for (n = 0; n < nbRecords; n++) {
+        int dSize;
+        if (n+1 < nbRecords) {
+            LZ4_PREFETCH(srcs[n+1]);
+            LZ4_PREFETCH_WRITE(dsts[n+1]);
+        }
+        dSize = LZ4_decompress_generic(srcs[n], dsts[n], srcSizes[n], dstCapacities[n], endOnInputSize, full, 0, noDict, (BYTE*)dsts[n], NULL, 0);
+        dstSizes[n] = dSize;
+        nbErrors += (dSize < 0);
+    }
+    return nbErrors;
+}
+
+/*-*****************************
+*  Interleaved decompression
+*******************************/
+/* Decoding a single block is a long chain of dependent loads :
+ * each sequence's position depends on the previous one's lengths,
+ * so a cache miss on input, or on a match, stalls the whole decoder.
+ * Independent blocks have no such dependency between them :
+ * decoding them in lockstep, one sequence per block per round,
+ * lets out-of-order execution overlap their latencies.
+ * Each lane only decodes "easy" sequences, far enough from block's end.
+ * Anything else (last sequences, malformed input) is handed over to LZ4_decompress_generic(),
+ * which resumes decoding from the beginning of the sequence. */
+
+typedef struct {
+    const BYTE* ip;
+    const BYTE* iend;
+    const BYTE* shortiend;
+    BYTE* op;
+    BYTE* oend;
+    BYTE* shortoend;
+    BYTE* lowPrefix;
+} LZ4_decLane_t;
+
+/* LZ4_decodeLaneSequence() :
+ * decodes one sequence of `lane`, within block boundaries (noDict, safe).
+ * Nothing is committed into `lane` unless the whole sequence is decoded,
+ * though bytes beyond lane->op may be overwritten (within output buffer).
+ * @return : 1 if a sequence was decoded,
+ *           0 if lane must be finished by LZ4_decompress_generic() from current position. */
+LZ4_FORCE_INLINE int LZ4_decodeLaneSequence(LZ4_decLane_t* lane)
+{
+    static const unsigned inc32table[8] = {0, 1, 2,  1,  0,  4, 4, 4};
+    static const int      dec64table[8] = {0, 0, 0, -1, -4,  1, 2, 3};
+    const BYTE* ip = lane->ip;
+    const BYTE* const iend = lane->iend;
+    BYTE* op = lane->op;
+    BYTE* const oend = lane->oend;
+    BYTE* cpy;
+    const BYTE* match;
+    size_t offset;
+
+    unsigned const token = *ip++;
+    size_t length = token >> ML_BITS;   /* literal length */
+
+    /* same two-stage shortcut as LZ4_decompress_generic() */
+    if ((length != RUN_MASK) && likely((ip < lane->shortiend) & (op <= lane->shortoend))) {
+        memcpy(op, ip, 16);
+        op += length; ip += length;
+        offset = LZ4_readLE16(ip); ip += 2;
+        match = op - offset;
+        length = token & ML_MASK;
+        if ((length != ML_MASK) && (offset >= 8) && (match >= lane->lowPrefix)) {
+            memcpy(op + 0, match + 0, 8);
+            memcpy(op + 8, match + 8, 8);
+            memcpy(op +16, match +16, 2);
+            lane->ip = ip;
+            lane->op = op + length + MINMATCH;
+            return 1;
+        }
+        goto _copy_match;
+    }
+
+    /* decode literal length */
+    if (length == RUN_MASK) {
+        unsigned s;
+        do {
+            s = *ip++;
+            length += s;
+        } while (likely(ip<iend-RUN_MASK) & (s==255));
+        if (unlikely((uptrval)(op)+length<(uptrval)(op))) return 0;
+        if (unlikely((uptrval)(ip)+length<(uptrval)(ip))) return 0;
+    }
+
+    /* copy literals */
+    cpy = op+length;
+    if ((cpy>oend-MFLIMIT) || (ip+length>iend-(2+1+LASTLITERALS))) return 0;   /* last literals */
+    LZ4_wildCopy(op, ip, cpy);
+    ip += length; op = cpy;
+
+    /* get offset */
+    offset = LZ4_readLE16(ip); ip+=2;
+    match = op - offset;
+
+    /* get matchlength */
+    length = token & ML_MASK;
+
+_copy_match:
+    if (unlikely(match < lane->lowPrefix)) return 0;
+    LZ4_write32(op, (U32)offset);
+    if (length == ML_MASK) {
+        unsigned s;
+        do {
+            s = *ip++;
+            if (ip > iend-LASTLITERALS) return 0;
+            length += s;
+        } while (s==255);
+        if (unlikely((uptrval)(op)+length<(uptrval)op)) return 0;
+    }
+    length += MINMATCH;
+
+    /* copy match */
+    cpy = op + length;
+    if (unlikely(cpy>oend-12)) return 0;   /* close to block's end */
+    if (unlikely(offset<8)) {
+        op[0] = match[0];
+        op[1] = match[1];
+        op[2] = match[2];
+        op[3] = match[3];
+        match += inc32table[offset];
+        memcpy(op+4, match, 4);
+        match -= dec64table[offset];
+    } else { LZ4_copy8(op, match); match+=8; }
+    op += 8;
+    LZ4_copy8(op, match);
+    if (length>16) LZ4_wildCopy(op+8, match+8, cpy);
+
+    lane->ip = ip;
+    lane->op = cpy;
+    return 1;
+}
+
+/*! LZ4_decompress_safe_interleaved() :
+ *  `nbLanes` is expected to be a compile-time constant, so that lanes get fully unrolled. */
+LZ4_FORCE_INLINE int LZ4_decompress_safe_interleaved(
+                 const char* const* srcs, const int* srcSizes,
+                 char* const* dsts, const int* dstCapacities, int* dstSizes,
+                 int const nbLanes)
+{
+    LZ4_decLane_t lanes[4];
+    unsigned active = 0;
+    int nbErrors = 0;
+    int n;
+
+    assert(nbLanes <= 4);
+    for (n=0; n<nbLanes; n++) {
+        LZ4_decLane_t* const lane = lanes + n;
+        lane->ip = (const BYTE*)srcs[n];
+        lane->op = (BYTE*)dsts[n];
+        lane->lowPrefix = lane->op;
+        if ((srcSizes[n] <= 0) || (dstCapacities[n] <= 0)) {   /* let LZ4_decompress_generic() sort it out */
+            lane->iend = lane->shortiend = lane->ip;
+            lane->oend = lane->shortoend = lane->op;
+            continue;
+        }
+        lane->iend = lane->ip + srcSizes[n];
+        lane->oend = lane->op + dstCapacities[n];
+        lane->shortiend = lane->iend - 14 /*maxLL*/ - 2 /*offset*/;
+        lane->shortoend = lane->oend - 14 /*maxLL*/ - 18 /*maxML*/;
+        active |= 1U << n;
+    }
+
+    /* lockstep : one sequence per lane per round, as long as all lanes are active */
+    if (active == (1U << nbLanes) - 1) {
+        while (1) {
+            int ok = 1;
+            for (n=0; n<nbLanes; n++) ok &= LZ4_decodeLaneSequence(lanes + n);
+            if (!ok) break;
+    }   }
+    while (active) {
+        for (n=0; n<nbLanes; n++) {
+            if ((active >> n) & 1) {
+                if (!LZ4_decodeLaneSequence(lanes + n)) active &= ~(1U << n);
+    }   }   }
+
+    /* finish each lane with the regular decoder */
+    for (n=0; n<nbLanes; n++) {
+        LZ4_decLane_t* const lane = lanes + n;
+        int const iDone = (int)(lane->ip - (const BYTE*)srcs[n]);
+        int const oDone = (int)(lane->op - (BYTE*)dsts[n]);
+        int const r = LZ4_decompress_generic((const char*)lane->ip, (char*)lane->op,
+                                             srcSizes[n] - iDone, dstCapacities[n] - oDone,
+                                             endOnInputSize, full, 0, noDict, lane->lowPrefix, NULL, 0);
+        dstSizes[n] = (r < 0) ? r - iDone : oDone + r;
+        nbErrors += (r < 0);
+    }
+    return nbErrors;
+}
+
+LZ4_FORCE_O2_GCC_PPC64LE
+int LZ4_decompress_safe_x2(const char* const* srcs, const int* srcSizes,
+                           char* const* dsts, const int* dstCapacities, int* dstSizes)
+{
+    return LZ4_decompress_safe_interleaved(srcs, srcSizes, dsts, dstCapacities, dstSizes, 2);
+}
+
+LZ4_FORCE_O2_GCC_PPC64LE
+int LZ4_decompress_safe_x4(const char* const* srcs, const int* srcSizes,
+                           char* const* dsts, const int* dstCapacities, int* dstSizes)
+{
+    return LZ4_decompress_safe_interleaved(srcs, srcSizes, dsts, dstCapacities, dstSizes, 4);
+}
+
 LZ4_FORCE_O2_GCC_PPC64LE
 int LZ4_decompress_safe_partial(const char* source, char* dest, int compressedSize, int targetOutputSize, int maxDecompressedSize)
 {
@@ -351,14 +351,17 @@ LZ4LIB_API int LZ4_decompress_fast_usingDict (const char* src, char* dst, int or
 #if defined(__cplusplus) || (defined (__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) /* C99 */)
 #include <stdint.h>
 
-typedef struct {
+typedef struct LZ4_stream_t_internal LZ4_stream_t_internal;
+struct LZ4_stream_t_internal {
     uint32_t hashTable[LZ4_HASH_SIZE_U32];
     uint32_t currentOffset;
-    uint32_t initCheck;
+    uint16_t initCheck;
+    uint16_t tableState;
     const uint8_t* dictionary;
     uint8_t* bufferStart;   /* obsolete, used for slideInputBuffer */
+    const LZ4_stream_t_internal* dictCtx;
     uint32_t dictSize;
-} LZ4_stream_t_internal;
+};
 
 typedef struct {
     const uint8_t* externalDict;
@@ -369,14 +372,17 @@ typedef struct {
 
 #else
 
-typedef struct {
+typedef struct LZ4_stream_t_internal LZ4_stream_t_internal;
+struct LZ4_stream_t_internal {
     unsigned int hashTable[LZ4_HASH_SIZE_U32];
     unsigned int currentOffset;
-    unsigned int initCheck;
+    unsigned short initCheck;
+    unsigned short tableState;
     const unsigned char* dictionary;
     unsigned char* bufferStart;   /* obsolete, used for slideInputBuffer */
+    const LZ4_stream_t_internal* dictCtx;
     unsigned int dictSize;
-} LZ4_stream_t_internal;
+};
 
 typedef struct {
     const unsigned char* externalDict;
@@ -394,8 +400,11 @@ typedef struct {
  * note : only use in association with static linking !
  *        this definition is not API/ABI safe,
  *        it may change in a future version !
+ * note 2 : LZ4_STREAMSIZE_U64 grew from +4 to +5 when `dictCtx` was added (LZ4_attach_dictionary()) :
+ *        sizeof(LZ4_stream_t) is 8 bytes larger than in v1.8.1 release.
+ *        Code allocating LZ4_stream_t statically, or using LZ4_STREAMSIZE, must be recompiled.
  */
-#define LZ4_STREAMSIZE_U64 ((1 << (LZ4_MEMORY_USAGE-3)) + 4)
+#define LZ4_STREAMSIZE_U64 ((1 << (LZ4_MEMORY_USAGE-3)) + 5)
 #define LZ4_STREAMSIZE     (LZ4_STREAMSIZE_U64 * sizeof(unsigned long long))
 union LZ4_stream_u {
     unsigned long long table[LZ4_STREAMSIZE_U64];
@@ -474,6 +483,122 @@ LZ4LIB_API LZ4_DEPRECATED("use LZ4_decompress_fast_usingDict() instead") int LZ4
 #endif /* LZ4_H_2983827168210 */
 
 
+/*-**************************************************
+ * !!!!!     STATIC LINKING ONLY     !!!!!
+ * Following definitions are considered experimental.
+ * They should not be linked from DLL,
+ * as there is no guarantee of API stability yet.
+ * Prototypes will be promoted to "stable" status
+ * after successfull usage in real-life scenarios.
+ ***************************************************/
+#ifdef LZ4_STATIC_LINKING_ONLY   /* protection macro */
+#ifndef LZ4_SLO_299033254
+#define LZ4_SLO_299033254
+
+/*! LZ4_compress_fast_extState_fastReset() : v1.8.1 (experimental)
+ *  Same as LZ4_compress_fast_extState(), but does not wipe `state` before each call.
+ *  Instead, hash table entries are tagged with a position which increases from one call to the next,
+ *  so that entries left by previous calls are ignored.
+ *  The table is only wiped once every 64 KB of input, or when `state` was last used by another function.
+ *  This is much faster when compressing many small inputs with the same `state`.
+ *  Result is byte-identical to LZ4_compress_fast_extState().
+ *  `state` must have been initialized once, using LZ4_resetStream() or LZ4_createStream().
+ */
+int LZ4_compress_fast_extState_fastReset (void* state, const char* src, char* dst, int srcSize, int dstCapacity, int acceleration);
+
+/*! LZ4_attach_dictionary() : v1.8.1 (experimental)
+ *  Starts a new stream on `working_stream`, referencing `dictionary_stream` instead of copying it.
+ *  `dictionary_stream` must have been prepared once with LZ4_loadDict(),
+ *  and must remain unmodified, along with its dictionary buffer, while it's referenced.
+ *  The first LZ4_compress_fast_continue() on `working_stream` then searches matches
+ *  into both its own (empty) table and the one of `dictionary_stream`,
+ *  avoiding to re-hash the dictionary for each new stream.
+ *  Afterwards, the dictionary is no longer referenced : next blocks depend on previous ones, as usual.
+ *  `dictionary_stream` is only read : it can be attached to any number of working streams,
+ *  in any number of threads, concurrently.
+ *  Previous content of `working_stream` is discarded, without wiping its table (cheap reset).
+ *  `dictionary_stream==NULL` just starts a new stream, without dictionary.
+ *  Output can be decoded with LZ4_decompress_safe_usingDict(), using the same dictionary.
+ */
+void LZ4_attach_dictionary(LZ4_stream_t* working_stream, const LZ4_stream_t* dictionary_stream);
+
+/*! LZ4_compress_lazy() : v1.8.1 (experimental)
+ *  Intermediate compression levels, between LZ4_compress_default() and LZ4_compress_HC().
+ *  Before emitting a match, the parser checks if next position starts a longer one (lazy matching).
+ *  `lazyLevel` 1 : uses the same 16 KB hash table as LZ4_compress_fast() ;
+ *  `lazyLevel` 2 : adds a second table, of 8-bytes sequences, which keeps long matches : slower, compresses more.
+ *  Output is a regular LZ4 block, for which decompression speed is unaffected.
+ *  LZ4_compress_lazy_extState() : `state` must be a LZ4_streamLazy_t (a LZ4_stream_t is enough for `lazyLevel` 1).
+ */
+int LZ4_compress_lazy (const char* src, char* dst, int srcSize, int dstCapacity, int lazyLevel);
+int LZ4_compress_lazy_extState (void* state, const char* src, char* dst, int srcSize, int dstCapacity, int lazyLevel);
+
+/*! LZ4_streamLazy_t : v1.8.1 (experimental)
+ *  Streaming state of LZ4_compress_lazy_continue(), for any `lazyLevel`.
+ *  Its first member is a regular stream : LZ4_saveDict() can be invoked on `&state->stream`.
+ *  Initialize it with LZ4_resetStreamLazy() or LZ4_loadDictLazy(), not LZ4_resetStream() nor LZ4_loadDict().
+ *  A given stream must always be used with the same `lazyLevel`.
+ */
+typedef struct LZ4_streamLazy_s {
+    LZ4_stream_t stream;                           /* same table as LZ4_compress_fast() */
+    unsigned int longTable[LZ4_HASH_SIZE_U32];     /* lazyLevel 2 : positions of 8-bytes sequences */
+    const struct LZ4_streamLazy_s* dictStream;     /* set by LZ4_attach_dictionaryLazy(), until first block */
+} LZ4_streamLazy_t;
+
+void LZ4_resetStreamLazy (LZ4_streamLazy_t* streamPtr);
+int  LZ4_loadDictLazy (LZ4_streamLazy_t* streamPtr, const char* dictionary, int dictSize);
+int  LZ4_compress_lazy_continue (LZ4_streamLazy_t* streamPtr, const char* src, char* dst, int srcSize, int dstCapacity, int lazyLevel);
+
+/*! LZ4_attach_dictionaryLazy() : v1.8.1 (experimental)
+ *  Same as LZ4_attach_dictionary(), for a `dictionary_stream` loaded with LZ4_loadDictLazy().
+ *  The lazy parser can't read dictionary tables by reference : first block copies them into `working_stream`,
+ *  i.e. 16 KB, plus 16 KB of long table for `lazyLevel` 2, which is copied instead of re-hashed.
+ *  LZ4_attach_dictionary(&state->stream, dictStream) also works with a regular dictionary stream,
+ *  but first block then re-hashes the whole dictionary for `lazyLevel` 2.
+ *  Since this happens on every attach, prefer linked blocks when compressing many small inputs with lazy levels. */
+void LZ4_attach_dictionaryLazy(LZ4_streamLazy_t* working_stream, const LZ4_streamLazy_t* dictionary_stream);
+
+/*! LZ4_compress_batch() : v1.8.1 (experimental)
+ *  Compresses `nbRecords` independent inputs `srcs[n]` of `srcSizes[n]` bytes into `dsts[n]`,
+ *  each record producing the same block as LZ4_compress_fast_extState().
+ *  `state` is reused across records the same way as LZ4_compress_fast_extState_fastReset(),
+ *  and next record is prefetched while current one is compressed,
+ *  so per-record overhead is amortized over the whole batch.
+ *  `dstSizes[n]` receives the compressed size of record n, or 0 if it could not fit into `dstCapacities[n]`.
+ *  `state` must have been initialized once, using LZ4_resetStream() or LZ4_createStream().
+ * @return : number of records which could not be compressed (0 means all succeeded)
+ */
+int LZ4_compress_batch (void* state, const char* const* srcs, const int* srcSizes,
+                        char* const* dsts, const int* dstCapacities, int* dstSizes,
+                        int nbRecords, int acceleration);
+
+/*! LZ4_decompress_safe_batch() : v1.8.1 (experimental)
+ *  Decompresses `nbRecords` independent blocks, as LZ4_decompress_safe() would for each of them.
+ *  `dstSizes[n]` receives the result of record n : decompressed size, or a negative value if it is malformed.
+ * @return : number of records which failed (0 means all succeeded)
+ */
+int LZ4_decompress_safe_batch (const char* const* srcs, const int* srcSizes,
+                               char* const* dsts, const int* dstCapacities, int* dstSizes,
+                               int nbRecords);
+
+/*! LZ4_decompress_safe_x2(), LZ4_decompress_safe_x4() : v1.8.1 (experimental)
+ *  Decompress 2 (resp. 4) independent blocks, as LZ4_decompress_safe() would for each of them,
+ *  but within a single loop, interleaving their sequences :
+ *  memory accesses of one block can then overlap with decoding of the others.
+ *  Useful when many blocks are queued, and blocks are not small (>= a few KB).
+ *  Each array must contain exactly 2 (resp. 4) entries, with non-overlapping buffers.
+ *  `dstSizes[n]` receives the result of block n : decompressed size, or a negative value if it is malformed.
+ * @return : number of blocks which failed (0 means all succeeded)
+ */
+int LZ4_decompress_safe_x2 (const char* const* srcs, const int* srcSizes,
+                            char* const* dsts, const int* dstCapacities, int* dstSizes);
+int LZ4_decompress_safe_x4 (const char* const* srcs, const int* srcSizes,
+                            char* const* dsts, const int* dstCapacities, int* dstSizes);
+
+#endif   /* LZ4_SLO_299033254 */
+#endif   /* LZ4_STATIC_LINKING_ONLY */
+
+
 #if defined (__cplusplus)
 }
 #endif
@@ -0,0 +1,327 @@
+/*
+ * LZ4 - chunked parallel compression
+ * Copyright (C) 2011-2017, Yann Collet.
+ *
+ * BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at :
+ *  - LZ4 source repository : https://github.com/lz4/lz4
+ */
+
+
+/*-************************************
+*  Memory routines
+**************************************/
+#include <stdlib.h>   /* malloc, free */
+#define ALLOCATOR(s)   malloc(s)
+#define FREEMEM        free
+#include <string.h>   /* memcpy, memmove */
+
+
+/*-************************************
+*  Includes
+**************************************/
+#include "lz4chunked.h"
+#include "lz4.h"
+#include "lz4threads.h"
+
+
+/*-************************************
+*  Basic Types
+**************************************/
+#if !defined (__VMS) && (defined (__cplusplus) || (defined (__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) /* C99 */) )
+# include <stdint.h>
+  typedef  uint8_t BYTE;
+  typedef uint32_t U32;
+  typedef uint64_t U64;
+#else
+  typedef unsigned char       BYTE;
+  typedef unsigned int        U32;
+  typedef unsigned long long  U64;
+#endif
+
+#define LZ4_CHUNKED_RAWFLAG  0x80000000U
+#define LZ4_CHUNKED_SIZEMASK 0x7FFFFFFFU
+
+
+/* unoptimized version; solves endianess & alignment issues */
+static U32 LZ4C_readLE32 (const void* src)
+{
+    const BYTE* const srcPtr = (const BYTE*)src;
+    U32 value32 = srcPtr[0];
+    value32 += (srcPtr[1]<<8);
+    value32 += (srcPtr[2]<<16);
+    value32 += ((U32)srcPtr[3])<<24;
+    return value32;
+}
+
+static void LZ4C_writeLE32 (void* dst, U32 value32)
+{
+    BYTE* const dstPtr = (BYTE*)dst;
+    dstPtr[0] = (BYTE)value32;
+    dstPtr[1] = (BYTE)(value32 >> 8);
+    dstPtr[2] = (BYTE)(value32 >> 16);
+    dstPtr[3] = (BYTE)(value32 >> 24);
+}
+
+static U64 LZ4C_readLE64 (const void* src)
+{
+    return LZ4C_readLE32(src) + ((U64)LZ4C_readLE32((const BYTE*)src + 4) << 32);
+}
+
+static void LZ4C_writeLE64 (void* dst, U64 value64)
+{
+    LZ4C_writeLE32(dst, (U32)value64);
+    LZ4C_writeLE32((BYTE*)dst + 4, (U32)(value64 >> 32));
+}
+
+
+/*-************************************
+*  Helpers
+**************************************/
+static size_t LZ4C_nbChunks(size_t srcSize, size_t chunkSize)
+{
+    return (srcSize / chunkSize) + ((srcSize % chunkSize) != 0);
+}
+
+static size_t LZ4C_chunkLength(size_t contentSize, size_t chunkSize, size_t chunkNb)
+{
+    size_t const start = chunkNb * chunkSize;
+    size_t const remaining = contentSize - start;
+    return remaining < chunkSize ? remaining : chunkSize;
+}
+
+/* LZ4C_selectChunkSize() :
+ * @return : effective chunk size, or 0 if invalid */
+static size_t LZ4C_selectChunkSize(int chunkSize)
+{
+    if (chunkSize == 0) return LZ4_CHUNKED_CHUNKSIZE_DEFAULT;
+    if ((chunkSize < LZ4_CHUNKED_CHUNKSIZE_MIN) || (chunkSize > LZ4_MAX_INPUT_SIZE)) return 0;
+    return (size_t)chunkSize;
+}
+
+static LZ4_pool* LZ4C_createPool(int nbThreads, size_t nbChunks)
+{
+    if (nbThreads <= 1) return NULL;
+    if ((size_t)nbThreads > nbChunks) nbThreads = (int)nbChunks;
+    return LZ4_pool_create((unsigned)nbThreads);
+}
+
+
+/*-************************************
+*  Compression
+**************************************/
+size_t LZ4_chunked_compressBound(size_t srcSize, int chunkSize)
+{
+    size_t const cSize = LZ4C_selectChunkSize(chunkSize);
+    size_t nbChunks;
+    if (cSize == 0) return 0;
+    nbChunks = LZ4C_nbChunks(srcSize, cSize);
+    if ((U64)nbChunks > (U64)LZ4_CHUNKED_SIZEMASK) return 0;
+    return LZ4_CHUNKED_HEADERSIZE + 4*nbChunks + srcSize;
+}
+
+typedef struct {
+    const char* src;
+    size_t srcSize;
+    size_t chunkSize;
+    BYTE* table;
+    char* slots;      /* chunk n is compressed at slots + n*chunkSize */
+    int acceleration;
+} LZ4C_cJob_t;
+
+/* Each chunk is compressed into a slot as large as the chunk itself :
+ * any chunk which doesn't fit is incompressible, and stored raw instead. */
+static void LZ4C_compressJob(void* opaque, unsigned chunkNb)
+{
+    const LZ4C_cJob_t* const job = (const LZ4C_cJob_t*)opaque;
+    size_t const start = (size_t)chunkNb * job->chunkSize;
+    int const chunkLength = (int)LZ4C_chunkLength(job->srcSize, job->chunkSize, chunkNb);
+    char* const slot = job->slots + start;
+    int const cSize = LZ4_compress_fast(job->src + start, slot, chunkLength, chunkLength-1, job->acceleration);
+    if (cSize > 0) {
+        LZ4C_writeLE32(job->table + 4*(size_t)chunkNb, (U32)cSize);
+    } else {
+        memcpy(slot, job->src + start, (size_t)chunkLength);
+        LZ4C_writeLE32(job->table + 4*(size_t)chunkNb, (U32)chunkLength | LZ4_CHUNKED_RAWFLAG);
+    }
+}
+
+size_t LZ4_compress_chunked(const char* src, size_t srcSize,
+                            char* dst, size_t dstCapacity,
+                            int chunkSize, int acceleration, int nbThreads)
+{
+    size_t const cSize = LZ4C_selectChunkSize(chunkSize);
+    size_t const bound = LZ4_chunked_compressBound(srcSize, chunkSize);
+    BYTE* const ostart = (BYTE*)dst;
+    size_t nbChunks;
+    BYTE* op;
+
+    if (bound == 0) return 0;
+    if (dstCapacity < bound) return 0;
+    nbChunks = LZ4C_nbChunks(srcSize, cSize);
+
+    LZ4C_writeLE32(ostart, LZ4_CHUNKED_MAGICNUMBER);
+    LZ4C_writeLE32(ostart+4, (U32)cSize);
+    LZ4C_writeLE64(ostart+8, (U64)srcSize);
+    op = ostart + LZ4_CHUNKED_HEADERSIZE + 4*nbChunks;
+
+    /* compress all chunks into their slots */
+    {   LZ4C_cJob_t job;
+        LZ4_pool* const pool = LZ4C_createPool(nbThreads, nbChunks);
+        job.src = src;
+        job.srcSize = srcSize;
+        job.chunkSize = cSize;
+        job.table = ostart + LZ4_CHUNKED_HEADERSIZE;
+        job.slots = (char*)op;
+        job.acceleration = acceleration;
+        LZ4_pool_run(pool, LZ4C_compressJob, &job, (unsigned)nbChunks);
+        LZ4_pool_free(pool);
+    }
+
+    /* compact : slots are moved back to back, in chunk order */
+    {   size_t n;
+        const BYTE* const slots = op;
+        for (n=0; n<nbChunks; n++) {
+            size_t const size = LZ4C_readLE32(ostart + LZ4_CHUNKED_HEADERSIZE + 4*n) & LZ4_CHUNKED_SIZEMASK;
+            const BYTE* const slot = slots + n*cSize;
+            if (op != slot) memmove(op, slot, size);
+            op += size;
+    }   }
+
+    return (size_t)(op - ostart);
+}
+
+
+/*-************************************
+*  Decompression
+**************************************/
+/* LZ4C_parseHeader() :
+ * validates header, and checks that chunk table and payloads fit within `srcSize`.
+ * @return : content size, or LZ4_CHUNKED_ERROR */
+static size_t LZ4C_parseHeader(const BYTE* src, size_t srcSize, size_t* chunkSizePtr, size_t* nbChunksPtr)
+{
+    size_t chunkSize, nbChunks, tableEnd, payloadSize = 0;
+    U64 contentSize;
+    if (srcSize < LZ4_CHUNKED_HEADERSIZE) return LZ4_CHUNKED_ERROR;
+    if (LZ4C_readLE32(src) != LZ4_CHUNKED_MAGICNUMBER) return LZ4_CHUNKED_ERROR;
+    {   U32 const cs = LZ4C_readLE32(src+4);
+        if ((cs < LZ4_CHUNKED_CHUNKSIZE_MIN) || (cs > LZ4_MAX_INPUT_SIZE)) return LZ4_CHUNKED_ERROR;
+        chunkSize = cs;
+    }
+    contentSize = LZ4C_readLE64(src+8);
+    if (contentSize >= (U64)LZ4_CHUNKED_ERROR) return LZ4_CHUNKED_ERROR;   /* doesn't fit in size_t */
+    nbChunks = LZ4C_nbChunks((size_t)contentSize, chunkSize);
+    if ((U64)nbChunks > (U64)LZ4_CHUNKED_SIZEMASK) return LZ4_CHUNKED_ERROR;
+    if (nbChunks > (srcSize - LZ4_CHUNKED_HEADERSIZE) / 4) return LZ4_CHUNKED_ERROR;
+    tableEnd = LZ4_CHUNKED_HEADERSIZE + 4*nbChunks;
+    {   size_t n;
+        for (n=0; n<nbChunks; n++) {
+            U32 const entry = LZ4C_readLE32(src + LZ4_CHUNKED_HEADERSIZE + 4*n);
+            size_t const size = entry & LZ4_CHUNKED_SIZEMASK;
+            if ( (entry & LZ4_CHUNKED_RAWFLAG)
+              && (size != LZ4C_chunkLength((size_t)contentSize, chunkSize, n)) )
+                return LZ4_CHUNKED_ERROR;
+            payloadSize += size;
+            if (payloadSize > srcSize - tableEnd) return LZ4_CHUNKED_ERROR;
+    }   }
+    *chunkSizePtr = chunkSize;
+    *nbChunksPtr = nbChunks;
+    return (size_t)contentSize;
+}
+
+size_t LZ4_chunked_getContentSize(const char* src, size_t srcSize)
+{
+    size_t chunkSize, nbChunks;
+    return LZ4C_parseHeader((const BYTE*)src, srcSize, &chunkSize, &nbChunks);
+}
+
+typedef struct {
+    const BYTE* table;
+    const char* src;
+    char* dst;
+    size_t contentSize;
+    size_t chunkSize;
+    size_t* offsets;  /* input : payload position of each chunk; output : LZ4_CHUNKED_ERROR if chunk is corrupted */
+} LZ4C_dJob_t;
+
+static void LZ4C_decompressJob(void* opaque, unsigned chunkNb)
+{
+    const LZ4C_dJob_t* const job = (const LZ4C_dJob_t*)opaque;
+    U32 const entry = LZ4C_readLE32(job->table + 4*(size_t)chunkNb);
+    int const size = (int)(entry & LZ4_CHUNKED_SIZEMASK);
+    int const chunkLength = (int)LZ4C_chunkLength(job->contentSize, job->chunkSize, chunkNb);
+    const char* const ip = job->src + job->offsets[chunkNb];
+    char* const op = job->dst + (size_t)chunkNb * job->chunkSize;
+    if (entry & LZ4_CHUNKED_RAWFLAG) {
+        memcpy(op, ip, (size_t)chunkLength);   /* size == chunkLength, checked by LZ4C_parseHeader() */
+    } else {
+        if (LZ4_decompress_safe(ip, op, size, chunkLength) != chunkLength)
+            job->offsets[chunkNb] = LZ4_CHUNKED_ERROR;
+    }
+}
+
+size_t LZ4_decompress_chunked(const char* src, size_t srcSize,
+                              char* dst, size_t dstCapacity,
+                              int nbThreads)
+{
+    const BYTE* const istart = (const BYTE*)src;
+    size_t chunkSize, nbChunks;
+    size_t const contentSize = LZ4C_parseHeader(istart, srcSize, &chunkSize, &nbChunks);
+    size_t* offsets;
+    size_t result = contentSize;
+
+    if (contentSize == LZ4_CHUNKED_ERROR) return LZ4_CHUNKED_ERROR;
+    if (dstCapacity < contentSize) return LZ4_CHUNKED_ERROR;
+    if (nbChunks == 0) return 0;
+
+    offsets = (size_t*)ALLOCATOR(nbChunks * sizeof(size_t));
+    if (offsets == NULL) return LZ4_CHUNKED_ERROR;
+    {   size_t n, pos = LZ4_CHUNKED_HEADERSIZE + 4*nbChunks;
+        for (n=0; n<nbChunks; n++) {
+            offsets[n] = pos;
+            pos += LZ4C_readLE32(istart + LZ4_CHUNKED_HEADERSIZE + 4*n) & LZ4_CHUNKED_SIZEMASK;
+    }   }
+
+    {   LZ4C_dJob_t job;
+        LZ4_pool* const pool = LZ4C_createPool(nbThreads, nbChunks);
+        job.table = istart + LZ4_CHUNKED_HEADERSIZE;
+        job.src = src;
+        job.dst = dst;
+        job.contentSize = contentSize;
+        job.chunkSize = chunkSize;
+        job.offsets = offsets;
+        LZ4_pool_run(pool, LZ4C_decompressJob, &job, (unsigned)nbChunks);
+        LZ4_pool_free(pool);
+    }
+
+    {   size_t n;
+        for (n=0; n<nbChunks; n++)
+            if (offsets[n] == LZ4_CHUNKED_ERROR) result = LZ4_CHUNKED_ERROR;
+    }
+    FREEMEM(offsets);
+    return result;
+}
@@ -0,0 +1,113 @@
+/*
+ * LZ4 - chunked parallel compression
+ * Header File
+ * Copyright (C) 2011-2017, Yann Collet.
+ *
+ * BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at :
+ *  - LZ4 source repository : https://github.com/lz4/lz4
+ */
+
+#ifndef LZ4_CHUNKED_H_19833
+#define LZ4_CHUNKED_H_19833
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* --- Dependency --- */
+#include <stddef.h>   /* size_t */
+#include "lz4.h"      /* LZ4LIB_API */
+
+
+/*-************************************
+*  Chunked format
+**************************************/
+/* The chunked API splits a large buffer into fixed-size chunks,
+ * and compresses each chunk as an independent LZ4 block.
+ * Since chunks share no history, they can be compressed and decompressed in parallel.
+ * The trade-off is a slightly lower compression ratio, since matches can't cross chunk boundaries.
+ *
+ * Compressed layout (all fields little-endian) :
+ *   magic number   : 4 bytes, LZ4_CHUNKED_MAGICNUMBER
+ *   chunk size     : 4 bytes, uncompressed size of each chunk (last one may be shorter)
+ *   content size   : 8 bytes, total uncompressed size
+ *   chunk table    : 4 bytes per chunk, size of its compressed payload;
+ *                    highest bit set means the chunk is stored uncompressed.
+ *   payloads       : chunks, in order, back to back.
+ *
+ * Output is fully determined by input, chunk size and acceleration :
+ * it does not depend on the number of threads used to produce it.
+ */
+#define LZ4_CHUNKED_MAGICNUMBER      0x43345A4CU   /* "LZ4C" */
+#define LZ4_CHUNKED_HEADERSIZE       16
+#define LZ4_CHUNKED_CHUNKSIZE_MIN    (1 << 10)
+#define LZ4_CHUNKED_CHUNKSIZE_DEFAULT (4 << 20)
+#define LZ4_CHUNKED_ERROR            ((size_t)-1)
+
+
+/*-************************************
+*  Simple functions
+**************************************/
+/*! LZ4_chunked_compressBound() :
+ *  Provides the maximum compressed size of `srcSize` bytes split into chunks of `chunkSize` bytes.
+ *  `chunkSize==0` selects LZ4_CHUNKED_CHUNKSIZE_DEFAULT.
+ *  @return : 0 if `chunkSize` is out of range [LZ4_CHUNKED_CHUNKSIZE_MIN, LZ4_MAX_INPUT_SIZE]. */
+LZ4LIB_API size_t LZ4_chunked_compressBound(size_t srcSize, int chunkSize);
+
+/*! LZ4_compress_chunked() :
+ *  Compresses `src` into `dst`, using up to `nbThreads` threads (calling thread included).
+ *  `dstCapacity` must be >= LZ4_chunked_compressBound(srcSize, chunkSize) :
+ *  `dst` is used as scratch space, each chunk being compressed into its own worst-case slot
+ *  before being moved into its final position.
+ *  `acceleration` behaves as in LZ4_compress_fast(). `chunkSize==0` selects default.
+ *  `nbThreads<=1`, or a library built without multi-threading support, means serial compression.
+ *  @return : size of compressed data written into `dst`, or 0 on error. */
+LZ4LIB_API size_t LZ4_compress_chunked(const char* src, size_t srcSize,
+                                       char* dst, size_t dstCapacity,
+                                       int chunkSize, int acceleration, int nbThreads);
+
+/*! LZ4_chunked_getContentSize() :
+ *  @return : size of original data, as stored in `src` header,
+ *            or LZ4_CHUNKED_ERROR if `src` doesn't start with a valid chunked header and table. */
+LZ4LIB_API size_t LZ4_chunked_getContentSize(const char* src, size_t srcSize);
+
+/*! LZ4_decompress_chunked() :
+ *  Decompresses a buffer produced by LZ4_compress_chunked(),
+ *  using up to `nbThreads` threads (calling thread included).
+ *  `dstCapacity` must be >= original size.
+ *  Malformed input is detected, and never reads nor writes beyond provided buffers.
+ *  @return : nb of bytes decompressed into `dst`, or LZ4_CHUNKED_ERROR. */
+LZ4LIB_API size_t LZ4_decompress_chunked(const char* src, size_t srcSize,
+                                         char* dst, size_t dstCapacity,
+                                         int nbThreads);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* LZ4_CHUNKED_H_19833 */
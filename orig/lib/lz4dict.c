@@ -0,0 +1,272 @@
+/*
+ * LZ4 - dictionary trainer
+ * Copyright (C) 2011-2017, Yann Collet.
+ *
+ * BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at :
+ *  - LZ4 source repository : https://github.com/lz4/lz4
+ */
+
+
+
+/*-************************************
+*  Memory routines
+**************************************/
+#include <stdlib.h>   /* malloc, calloc, free */
+#define ALLOCATOR(n,s) calloc(n,s)
+#define FREEMEM        free
+#include <string.h>   /* memcpy, memmove, memset */
+
+
+/*-************************************
+*  Includes
+**************************************/
+#include "lz4dict.h"
+
+
+/*-************************************
+*  Basic Types
+**************************************/
+#if !defined (__VMS) && (defined (__cplusplus) || (defined (__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) /* C99 */) )
+# include <stdint.h>
+  typedef  uint8_t BYTE;
+  typedef uint32_t U32;
+  typedef uint64_t U64;
+#else
+  typedef unsigned char       BYTE;
+  typedef unsigned int        U32;
+  typedef unsigned long long  U64;
+#endif
+
+
+/*-************************************
+*  Constants
+**************************************/
+#define LZ4D_HASHLOG        20
+#define LZ4D_HASHSIZE       (1U << LZ4D_HASHLOG)
+#define LZ4D_NODMER         LZ4D_HASHSIZE   /* position where no dmer starts : its frequency is always 0 */
+#define LZ4D_SEGMENTSIZE_DEFAULT 512
+#define LZ4D_DMERSIZE_DEFAULT    6
+
+#define MIN(a,b)   ( (a) < (b) ? (a) : (b) )
+
+
+/*-************************************
+*  Trainer
+**************************************/
+typedef struct {
+    const BYTE* samples;
+    const size_t* sampleEnds;   /* cumulative : sample n covers [sampleEnds[n-1], sampleEnds[n]) */
+    unsigned nbSamples;
+    unsigned dmerSize;
+    U32* freqs;                 /* nb of samples containing each dmer, LZ4D_HASHSIZE+1 cells */
+    U32* active;                /* nb of occurrences of each dmer within current window */
+    U32* epochDmers;            /* dmer id at each position of current epoch */
+} LZ4D_ctx_t;
+
+typedef struct {
+    size_t begin;
+    size_t end;
+    U64 score;
+} LZ4D_segment_t;
+
+static U32 LZ4D_hashDmer(const BYTE* p, unsigned dmerSize)
+{
+    U64 v = 0;
+    unsigned n;
+    for (n=0; n<dmerSize; n++) v = (v << 8) + p[n];
+    return (U32)((v * 11400714785074694791ULL) >> (64 - LZ4D_HASHLOG));
+}
+
+/* LZ4D_sampleOf() :
+ * @return : index of the sample containing position `pos` (binary search) */
+static unsigned LZ4D_sampleOf(const LZ4D_ctx_t* ctx, size_t pos)
+{
+    unsigned lo = 0, hi = ctx->nbSamples - 1;
+    while (lo < hi) {
+        unsigned const mid = lo + (hi - lo) / 2;
+        if (ctx->sampleEnds[mid] <= pos) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+/* LZ4D_fillEpochDmers() :
+ * identifies the dmer starting at each position of [begin, end).
+ * dmers overlapping 2 samples are not real content : they are marked LZ4D_NODMER. */
+static void LZ4D_fillEpochDmers(LZ4D_ctx_t* ctx, size_t begin, size_t end)
+{
+    unsigned s = LZ4D_sampleOf(ctx, begin);
+    size_t pos;
+    for (pos = begin; pos < end; pos++) {
+        while (ctx->sampleEnds[s] <= pos) s++;
+        ctx->epochDmers[pos - begin] = (pos + ctx->dmerSize <= ctx->sampleEnds[s]) ?
+                                       LZ4D_hashDmer(ctx->samples + pos, ctx->dmerSize) : LZ4D_NODMER;
+    }
+}
+
+/* LZ4D_selectSegment() :
+ * slides a window of `segmentSize` bytes over epoch [begin, end),
+ * scoring each segment as the sum of frequencies of the distinct dmers it contains.
+ * The best segment is then trimmed of its useless borders,
+ * and its dmers are zeroed, so that they don't contribute to later selections.
+ * `end - begin` must be >= segmentSize. */
+static LZ4D_segment_t LZ4D_selectSegment(LZ4D_ctx_t* ctx, size_t begin, size_t end, size_t segmentSize)
+{
+    const U32* const dmers = ctx->epochDmers;
+    U32* const freqs = ctx->freqs;
+    U32* const active = ctx->active;
+    size_t const windowSize = segmentSize - ctx->dmerSize + 1;   /* nb of dmers starting within a segment */
+    size_t const nbPositions = end - begin - ctx->dmerSize + 1;
+    LZ4D_segment_t best;
+    U64 score = 0;
+    size_t n;
+
+    best.begin = 0; best.end = 0; best.score = 0;
+    LZ4D_fillEpochDmers(ctx, begin, end);
+
+    for (n = 0; n < nbPositions; n++) {
+        if (active[dmers[n]]++ == 0) score += freqs[dmers[n]];
+        if (n >= windowSize) {
+            U32 const leaving = dmers[n - windowSize];
+            if (--active[leaving] == 0) score -= freqs[leaving];
+        }
+        if ((n + 1 >= windowSize) && (score > best.score)) {
+            best.begin = n + 1 - windowSize;
+            best.score = score;
+        }
+    }
+    /* leave `active` clean for next epoch */
+    for (n = (nbPositions > windowSize) ? nbPositions - windowSize : 0; n < nbPositions; n++)
+        active[dmers[n]]--;
+
+    if (best.score == 0) return best;
+
+    /* trim borders : no need to store bytes which only belong to useless dmers */
+    {   size_t first = best.begin;
+        size_t last = best.begin + windowSize - 1;
+        while (freqs[dmers[first]] == 0) first++;   /* score > 0 : there is at least one useful dmer */
+        while (freqs[dmers[last]] == 0) last--;
+        for (n = first; n <= last; n++) freqs[dmers[n]] = 0;
+        best.begin = begin + first;
+        best.end = begin + last + ctx->dmerSize;
+    }
+    return best;
+}
+
+size_t LZ4_trainFromBuffer_advanced(void* dictBuffer, size_t dictCapacity,
+                                    const void* samplesBuffer, const size_t* samplesSizes, unsigned nbSamples,
+                                    unsigned segmentSize, unsigned dmerSize)
+{
+    const BYTE* const samples = (const BYTE*)samplesBuffer;
+    BYTE* const dict = (BYTE*)dictBuffer;
+    LZ4D_ctx_t ctx;
+    size_t* sampleEnds;
+    size_t totalSize = 0;
+    size_t nbEpochs, epochSize, maxEpochSize;
+    size_t tail, epoch, nbFruitless = 0;
+    unsigned s;
+
+    if (segmentSize == 0) segmentSize = LZ4D_SEGMENTSIZE_DEFAULT;
+    if (dmerSize == 0) dmerSize = LZ4D_DMERSIZE_DEFAULT;
+    if ((dmerSize < LZ4_DICT_DMERSIZE_MIN) || (dmerSize > LZ4_DICT_DMERSIZE_MAX)) return 0;
+    if ((dictBuffer == NULL) || (samplesBuffer == NULL) || (samplesSizes == NULL) || (nbSamples == 0)) return 0;
+    if (dictCapacity > LZ4_DICT_SIZE_MAX) dictCapacity = LZ4_DICT_SIZE_MAX;
+    if (segmentSize > dictCapacity) segmentSize = (unsigned)dictCapacity;
+    if (segmentSize < dmerSize) return 0;
+
+    for (s = 0; s < nbSamples; s++) totalSize += samplesSizes[s];
+    if (totalSize <= dictCapacity) {
+        /* not enough content to select from : the whole sample set is the dictionary */
+        memcpy(dict, samples, totalSize);
+        return totalSize;
+    }
+
+    nbEpochs = dictCapacity / segmentSize;
+    epochSize = totalSize / nbEpochs;
+    if (epochSize < segmentSize) {
+        nbEpochs = totalSize / segmentSize;
+        epochSize = segmentSize;
+    }
+    maxEpochSize = totalSize - (nbEpochs - 1) * epochSize;   /* last epoch also gets the remainder */
+
+    sampleEnds = (size_t*)ALLOCATOR(nbSamples, sizeof(size_t));
+    ctx.freqs = (U32*)ALLOCATOR(LZ4D_HASHSIZE + 1, sizeof(U32));
+    ctx.active = (U32*)ALLOCATOR(LZ4D_HASHSIZE + 1, sizeof(U32));
+    ctx.epochDmers = (U32*)ALLOCATOR(maxEpochSize, sizeof(U32));
+    if ((sampleEnds == NULL) || (ctx.freqs == NULL) || (ctx.active == NULL) || (ctx.epochDmers == NULL)) {
+        FREEMEM(sampleEnds); FREEMEM(ctx.freqs); FREEMEM(ctx.active); FREEMEM(ctx.epochDmers);
+        return 0;
+    }
+    ctx.samples = samples;
+    ctx.sampleEnds = sampleEnds;
+    ctx.nbSamples = nbSamples;
+    ctx.dmerSize = dmerSize;
+
+    /* count, for each dmer, the nb of samples containing it.
+     * `active` is temporarily used to remember the last sample which counted each dmer. */
+    {   size_t pos = 0;
+        for (s = 0; s < nbSamples; s++) {
+            size_t const sampleEnd = pos + samplesSizes[s];
+            sampleEnds[s] = sampleEnd;
+            for ( ; pos + dmerSize <= sampleEnd; pos++) {
+                U32 const h = LZ4D_hashDmer(samples + pos, dmerSize);
+                if (ctx.active[h] != s + 1) { ctx.active[h] = s + 1; ctx.freqs[h]++; }
+            }
+            pos = sampleEnd;
+    }   }
+    memset(ctx.active, 0, (LZ4D_HASHSIZE + 1) * sizeof(U32));
+    /* a dmer present in a single sample is useless, as long as there are several samples */
+    if (nbSamples > 1) {
+        U32 h;
+        for (h = 0; h < LZ4D_HASHSIZE; h++) if (ctx.freqs[h] == 1) ctx.freqs[h] = 0;
+    }
+
+    /* select segments, one per epoch, cycling through epochs until the dictionary is full,
+     * or until no epoch has anything left to offer */
+    tail = dictCapacity;
+    for (epoch = 0; (tail > 0) && (nbFruitless < nbEpochs); epoch = (epoch + 1) % nbEpochs) {
+        size_t const epochBegin = epoch * epochSize;
+        size_t const epochEnd = (epoch == nbEpochs - 1) ? totalSize : epochBegin + epochSize;
+        LZ4D_segment_t const segment = LZ4D_selectSegment(&ctx, epochBegin, epochEnd, segmentSize);
+        size_t segSize;
+        if (segment.score == 0) { nbFruitless++; continue; }
+        nbFruitless = 0;
+        segSize = MIN(segment.end - segment.begin, tail);
+        tail -= segSize;
+        memcpy(dict + tail, samples + segment.begin, segSize);
+    }
+
+    FREEMEM(sampleEnds); FREEMEM(ctx.freqs); FREEMEM(ctx.active); FREEMEM(ctx.epochDmers);
+    if (tail > 0) memmove(dict, dict + tail, dictCapacity - tail);
+    return dictCapacity - tail;
+}
+
+size_t LZ4_trainFromBuffer(void* dictBuffer, size_t dictCapacity,
+                           const void* samplesBuffer, const size_t* samplesSizes, unsigned nbSamples)
+{
+    return LZ4_trainFromBuffer_advanced(dictBuffer, dictCapacity, samplesBuffer, samplesSizes, nbSamples, 0, 0);
+}
@@ -0,0 +1,90 @@
+/*
+ * LZ4 - dictionary trainer
+ * Header File
+ * Copyright (C) 2011-2017, Yann Collet.
+ *
+ * BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at :
+ *  - LZ4 source repository : https://github.com/lz4/lz4
+ */
+
+
+#ifndef LZ4_DICT_H_38711
+#define LZ4_DICT_H_38711
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* --- Dependency --- */
+#include <stddef.h>   /* size_t */
+#include "lz4.h"      /* LZ4LIB_API */
+
+
+/*-************************************
+*  Dictionary training
+**************************************/
+/* A dictionary is raw content, primed with LZ4_loadDict() (or referenced with LZ4_attach_dictionary())
+ * before compressing, and with LZ4_setStreamDecode() / LZ4_decompress_safe_usingDict() before decompressing.
+ * It is most useful for small records (a few KB or less), which contain too little history
+ * to find matches within themselves, but share a lot of content with each other.
+ *
+ * The trainer selects segments of the samples made of substrings present in many samples.
+ * Samples are split into epochs, one per segment : the best segment of each epoch is selected,
+ * then its substrings stop contributing to the score of further segments.
+ * The first selected segments are placed at the end of the dictionary, where offsets are shortest.
+ */
+#define LZ4_DICT_SIZE_MAX          (64 << 10)   /* LZ4 can't reference content beyond 64 KB */
+#define LZ4_DICT_DMERSIZE_MIN      4
+#define LZ4_DICT_DMERSIZE_MAX      8
+
+
+/*! LZ4_trainFromBuffer() :
+ *  Trains a dictionary from samples, stored back to back into `samplesBuffer`.
+ *  Sample `n` is `samplesSizes[n]` bytes long.
+ *  `dictCapacity` is capped at LZ4_DICT_SIZE_MAX.
+ *  A few hundred samples, totalling ~100x `dictCapacity`, are typically enough.
+ *  @return : size of the dictionary written into `dictBuffer` (<= dictCapacity),
+ *            or 0 on error (invalid parameters, allocation failure),
+ *            or when samples share no content worth storing into a dictionary. */
+LZ4LIB_API size_t LZ4_trainFromBuffer(void* dictBuffer, size_t dictCapacity,
+                                      const void* samplesBuffer, const size_t* samplesSizes, unsigned nbSamples);
+
+/*! LZ4_trainFromBuffer_advanced() :
+ *  Same as LZ4_trainFromBuffer(), with explicit parameters :
+ *  `segmentSize` : size of segments copied into the dictionary. 0 means default.
+ *  `dmerSize`    : length of substrings counted across samples, within [LZ4_DICT_DMERSIZE_MIN, LZ4_DICT_DMERSIZE_MAX].
+ *                  0 means default. */
+LZ4LIB_API size_t LZ4_trainFromBuffer_advanced(void* dictBuffer, size_t dictCapacity,
+                                               const void* samplesBuffer, const size_t* samplesSizes, unsigned nbSamples,
+                                               unsigned segmentSize, unsigned dmerSize);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* LZ4_DICT_H_38711 */
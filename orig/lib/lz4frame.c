@@ -60,11 +60,13 @@ You can contact the author at :
 *  Includes
 **************************************/
 #include "lz4frame_static.h"
+#define LZ4_STATIC_LINKING_ONLY
 #include "lz4.h"
 #define LZ4_HC_STATIC_LINKING_ONLY
 #include "lz4hc.h"
 #define XXH_STATIC_LINKING_ONLY
 #include "xxhash.h"
+#include "lz4threads.h"
 
 
 /*-************************************
@@ -171,11 +173,97 @@ static const size_t maxFHSize = LZ4F_HEADER_SIZE_MAX;   /* 19 */
 static const size_t BHSize = 4;
 
 
+/*-************************************
+*  Custom memory
+**************************************/
+/* contexts allocate through their LZ4F_CustomMem, with calloc() semantic */
+static void* LZ4F_calloc(size_t s, LZ4F_CustomMem cmem)
+{
+    if (cmem.customAlloc) {
+        void* const p = cmem.customAlloc(cmem.opaqueState, s);
+        if (p != NULL) MEM_INIT(p, 0, s);
+        return p;
+    }
+    return ALLOCATOR(s);
+}
+
+static void LZ4F_free(void* p, LZ4F_CustomMem cmem)
+{
+    if (p == NULL) return;
+    if (cmem.customFree) { cmem.customFree(cmem.opaqueState, p); return; }
+    FREEMEM(p);
+}
+
+/* static workspace : a bump allocator, located at the beginning of the workspace.
+ * Only the most recent allocation can be given back :
+ * other released areas remain reserved until the workspace is initialized again. */
+typedef struct {
+    BYTE*  base;
+    size_t capacity;
+    size_t used;
+    void*  lastAlloc;
+} LZ4F_workspace_t;
+
+#define LZ4F_WKSP_ALIGN      8   /* enough for LZ4_stream_t and LZ4_streamHC_t */
+#define LZ4F_WKSP_ROUND(s)   (((size_t)(s) + (LZ4F_WKSP_ALIGN-1)) & ~(size_t)(LZ4F_WKSP_ALIGN-1))
+
+static void* LZ4F_workspaceAlloc(void* opaque, size_t size)
+{
+    LZ4F_workspace_t* const wksp = (LZ4F_workspace_t*)opaque;
+    size_t const roundedSize = LZ4F_WKSP_ROUND(size);
+    if (roundedSize > wksp->capacity - wksp->used) return NULL;
+    wksp->lastAlloc = wksp->base + wksp->used;
+    wksp->used += roundedSize;
+    return wksp->lastAlloc;
+}
+
+static void LZ4F_workspaceFree(void* opaque, void* address)
+{
+    LZ4F_workspace_t* const wksp = (LZ4F_workspace_t*)opaque;
+    if ((address != NULL) && (address == wksp->lastAlloc)) {
+        wksp->used = (size_t)((BYTE*)address - wksp->base);
+        wksp->lastAlloc = NULL;
+    }
+}
+
+/* LZ4F_workspaceInit() :
+ * @return : allocator carving memory from `workspace`, with a NULL customAlloc on failure */
+static LZ4F_CustomMem LZ4F_workspaceInit(void* workspace, size_t workspaceSize)
+{
+    LZ4F_CustomMem cmem = { NULL, NULL, NULL };
+    LZ4F_workspace_t* const wksp = (LZ4F_workspace_t*)workspace;
+    size_t const headerSize = LZ4F_WKSP_ROUND(sizeof(LZ4F_workspace_t));
+    if (workspace == NULL) return cmem;
+    if ((size_t)workspace & (LZ4F_WKSP_ALIGN-1)) return cmem;   /* must be aligned */
+    if (workspaceSize < headerSize) return cmem;
+    wksp->base = (BYTE*)workspace + headerSize;
+    wksp->capacity = workspaceSize - headerSize;
+    wksp->used = 0;
+    wksp->lastAlloc = NULL;
+    cmem.customAlloc = LZ4F_workspaceAlloc;
+    cmem.customFree = LZ4F_workspaceFree;
+    cmem.opaqueState = wksp;
+    return cmem;
+}
+
+
 /*-************************************
 *  Structures and local types
 **************************************/
+typedef struct
+{
+    BYTE*  buffer;        /* 64 KB of history (linked mode), followed by block content */
+    size_t dictSize;      /* history size, just before block content */
+    size_t srcSize;
+    void*  lz4Ctx;        /* LZ4_stream_t, LZ4_streamLazy_t or LZ4_streamHC_t, depending on mtCtxType */
+    void*  hcWorkspace;   /* optimal parser workspace, mtWorkspaceSize bytes */
+    BYTE*  dst;           /* compressed block, within dstBuffer */
+    size_t cSize;
+} LZ4F_mtJob_t;
+
 typedef struct LZ4F_cctx_s
 {
+    LZ4F_CustomMem customMem;
     LZ4F_preferences_t prefs;
     U32    version;
     U32    cStage;
@@ -188,9 +276,38 @@ typedef struct LZ4F_cctx_s
     U64    totalInSize;
     XXH32_state_t xxh;
     void*  lz4CtxPtr;
-    U32    lz4CtxLevel;   /* 0: unallocated;  1: LZ4_stream_t;  3: LZ4_streamHC_t */
+    U32    lz4CtxLevel;   /* 0: unallocated;  1: LZ4_stream_t;  2: LZ4_streamLazy_t;  3: LZ4_streamHC_t */
+    U32    lz4CtxState;   /* 0: uninitialized;  then initialized as type 1, 2 or 3 (see lz4CtxLevel) */
+    void*  hcWorkspace;   /* optimal parser workspace, lent to lz4CtxPtr */
+    size_t hcWorkspaceSize;
+    LZ4_pool*     pool;          /* nbWorkers >= 2 */
+    LZ4F_mtJob_t* mtJobs;        /* nbWorkers >= 1 */
+    unsigned      mtNbJobsMax;
+    unsigned      mtNbJobs;      /* jobs currently filled; last one may be partial */
+    size_t        mtBlockSize;   /* capacity of job buffers */
+    U32           mtCtxType;     /* 1: LZ4_stream_t;  2: LZ4_streamLazy_t;  3: LZ4_streamHC_t */
+    size_t        mtWorkspaceSize;   /* capacity of job HC workspaces */
+    LZ4F_mtJob_t* mtPrevJob;     /* provides history of next job in linked mode; NULL at frame start */
+    U32*   seekTable;            /* compressed and decompressed size of each block (prefs.seekTable) */
+    size_t seekTableNbBlocks;
+    size_t seekTableCapacity;    /* in blocks */
+    U32    seekTableError;       /* allocation failed : seek table is incomplete */
+    U32    lazyLevel;            /* LZ4F_setLazyLevel() : applies to next frames */
+    U32    frameLazyLevel;       /* lazyLevel of current frame ; 0 for HC levels */
 } LZ4F_cctx_t;
 
+#define LZ4F_LAZYLEVEL_MAX 2
+
+/*! LZ4F_ctxType() :
+ *  levels below LZ4HC_CLEVEL_MIN select LZ4_compress_fast(), or LZ4_compress_lazy() when `lazyLevel` > 0
+ * @return : 1: LZ4_stream_t ; 2: LZ4_streamLazy_t ; 3: LZ4_streamHC_t (by increasing size) */
+static U32 LZ4F_ctxType(int level, U32 lazyLevel)
+{
+    if (level >= LZ4HC_CLEVEL_MIN) return 3;
+    if (lazyLevel) return 2;
+    return 1;
+}
+
 
 /*-************************************
 *  Error management
@@ -268,6 +385,109 @@ static LZ4F_blockSizeID_t LZ4F_optimalBSID(const LZ4F_blockSizeID_t requestedBSI
     return requestedBSID;
 }
 
+
+/*-*********************************
+*  Multi-threading resources
+***********************************/
+
+/*! LZ4F_mtNbJobsMax() :
+ *  nb of blocks which can be buffered within cctx before being compressed */
+static unsigned LZ4F_mtNbJobsMax(const LZ4F_preferences_t* prefsPtr)
+{
+    if (prefsPtr->nbWorkers == 0) return 1;
+    if (prefsPtr->nbBlocksInFlight == 0) return prefsPtr->nbWorkers;
+    return prefsPtr->nbBlocksInFlight;
+}
+
+static void LZ4F_mtFreeJobs(LZ4F_cctx_t* cctxPtr)
+{
+    unsigned n;
+    if (cctxPtr->mtJobs == NULL) return;
+    for (n=0; n<cctxPtr->mtNbJobsMax; n++) {
+        LZ4F_free(cctxPtr->mtJobs[n].buffer, cctxPtr->customMem);
+        LZ4F_free(cctxPtr->mtJobs[n].lz4Ctx, cctxPtr->customMem);   /* works because LZ4_streamHC_t and LZ4_stream_t are simple POD types */
+        LZ4F_free(cctxPtr->mtJobs[n].hcWorkspace, cctxPtr->customMem);
+    }
+    LZ4F_free(cctxPtr->mtJobs, cctxPtr->customMem);
+    cctxPtr->mtJobs = NULL;
+    cctxPtr->mtNbJobsMax = 0;
+}
+
+/*! LZ4F_poolUpdate() :
+ *  (re)creates `*poolPtr` for `nbThreads`, allocating through `cmem`.
+ *  A static context can't start threads : it fails, rather than silently falling back to serial.
+ *  Otherwise, a pool which can't be created (NULL) just means serial processing. */
+static LZ4F_errorCode_t LZ4F_poolUpdate(LZ4_pool** poolPtr, unsigned nbThreads, LZ4F_CustomMem cmem)
+{
+    if (LZ4_pool_nbThreads(*poolPtr) == (nbThreads ? nbThreads : 1)) return 0;
+    LZ4_pool_free(*poolPtr);
+    *poolPtr = NULL;
+    if (nbThreads <= 1) return 0;
+    if (cmem.customAlloc == LZ4F_workspaceAlloc) return err0r(LZ4F_ERROR_allocation_failed);
+    *poolPtr = LZ4_pool_create_advanced(nbThreads, cmem.customAlloc, cmem.customFree, cmem.opaqueState);
+    return 0;
+}
+
+static void LZ4F_mtFree(LZ4F_cctx_t* cctxPtr)
+{
+    LZ4F_mtFreeJobs(cctxPtr);
+    LZ4_pool_free(cctxPtr->pool);
+    cctxPtr->pool = NULL;
+}
+
+/*! LZ4F_mtInit() :
+ *  (re)allocates pool and jobs for current preferences, then starts a new frame.
+ *  A pool which can't be created just means serial compression : output is the same.
+ *  Exception : a static context fails, since it can't start threads (see LZ4F_poolUpdate()). */
+static LZ4F_errorCode_t LZ4F_mtInit(LZ4F_cctx_t* cctxPtr)
+{
+    unsigned const nbJobsMax = LZ4F_mtNbJobsMax(&cctxPtr->prefs);
+    U32 const ctxType = LZ4F_ctxType(cctxPtr->prefs.compressionLevel, cctxPtr->frameLazyLevel);
+    size_t const hcWorkspaceSize = (ctxType == 3) ? (size_t)LZ4_sizeofWorkspaceHC(cctxPtr->prefs.compressionLevel) : 0;
+
+    {   LZ4F_errorCode_t const poolError = LZ4F_poolUpdate(&cctxPtr->pool, cctxPtr->prefs.nbWorkers, cctxPtr->customMem);
+        if (LZ4F_isError(poolError)) return poolError;
+    }
+
+    if ( (cctxPtr->mtNbJobsMax != nbJobsMax)
+      || (cctxPtr->mtBlockSize < cctxPtr->maxBlockSize)
+      || (cctxPtr->mtCtxType != ctxType)
+      || (cctxPtr->mtWorkspaceSize < hcWorkspaceSize) ) {
+        unsigned n;
+        LZ4F_mtFreeJobs(cctxPtr);
+        cctxPtr->mtJobs = (LZ4F_mtJob_t*)LZ4F_calloc(nbJobsMax * sizeof(LZ4F_mtJob_t), cctxPtr->customMem);
+        if (cctxPtr->mtJobs == NULL) return err0r(LZ4F_ERROR_allocation_failed);
+        cctxPtr->mtNbJobsMax = nbJobsMax;
+        cctxPtr->mtBlockSize = cctxPtr->maxBlockSize;
+        cctxPtr->mtCtxType = ctxType;
+        cctxPtr->mtWorkspaceSize = hcWorkspaceSize;
+        for (n=0; n<nbJobsMax; n++) {
+            LZ4F_mtJob_t* const job = cctxPtr->mtJobs + n;
+            job->buffer = (BYTE*)LZ4F_calloc(64 KB + cctxPtr->mtBlockSize, cctxPtr->customMem);
+            if (ctxType == 1) {
+                job->lz4Ctx = LZ4F_calloc(sizeof(LZ4_stream_t), cctxPtr->customMem);
+                if (job->lz4Ctx) LZ4_resetStream((LZ4_stream_t*)job->lz4Ctx);
+            } else if (ctxType == 2) {
+                job->lz4Ctx = LZ4F_calloc(sizeof(LZ4_streamLazy_t), cctxPtr->customMem);
+                if (job->lz4Ctx) LZ4_resetStreamLazy((LZ4_streamLazy_t*)job->lz4Ctx);
+            } else {
+                job->lz4Ctx = LZ4F_calloc(sizeof(LZ4_streamHC_t), cctxPtr->customMem);
+                if (job->lz4Ctx) LZ4_resetStreamHC((LZ4_streamHC_t*)job->lz4Ctx, cctxPtr->prefs.compressionLevel);
+            }
+            if (hcWorkspaceSize) job->hcWorkspace = LZ4F_calloc(hcWorkspaceSize, cctxPtr->customMem);
+            if ((job->buffer == NULL) || (job->lz4Ctx == NULL)
+              || (hcWorkspaceSize && (job->hcWorkspace == NULL)) ) {
+                LZ4F_mtFreeJobs(cctxPtr);
+                return err0r(LZ4F_ERROR_allocation_failed);
+        }   }
+    }
+
+    cctxPtr->mtNbJobs = 0;
+    cctxPtr->mtPrevJob = NULL;
+    return LZ4F_OK_NoError;
+}
+
+
 /*! LZ4F_compressBound_internal() :
  *  Provides dstCapacity given a srcSize to guarantee operation success in worst case situations.
  *  prefsPtr is optional : if NULL is provided, preferences will be set to cover worst case scenario.
@@ -285,7 +505,7 @@ static size_t LZ4F_compressBound_internal(size_t srcSize,
         U32 const flush = prefsPtr->autoFlush | (srcSize==0);
         LZ4F_blockSizeID_t const blockID = prefsPtr->frameInfo.blockSizeID;
         size_t const blockSize = LZ4F_getBlockSize(blockID);
-        size_t const maxBuffered = blockSize - 1;
+        size_t const maxBuffered = (blockSize * LZ4F_mtNbJobsMax(prefsPtr)) - 1;
         size_t const bufferedSize = MIN(alreadyBuffered, maxBuffered);
         size_t const maxSrcSize = srcSize + bufferedSize;
         unsigned const nbFullBlocks = (unsigned)(maxSrcSize / blockSize);
@@ -311,10 +531,24 @@ size_t LZ4F_compressFrameBound(size_t srcSize, const LZ4F_preferences_t* prefere
     else memset(&prefs, 0, sizeof(prefs));
     prefs.autoFlush = 1;
 
-    return headerSize + LZ4F_compressBound_internal(srcSize, &prefs, 0);;
+    {   size_t const seekTableSize = prefs.seekTable ?
+                LZ4F_SEEKTABLE_SIZE((srcSize / LZ4F_getBlockSize(prefs.frameInfo.blockSizeID)) + 1) : 0;
+        return headerSize + LZ4F_compressBound_internal(srcSize, &prefs, 0) + seekTableSize;
+    }
 }
 
 
+/* LZ4F_freeFrameCCtx() :
+ * releases resources allocated within the temporary context of LZ4F_compressFrame_usingCDict().
+ * `stackCtx` : fast compression context pre-created on stack, not to be freed */
+static void LZ4F_freeFrameCCtx(LZ4F_cctx_t* cctxPtr, const void* stackCtx)
+{
+    if (cctxPtr->lz4CtxPtr != stackCtx) LZ4F_free(cctxPtr->lz4CtxPtr, cctxPtr->customMem);
+    LZ4F_free(cctxPtr->hcWorkspace, cctxPtr->customMem);
+    LZ4F_mtFree(cctxPtr);   /* multi-threading resources, if any */
+    LZ4F_free(cctxPtr->seekTable, cctxPtr->customMem);
+}
+
 /*! LZ4F_compressFrame_usingCDict() :
  *  Compress srcBuffer using a dictionary, in a single step.
  *  cdict can be NULL, in which case, no dictionary is used.
@@ -353,7 +587,7 @@ size_t LZ4F_compressFrame_usingCDict(void* dstBuffer, size_t dstCapacity,
     if (srcSize <= LZ4F_getBlockSize(prefs.frameInfo.blockSizeID))
         prefs.frameInfo.blockMode = LZ4F_blockIndependent;   /* only one block => no need for inter-block link */
 
-    if (prefs.compressionLevel < LZ4HC_CLEVEL_MIN) {
+    if (LZ4F_ctxType(prefs.compressionLevel, 0) == 1) {
         cctxI.lz4CtxPtr = &lz4ctx;
         cctxI.lz4CtxLevel = 1;
     }  /* fast compression context pre-created on stack */
@@ -365,19 +599,18 @@ size_t LZ4F_compressFrame_usingCDict(void* dstBuffer, size_t dstCapacity,
         return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);
 
     { size_t const headerSize = LZ4F_compressBegin_usingCDict(&cctxI, dstBuffer, dstCapacity, cdict, &prefs);  /* write header */
-      if (LZ4F_isError(headerSize)) return headerSize;
+      if (LZ4F_isError(headerSize)) { LZ4F_freeFrameCCtx(&cctxI, &lz4ctx); return headerSize; }
       dstPtr += headerSize;   /* header size */ }
 
     { size_t const cSize = LZ4F_compressUpdate(&cctxI, dstPtr, dstEnd-dstPtr, srcBuffer, srcSize, &options);
-      if (LZ4F_isError(cSize)) return cSize;
+      if (LZ4F_isError(cSize)) { LZ4F_freeFrameCCtx(&cctxI, &lz4ctx); return cSize; }
       dstPtr += cSize; }
 
     { size_t const tailSize = LZ4F_compressEnd(&cctxI, dstPtr, dstEnd-dstPtr, &options);   /* flush last block, and generate suffix */
-      if (LZ4F_isError(tailSize)) return tailSize;
+      if (LZ4F_isError(tailSize)) { LZ4F_freeFrameCCtx(&cctxI, &lz4ctx); return tailSize; }
       dstPtr += tailSize; }
 
-    if (prefs.compressionLevel >= LZ4HC_CLEVEL_MIN)  /* Ctx allocation only for lz4hc */
-        FREEMEM(cctxI.lz4CtxPtr);
+    LZ4F_freeFrameCCtx(&cctxI, &lz4ctx);
 
     return (dstPtr - dstStart);
 }
@@ -406,7 +639,9 @@ size_t LZ4F_compressFrame(void* dstBuffer, size_t dstCapacity,
 
 struct LZ4F_CDict_s {
     void* dictContent;
-    LZ4_stream_t* fastCtx;
+    size_t dictSize;
+    LZ4_streamLazy_t* lazyCtx;   /* also holds long table of lazy levels */
+    LZ4_stream_t* fastCtx;       /* == &lazyCtx->stream */
     LZ4_streamHC_t* HCCtx;
 }; /* typedef'd to LZ4F_CDict within lz4frame_static.h */
 
@@ -426,15 +661,17 @@ LZ4F_CDict* LZ4F_createCDict(const void* dictBuffer, size_t dictSize)
         dictSize = 64 KB;
     }
     cdict->dictContent = ALLOCATOR(dictSize);
-    cdict->fastCtx = LZ4_createStream();
+    cdict->lazyCtx = (LZ4_streamLazy_t*)ALLOCATOR(sizeof(LZ4_streamLazy_t));
+    cdict->fastCtx = (cdict->lazyCtx != NULL) ? &cdict->lazyCtx->stream : NULL;
     cdict->HCCtx = LZ4_createStreamHC();
-    if (!cdict->dictContent || !cdict->fastCtx || !cdict->HCCtx) {
+    if (!cdict->dictContent || !cdict->lazyCtx || !cdict->HCCtx) {
         LZ4F_freeCDict(cdict);
         return NULL;
     }
     memcpy(cdict->dictContent, dictStart, dictSize);
-    LZ4_resetStream(cdict->fastCtx);
-    LZ4_loadDict (cdict->fastCtx, (const char*)cdict->dictContent, (int)dictSize);
+    cdict->dictSize = dictSize;
+    LZ4_resetStreamLazy(cdict->lazyCtx);
+    LZ4_loadDictLazy(cdict->lazyCtx, (const char*)cdict->dictContent, (int)dictSize);   /* also LZ4_loadDict() into fastCtx */
     LZ4_resetStreamHC(cdict->HCCtx, LZ4HC_CLEVEL_DEFAULT);
     LZ4_loadDictHC(cdict->HCCtx, (const char*)cdict->dictContent, (int)dictSize);
     return cdict;
@@ -444,7 +681,7 @@ void LZ4F_freeCDict(LZ4F_CDict* cdict)
 {
     if (cdict==NULL) return;  /* support free on NULL */
     FREEMEM(cdict->dictContent);
-    LZ4_freeStream(cdict->fastCtx);
+    FREEMEM(cdict->lazyCtx);
     LZ4_freeStreamHC(cdict->HCCtx);
     FREEMEM(cdict);
 }
@@ -464,32 +701,55 @@ void LZ4F_freeCDict(LZ4F_CDict* cdict)
  */
 LZ4F_errorCode_t LZ4F_createCompressionContext(LZ4F_compressionContext_t* LZ4F_compressionContextPtr, unsigned version)
 {
-    LZ4F_cctx_t* const cctxPtr = (LZ4F_cctx_t*)ALLOCATOR(sizeof(LZ4F_cctx_t));
+    LZ4F_cctx_t* const cctxPtr = LZ4F_createCompressionContext_advanced(LZ4F_defaultCMem, version);
     if (cctxPtr==NULL) return err0r(LZ4F_ERROR_allocation_failed);
 
-    cctxPtr->version = version;
-    cctxPtr->cStage = 0;   /* Next stage : init stream */
-
     *LZ4F_compressionContextPtr = (LZ4F_compressionContext_t)cctxPtr;
 
     return LZ4F_OK_NoError;
 }
 
+LZ4F_cctx* LZ4F_createCompressionContext_advanced(LZ4F_CustomMem customMem, unsigned version)
+{
+    LZ4F_cctx_t* cctxPtr;
+    if ((customMem.customAlloc == NULL) != (customMem.customFree == NULL)) return NULL;   /* both or none */
+    cctxPtr = (LZ4F_cctx_t*)LZ4F_calloc(sizeof(LZ4F_cctx_t), customMem);
+    if (cctxPtr==NULL) return NULL;
+
+    cctxPtr->customMem = customMem;
+    cctxPtr->version = version;
+    cctxPtr->cStage = 0;   /* Next stage : init stream */
+
+    return cctxPtr;
+}
+
 
 LZ4F_errorCode_t LZ4F_freeCompressionContext(LZ4F_compressionContext_t LZ4F_compressionContext)
 {
     LZ4F_cctx_t* const cctxPtr = (LZ4F_cctx_t*)LZ4F_compressionContext;
 
     if (cctxPtr != NULL) {  /* support free on NULL */
-       FREEMEM(cctxPtr->lz4CtxPtr);  /* works because LZ4_streamHC_t and LZ4_stream_t are simple POD types */
-       FREEMEM(cctxPtr->tmpBuff);
-       FREEMEM(LZ4F_compressionContext);
+       LZ4F_CustomMem const cmem = cctxPtr->customMem;
+       LZ4F_free(cctxPtr->lz4CtxPtr, cmem);  /* works because LZ4_streamHC_t and LZ4_stream_t are simple POD types */
+       LZ4F_free(cctxPtr->tmpBuff, cmem);
+       LZ4F_free(cctxPtr->hcWorkspace, cmem);
+       LZ4F_mtFree(cctxPtr);
+       LZ4F_free(cctxPtr->seekTable, cmem);
+       LZ4F_free(cctxPtr, cmem);
     }
 
     return LZ4F_OK_NoError;
 }
 
 
+LZ4F_errorCode_t LZ4F_setLazyLevel(LZ4F_cctx* cctxPtr, unsigned lazyLevel)
+{
+    if (lazyLevel > LZ4F_LAZYLEVEL_MAX) return err0r(LZ4F_ERROR_compressionLevel_invalid);
+    cctxPtr->lazyLevel = lazyLevel;
+    return LZ4F_OK_NoError;
+}
+
+
 /*! LZ4F_compressBegin_usingCDict() :
  *  init streaming compression and writes frame header into dstBuffer.
  *  dstBuffer must be >= LZ4F_HEADER_SIZE_MAX bytes.
@@ -510,32 +770,71 @@ size_t LZ4F_compressBegin_usingCDict(LZ4F_cctx* cctxPtr,
     memset(&prefNull, 0, sizeof(prefNull));
     if (preferencesPtr == NULL) preferencesPtr = &prefNull;
     cctxPtr->prefs = *preferencesPtr;
+    if (cctxPtr->prefs.frameInfo.blockSizeID == 0)
+        cctxPtr->prefs.frameInfo.blockSizeID = LZ4F_BLOCKSIZEID_DEFAULT;
+    cctxPtr->maxBlockSize = LZ4F_getBlockSize(cctxPtr->prefs.frameInfo.blockSizeID);
+    cctxPtr->cdict = cdict;
+    cctxPtr->frameLazyLevel = (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN) ? cctxPtr->lazyLevel : 0;
+    if (cctxPtr->prefs.seekTable && (cctxPtr->prefs.frameInfo.blockMode == LZ4F_blockLinked))
+        return err0r(LZ4F_ERROR_blockMode_invalid);   /* random access requires independent blocks */
+    cctxPtr->seekTableNbBlocks = 0;
+    cctxPtr->seekTableError = 0;
+
+    if (cctxPtr->prefs.nbWorkers) {
+        /* blocks are buffered and compressed by jobs, each with its own context */
+        LZ4F_errorCode_t const initError = LZ4F_mtInit(cctxPtr);
+        if (LZ4F_isError(initError)) return initError;
+        cctxPtr->tmpInSize = 0;
+        XXH32_reset(&(cctxPtr->xxh), 0);
+    } else {
 
     /* Ctx Management */
-    {   U32 const ctxTypeID = (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN) ? 1 : 2;  /* 0:nothing ; 1:LZ4 table ; 2:HC tables */
+    {   U32 const ctxTypeID = LZ4F_ctxType(cctxPtr->prefs.compressionLevel, cctxPtr->frameLazyLevel);  /* 0:nothing ; 1:LZ4 table ; 2:lazy tables ; 3:HC tables */
         if (cctxPtr->lz4CtxLevel < ctxTypeID) {
-            FREEMEM(cctxPtr->lz4CtxPtr);
-            if (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN)
-                cctxPtr->lz4CtxPtr = (void*)LZ4_createStream();
-            else
-                cctxPtr->lz4CtxPtr = (void*)LZ4_createStreamHC();
+            size_t const ctxSize = (ctxTypeID == 1) ? sizeof(LZ4_stream_t) :
+                                   (ctxTypeID == 2) ? sizeof(LZ4_streamLazy_t) : sizeof(LZ4_streamHC_t);
+            LZ4F_free(cctxPtr->lz4CtxPtr, cctxPtr->customMem);
+            cctxPtr->lz4CtxLevel = 0;
+            cctxPtr->lz4CtxPtr = LZ4F_calloc(ctxSize, cctxPtr->customMem);   /* initialized below */
             if (cctxPtr->lz4CtxPtr == NULL) return err0r(LZ4F_ERROR_allocation_failed);
             cctxPtr->lz4CtxLevel = ctxTypeID;
-    }   }
+            cctxPtr->lz4CtxState = 0;
+        }
+        /* full initialization only when the context changes type :
+         * afterwards, dictionaries are attached by reference, which only requires a valid stream */
+        if (cctxPtr->lz4CtxState != ctxTypeID) {
+            if (ctxTypeID == 1)
+                LZ4_resetStream((LZ4_stream_t*)(cctxPtr->lz4CtxPtr));
+            else if (ctxTypeID == 2)
+                LZ4_resetStreamLazy((LZ4_streamLazy_t*)(cctxPtr->lz4CtxPtr));
+            else
+                LZ4_resetStreamHC((LZ4_streamHC_t*)(cctxPtr->lz4CtxPtr), cctxPtr->prefs.compressionLevel);
+            cctxPtr->lz4CtxState = ctxTypeID;
+        }
+        /* preserved by all HC resets used below */
+        if (ctxTypeID == 3) {
+            size_t const hcWorkspaceSize = (size_t)LZ4_sizeofWorkspaceHC(cctxPtr->prefs.compressionLevel);
+            if (cctxPtr->hcWorkspaceSize < hcWorkspaceSize) {
+                cctxPtr->hcWorkspaceSize = 0;
+                LZ4F_free(cctxPtr->hcWorkspace, cctxPtr->customMem);
+                cctxPtr->hcWorkspace = LZ4F_calloc(hcWorkspaceSize, cctxPtr->customMem);
+                if (cctxPtr->hcWorkspace == NULL) return err0r(LZ4F_ERROR_allocation_failed);
+                cctxPtr->hcWorkspaceSize = hcWorkspaceSize;
+            }
+            LZ4_favorDecompressionSpeed((LZ4_streamHC_t*)(cctxPtr->lz4CtxPtr), (int)cctxPtr->prefs.favorDecSpeed);
+            LZ4_setWorkspaceHC((LZ4_streamHC_t*)(cctxPtr->lz4CtxPtr), cctxPtr->hcWorkspace, cctxPtr->hcWorkspaceSize);
+        }
+    }
 
     /* Buffer Management */
-    if (cctxPtr->prefs.frameInfo.blockSizeID == 0)
-        cctxPtr->prefs.frameInfo.blockSizeID = LZ4F_BLOCKSIZEID_DEFAULT;
-    cctxPtr->maxBlockSize = LZ4F_getBlockSize(cctxPtr->prefs.frameInfo.blockSizeID);
-
     {   size_t const requiredBuffSize = preferencesPtr->autoFlush ?
                 (cctxPtr->prefs.frameInfo.blockMode == LZ4F_blockLinked) * 64 KB :  /* only needs windows size */
                 cctxPtr->maxBlockSize + ((cctxPtr->prefs.frameInfo.blockMode == LZ4F_blockLinked) * 128 KB);
 
         if (cctxPtr->maxBufferSize < requiredBuffSize) {
             cctxPtr->maxBufferSize = 0;
-            FREEMEM(cctxPtr->tmpBuff);
-            cctxPtr->tmpBuff = (BYTE*)ALLOCATOR(requiredBuffSize);
+            LZ4F_free(cctxPtr->tmpBuff, cctxPtr->customMem);
+            cctxPtr->tmpBuff = (BYTE*)LZ4F_calloc(requiredBuffSize, cctxPtr->customMem);
             if (cctxPtr->tmpBuff == NULL) return err0r(LZ4F_ERROR_allocation_failed);
             cctxPtr->maxBufferSize = requiredBuffSize;
     }   }
@@ -544,23 +843,27 @@ size_t LZ4F_compressBegin_usingCDict(LZ4F_cctx* cctxPtr,
     XXH32_reset(&(cctxPtr->xxh), 0);
 
     /* context init */
-    cctxPtr->cdict = cdict;
     if (cctxPtr->prefs.frameInfo.blockMode == LZ4F_blockLinked) {
         /* frame init only for blockLinked : blockIndependent will be init at each block */
         if (cdict) {
-            if (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN) {
-                memcpy(cctxPtr->lz4CtxPtr, cdict->fastCtx, sizeof(*cdict->fastCtx));
+            if (cctxPtr->frameLazyLevel) {
+                LZ4_attach_dictionaryLazy((LZ4_streamLazy_t*)(cctxPtr->lz4CtxPtr), cdict->lazyCtx);
+            } else if (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN) {
+                LZ4_attach_dictionary((LZ4_stream_t*)(cctxPtr->lz4CtxPtr), cdict->fastCtx);
             } else {
-                memcpy(cctxPtr->lz4CtxPtr, cdict->HCCtx, sizeof(*cdict->HCCtx));
+                LZ4_attach_HC_dictionary((LZ4_streamHC_t*)(cctxPtr->lz4CtxPtr), cdict->HCCtx);
                 LZ4_setCompressionLevel((LZ4_streamHC_t*)cctxPtr->lz4CtxPtr, cctxPtr->prefs.compressionLevel);
             }
         } else {
-            if (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN)
+            if (cctxPtr->frameLazyLevel)
+                LZ4_resetStreamLazy((LZ4_streamLazy_t*)(cctxPtr->lz4CtxPtr));
+            else if (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN)
                 LZ4_resetStream((LZ4_stream_t*)(cctxPtr->lz4CtxPtr));
-            else
-                LZ4_resetStreamHC((LZ4_streamHC_t*)(cctxPtr->lz4CtxPtr), cctxPtr->prefs.compressionLevel);
+            else   /* context is already initialized (see above) */
+                LZ4_resetStreamHC_fast((LZ4_streamHC_t*)(cctxPtr->lz4CtxPtr), cctxPtr->prefs.compressionLevel);
         }
     }
+    }   /* !nbWorkers */
 
     /* Magic Number */
     LZ4F_writeLE32(dstPtr, LZ4F_MAGICNUMBER);
@@ -650,12 +953,34 @@ static size_t LZ4F_makeBlock(void* dst, const void* src, size_t srcSize,
     return 4 + cSize + ((U32)crcFlag)*4;
 }
 
+/*! LZ4F_seekTableAdd() :
+ *  records a block just written, when a seek table is requested */
+static void LZ4F_seekTableAdd(LZ4F_cctx_t* cctxPtr, size_t cBlockSize, size_t srcSize)
+{
+    if (!cctxPtr->prefs.seekTable) return;
+    if (cctxPtr->seekTableNbBlocks == cctxPtr->seekTableCapacity) {
+        size_t const newCapacity = cctxPtr->seekTableCapacity ? cctxPtr->seekTableCapacity * 2 : 64;
+        U32* const newTable = (U32*)LZ4F_calloc(newCapacity * 2 * sizeof(U32), cctxPtr->customMem);
+        if (newTable == NULL) { cctxPtr->seekTableError = 1; return; }
+        if (cctxPtr->seekTableNbBlocks)
+            memcpy(newTable, cctxPtr->seekTable, cctxPtr->seekTableNbBlocks * 2 * sizeof(U32));
+        LZ4F_free(cctxPtr->seekTable, cctxPtr->customMem);
+        cctxPtr->seekTable = newTable;
+        cctxPtr->seekTableCapacity = newCapacity;
+    }
+    cctxPtr->seekTable[2*cctxPtr->seekTableNbBlocks] = (U32)cBlockSize;
+    cctxPtr->seekTable[2*cctxPtr->seekTableNbBlocks + 1] = (U32)srcSize;
+    cctxPtr->seekTableNbBlocks++;
+}
+
 
 static int LZ4F_compressBlock(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, int level, const LZ4F_CDict* cdict)
 {
     int const acceleration = (level < -1) ? -level : 1;
     if (cdict) {
-        memcpy(ctx, cdict->fastCtx, sizeof(*cdict->fastCtx));
+        /* by reference : no table copy.
+         * entries left by LZ4_compress_fast_extState(), when ctx served a frame without dictionary, are reset there */
+        LZ4_attach_dictionary((LZ4_stream_t*)ctx, cdict->fastCtx);
         return LZ4_compress_fast_continue((LZ4_stream_t*)ctx, src, dst, srcSize, dstCapacity, acceleration);
     }
     return LZ4_compress_fast_extState(ctx, src, dst, srcSize, dstCapacity, acceleration);
@@ -668,14 +993,47 @@ static int LZ4F_compressBlock_continue(void* ctx, const char* src, char* dst, in
     return LZ4_compress_fast_continue((LZ4_stream_t*)ctx, src, dst, srcSize, dstCapacity, acceleration);
 }
 
+static int LZ4F_compressBlockLazy_internal(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, const LZ4F_CDict* cdict, int lazyLevel)
+{
+    if (cdict) {
+        LZ4_attach_dictionaryLazy((LZ4_streamLazy_t*)ctx, cdict->lazyCtx);   /* tables are copied by first block, not re-hashed */
+        return LZ4_compress_lazy_continue((LZ4_streamLazy_t*)ctx, src, dst, srcSize, dstCapacity, lazyLevel);
+    }
+    return LZ4_compress_lazy_extState(ctx, src, dst, srcSize, dstCapacity, lazyLevel);
+}
+
+static int LZ4F_compressBlockLazy1(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, int level, const LZ4F_CDict* cdict)
+{
+    (void)level;
+    return LZ4F_compressBlockLazy_internal(ctx, src, dst, srcSize, dstCapacity, cdict, 1);
+}
+
+static int LZ4F_compressBlockLazy2(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, int level, const LZ4F_CDict* cdict)
+{
+    (void)level;
+    return LZ4F_compressBlockLazy_internal(ctx, src, dst, srcSize, dstCapacity, cdict, 2);
+}
+
+static int LZ4F_compressBlockLazy1_continue(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, int level, const LZ4F_CDict* cdict)
+{
+    (void)level; (void)cdict; /* init once at beginning of frame */
+    return LZ4_compress_lazy_continue((LZ4_streamLazy_t*)ctx, src, dst, srcSize, dstCapacity, 1);
+}
+
+static int LZ4F_compressBlockLazy2_continue(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, int level, const LZ4F_CDict* cdict)
+{
+    (void)level; (void)cdict; /* init once at beginning of frame */
+    return LZ4_compress_lazy_continue((LZ4_streamLazy_t*)ctx, src, dst, srcSize, dstCapacity, 2);
+}
+
 static int LZ4F_compressBlockHC(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, int level, const LZ4F_CDict* cdict)
 {
     if (cdict) {
-        memcpy(ctx, cdict->HCCtx, sizeof(*cdict->HCCtx));
+        LZ4_attach_HC_dictionary((LZ4_streamHC_t*)ctx, cdict->HCCtx);   /* by reference : no table copy */
         LZ4_setCompressionLevel((LZ4_streamHC_t*)ctx, level);
         return LZ4_compress_HC_continue((LZ4_streamHC_t*)ctx, src, dst, srcSize, dstCapacity);
     }
-    return LZ4_compress_HC_extStateHC(ctx, src, dst, srcSize, dstCapacity, level);
+    return LZ4_compress_HC_extStateHC_fastReset(ctx, src, dst, srcSize, dstCapacity, level);   /* ctx was initialized at frame start */
 }
 
 static int LZ4F_compressBlockHC_continue(void* ctx, const char* src, char* dst, int srcSize, int dstCapacity, int level, const LZ4F_CDict* cdict)
@@ -684,9 +1042,17 @@ static int LZ4F_compressBlockHC_continue(void* ctx, const char* src, char* dst,
     return LZ4_compress_HC_continue((LZ4_streamHC_t*)ctx, src, dst, srcSize, dstCapacity);
 }
 
-static compressFunc_t LZ4F_selectCompression(LZ4F_blockMode_t blockMode, int level)
+static compressFunc_t LZ4F_selectCompression(LZ4F_blockMode_t blockMode, int level, U32 lazyLevel)
 {
     if (level < LZ4HC_CLEVEL_MIN) {
+        if (lazyLevel == 1) {
+            if (blockMode == LZ4F_blockIndependent) return LZ4F_compressBlockLazy1;
+            return LZ4F_compressBlockLazy1_continue;
+        }
+        if (lazyLevel == 2) {
+            if (blockMode == LZ4F_blockIndependent) return LZ4F_compressBlockLazy2;
+            return LZ4F_compressBlockLazy2_continue;
+        }
         if (blockMode == LZ4F_blockIndependent) return LZ4F_compressBlock;
         return LZ4F_compressBlock_continue;
     }
@@ -696,24 +1062,162 @@ static compressFunc_t LZ4F_selectCompression(LZ4F_blockMode_t blockMode, int lev
 
 static int LZ4F_localSaveDict(LZ4F_cctx_t* cctxPtr)
 {
-    if (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN)
+    if (cctxPtr->prefs.compressionLevel < LZ4HC_CLEVEL_MIN)   /* LZ4_stream_t, or first member of LZ4_streamLazy_t */
         return LZ4_saveDict ((LZ4_stream_t*)(cctxPtr->lz4CtxPtr), (char*)(cctxPtr->tmpBuff), 64 KB);
     return LZ4_saveDictHC ((LZ4_streamHC_t*)(cctxPtr->lz4CtxPtr), (char*)(cctxPtr->tmpBuff), 64 KB);
 }
 
+
+/*-*********************************
+*  Multi-threaded block compression
+***********************************/
+
+/*! LZ4F_mtStartJob() :
+ *  prepares `job` to receive next block.
+ *  In linked mode, it starts with up to 64 KB of history :
+ *  the end of previous block (and its own history), or dictionary at frame start.
+ *  Note : `job` may also be previous job, when only one block is in flight. */
+static void LZ4F_mtStartJob(LZ4F_cctx_t* cctxPtr, LZ4F_mtJob_t* job)
+{
+    size_t dictSize = 0;
+    if (cctxPtr->prefs.frameInfo.blockMode == LZ4F_blockLinked) {
+        const LZ4F_mtJob_t* const prevJob = cctxPtr->mtPrevJob;
+        const BYTE* histEnd = NULL;
+        size_t histSize = 0;
+        if (prevJob != NULL) {
+            histEnd = prevJob->buffer + 64 KB + prevJob->srcSize;
+            histSize = prevJob->dictSize + prevJob->srcSize;
+        } else if (cctxPtr->cdict != NULL) {
+            histEnd = (const BYTE*)cctxPtr->cdict->dictContent + cctxPtr->cdict->dictSize;
+            histSize = cctxPtr->cdict->dictSize;
+        }
+        dictSize = MIN(histSize, 64 KB);
+        if (dictSize) memmove(job->buffer + 64 KB - dictSize, histEnd - dictSize, dictSize);
+        cctxPtr->mtPrevJob = job;
+    }
+    job->dictSize = dictSize;
+    job->srcSize = 0;
+}
+
+/* LZ4F_mtCompressJob() :
+ * compresses one block, into its own worst-case slot. Runs concurrently with other jobs. */
+static void LZ4F_mtCompressJob(void* opaque, unsigned jobNb)
+{
+    LZ4F_cctx_t* const cctxPtr = (LZ4F_cctx_t*)opaque;
+    LZ4F_mtJob_t* const job = cctxPtr->mtJobs + jobNb;
+    const BYTE* const src = job->buffer + 64 KB;
+    int const level = cctxPtr->prefs.compressionLevel;
+    compressFunc_t const compress = LZ4F_selectCompression(cctxPtr->prefs.frameInfo.blockMode, level, cctxPtr->frameLazyLevel);
+
+    if (cctxPtr->prefs.frameInfo.blockMode == LZ4F_blockLinked) {
+        if (cctxPtr->mtCtxType == 2) {
+            LZ4_resetStreamLazy((LZ4_streamLazy_t*)job->lz4Ctx);
+            LZ4_loadDictLazy((LZ4_streamLazy_t*)job->lz4Ctx, (const char*)(src - job->dictSize), (int)job->dictSize);
+        } else if (level < LZ4HC_CLEVEL_MIN) {
+            LZ4_resetStream((LZ4_stream_t*)job->lz4Ctx);
+            LZ4_loadDict((LZ4_stream_t*)job->lz4Ctx, (const char*)(src - job->dictSize), (int)job->dictSize);
+        } else {
+            LZ4_resetStreamHC((LZ4_streamHC_t*)job->lz4Ctx, level);
+            LZ4_loadDictHC((LZ4_streamHC_t*)job->lz4Ctx, (const char*)(src - job->dictSize), (int)job->dictSize);
+    }   }
+    /* independent blocks : job->lz4Ctx keeps whatever the previous frame left in it ;
+     * LZ4F_compressBlock() attaches the cdict, which resets such leftover entries first */
+    if (level >= LZ4HC_CLEVEL_MIN) {
+        LZ4_favorDecompressionSpeed((LZ4_streamHC_t*)job->lz4Ctx, (int)cctxPtr->prefs.favorDecSpeed);
+        LZ4_setWorkspaceHC((LZ4_streamHC_t*)job->lz4Ctx, job->hcWorkspace, cctxPtr->mtWorkspaceSize);
+    }
+
+    job->cSize = LZ4F_makeBlock(job->dst, src, job->srcSize,
+                                compress, job->lz4Ctx, level,
+                                cctxPtr->cdict, cctxPtr->prefs.frameInfo.blockChecksumFlag);
+}
+
+/*! LZ4F_mtCompressJobs() :
+ *  compresses all buffered blocks, then packs them in order at `dstStart`.
+ *  assumption : dst capacity is >= worst case of all buffered blocks
+ * @return : nb of bytes written into dstStart */
+static size_t LZ4F_mtCompressJobs(LZ4F_cctx_t* cctxPtr, BYTE* dstStart)
+{
+    size_t const blockCRCSize = 4 * cctxPtr->prefs.frameInfo.blockChecksumFlag;
+    BYTE* dstPtr = dstStart;
+    unsigned n;
+
+    for (n=0; n<cctxPtr->mtNbJobs; n++) {
+        cctxPtr->mtJobs[n].dst = dstPtr;
+        dstPtr += 4 + cctxPtr->mtJobs[n].srcSize + blockCRCSize;
+    }
+    LZ4_pool_run(cctxPtr->pool, LZ4F_mtCompressJob, cctxPtr, cctxPtr->mtNbJobs);
+
+    dstPtr = dstStart;
+    for (n=0; n<cctxPtr->mtNbJobs; n++) {
+        memmove(dstPtr, cctxPtr->mtJobs[n].dst, cctxPtr->mtJobs[n].cSize);
+        dstPtr += cctxPtr->mtJobs[n].cSize;
+        LZ4F_seekTableAdd(cctxPtr, cctxPtr->mtJobs[n].cSize, cctxPtr->mtJobs[n].srcSize);
+    }
+    cctxPtr->mtNbJobs = 0;
+    cctxPtr->tmpInSize = 0;
+    return dstPtr - dstStart;
+}
+
+/*! LZ4F_mtCompressUpdate() :
+ *  buffers input into jobs, and compresses them as soon as all jobs are full.
+ *  `flush` also compresses a partially filled set of jobs.
+ * @return : nb of bytes written into dstBuffer */
+static size_t LZ4F_mtCompressUpdate(LZ4F_cctx_t* cctxPtr, void* dstBuffer,
+                                    const void* srcBuffer, size_t srcSize, int flush)
+{
+    size_t const blockSize = cctxPtr->maxBlockSize;
+    const BYTE* srcPtr = (const BYTE*)srcBuffer;
+    const BYTE* const srcEnd = srcPtr + srcSize;
+    BYTE* const dstStart = (BYTE*)dstBuffer;
+    BYTE* dstPtr = dstStart;
+
+    while (srcPtr < srcEnd) {
+        LZ4F_mtJob_t* job;
+        if ((cctxPtr->mtNbJobs == 0) || (cctxPtr->mtJobs[cctxPtr->mtNbJobs-1].srcSize == blockSize))
+            LZ4F_mtStartJob(cctxPtr, cctxPtr->mtJobs + cctxPtr->mtNbJobs++);
+        job = cctxPtr->mtJobs + cctxPtr->mtNbJobs - 1;
+        {   size_t const sizeToCopy = MIN(blockSize - job->srcSize, (size_t)(srcEnd - srcPtr));
+            memcpy(job->buffer + 64 KB + job->srcSize, srcPtr, sizeToCopy);
+            job->srcSize += sizeToCopy;
+            cctxPtr->tmpInSize += sizeToCopy;
+            srcPtr += sizeToCopy;
+        }
+        if ((job->srcSize == blockSize) && (cctxPtr->mtNbJobs == cctxPtr->mtNbJobsMax))
+            dstPtr += LZ4F_mtCompressJobs(cctxPtr, dstPtr);
+    }
+
+    if (flush && cctxPtr->mtNbJobs)
+        dstPtr += LZ4F_mtCompressJobs(cctxPtr, dstPtr);
+
+    return dstPtr - dstStart;
+}
+
+
 typedef enum { notDone, fromTmpBuffer, fromSrcBuffer } LZ4F_lastBlockStatus;
 
-/*! LZ4F_compressUpdate() :
- *  LZ4F_compressUpdate() can be called repetitively to compress as much data as necessary.
- *  dstBuffer MUST be >= LZ4F_compressBound(srcSize, preferencesPtr).
- *  LZ4F_compressOptions_t structure is optional : you can provide NULL as argument.
- * @return : the number of bytes written into dstBuffer. It can be zero, meaning input data was just buffered.
- *           or an error code if it fails (which can be tested using LZ4F_isError())
- */
-size_t LZ4F_compressUpdate(LZ4F_cctx* cctxPtr,
-                           void* dstBuffer, size_t dstCapacity,
-                     const void* srcBuffer, size_t srcSize,
-                     const LZ4F_compressOptions_t* compressOptionsPtr)
+/* LZ4F_canBuffer() :
+ * small inputs, which don't complete current block, are just appended to tmpIn.
+ * Only possible when blocks are not flushed on each call (autoFlush),
+ * and tmpIn is not managed by multi-threading jobs (nbWorkers).
+ * Note : tmpIn always has room for a full block in this mode, see "keep tmpIn within limits" */
+#define LZ4F_canBuffer(cctxPtr, srcSize) \
+    ( (cctxPtr)->cStage == 1 && !(cctxPtr)->prefs.nbWorkers && !(cctxPtr)->prefs.autoFlush \
+      && ((srcSize) < (cctxPtr)->maxBlockSize - (cctxPtr)->tmpInSize) )
+
+static void LZ4F_bufferInput(LZ4F_cctx_t* cctxPtr, const void* srcBuffer, size_t srcSize)
+{
+    memcpy(cctxPtr->tmpIn + cctxPtr->tmpInSize, srcBuffer, srcSize);
+    cctxPtr->tmpInSize += srcSize;
+    if (cctxPtr->prefs.frameInfo.contentChecksumFlag == LZ4F_contentChecksumEnabled)
+        XXH32_update(&(cctxPtr->xxh), srcBuffer, srcSize);
+    cctxPtr->totalInSize += srcSize;
+}
+
+static size_t LZ4F_compressUpdate_generic(LZ4F_cctx* cctxPtr,
+                                          void* dstBuffer, size_t dstCapacity,
+                                    const void* srcBuffer, size_t srcSize,
+                                    const LZ4F_compressOptions_t* compressOptionsPtr)
 {
     LZ4F_compressOptions_t cOptionsNull;
     size_t const blockSize = cctxPtr->maxBlockSize;
@@ -722,7 +1226,7 @@ size_t LZ4F_compressUpdate(LZ4F_cctx* cctxPtr,
     BYTE* const dstStart = (BYTE*)dstBuffer;
     BYTE* dstPtr = dstStart;
     LZ4F_lastBlockStatus lastBlockCompressed = notDone;
-    compressFunc_t const compress = LZ4F_selectCompression(cctxPtr->prefs.frameInfo.blockMode, cctxPtr->prefs.compressionLevel);
+    compressFunc_t const compress = LZ4F_selectCompression(cctxPtr->prefs.frameInfo.blockMode, cctxPtr->prefs.compressionLevel, cctxPtr->frameLazyLevel);
 
 
     if (cctxPtr->cStage != 1) return err0r(LZ4F_ERROR_GENERIC);
@@ -730,6 +1234,14 @@ size_t LZ4F_compressUpdate(LZ4F_cctx* cctxPtr,
     memset(&cOptionsNull, 0, sizeof(cOptionsNull));
     if (compressOptionsPtr == NULL) compressOptionsPtr = &cOptionsNull;
 
+    if (cctxPtr->prefs.nbWorkers) {
+        size_t const cSize = LZ4F_mtCompressUpdate(cctxPtr, dstBuffer, srcBuffer, srcSize, cctxPtr->prefs.autoFlush);
+        if (cctxPtr->prefs.frameInfo.contentChecksumFlag == LZ4F_contentChecksumEnabled)
+            XXH32_update(&(cctxPtr->xxh), srcBuffer, srcSize);
+        cctxPtr->totalInSize += srcSize;
+        return cSize;
+    }
+
     /* complete tmp buffer */
     if (cctxPtr->tmpInSize > 0) {   /* some data already within tmp buffer */
         size_t const sizeToCopy = blockSize - cctxPtr->tmpInSize;
@@ -745,9 +1257,12 @@ size_t LZ4F_compressUpdate(LZ4F_cctx* cctxPtr,
             memcpy(cctxPtr->tmpIn + cctxPtr->tmpInSize, srcBuffer, sizeToCopy);
             srcPtr += sizeToCopy;
 
-            dstPtr += LZ4F_makeBlock(dstPtr, cctxPtr->tmpIn, blockSize,
+            {   size_t const cBlockSize = LZ4F_makeBlock(dstPtr, cctxPtr->tmpIn, blockSize,
                                      compress, cctxPtr->lz4CtxPtr, cctxPtr->prefs.compressionLevel,
                                      cctxPtr->cdict, cctxPtr->prefs.frameInfo.blockChecksumFlag);
+                LZ4F_seekTableAdd(cctxPtr, cBlockSize, blockSize);
+                dstPtr += cBlockSize;
+            }
 
             if (cctxPtr->prefs.frameInfo.blockMode==LZ4F_blockLinked) cctxPtr->tmpIn += blockSize;
             cctxPtr->tmpInSize = 0;
@@ -757,18 +1272,24 @@ size_t LZ4F_compressUpdate(LZ4F_cctx* cctxPtr,
     while ((size_t)(srcEnd - srcPtr) >= blockSize) {
         /* compress full blocks */
         lastBlockCompressed = fromSrcBuffer;
-        dstPtr += LZ4F_makeBlock(dstPtr, srcPtr, blockSize,
+        {   size_t const cBlockSize = LZ4F_makeBlock(dstPtr, srcPtr, blockSize,
                                  compress, cctxPtr->lz4CtxPtr, cctxPtr->prefs.compressionLevel,
                                  cctxPtr->cdict, cctxPtr->prefs.frameInfo.blockChecksumFlag);
+            LZ4F_seekTableAdd(cctxPtr, cBlockSize, blockSize);
+            dstPtr += cBlockSize;
+        }
         srcPtr += blockSize;
     }
 
     if ((cctxPtr->prefs.autoFlush) && (srcPtr < srcEnd)) {
         /* compress remaining input < blockSize */
         lastBlockCompressed = fromSrcBuffer;
-        dstPtr += LZ4F_makeBlock(dstPtr, srcPtr, srcEnd - srcPtr,
+        {   size_t const cBlockSize = LZ4F_makeBlock(dstPtr, srcPtr, srcEnd - srcPtr,
                                  compress, cctxPtr->lz4CtxPtr, cctxPtr->prefs.compressionLevel,
                                  cctxPtr->cdict, cctxPtr->prefs.frameInfo.blockChecksumFlag);
+            LZ4F_seekTableAdd(cctxPtr, cBlockSize, srcEnd - srcPtr);
+            dstPtr += cBlockSize;
+        }
         srcPtr  = srcEnd;
     }
 
@@ -806,6 +1327,50 @@ size_t LZ4F_compressUpdate(LZ4F_cctx* cctxPtr,
     return dstPtr - dstStart;
 }
 
+/*! LZ4F_compressUpdate() :
+ *  LZ4F_compressUpdate() can be called repetitively to compress as much data as necessary.
+ *  dstBuffer MUST be >= LZ4F_compressBound(srcSize, preferencesPtr).
+ *  LZ4F_compressOptions_t structure is optional : you can provide NULL as argument.
+ * @return : the number of bytes written into dstBuffer. It can be zero, meaning input data was just buffered.
+ *           or an error code if it fails (which can be tested using LZ4F_isError())
+ */
+size_t LZ4F_compressUpdate(LZ4F_cctx* cctxPtr,
+                           void* dstBuffer, size_t dstCapacity,
+                     const void* srcBuffer, size_t srcSize,
+                     const LZ4F_compressOptions_t* compressOptionsPtr)
+{
+    if (LZ4F_canBuffer(cctxPtr, srcSize)) {   /* fast path : nothing to compress yet */
+        LZ4F_bufferInput(cctxPtr, srcBuffer, srcSize);
+        return 0;
+    }
+    return LZ4F_compressUpdate_generic(cctxPtr, dstBuffer, dstCapacity, srcBuffer, srcSize, compressOptionsPtr);
+}
+
+/*! LZ4F_compressUpdateV() :
+ *  Same result as invoking LZ4F_compressUpdate() on each record in turn.
+ * @return : total nb of bytes written into dstBuffer, or an error code */
+size_t LZ4F_compressUpdateV(LZ4F_cctx* cctxPtr,
+                            void* dstBuffer, size_t dstCapacity,
+                      const LZ4F_iovec_t* records, size_t nbRecords,
+                      const LZ4F_compressOptions_t* compressOptionsPtr)
+{
+    BYTE* const dstStart = (BYTE*)dstBuffer;
+    BYTE* const dstEnd = dstStart + dstCapacity;
+    BYTE* dstPtr = dstStart;
+    size_t n;
+
+    for (n=0; n<nbRecords; n++) {
+        if (LZ4F_canBuffer(cctxPtr, records[n].len)) {
+            LZ4F_bufferInput(cctxPtr, records[n].base, records[n].len);
+        } else {
+            size_t const cSize = LZ4F_compressUpdate_generic(cctxPtr, dstPtr, dstEnd - dstPtr,
+                                                             records[n].base, records[n].len, compressOptionsPtr);
+            if (LZ4F_isError(cSize)) return cSize;
+            dstPtr += cSize;
+    }   }
+    return dstPtr - dstStart;
+}
+
 
 /*! LZ4F_flush() :
  *  Should you need to create compressed data immediately, without waiting for a block to be filled,
@@ -823,16 +1388,25 @@ size_t LZ4F_flush(LZ4F_cctx* cctxPtr, void* dstBuffer, size_t dstCapacity, const
 
     if (cctxPtr->tmpInSize == 0) return 0;   /* nothing to flush */
     if (cctxPtr->cStage != 1) return err0r(LZ4F_ERROR_GENERIC);
-    if (dstCapacity < (cctxPtr->tmpInSize + 4)) return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);   /* +4 : block header(4)  */
     (void)compressOptionsPtr;   /* not yet useful */
 
+    if (cctxPtr->prefs.nbWorkers) {
+        size_t const blockOverhead = 4 + 4 * cctxPtr->prefs.frameInfo.blockChecksumFlag;   /* block header(4) + block checksum(4) */
+        if (dstCapacity < cctxPtr->tmpInSize + cctxPtr->mtNbJobs * blockOverhead) return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);
+        return LZ4F_mtCompressJobs(cctxPtr, dstStart);
+    }
+    if (dstCapacity < (cctxPtr->tmpInSize + 4)) return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);   /* +4 : block header(4)  */
+
     /* select compression function */
-    compress = LZ4F_selectCompression(cctxPtr->prefs.frameInfo.blockMode, cctxPtr->prefs.compressionLevel);
+    compress = LZ4F_selectCompression(cctxPtr->prefs.frameInfo.blockMode, cctxPtr->prefs.compressionLevel, cctxPtr->frameLazyLevel);
 
     /* compress tmp buffer */
-    dstPtr += LZ4F_makeBlock(dstPtr, cctxPtr->tmpIn, cctxPtr->tmpInSize,
+    {   size_t const cBlockSize = LZ4F_makeBlock(dstPtr, cctxPtr->tmpIn, cctxPtr->tmpInSize,
                              compress, cctxPtr->lz4CtxPtr, cctxPtr->prefs.compressionLevel,
                              cctxPtr->cdict, cctxPtr->prefs.frameInfo.blockChecksumFlag);
+        LZ4F_seekTableAdd(cctxPtr, cBlockSize, cctxPtr->tmpInSize);
+        dstPtr += cBlockSize;
+    }
     if (cctxPtr->prefs.frameInfo.blockMode==LZ4F_blockLinked) cctxPtr->tmpIn += cctxPtr->tmpInSize;
     cctxPtr->tmpInSize = 0;
 
@@ -846,6 +1420,18 @@ size_t LZ4F_flush(LZ4F_cctx* cctxPtr, void* dstBuffer, size_t dstCapacity, const
 }
 
 
+/*! LZ4F_seekTableSize() :
+ *  blocks still buffered within cctx will be written by LZ4F_compressEnd(), hence they are counted too */
+size_t LZ4F_seekTableSize(const LZ4F_cctx* cctxPtr)
+{
+    size_t nbBlocks = cctxPtr->seekTableNbBlocks;
+    if (!cctxPtr->prefs.seekTable) return 0;
+    if (cctxPtr->prefs.nbWorkers) nbBlocks += cctxPtr->mtNbJobs;
+    else nbBlocks += (cctxPtr->tmpInSize > 0);
+    return LZ4F_SEEKTABLE_SIZE(nbBlocks);
+}
+
+
 /*! LZ4F_compressEnd() :
  * When you want to properly finish the compressed frame, just call LZ4F_compressEnd().
  * It will flush whatever data remained within compressionContext (like LZ4_flush())
@@ -859,10 +1445,18 @@ size_t LZ4F_compressEnd(LZ4F_cctx* cctxPtr, void* dstBuffer, size_t dstMaxSize,
 {
     BYTE* const dstStart = (BYTE*)dstBuffer;
     BYTE* dstPtr = dstStart;
+    size_t const seekTableSize = LZ4F_seekTableSize(cctxPtr);
 
-    size_t const flushSize = LZ4F_flush(cctxPtr, dstBuffer, dstMaxSize, compressOptionsPtr);
-    if (LZ4F_isError(flushSize)) return flushSize;
-    dstPtr += flushSize;
+    if (seekTableSize) {
+        if (cctxPtr->seekTableError) return err0r(LZ4F_ERROR_allocation_failed);
+        if (dstMaxSize < LZ4F_compressBound_internal(0, &(cctxPtr->prefs), cctxPtr->tmpInSize) + seekTableSize)
+            return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);
+    }
+
+    {   size_t const flushSize = LZ4F_flush(cctxPtr, dstBuffer, dstMaxSize, compressOptionsPtr);
+        if (LZ4F_isError(flushSize)) return flushSize;
+        dstPtr += flushSize;
+    }
 
     LZ4F_writeLE32(dstPtr, 0);
     dstPtr+=4;   /* endMark */
@@ -873,8 +1467,25 @@ size_t LZ4F_compressEnd(LZ4F_cctx* cctxPtr, void* dstBuffer, size_t dstMaxSize,
         dstPtr+=4;   /* content Checksum */
     }
 
+    if (seekTableSize) {
+        size_t const nbBlocks = cctxPtr->seekTableNbBlocks;
+        size_t n;
+        if (cctxPtr->seekTableError) return err0r(LZ4F_ERROR_allocation_failed);   /* last block could not be recorded */
+        LZ4F_writeLE32(dstPtr, LZ4F_SEEKTABLE_MAGIC);
+        LZ4F_writeLE32(dstPtr+4, (U32)(LZ4F_SEEKTABLE_SIZE(nbBlocks) - 8));   /* skippable frame content size */
+        dstPtr += 8;
+        for (n=0; n<2*nbBlocks; n++) {
+            LZ4F_writeLE32(dstPtr, cctxPtr->seekTable[n]);
+            dstPtr += 4;
+        }
+        LZ4F_writeLE32(dstPtr, (U32)nbBlocks);
+        LZ4F_writeLE32(dstPtr+4, LZ4F_SEEKTABLE_FOOTER_MAGIC);
+        dstPtr += 8;
+    }
+
+    /* buffers and tables are kept for next frame, which starts over them :
+     * LZ4F_compressBegin() resets them, or attaches a dictionary, which discards entries left by this frame */
     cctxPtr->cStage = 0;   /* state is now re-usable (with identical preferences) */
-    cctxPtr->maxBufferSize = 0;  /* reuse HC context */
 
     if (cctxPtr->prefs.frameInfo.contentSize) {
         if (cctxPtr->prefs.frameInfo.contentSize != cctxPtr->totalInSize)
@@ -902,6 +1513,7 @@ typedef enum {
 } dStage_t;
 
 struct LZ4F_dctx_s {
+    LZ4F_CustomMem customMem;
     LZ4F_frameInfo_t frameInfo;
     U32    version;
     dStage_t dStage;
@@ -919,6 +1531,10 @@ struct LZ4F_dctx_s {
     size_t tmpOutStart;
     XXH32_state_t xxh;
     XXH32_state_t blockChecksum;
+    LZ4_streamDecode_t streamDecode;   /* history of blocks decoded straight into dst (directDst) */
+    U32    historyInStream;            /* history is tracked by streamDecode instead of dict */
+    U32    skipChecksum;               /* checksums of current frame are not verified */
+    LZ4_pool* pool;                    /* LZ4F_decompressFrame_parallel_usingDCtx() ; kept across frames */
     BYTE   header[LZ4F_HEADER_SIZE_MAX];
 };  /* typedef'd to LZ4F_dctx in lz4frame.h */
 
@@ -931,27 +1547,82 @@ struct LZ4F_dctx_s {
  */
 LZ4F_errorCode_t LZ4F_createDecompressionContext(LZ4F_dctx** LZ4F_decompressionContextPtr, unsigned versionNumber)
 {
-    LZ4F_dctx* const dctx = (LZ4F_dctx*)ALLOCATOR(sizeof(LZ4F_dctx));
+    LZ4F_dctx* const dctx = LZ4F_createDecompressionContext_advanced(LZ4F_defaultCMem, versionNumber);
     if (dctx==NULL) return err0r(LZ4F_ERROR_GENERIC);
 
-    dctx->version = versionNumber;
     *LZ4F_decompressionContextPtr = dctx;
     return LZ4F_OK_NoError;
 }
 
+LZ4F_dctx* LZ4F_createDecompressionContext_advanced(LZ4F_CustomMem customMem, unsigned versionNumber)
+{
+    LZ4F_dctx* dctx;
+    if ((customMem.customAlloc == NULL) != (customMem.customFree == NULL)) return NULL;   /* both or none */
+    dctx = (LZ4F_dctx*)LZ4F_calloc(sizeof(LZ4F_dctx), customMem);
+    if (dctx==NULL) return NULL;
+
+    dctx->customMem = customMem;
+    dctx->version = versionNumber;
+    return dctx;
+}
+
 LZ4F_errorCode_t LZ4F_freeDecompressionContext(LZ4F_dctx* dctx)
 {
     LZ4F_errorCode_t result = LZ4F_OK_NoError;
     if (dctx != NULL) {   /* can accept NULL input, like free() */
+      LZ4F_CustomMem const cmem = dctx->customMem;
       result = (LZ4F_errorCode_t)dctx->dStage;
-      FREEMEM(dctx->tmpIn);
-      FREEMEM(dctx->tmpOutBuffer);
-      FREEMEM(dctx);
+      LZ4F_free(dctx->tmpIn, cmem);
+      LZ4F_free(dctx->tmpOutBuffer, cmem);
+      LZ4_pool_free(dctx->pool);
+      LZ4F_free(dctx, cmem);
     }
     return result;
 }
 
 
+/*==---   Static workspace   ---==*/
+
+/*! LZ4F_workspaceSize() :
+ *  compression : context, LZ4 state, optimal parser workspace, and input buffer (LZ4F_compressBegin()) ;
+ *  decompression : context, input and output buffers (LZ4F_decompress()) */
+size_t LZ4F_workspaceSize(const LZ4F_preferences_t* prefsPtr)
+{
+    LZ4F_preferences_t prefsNull;
+    memset(&prefsNull, 0, sizeof(prefsNull));
+    if (prefsPtr == NULL) prefsPtr = &prefsNull;
+    {   size_t const blockSize = LZ4F_getBlockSize(prefsPtr->frameInfo.blockSizeID);
+        size_t const linked = (prefsPtr->frameInfo.blockMode == LZ4F_blockLinked);
+        U32 const ctxType = LZ4F_ctxType(prefsPtr->compressionLevel, 0);
+        size_t const lz4CtxSize = (ctxType == 1) ? sizeof(LZ4_stream_t) :
+                                  (ctxType == 2) ? sizeof(LZ4_streamLazy_t) : sizeof(LZ4_streamHC_t);
+        size_t const hcWorkspaceSize = (ctxType == 3) ? (size_t)LZ4_sizeofWorkspaceHC(prefsPtr->compressionLevel) : 0;
+        size_t const cBuffSize = prefsPtr->autoFlush ? linked * 64 KB : blockSize + linked * 128 KB;
+        size_t const cctxSize = LZ4F_WKSP_ROUND(sizeof(LZ4F_cctx_t)) + LZ4F_WKSP_ROUND(lz4CtxSize)
+                              + LZ4F_WKSP_ROUND(hcWorkspaceSize) + LZ4F_WKSP_ROUND(cBuffSize);
+        size_t const dctxSize = LZ4F_WKSP_ROUND(sizeof(LZ4F_dctx))
+                              + LZ4F_WKSP_ROUND(blockSize + 4)               /* tmpIn */
+                              + LZ4F_WKSP_ROUND(blockSize + linked * 128 KB);  /* tmpOutBuffer */
+        if (LZ4F_isError(blockSize)) return blockSize;
+        return LZ4F_WKSP_ROUND(sizeof(LZ4F_workspace_t)) + ((cctxSize > dctxSize) ? cctxSize : dctxSize);
+    }
+}
+
+LZ4F_cctx* LZ4F_initStaticCCtx(void* workspace, size_t workspaceSize)
+{
+    LZ4F_CustomMem const cmem = LZ4F_workspaceInit(workspace, workspaceSize);
+    if (cmem.customAlloc == NULL) return NULL;
+    return LZ4F_createCompressionContext_advanced(cmem, LZ4F_VERSION);
+}
+
+LZ4F_dctx* LZ4F_initStaticDCtx(void* workspace, size_t workspaceSize)
+{
+    LZ4F_CustomMem const cmem = LZ4F_workspaceInit(workspace, workspaceSize);
+    if (cmem.customAlloc == NULL) return NULL;
+    return LZ4F_createDecompressionContext_advanced(cmem, LZ4F_VERSION);
+}
+
+
 /*==---   Streaming Decompression operations   ---==*/
 
 void LZ4F_resetDecompressionContext(LZ4F_dctx* dctx)
@@ -959,6 +1630,8 @@ void LZ4F_resetDecompressionContext(LZ4F_dctx* dctx)
     dctx->dStage = dstage_getFrameHeader;
     dctx->dict = NULL;
     dctx->dictSize = 0;
+    dctx->historyInStream = 0;
+    dctx->skipChecksum = 0;
 }
 
 
@@ -1193,6 +1866,49 @@ static void LZ4F_updateDict(LZ4F_dctx* dctx, const BYTE* dstPtr, size_t dstSize,
     }
 }
 
+/* LZ4F_appendHistory() :
+ * registers `size` bytes, just written at `dst` without being decoded, as history of `streamDecode`,
+ * the same way LZ4_decompress_safe_continue() would have done */
+static void LZ4F_appendHistory(LZ4_streamDecode_t* streamDecode, const BYTE* dst, size_t size)
+{
+    LZ4_streamDecode_t_internal* const lz4sd = &streamDecode->internal_donotuse;
+    if (size == 0) return;
+    if (lz4sd->prefixEnd != dst) {
+        lz4sd->extDictSize = lz4sd->prefixSize;
+        lz4sd->externalDict = lz4sd->prefixEnd - lz4sd->extDictSize;
+        lz4sd->prefixSize = 0;
+    }
+    lz4sd->prefixSize += size;
+    lz4sd->prefixEnd = dst + size;
+}
+
+/* LZ4F_historyToStream() :
+ * directDst mode : history is referenced where it was decoded (up to 2 segments), never copied */
+static void LZ4F_historyToStream(LZ4F_dctx* dctx)
+{
+    if (dctx->historyInStream) return;
+    LZ4_setStreamDecode(&dctx->streamDecode, (const char*)dctx->dict, (int)dctx->dictSize);
+    dctx->historyInStream = 1;
+}
+
+/* LZ4F_historyToDict() :
+ * gathers last 64 KB of history into tmpOutBuffer, for regular (non-directDst) operations.
+ * note : when external segment is within tmpOutBuffer, prefix is necessarily in dst */
+static void LZ4F_historyToDict(LZ4F_dctx* dctx)
+{
+    const LZ4_streamDecode_t_internal* const lz4sd = &dctx->streamDecode.internal_donotuse;
+    size_t const prefixSize = MIN(lz4sd->prefixSize, 64 KB);
+    size_t const extSize = MIN(lz4sd->extDictSize, 64 KB - prefixSize);
+    if (!dctx->historyInStream) return;
+    if (extSize)
+        memmove(dctx->tmpOutBuffer, lz4sd->externalDict + lz4sd->extDictSize - extSize, extSize);
+    if (prefixSize)
+        memmove(dctx->tmpOutBuffer + extSize, lz4sd->prefixEnd - prefixSize, prefixSize);
+    dctx->dict = dctx->tmpOutBuffer;
+    dctx->dictSize = extSize + prefixSize;
+    dctx->historyInStream = 0;
+}
+
 
 
 /*! LZ4F_decompress() :
@@ -1229,12 +1945,33 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
     unsigned doAnotherStage = 1;
     size_t nextSrcSizeHint = 1;
 
+    /* once skipped, checksums can't be verified anymore until end of frame (fast path below included) */
+    if ((decompressOptionsPtr != NULL) && decompressOptionsPtr->skipChecksums) dctx->skipChecksum = 1;
+
+    /* fast path : small input, which doesn't complete current compressed block, is just stored into tmpIn.
+     * Only when no other action would be taken at this point :
+     * no history to transfer from a previous directDst call,
+     * and no history to preserve from a previous stableDst call */
+    if ( (dctx->dStage == dstage_storeCBlock)
+      && (*srcSizePtr < dctx->tmpInTarget - dctx->tmpInSize)
+      && (!dctx->historyInStream)
+      && ( (dctx->frameInfo.blockMode == LZ4F_blockIndependent)
+        || (dctx->dict == dctx->tmpOutBuffer)
+        || ((decompressOptionsPtr != NULL) && decompressOptionsPtr->stableDst) ) ) {
+        memcpy(dctx->tmpIn + dctx->tmpInSize, srcBuffer, *srcSizePtr);
+        dctx->tmpInSize += *srcSizePtr;
+        *dstSizePtr = 0;
+        return (dctx->tmpInTarget - dctx->tmpInSize) + BHSize;
+    }
 
     memset(&optionsNull, 0, sizeof(optionsNull));
     if (decompressOptionsPtr==NULL) decompressOptionsPtr = &optionsNull;
     *srcSizePtr = 0;
     *dstSizePtr = 0;
 
+    /* previous call was directDst : its output is still in place, but may not remain so */
+    if (!decompressOptionsPtr->directDst) LZ4F_historyToDict(dctx);
+
     /* behaves as a state machine */
 
     while (doAnotherStage) {
@@ -1272,18 +2009,18 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
             break;
 
         case dstage_init:
-            if (dctx->frameInfo.contentChecksumFlag) XXH32_reset(&(dctx->xxh), 0);
+            if (dctx->frameInfo.contentChecksumFlag && !dctx->skipChecksum) XXH32_reset(&(dctx->xxh), 0);
             /* internal buffers allocation */
             {   size_t const bufferNeeded = dctx->maxBlockSize
                     + ((dctx->frameInfo.blockMode==LZ4F_blockLinked) * 128 KB);
                 if (bufferNeeded > dctx->maxBufferSize) {   /* tmp buffers too small */
                     dctx->maxBufferSize = 0;   /* ensure allocation will be re-attempted on next entry*/
-                    FREEMEM(dctx->tmpIn);
-                    dctx->tmpIn = (BYTE*)ALLOCATOR(dctx->maxBlockSize + 4 /* block checksum */);
+                    LZ4F_free(dctx->tmpIn, dctx->customMem);
+                    dctx->tmpIn = (BYTE*)LZ4F_calloc(dctx->maxBlockSize + 4 /* block checksum */, dctx->customMem);
                     if (dctx->tmpIn == NULL)
                         return err0r(LZ4F_ERROR_allocation_failed);
-                    FREEMEM(dctx->tmpOutBuffer);
-                    dctx->tmpOutBuffer= (BYTE*)ALLOCATOR(bufferNeeded);
+                    LZ4F_free(dctx->tmpOutBuffer, dctx->customMem);
+                    dctx->tmpOutBuffer= (BYTE*)LZ4F_calloc(bufferNeeded, dctx->customMem);
                     if (dctx->tmpOutBuffer== NULL)
                         return err0r(LZ4F_ERROR_allocation_failed);
                     dctx->maxBufferSize = bufferNeeded;
@@ -1293,6 +2030,7 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
             dctx->tmpOut = dctx->tmpOutBuffer;
             dctx->tmpOutStart = 0;
             dctx->tmpOutSize = 0;
+            dctx->historyInStream = 0;
 
             dctx->dStage = dstage_getBlockHeader;
             /* fall-through */
@@ -1336,7 +2074,7 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
                 if (LZ4F_readLE32(selectedIn) & LZ4F_BLOCKUNCOMPRESSED_FLAG) {
                     /* next block is uncompressed */
                     dctx->tmpInTarget = nextCBlockSize;
-                    if (dctx->frameInfo.blockChecksumFlag) {
+                    if (dctx->frameInfo.blockChecksumFlag && !dctx->skipChecksum) {
                         XXH32_reset(&dctx->blockChecksum, 0);
                     }
                     dctx->dStage = dstage_copyDirect;
@@ -1356,17 +2094,23 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
             {   size_t const minBuffSize = MIN((size_t)(srcEnd-srcPtr), (size_t)(dstEnd-dstPtr));
                 size_t const sizeToCopy = MIN(dctx->tmpInTarget, minBuffSize);
                 memcpy(dstPtr, srcPtr, sizeToCopy);
-                if (dctx->frameInfo.blockChecksumFlag) {
-                    XXH32_update(&dctx->blockChecksum, srcPtr, sizeToCopy);
+                if (!dctx->skipChecksum) {
+                    if (dctx->frameInfo.blockChecksumFlag)
+                        XXH32_update(&dctx->blockChecksum, srcPtr, sizeToCopy);
+                    if (dctx->frameInfo.contentChecksumFlag)
+                        XXH32_update(&dctx->xxh, srcPtr, sizeToCopy);
                 }
-                if (dctx->frameInfo.contentChecksumFlag)
-                    XXH32_update(&dctx->xxh, srcPtr, sizeToCopy);
                 if (dctx->frameInfo.contentSize)
                     dctx->frameRemainingSize -= sizeToCopy;
 
                 /* history management (linked blocks only)*/
-                if (dctx->frameInfo.blockMode == LZ4F_blockLinked)
-                    LZ4F_updateDict(dctx, dstPtr, sizeToCopy, dstStart, 0);
+                if (dctx->frameInfo.blockMode == LZ4F_blockLinked) {
+                    if (decompressOptionsPtr->directDst) {
+                        LZ4F_historyToStream(dctx);
+                        LZ4F_appendHistory(&dctx->streamDecode, dstPtr, sizeToCopy);
+                    } else {
+                        LZ4F_updateDict(dctx, dstPtr, sizeToCopy, dstStart, 0);
+                }   }
 
                 srcPtr += sizeToCopy;
                 dstPtr += sizeToCopy;
@@ -1404,7 +2148,8 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
                     }
                     crcSrc = dctx->header;
                 }
-                {   U32 const readCRC = LZ4F_readLE32(crcSrc);
+                if (!dctx->skipChecksum) {
+                    U32 const readCRC = LZ4F_readLE32(crcSrc);
                     U32 const calcCRC = XXH32_digest(&dctx->blockChecksum);
                     if (readCRC != calcCRC)
                         return err0r(LZ4F_ERROR_blockChecksum_invalid);
@@ -1443,7 +2188,8 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
             if (dctx->frameInfo.blockChecksumFlag) {
                 dctx->tmpInTarget -= 4;
                 assert(selectedIn != NULL);  /* selectedIn is defined at this stage (either srcPtr, or dctx->tmpIn) */
-                {   U32 const readBlockCrc = LZ4F_readLE32(selectedIn + dctx->tmpInTarget);
+                if (!dctx->skipChecksum) {
+                    U32 const readBlockCrc = LZ4F_readLE32(selectedIn + dctx->tmpInTarget);
                     U32 const calcBlockCrc = XXH32(selectedIn, dctx->tmpInTarget, 0);
                     if (readBlockCrc != calcBlockCrc)
                         return err0r(LZ4F_ERROR_blockChecksum_invalid);
@@ -1451,18 +2197,26 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
 
             if ((size_t)(dstEnd-dstPtr) >= dctx->maxBlockSize) {
                 /* enough capacity in `dst` to decompress directly there */
-                int const decodedSize = LZ4_decompress_safe_usingDict(
-                        (const char*)selectedIn, (char*)dstPtr,
-                        (int)dctx->tmpInTarget, (int)dctx->maxBlockSize,
-                        (const char*)dctx->dict, (int)dctx->dictSize);
+                int decodedSize;
+                if ((dctx->frameInfo.blockMode==LZ4F_blockLinked) && decompressOptionsPtr->directDst) {
+                    LZ4F_historyToStream(dctx);
+                    decodedSize = LZ4_decompress_safe_continue(&dctx->streamDecode,
+                            (const char*)selectedIn, (char*)dstPtr,
+                            (int)dctx->tmpInTarget, (int)dctx->maxBlockSize);
+                } else {
+                    decodedSize = LZ4_decompress_safe_usingDict(
+                            (const char*)selectedIn, (char*)dstPtr,
+                            (int)dctx->tmpInTarget, (int)dctx->maxBlockSize,
+                            (const char*)dctx->dict, (int)dctx->dictSize);
+                }
                 if (decodedSize < 0) return err0r(LZ4F_ERROR_GENERIC);   /* decompression failed */
-                if (dctx->frameInfo.contentChecksumFlag)
+                if (dctx->frameInfo.contentChecksumFlag && !dctx->skipChecksum)
                     XXH32_update(&(dctx->xxh), dstPtr, decodedSize);
                 if (dctx->frameInfo.contentSize)
                     dctx->frameRemainingSize -= decodedSize;
 
                 /* dictionary management */
-                if (dctx->frameInfo.blockMode==LZ4F_blockLinked)
+                if ((dctx->frameInfo.blockMode==LZ4F_blockLinked) && !dctx->historyInStream)
                     LZ4F_updateDict(dctx, dstPtr, decodedSize, dstStart, 0);
 
                 dstPtr += decodedSize;
@@ -1471,6 +2225,7 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
             }
 
             /* not enough place into dst : decode into tmpOut */
+            LZ4F_historyToDict(dctx);   /* directDst : history can't be referenced in place anymore */
             /* ensure enough place for tmpOut */
             if (dctx->frameInfo.blockMode == LZ4F_blockLinked) {
                 if (dctx->dict == dctx->tmpOutBuffer) {
@@ -1492,7 +2247,7 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
                         (const char*)dctx->dict, (int)dctx->dictSize);
                 if (decodedSize < 0)  /* decompression failed */
                     return err0r(LZ4F_ERROR_decompressionFailed);
-                if (dctx->frameInfo.contentChecksumFlag)
+                if (dctx->frameInfo.contentChecksumFlag && !dctx->skipChecksum)
                     XXH32_update(&(dctx->xxh), dctx->tmpOut, decodedSize);
                 if (dctx->frameInfo.contentSize)
                     dctx->frameRemainingSize -= decodedSize;
@@ -1556,15 +2311,16 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
             }   /* if (dctx->dStage == dstage_storeSuffix) */
 
         /* case dstage_checkSuffix: */   /* no direct call, avoid scan-build warning */
-            {   U32 const readCRC = LZ4F_readLE32(selectedIn);
+            if (!dctx->skipChecksum) {
+                U32 const readCRC = LZ4F_readLE32(selectedIn);
                 U32 const resultCRC = XXH32_digest(&(dctx->xxh));
                 if (readCRC != resultCRC)
                     return err0r(LZ4F_ERROR_contentChecksum_invalid);
-                nextSrcSizeHint = 0;
-                LZ4F_resetDecompressionContext(dctx);
-                doAnotherStage = 0;
-                break;
             }
+            nextSrcSizeHint = 0;
+            LZ4F_resetDecompressionContext(dctx);
+            doAnotherStage = 0;
+            break;
 
         case dstage_getSFrameSize:
             if ((srcEnd - srcPtr) >= 4) {
@@ -1621,6 +2377,7 @@ size_t LZ4F_decompress(LZ4F_dctx* dctx,
     if ( (dctx->frameInfo.blockMode==LZ4F_blockLinked)  /* next block will use up to 64KB from previous ones */
       && (dctx->dict != dctx->tmpOutBuffer)             /* dictionary is not already within tmp */
       && (!decompressOptionsPtr->stableDst)             /* cannot rely on dst data to remain there for next call */
+      && (!decompressOptionsPtr->directDst)             /* directDst implies stableDst */
       && ((unsigned)(dctx->dStage)-2 < (unsigned)(dstage_getSuffix)-2) )  /* valid stages : [init ... getSuffix[ */
     {
         if (dctx->dStage == dstage_flushOut) {
@@ -1672,3 +2429,582 @@ size_t LZ4F_decompress_usingDict(LZ4F_dctx* dctx,
                            srcBuffer, srcSizePtr,
                            decompressOptionsPtr);
 }
+
+
+/*-***************************************************
+*   One-pass frame decompression
+*****************************************************/
+
+typedef struct {
+    const BYTE* src;      /* block content */
+    size_t cSize;         /* size of block content */
+    U32    uncompressed;
+    BYTE*  dst;           /* speculative position : blockNb * maxBlockSize */
+    size_t dstCapacity;
+    size_t dSize;         /* decoded size, or error code */
+} LZ4F_blockDesc_t;
+
+typedef struct {
+    LZ4F_blockDesc_t* blocks;
+    const char* dict;
+    int    dictSize;
+    U32    blockChecksumFlag;
+} LZ4F_parallelDCtx_t;
+
+/*! LZ4F_nextBlock() :
+ *  reads the block header at *ipPtr, and checks that its content (and checksum) fits within `iend`.
+ * @return : 1 when a block was read into `blk`, 0 on endMark,
+ *           or an error code (testable with LZ4F_isError()) */
+static size_t LZ4F_nextBlock(LZ4F_blockDesc_t* blk, const BYTE** ipPtr, const BYTE* iend,
+                             size_t maxBlockSize, U32 blockChecksumFlag)
+{
+    const BYTE* ip = *ipPtr;
+    U32 blockHeader;
+    if ((size_t)(iend-ip) < BHSize) return err0r(LZ4F_ERROR_frameSize_wrong);   /* truncated frame */
+    blockHeader = LZ4F_readLE32(ip);
+    ip += BHSize;
+    if (blockHeader == 0) { *ipPtr = ip; return 0; }   /* endMark */
+    blk->cSize = blockHeader & 0x7FFFFFFFU;
+    blk->uncompressed = blockHeader >> 31;
+    if (blk->cSize > maxBlockSize) return err0r(LZ4F_ERROR_maxBlockSize_invalid);
+    if ((size_t)(iend-ip) < blk->cSize + (blockChecksumFlag*4)) return err0r(LZ4F_ERROR_frameSize_wrong);
+    blk->src = ip;
+    *ipPtr = ip + blk->cSize + (blockChecksumFlag*4);
+    return 1;
+}
+
+static size_t LZ4F_checkBlockChecksum(const LZ4F_blockDesc_t* blk)
+{
+    U32 const readCRC = LZ4F_readLE32(blk->src + blk->cSize);
+    U32 const calcCRC = XXH32(blk->src, blk->cSize, 0);
+    if (readCRC != calcCRC) return err0r(LZ4F_ERROR_blockChecksum_invalid);
+    return 0;
+}
+
+static size_t LZ4F_decodeIndependentBlock(const LZ4F_blockDesc_t* blk, BYTE* dst, size_t dstCapacity,
+                                          const char* dict, int dictSize)
+{
+    if (blk->uncompressed) {
+        if (blk->cSize > dstCapacity) return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);
+        memcpy(dst, blk->src, blk->cSize);
+        return blk->cSize;
+    }
+    {   int const dSize = LZ4_decompress_safe_usingDict((const char*)blk->src, (char*)dst,
+                                                        (int)blk->cSize, (int)dstCapacity,
+                                                        dict, dictSize);
+        if (dSize < 0) return err0r(LZ4F_ERROR_decompressionFailed);
+        return (size_t)dSize;
+    }
+}
+
+static size_t LZ4F_decodeLinkedBlock(const LZ4F_blockDesc_t* blk, BYTE* dst, size_t dstCapacity,
+                                     LZ4_streamDecode_t* streamDecode)
+{
+    if (blk->uncompressed) {
+        if (blk->cSize > dstCapacity) return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);
+        memcpy(dst, blk->src, blk->cSize);
+        LZ4F_appendHistory(streamDecode, dst, blk->cSize);
+        return blk->cSize;
+    }
+    {   int const dSize = LZ4_decompress_safe_continue(streamDecode, (const char*)blk->src, (char*)dst,
+                                                       (int)blk->cSize, (int)dstCapacity);
+        if (dSize < 0) return err0r(LZ4F_ERROR_decompressionFailed);
+        return (size_t)dSize;
+    }
+}
+
+/*! LZ4F_readFrameHeader() :
+ *  decodes the header of a frame entirely present in `src`, into a stack `dctx` (no internal buffer).
+ * @return : header size, or 0 for a skippable frame (its total size is then written into *skipSizePtr),
+ *           or an error code (testable with LZ4F_isError()) */
+static size_t LZ4F_readFrameHeader(LZ4F_dctx* dctx, const BYTE* src, size_t srcSize, size_t* skipSizePtr)
+{
+    size_t hSize;
+    memset(dctx, 0, sizeof(*dctx));
+    if (srcSize < 8) return err0r(LZ4F_ERROR_frameHeader_incomplete);
+    hSize = LZ4F_decodeHeader(dctx, src, srcSize);
+    if (LZ4F_isError(hSize)) return hSize;
+    if (dctx->frameInfo.frameType == LZ4F_skippableFrame) {
+        size_t const skipSize = 8 + (size_t)LZ4F_readLE32(src+4);
+        if (skipSize > srcSize) return err0r(LZ4F_ERROR_frameSize_wrong);
+        *skipSizePtr = skipSize;
+        return 0;
+    }
+    if (dctx->dStage != dstage_init) return err0r(LZ4F_ERROR_frameHeader_incomplete);
+    return hSize;
+}
+
+/*! LZ4F_decodeBlocks_serial() :
+ *  decodes all blocks of a frame, in order, straight into their final position within `dst`.
+ *  On entry, *ipPtr points at first block header ; on exit, it points just after endMark.
+ * @return : decoded size, or an error code (testable with LZ4F_isError()) */
+static size_t LZ4F_decodeBlocks_serial(BYTE* dst, size_t dstCapacity,
+                                       const BYTE** ipPtr, const BYTE* iend,
+                                       const LZ4F_dctx* dctx,
+                                       const void* dict, size_t dictSize)
+{
+    BYTE* const dstEnd = dst + dstCapacity;
+    BYTE* op = dst;
+    size_t const maxBlockSize = dctx->maxBlockSize;
+    U32 const blockChecksumFlag = dctx->frameInfo.blockChecksumFlag;
+    LZ4F_blockDesc_t blk;
+    LZ4_streamDecode_t streamDecode;
+    LZ4_setStreamDecode(&streamDecode, (const char*)dict, (int)dictSize);
+    for (;;) {
+        size_t const r = LZ4F_nextBlock(&blk, ipPtr, iend, maxBlockSize, blockChecksumFlag);
+        size_t const blockCapacity = MIN(maxBlockSize, (size_t)(dstEnd-op));
+        size_t dSize;
+        if (LZ4F_isError(r)) return r;
+        if (r == 0) break;   /* endMark */
+        if (blockChecksumFlag) {
+            size_t const crcError = LZ4F_checkBlockChecksum(&blk);
+            if (LZ4F_isError(crcError)) return crcError;
+        }
+        if (dctx->frameInfo.blockMode == LZ4F_blockLinked)
+            dSize = LZ4F_decodeLinkedBlock(&blk, op, blockCapacity, &streamDecode);
+        else
+            dSize = LZ4F_decodeIndependentBlock(&blk, op, blockCapacity, (const char*)dict, (int)dictSize);
+        if (LZ4F_isError(dSize)) return dSize;
+        op += dSize;
+    }
+    return (size_t)(op - dst);
+}
+
+/*! LZ4F_checkFrameEnd() :
+ *  verifies content checksum (read from `crcSrc`, when present) and content size (when present).
+ * @return : dSize, or an error code */
+static size_t LZ4F_checkFrameEnd(const LZ4F_dctx* dctx, const BYTE* dst, size_t dSize, const BYTE* crcSrc)
+{
+    if (dctx->frameInfo.contentChecksumFlag && (crcSrc != NULL)) {
+        U32 const readCRC = LZ4F_readLE32(crcSrc);
+        U32 const calcCRC = XXH32(dst, dSize, 0);
+        if (readCRC != calcCRC) return err0r(LZ4F_ERROR_contentChecksum_invalid);
+    }
+    if ( dctx->frameInfo.contentSize
+      && (dctx->frameInfo.contentSize != (U64)dSize) )
+        return err0r(LZ4F_ERROR_frameSize_wrong);
+    return dSize;
+}
+
+struct LZ4F_checksumJob_s {
+    LZ4_async* async;
+    const BYTE* dst;
+    size_t dSize;
+    U32 readCRC;
+    U32 calcCRC;
+};
+
+static void LZ4F_checksumJob_run(void* opaque, unsigned jobNb)
+{
+    LZ4F_checksumJob* const job = (LZ4F_checksumJob*)opaque;
+    (void)jobNb;
+    job->calcCRC = XXH32(job->dst, job->dSize, 0);
+}
+
+/*! LZ4F_decompressFrame_generic() :
+ *  Frame header, blocks and checksums are read in a single pass, straight from `src` into `dst` :
+ *  there is no dctx state machine, no staging, and no allocation.
+ *  When `jobPtr` is not NULL, content checksum is handed over to a background job. */
+static size_t LZ4F_decompressFrame_generic(void* dstBuffer, size_t dstCapacity,
+                                           const void* srcBuffer, size_t srcSize,
+                                           const void* dict, size_t dictSize,
+                                           LZ4F_checksumJob** jobPtr)
+{
+    LZ4F_dctx dctx;   /* only used to decode frame header : no internal buffer */
+    const BYTE* ip = (const BYTE*)srcBuffer;
+    const BYTE* const iend = ip + srcSize;
+    size_t skipSize, dSize;
+
+    if (dictSize > 64 KB) {
+        dict = (const BYTE*)dict + dictSize - 64 KB;
+        dictSize = 64 KB;
+    }
+
+    {   size_t const hSize = LZ4F_readFrameHeader(&dctx, ip, srcSize, &skipSize);
+        if (LZ4F_isError(hSize)) return hSize;
+        if (hSize == 0) return 0;   /* skippable frame */
+        ip += hSize;
+    }
+    if (dctx.frameInfo.contentSize > dstCapacity) return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);
+
+    dSize = LZ4F_decodeBlocks_serial((BYTE*)dstBuffer, dstCapacity, &ip, iend, &dctx, dict, dictSize);
+    if (LZ4F_isError(dSize)) return dSize;
+    if (dctx.frameInfo.contentChecksumFlag && ((size_t)(iend-ip) < 4))
+        return err0r(LZ4F_ERROR_frameSize_wrong);
+    if ((jobPtr == NULL) || !dctx.frameInfo.contentChecksumFlag)
+        return LZ4F_checkFrameEnd(&dctx, (const BYTE*)dstBuffer, dSize, ip);
+
+    dSize = LZ4F_checkFrameEnd(&dctx, (const BYTE*)dstBuffer, dSize, NULL);   /* content size only */
+    if (LZ4F_isError(dSize)) return dSize;
+    {   LZ4F_checksumJob* const job = (LZ4F_checksumJob*)ALLOCATOR(sizeof(*job));
+        if (job == NULL) return err0r(LZ4F_ERROR_allocation_failed);
+        job->dst = (const BYTE*)dstBuffer;
+        job->dSize = dSize;
+        job->readCRC = LZ4F_readLE32(ip);
+        job->async = LZ4_async_start(LZ4F_checksumJob_run, job);
+        /* on failure to start, checksum is calculated within LZ4F_checksumJob_wait() */
+        *jobPtr = job;
+    }
+    return dSize;
+}
+
+size_t LZ4F_decompressFrame(void* dstBuffer, size_t dstCapacity,
+                            const void* srcBuffer, size_t srcSize,
+                            const void* dict, size_t dictSize)
+{
+    return LZ4F_decompressFrame_generic(dstBuffer, dstCapacity, srcBuffer, srcSize, dict, dictSize, NULL);
+}
+
+size_t LZ4F_decompressFrame_deferredCheck(LZ4F_checksumJob** jobPtr,
+                            void* dstBuffer, size_t dstCapacity,
+                            const void* srcBuffer, size_t srcSize,
+                            const void* dict, size_t dictSize)
+{
+    if (jobPtr == NULL) return err0r(LZ4F_ERROR_GENERIC);
+    *jobPtr = NULL;
+    return LZ4F_decompressFrame_generic(dstBuffer, dstCapacity, srcBuffer, srcSize, dict, dictSize, jobPtr);
+}
+
+size_t LZ4F_checksumJob_wait(LZ4F_checksumJob* job)
+{
+    U32 match;
+    if (job == NULL) return 0;
+    if (job->async != NULL)
+        LZ4_async_wait(job->async);
+    else
+        LZ4F_checksumJob_run(job, 0);
+    match = (job->calcCRC == job->readCRC);
+    FREEMEM(job);
+    return match ? 0 : err0r(LZ4F_ERROR_contentChecksum_invalid);
+}
+
+/* LZ4F_decodeBlockJob() :
+ * decodes one independent block into its speculative position. Runs concurrently with other jobs. */
+static void LZ4F_decodeBlockJob(void* opaque, unsigned jobNb)
+{
+    const LZ4F_parallelDCtx_t* const pctx = (const LZ4F_parallelDCtx_t*)opaque;
+    LZ4F_blockDesc_t* const blk = pctx->blocks + jobNb;
+    if (pctx->blockChecksumFlag) {
+        size_t const crcError = LZ4F_checkBlockChecksum(blk);
+        if (LZ4F_isError(crcError)) { blk->dSize = crcError; return; }
+    }
+    if (blk->dstCapacity == 0) { blk->dSize = err0r(LZ4F_ERROR_dstMaxSize_tooSmall); return; }
+    blk->dSize = LZ4F_decodeIndependentBlock(blk, blk->dst, blk->dstCapacity, pctx->dict, pctx->dictSize);
+}
+
+/*! LZ4F_decompressFrame_parallel_internal() :
+ *  Independent blocks are first decoded concurrently, each at offset `blockNb * maxBlockSize`,
+ *  which is their final position whenever all previous blocks are full (the usual case).
+ *  Blocks are then packed in order : a block which didn't fit its speculative slot
+ *  is decoded again at its final position, which never overlaps slots of following blocks.
+ *  `poolPtr` : pool kept by caller, (re)created when needed ; NULL means a pool just for this frame.
+ *  `cmem` : allocates block descriptors and pool. */
+static size_t LZ4F_decompressFrame_parallel_internal(void* dstBuffer, size_t dstCapacity,
+                                     const void* srcBuffer, size_t* srcSizePtr,
+                                     const void* dict, size_t dictSize,
+                                     unsigned nbThreads, LZ4_pool** poolPtr, LZ4F_CustomMem cmem)
+{
+    LZ4F_dctx dctx;   /* only used to decode frame header : no internal buffer */
+    const BYTE* const srcStart = (const BYTE*)srcBuffer;
+    const BYTE* const srcEnd = srcStart + *srcSizePtr;
+    const BYTE* ip = srcStart;
+    const BYTE* blocksStart;
+    BYTE* const dstStart = (BYTE*)dstBuffer;
+    BYTE* const dstEnd = dstStart + dstCapacity;
+    BYTE* op = dstStart;
+    LZ4F_blockDesc_t blk;
+    size_t maxBlockSize, nbBlocks = 0, frameSize, skipSize = 0;
+    U32 blockChecksumFlag, contentChecksumFlag;
+
+    if (dictSize > 64 KB) {
+        dict = (const BYTE*)dict + dictSize - 64 KB;
+        dictSize = 64 KB;
+    }
+
+    /* frame header */
+    {   size_t const hSize = LZ4F_readFrameHeader(&dctx, ip, *srcSizePtr, &skipSize);
+        if (LZ4F_isError(hSize)) return hSize;
+        if (hSize == 0) { *srcSizePtr = skipSize; return 0; }   /* skippable frame */
+        ip += hSize;
+    }
+    maxBlockSize = dctx.maxBlockSize;
+    blockChecksumFlag = dctx.frameInfo.blockChecksumFlag;
+    contentChecksumFlag = dctx.frameInfo.contentChecksumFlag;
+    if (dctx.frameInfo.contentSize > dstCapacity) return err0r(LZ4F_ERROR_dstMaxSize_tooSmall);
+
+    /* pre-scan block headers */
+    blocksStart = ip;
+    for (;;) {
+        size_t const r = LZ4F_nextBlock(&blk, &ip, srcEnd, maxBlockSize, blockChecksumFlag);
+        if (LZ4F_isError(r)) return r;
+        if (r == 0) break;
+        nbBlocks++;
+    }
+    if (contentChecksumFlag) {
+        if ((size_t)(srcEnd-ip) < 4) return err0r(LZ4F_ERROR_frameSize_wrong);
+        ip += 4;
+    }
+    frameSize = ip - srcStart;
+
+    if ( (dctx.frameInfo.blockMode == LZ4F_blockLinked)
+      || (nbThreads <= 1) || (nbBlocks <= 1) ) {
+        /* serial decoding, straight into final position */
+        size_t dSize;
+        ip = blocksStart;
+        dSize = LZ4F_decodeBlocks_serial(dstStart, dstCapacity, &ip, srcEnd, &dctx, dict, dictSize);
+        if (LZ4F_isError(dSize)) return dSize;
+        op += dSize;
+    } else {
+        LZ4F_parallelDCtx_t pctx;
+        LZ4_pool* pool = NULL;
+        size_t n;
+        if (nbBlocks > (unsigned)-1) return err0r(LZ4F_ERROR_srcSize_tooLarge);   /* LZ4_pool_run() job numbers are unsigned */
+        pctx.blocks = (LZ4F_blockDesc_t*)LZ4F_calloc(nbBlocks * sizeof(LZ4F_blockDesc_t), cmem);
+        if (pctx.blocks == NULL) return err0r(LZ4F_ERROR_allocation_failed);
+        pctx.dict = (const char*)dict;
+        pctx.dictSize = (int)dictSize;
+        pctx.blockChecksumFlag = blockChecksumFlag;
+
+        ip = blocksStart;
+        for (n=0; n<nbBlocks; n++) {
+            LZ4F_blockDesc_t* const b = pctx.blocks + n;
+            size_t const slotStart = (n <= dstCapacity / maxBlockSize) ? n * maxBlockSize : dstCapacity;
+            LZ4F_nextBlock(b, &ip, srcEnd, maxBlockSize, blockChecksumFlag);   /* already validated */
+            b->dst = dstStart + slotStart;
+            b->dstCapacity = MIN(maxBlockSize, dstCapacity - slotStart);
+        }
+
+        {   LZ4F_errorCode_t const poolError = LZ4F_poolUpdate(poolPtr ? poolPtr : &pool, nbThreads, cmem);
+            if (LZ4F_isError(poolError)) { LZ4F_free(pctx.blocks, cmem); return poolError; }
+            if (poolPtr != NULL) pool = *poolPtr;
+        }
+        LZ4_pool_run(pool, LZ4F_decodeBlockJob, &pctx, (unsigned)nbBlocks);
+        if (poolPtr == NULL) LZ4_pool_free(pool);
+
+        /* pack blocks in order */
+        for (n=0; n<nbBlocks; n++) {
+            LZ4F_blockDesc_t* const b = pctx.blocks + n;
+            size_t dSize = b->dSize;
+            if (dSize == err0r(LZ4F_ERROR_blockChecksum_invalid)) { LZ4F_free(pctx.blocks, cmem); return dSize; }
+            if (LZ4F_isError(dSize)) {
+                /* retry at final position, which is necessarily <= speculative one */
+                dSize = LZ4F_decodeIndependentBlock(b, op, MIN(maxBlockSize, (size_t)(dstEnd-op)),
+                                                    (const char*)dict, (int)dictSize);
+                if (LZ4F_isError(dSize)) { LZ4F_free(pctx.blocks, cmem); return dSize; }
+            } else if (op != b->dst) {
+                memmove(op, b->dst, dSize);
+            }
+            op += dSize;
+        }
+        LZ4F_free(pctx.blocks, cmem);
+    }
+
+    /* frame checks */
+    {   size_t const dSize = LZ4F_checkFrameEnd(&dctx, dstStart, op - dstStart, srcStart + frameSize - 4);
+        if (LZ4F_isError(dSize)) return dSize;
+        *srcSizePtr = frameSize;
+        return dSize;
+    }
+}
+
+size_t LZ4F_decompressFrame_parallel(void* dstBuffer, size_t dstCapacity,
+                                     const void* srcBuffer, size_t* srcSizePtr,
+                                     const void* dict, size_t dictSize,
+                                     unsigned nbThreads)
+{
+    return LZ4F_decompressFrame_parallel_internal(dstBuffer, dstCapacity, srcBuffer, srcSizePtr,
+                                                  dict, dictSize, nbThreads, NULL, LZ4F_defaultCMem);
+}
+
+size_t LZ4F_decompressFrame_parallel_usingDCtx(LZ4F_dctx* dctx,
+                                     void* dstBuffer, size_t dstCapacity,
+                                     const void* srcBuffer, size_t* srcSizePtr,
+                                     const void* dict, size_t dictSize,
+                                     unsigned nbThreads)
+{
+    return LZ4F_decompressFrame_parallel_internal(dstBuffer, dstCapacity, srcBuffer, srcSizePtr,
+                                                  dict, dictSize, nbThreads, &dctx->pool, dctx->customMem);
+}
+
+
+/*-***************************************************
+*   Random access
+*****************************************************/
+
+struct LZ4F_seekable_s {
+    const BYTE* src;
+    const char* dict;
+    int    dictSize;
+    size_t nbBlocks;
+    size_t* cOffsets;     /* nbBlocks+1 entries : position of each block header within src */
+    U64*   dOffsets;      /* nbBlocks+1 entries : position of each block within decoded content */
+    size_t maxBlockSize;
+    U32    blockChecksumFlag;
+    BYTE*  blockBuffer;   /* last partially read block */
+    size_t cachedBlock;   /* == nbBlocks when blockBuffer is empty */
+};
+
+void LZ4F_seekableClose(LZ4F_seekable* s)
+{
+    if (s==NULL) return;
+    FREEMEM(s->cOffsets);
+    FREEMEM(s->dOffsets);
+    FREEMEM(s->blockBuffer);
+    FREEMEM(s);
+}
+
+/*! LZ4F_seekableOpen() :
+ *  the seek table is read from the end of `src`, then each entry is checked against its block header,
+ *  so that LZ4F_readAt() can trust recorded offsets. */
+size_t LZ4F_seekableOpen(LZ4F_seekable** sPtr, const void* srcBuffer, size_t srcSize,
+                         const void* dict, size_t dictSize)
+{
+    const BYTE* const srcStart = (const BYTE*)srcBuffer;
+    const BYTE* tableStart;
+    const BYTE* entry;
+    const BYTE* ip;
+    LZ4F_dctx dctx;   /* only used to decode frame header */
+    LZ4F_seekable* s;
+    LZ4F_blockDesc_t blk;
+    size_t nbBlocks, n;
+
+    *sPtr = NULL;
+    if (dictSize > 64 KB) {
+        dict = (const BYTE*)dict + dictSize - 64 KB;
+        dictSize = 64 KB;
+    }
+
+    /* seek table */
+    if (srcSize < LZ4F_SEEKTABLE_SIZE(0)) return err0r(LZ4F_ERROR_seekTable_invalid);
+    if (LZ4F_readLE32(srcStart + srcSize - 4) != LZ4F_SEEKTABLE_FOOTER_MAGIC) return err0r(LZ4F_ERROR_seekTable_invalid);
+    nbBlocks = LZ4F_readLE32(srcStart + srcSize - 8);
+    if (nbBlocks > (srcSize - LZ4F_SEEKTABLE_SIZE(0)) / 8) return err0r(LZ4F_ERROR_seekTable_invalid);
+    tableStart = srcStart + srcSize - LZ4F_SEEKTABLE_SIZE(nbBlocks);
+    if ( (LZ4F_readLE32(tableStart) != LZ4F_SEEKTABLE_MAGIC)
+      || (LZ4F_readLE32(tableStart+4) != LZ4F_SEEKTABLE_SIZE(nbBlocks) - 8) )
+        return err0r(LZ4F_ERROR_seekTable_invalid);
+
+    /* frame header */
+    memset(&dctx, 0, sizeof(dctx));
+    if (tableStart - srcStart < 8) return err0r(LZ4F_ERROR_frameHeader_incomplete);
+    {   size_t const hSize = LZ4F_decodeHeader(&dctx, srcStart, tableStart - srcStart);
+        if (LZ4F_isError(hSize)) return hSize;
+        if (dctx.frameInfo.frameType == LZ4F_skippableFrame) return err0r(LZ4F_ERROR_frameType_unknown);
+        if (dctx.dStage != dstage_init) return err0r(LZ4F_ERROR_frameHeader_incomplete);
+        ip = srcStart + hSize;
+    }
+    if (dctx.frameInfo.blockMode != LZ4F_blockIndependent) return err0r(LZ4F_ERROR_blockMode_invalid);
+
+    s = (LZ4F_seekable*)ALLOCATOR(sizeof(LZ4F_seekable));
+    if (s==NULL) return err0r(LZ4F_ERROR_allocation_failed);
+    s->cOffsets = (size_t*)ALLOCATOR((nbBlocks+1) * sizeof(size_t));
+    s->dOffsets = (U64*)ALLOCATOR((nbBlocks+1) * sizeof(U64));
+    s->blockBuffer = (BYTE*)ALLOCATOR(dctx.maxBlockSize);
+    if ((s->cOffsets==NULL) || (s->dOffsets==NULL) || (s->blockBuffer==NULL)) {
+        LZ4F_seekableClose(s);
+        return err0r(LZ4F_ERROR_allocation_failed);
+    }
+    s->src = srcStart;
+    s->dict = (const char*)dict;
+    s->dictSize = (int)dictSize;
+    s->nbBlocks = nbBlocks;
+    s->maxBlockSize = dctx.maxBlockSize;
+    s->blockChecksumFlag = dctx.frameInfo.blockChecksumFlag;
+    s->cachedBlock = nbBlocks;
+
+    /* check table entries against block headers */
+    s->cOffsets[0] = ip - srcStart;
+    s->dOffsets[0] = 0;
+    entry = tableStart + 8;
+    for (n=0; n<nbBlocks; n++) {
+        size_t const cBlockSize = LZ4F_readLE32(entry);
+        size_t const dBlockSize = LZ4F_readLE32(entry+4);
+        size_t const r = LZ4F_nextBlock(&blk, &ip, tableStart, s->maxBlockSize, s->blockChecksumFlag);
+        if ( (r != 1)
+          || (cBlockSize != BHSize + blk.cSize + s->blockChecksumFlag*4)
+          || (dBlockSize > s->maxBlockSize)
+          || (blk.uncompressed && (dBlockSize != blk.cSize)) ) {
+            LZ4F_seekableClose(s);
+            return err0r(LZ4F_ERROR_seekTable_invalid);
+        }
+        s->cOffsets[n+1] = ip - srcStart;
+        s->dOffsets[n+1] = s->dOffsets[n] + dBlockSize;
+        entry += 8;
+    }
+
+    /* frame must end right before its seek table */
+    if ( (LZ4F_nextBlock(&blk, &ip, tableStart, s->maxBlockSize, s->blockChecksumFlag) != 0)
+      || ((size_t)(tableStart - ip) != dctx.frameInfo.contentChecksumFlag * 4)
+      || (dctx.frameInfo.contentSize && (dctx.frameInfo.contentSize != s->dOffsets[nbBlocks])) ) {
+        LZ4F_seekableClose(s);
+        return err0r(LZ4F_ERROR_seekTable_invalid);
+    }
+
+    *sPtr = s;
+    return 0;
+}
+
+unsigned long long LZ4F_seekableContentSize(const LZ4F_seekable* s)
+{
+    return s->dOffsets[s->nbBlocks];
+}
+
+/*! LZ4F_seekableDecodeBlock() :
+ *  decodes block `blockNb` into `dst`, which must be exactly its decoded size as recorded in seek table */
+static size_t LZ4F_seekableDecodeBlock(const LZ4F_seekable* s, size_t blockNb, BYTE* dst)
+{
+    size_t const dBlockSize = (size_t)(s->dOffsets[blockNb+1] - s->dOffsets[blockNb]);
+    const BYTE* ip = s->src + s->cOffsets[blockNb];
+    LZ4F_blockDesc_t blk;
+    if (LZ4F_nextBlock(&blk, &ip, s->src + s->cOffsets[blockNb+1], s->maxBlockSize, s->blockChecksumFlag) != 1)
+        return err0r(LZ4F_ERROR_GENERIC);   /* already validated by LZ4F_seekableOpen() */
+    if (s->blockChecksumFlag) {
+        size_t const crcError = LZ4F_checkBlockChecksum(&blk);
+        if (LZ4F_isError(crcError)) return crcError;
+    }
+    {   size_t const dSize = LZ4F_decodeIndependentBlock(&blk, dst, dBlockSize, s->dict, s->dictSize);
+        if (LZ4F_isError(dSize)) return dSize;
+        if (dSize != dBlockSize) return err0r(LZ4F_ERROR_seekTable_invalid);
+    }
+    return 0;
+}
+
+size_t LZ4F_readAt(LZ4F_seekable* s, void* dstBuffer, size_t size, unsigned long long offset)
+{
+    BYTE* const dstStart = (BYTE*)dstBuffer;
+    BYTE* op = dstStart;
+    U64 const contentSize = s->dOffsets[s->nbBlocks];
+    size_t lo = 0, hi = s->nbBlocks;
+
+    if (offset >= contentSize) return 0;
+    if (size > contentSize - offset) size = (size_t)(contentSize - offset);
+
+    /* find block containing `offset` : dOffsets[lo] <= offset < dOffsets[hi] */
+    while (hi - lo > 1) {
+        size_t const mid = (lo + hi) / 2;
+        if (s->dOffsets[mid] <= offset) lo = mid; else hi = mid;
+    }
+
+    for ( ; size > 0; lo++) {
+        size_t const inBlock = (size_t)(offset - s->dOffsets[lo]);
+        size_t const blockSize = (size_t)(s->dOffsets[lo+1] - s->dOffsets[lo]);
+        size_t const toCopy = MIN(blockSize - inBlock, size);
+        if ((inBlock == 0) && (toCopy == blockSize)) {
+            /* whole block : decode straight into dst */
+            size_t const dResult = LZ4F_seekableDecodeBlock(s, lo, op);
+            if (LZ4F_isError(dResult)) return dResult;
+        } else {
+            if (s->cachedBlock != lo) {
+                size_t const dResult = LZ4F_seekableDecodeBlock(s, lo, s->blockBuffer);
+                if (LZ4F_isError(dResult)) { s->cachedBlock = s->nbBlocks; return dResult; }
+                s->cachedBlock = lo;
+            }
+            memcpy(op, s->blockBuffer + inBlock, toCopy);
+        }
+        op += toCopy;
+        offset += toCopy;
+        size -= toCopy;
+    }
+
+    return op - dstStart;
+}
@@ -174,12 +174,23 @@ typedef struct {
 /*! LZ4F_preferences_t :
  *  makes it possible to supply detailed compression parameters to the stream interface.
  *  It's not required to set all fields, as long as the structure was initially memset() to zero.
- *  All reserved fields must be set to zero. */
+ *  All reserved fields must be set to zero.
+ *
+ *  Multi-threading (v1.8.1, experimental) : when `nbWorkers >= 1`, full blocks are buffered within cctx,
+ *  up to `nbBlocksInFlight` of them, then compressed in parallel, and written in order.
+ *  Buffered blocks are released by next LZ4F_compressUpdate(), or by LZ4F_flush() / LZ4F_compressEnd(),
+ *  so dstCapacity must be sized with LZ4F_compressBound(), which accounts for these preferences.
+ *  Output is identical for any `nbWorkers >= 1` and `nbBlocksInFlight`, even on a library built without multi-threading support.
+ *  Independent blocks are also identical to `nbWorkers == 0`.
+ *  Linked blocks are not : each block uses previous 64 KB of input as dictionary, instead of a continuous history. */
 typedef struct {
   LZ4F_frameInfo_t frameInfo;
   int      compressionLevel;       /* 0 == default (fast mode); values above LZ4HC_CLEVEL_MAX count as LZ4HC_CLEVEL_MAX; values below 0 trigger "fast acceleration", proportional to value */
   unsigned autoFlush;              /* 1 == always flush, to reduce usage of internal buffers */
-  unsigned reserved[4];            /* must be zero for forward compatibility */
+  unsigned nbWorkers;              /* 0 == compress within calling thread (default); >= 1 : compress up to `nbWorkers` blocks in parallel */
+  unsigned nbBlocksInFlight;       /* nb of full blocks buffered before compressing them together (nbWorkers >= 1 only) ; 0 == default (nbWorkers) */
+  unsigned seekTable;              /* 1 == append a seek table after the frame, for random access (requires LZ4F_blockIndependent) ; see lz4frame_static.h */
+  unsigned favorDecSpeed;          /* 1 == parser favors decompression speed, at a small cost in ratio ; only for levels >= LZ4HC_CLEVEL_OPT_MIN (v1.8.1, experimental) */
 } LZ4F_preferences_t;
 
 LZ4FLIB_API int LZ4F_compressionLevel_max(void);
@@ -297,7 +308,9 @@ typedef LZ4F_dctx* LZ4F_decompressionContext_t;   /* compatibility with previous
 
 typedef struct {
   unsigned stableDst;    /* pledge that at least 64KB+64Bytes of previously decompressed data remain unmodifed where it was decoded. This optimization skips storage operations in tmp buffers */
-  unsigned reserved[3];  /* must be set to zero for forward compatibility */
+  unsigned directDst;    /* stronger pledge, implies stableDst : in addition, dstBuffer either continues right after previous output, or restarts at the beginning of a ring buffer of size >= 64 KB + maxBlockSize. Linked blocks are then decoded straight into dstBuffer whenever it can receive a full block, and history is never copied */
+  unsigned skipChecksums; /* block and content checksums are not verified. Faster, but corruption may go undetected. Once set, remains active until end of current frame */
+  unsigned reserved[1];  /* must be set to zero for forward compatibility */
 } LZ4F_decompressOptions_t;
 
 
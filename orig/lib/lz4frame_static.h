@@ -80,6 +80,7 @@ extern "C" {
         ITEM(ERROR_headerChecksum_invalid) \
         ITEM(ERROR_contentChecksum_invalid) \
         ITEM(ERROR_frameDecoding_alreadyStarted) \
+        ITEM(ERROR_seekTable_invalid) \
         ITEM(ERROR_maxCode)
 
 #define LZ4F_GENERATE_ENUM(ENUM) LZ4F_##ENUM,
@@ -135,6 +136,38 @@ LZ4FLIB_STATIC_API size_t LZ4F_compressBegin_usingCDict(
     const LZ4F_preferences_t* prefsPtr);
 
 
+/*! LZ4F_setLazyLevel() : v1.8.1 (experimental)
+ *  Fast levels (< LZ4HC_CLEVEL_MIN) of frames started next on `cctx` use lazy matching (LZ4_compress_lazy()) :
+ *  `lazyLevel` 0 : disabled (default) ;
+ *  `lazyLevel` 1 : same table as fast levels : slower, compresses more ;
+ *  `lazyLevel` 2 : adds a table of long matches : slower still, compresses even more.
+ *  HC levels ignore it. It remains set until changed, and doesn't affect a frame already started.
+ *  One-shot LZ4F_compressFrame() and LZ4F_compressFrame_usingCDict() don't use it.
+ *  With a CDict, each independent block starts by copying the dictionary tables : 16 KB, or 32 KB for `lazyLevel` 2.
+ *  A static context needs a workspace sized for level LZ4HC_CLEVEL_MIN (see LZ4F_workspaceSize()).
+ * @return : 0, or an error code (LZ4F_ERROR_compressionLevel_invalid) if `lazyLevel` > 2 */
+LZ4FLIB_STATIC_API LZ4F_errorCode_t LZ4F_setLazyLevel(LZ4F_cctx* cctx, unsigned lazyLevel);
+
+
+/*! LZ4F_compressUpdateV() :
+ *  Compresses a batch of records, with the same result as invoking LZ4F_compressUpdate() on each record in turn.
+ *  Records which don't complete current block are just buffered, with minimal per-record overhead.
+ *  dstCapacity must be >= LZ4F_compressBound(totalSize, prefsPtr), totalSize being the sum of all records' sizes.
+ *  When autoFlush is enabled, each record becomes at least one block : add 8 bytes per record.
+ * @return : number of bytes written into dstBuffer (it can be zero, meaning input data was just buffered),
+ *           or an error code (which can be tested using LZ4F_isError()) */
+typedef struct {
+    const void* base;
+    size_t len;
+} LZ4F_iovec_t;
+
+LZ4FLIB_STATIC_API size_t LZ4F_compressUpdateV(
+    LZ4F_cctx* cctx,
+    void* dstBuffer, size_t dstCapacity,
+    const LZ4F_iovec_t* records, size_t nbRecords,
+    const LZ4F_compressOptions_t* cOptPtr);
+
+
 /*! LZ4F_decompress_usingDict() :
  *  Same as LZ4F_decompress(), using a predefined dictionary.
  *  Dictionary is used "in place", without any preprocessing.
@@ -147,6 +180,194 @@ LZ4FLIB_STATIC_API size_t LZ4F_decompress_usingDict(
     const LZ4F_decompressOptions_t* decompressOptionsPtr);
 
 
+/*! LZ4F_decompressFrame() :
+ *  Decodes one complete frame, entirely present in `src`, directly into `dst`,
+ *  in a single pass, without any decompression context nor heap allocation.
+ *  Block and content checksums, as well as content size, are verified when present.
+ *  `dict` is optional (can be NULL) : it's only needed for frames compressed with a dictionary.
+ *  `dstCapacity` must be large enough to receive the whole decoded frame.
+ *  Only the first frame is decoded : any data after it (such as a seek table) is ignored.
+ *  A skippable frame is simply skipped (returns 0).
+ * @return : nb of bytes decoded into `dst`,
+ *           or an error code (which can be tested using LZ4F_isError()) */
+LZ4FLIB_STATIC_API size_t LZ4F_decompressFrame(
+    void* dst, size_t dstCapacity,
+    const void* src, size_t srcSize,
+    const void* dict, size_t dictSize);
+
+
+/*! LZ4F_decompressFrame_deferredCheck() :
+ *  Same as LZ4F_decompressFrame(), except that content checksum, when present,
+ *  is verified by a background job, while the caller already consumes decoded data.
+ *  Block checksums and content size are still verified before returning.
+ *  On success, `*jobPtr` receives a job handle, or NULL when frame has no content checksum.
+ *  Decoded data must then remain unmodified in `dst` until LZ4F_checksumJob_wait().
+ *  Since a corrupted frame is only detected by LZ4F_checksumJob_wait(),
+ *  decoded data must be treated as unverified until then.
+ *  Without multi-threading support, checksum is calculated within LZ4F_checksumJob_wait().
+ * @return : nb of bytes decoded into `dst`,
+ *           or an error code (which can be tested using LZ4F_isError()) ; `*jobPtr` is then NULL */
+typedef struct LZ4F_checksumJob_s LZ4F_checksumJob;
+LZ4FLIB_STATIC_API size_t LZ4F_decompressFrame_deferredCheck(
+    LZ4F_checksumJob** jobPtr,
+    void* dst, size_t dstCapacity,
+    const void* src, size_t srcSize,
+    const void* dict, size_t dictSize);
+
+/*! LZ4F_checksumJob_wait() :
+ *  Waits for completion of content checksum verification, then releases `job`.
+ *  Accepts NULL (frame without content checksum).
+ * @return : 0 if checksum is valid, or an error code (LZ4F_ERROR_contentChecksum_invalid) */
+LZ4FLIB_STATIC_API size_t LZ4F_checksumJob_wait(LZ4F_checksumJob* job);
+
+
+/*! LZ4F_decompressFrame_parallel() :
+ *  Decodes one complete frame, entirely present in `src` (typically, an in-memory or mmapped file),
+ *  directly into `dst`, using up to `nbThreads` threads (calling thread included).
+ *  Blocks of frames using LZ4F_blockIndependent are decoded concurrently ;
+ *  frames using LZ4F_blockLinked are decoded serially.
+ *  Block and content checksums, as well as content size, are verified when present.
+ *  `dict` is optional (can be NULL) : it's only needed for frames compressed with a dictionary.
+ *  `dstCapacity` must be large enough to receive the whole decoded frame.
+ *  On entry, `*srcSizePtr` is the amount of data available in `src`.
+ *  On exit, `*srcSizePtr` is the size of the frame, so next frame starts at `src + *srcSizePtr`.
+ *  A skippable frame is simply skipped (returns 0).
+ *  `nbThreads<=1`, or a library built without multi-threading support, means serial decoding.
+ *  Threads are started and joined within each invocation :
+ *  to decode many frames, prefer LZ4F_decompressFrame_parallel_usingDCtx().
+ * @return : nb of bytes decoded into `dst`,
+ *           or an error code (which can be tested using LZ4F_isError()) */
+LZ4FLIB_STATIC_API size_t LZ4F_decompressFrame_parallel(
+    void* dst, size_t dstCapacity,
+    const void* src, size_t* srcSizePtr,
+    const void* dict, size_t dictSize,
+    unsigned nbThreads);
+
+/*! LZ4F_decompressFrame_parallel_usingDCtx() :
+ *  Same as LZ4F_decompressFrame_parallel(), but threads are kept within `dctx`,
+ *  and re-used by next invocations requesting the same `nbThreads`.
+ *  They are released by LZ4F_freeDecompressionContext().
+ *  Pool and block descriptors are allocated through `dctx` custom memory functions, if any.
+ *  `dctx` streaming state is neither used nor modified :
+ *  it can be used with LZ4F_decompress() in between, but not concurrently. */
+LZ4FLIB_STATIC_API size_t LZ4F_decompressFrame_parallel_usingDCtx(LZ4F_dctx* dctx,
+    void* dst, size_t dstCapacity,
+    const void* src, size_t* srcSizePtr,
+    const void* dict, size_t dictSize,
+    unsigned nbThreads);
+
+
+/**********************************
+ *  Custom memory
+ *********************************/
+/* Contexts can allocate through user-provided functions, such as arena or pool allocators.
+ * customAlloc() and customFree() must be both set, or both NULL (default allocator).
+ * Memory returned by customAlloc() must be suitably aligned for any type, like malloc().
+ * After the first frame, a context re-uses its buffers :
+ * it only allocates again when a frame requires larger ones (bigger blocks, or higher compression level).
+ * Multi-threading resources (nbWorkers, LZ4F_decompressFrame_parallel_usingDCtx()) use custom functions too,
+ * thread pool included : only thread stacks are allocated by the system. */
+typedef void* (*LZ4F_AllocFunction) (void* opaqueState, size_t size);
+typedef void  (*LZ4F_FreeFunction) (void* opaqueState, void* address);
+typedef struct {
+    LZ4F_AllocFunction customAlloc;
+    LZ4F_FreeFunction customFree;
+    void* opaqueState;
+} LZ4F_CustomMem;
+static
+#ifdef __GNUC__
+__attribute__((__unused__))
+#endif
+LZ4F_CustomMem const LZ4F_defaultCMem = { NULL, NULL, NULL };  /**< this constant defers to stdlib's functions */
+
+/*! LZ4F_createCompressionContext_advanced() :
+ *  Same as LZ4F_createCompressionContext(), all allocations going through `customMem`.
+ * @return : a new context, or NULL on failure. Release it with LZ4F_freeCompressionContext(). */
+LZ4FLIB_STATIC_API LZ4F_cctx* LZ4F_createCompressionContext_advanced(LZ4F_CustomMem customMem, unsigned version);
+
+/*! LZ4F_createDecompressionContext_advanced() :
+ *  Same as LZ4F_createDecompressionContext(), all allocations going through `customMem`.
+ * @return : a new context, or NULL on failure. Release it with LZ4F_freeDecompressionContext(). */
+LZ4FLIB_STATIC_API LZ4F_dctx* LZ4F_createDecompressionContext_advanced(LZ4F_CustomMem customMem, unsigned version);
+
+/*! LZ4F_workspaceSize() :
+ *  Size of a workspace able to host either a compression or a decompression context,
+ *  with all its buffers, for frames using preferences `prefsPtr` (NULL means defaults).
+ *  A workspace sized for some preferences can also serve frames using smaller blocks or lower levels.
+ *  Not included : nbWorkers, seekTable, LZ4F_setLazyLevel().
+ * @return : workspace size, or an error code (which can be tested using LZ4F_isError()) */
+LZ4FLIB_STATIC_API size_t LZ4F_workspaceSize(const LZ4F_preferences_t* prefsPtr);
+
+/*! LZ4F_initStaticCCtx(), LZ4F_initStaticDCtx() :
+ *  Create a context within caller-provided `workspace`, which must be 8-bytes aligned.
+ *  The context never invokes any allocator : when workspace is too small, operations fail
+ *  with LZ4F_ERROR_allocation_failed.
+ *  Such a context can't start threads : LZ4F_compressBegin() with nbWorkers >= 2, and
+ *  LZ4F_decompressFrame_parallel_usingDCtx() with nbThreads >= 2 on independent blocks,
+ *  fail with LZ4F_ERROR_allocation_failed.
+ *  The workspace must outlive the context ; it can host only one context at a time.
+ *  Freeing such a context is optional, and doesn't release the workspace.
+ * @return : context, or NULL if `workspace` is NULL, misaligned or too small. */
+LZ4FLIB_STATIC_API LZ4F_cctx* LZ4F_initStaticCCtx(void* workspace, size_t workspaceSize);
+LZ4FLIB_STATIC_API LZ4F_dctx* LZ4F_initStaticDCtx(void* workspace, size_t workspaceSize);
+
+
+/**********************************
+ *  Random access
+ *********************************/
+/* When `preferences.seekTable` is set, LZ4F_compressEnd() appends a seek table after the frame.
+ * The seek table is a skippable frame, so it is transparently ignored by regular decoders.
+ * Layout (all fields little-endian) :
+ *   magic number   : 4 bytes, LZ4F_SEEKTABLE_MAGIC (a skippable frame magic number)
+ *   frame size     : 4 bytes, size of following content == 8 * nbBlocks + 8
+ *   entries        : 8 bytes per block, in order :
+ *                    compressed size (block header and checksum included), then decompressed size
+ *   nbBlocks       : 4 bytes
+ *   footer magic   : 4 bytes, LZ4F_SEEKTABLE_FOOTER_MAGIC
+ * The table can be found by reading the end of the compressed stream.
+ * Random access requires LZ4F_blockIndependent : LZ4F_compressBegin() fails with linked blocks. */
+#define LZ4F_SEEKTABLE_MAGIC         0x184D2A5EU
+#define LZ4F_SEEKTABLE_FOOTER_MAGIC  0x4C5A3453U   /* "S4ZL" */
+#define LZ4F_SEEKTABLE_SIZE(nbBlocks) (16 + 8 * (size_t)(nbBlocks))
+
+/*! LZ4F_seekTableSize() :
+ *  Size of the seek table which would be appended by LZ4F_compressEnd() at this point,
+ *  or 0 when `preferences.seekTable` is not set.
+ *  When a seek table is requested, LZ4F_compressEnd() requires
+ *  dstCapacity >= LZ4F_compressBound(0, prefsPtr) + LZ4F_seekTableSize(cctx).
+ *  Note : LZ4F_compressFrameBound() already includes the seek table. */
+LZ4FLIB_STATIC_API size_t LZ4F_seekTableSize(const LZ4F_cctx* cctx);
+
+typedef struct LZ4F_seekable_s LZ4F_seekable;
+
+/*! LZ4F_seekableOpen() :
+ *  Prepares random access into a frame followed by its seek table,
+ *  entirely present in `src` (typically, an in-memory or mmapped file).
+ *  `src` must start with the frame, and end with the seek table.
+ *  The seek table is checked against block headers.
+ *  `src` and `dict` (optional, can be NULL) are referenced, not copied :
+ *  they must remain accessible and unmodified until LZ4F_seekableClose().
+ * @return : 0 on success, `*sPtr` is then a valid LZ4F_seekable object,
+ *           or an error code (which can be tested using LZ4F_isError()) */
+LZ4FLIB_STATIC_API size_t LZ4F_seekableOpen(LZ4F_seekable** sPtr,
+                                            const void* src, size_t srcSize,
+                                            const void* dict, size_t dictSize);
+LZ4FLIB_STATIC_API void   LZ4F_seekableClose(LZ4F_seekable* s);
+
+/*! LZ4F_seekableContentSize() :
+ * @return : total decompressed size of the frame */
+LZ4FLIB_STATIC_API unsigned long long LZ4F_seekableContentSize(const LZ4F_seekable* s);
+
+/*! LZ4F_readAt() :
+ *  Decodes `size` bytes of original content, starting at position `offset`, into `dst`.
+ *  Only blocks overlapping requested range are decoded.
+ *  The last partially read block is kept cached, so that sequential small reads remain cheap.
+ *  Block checksums are verified when present ; content checksum is not.
+ * @return : nb of bytes written into `dst`, which is < `size` only when reaching end of content,
+ *           or an error code (which can be tested using LZ4F_isError()) */
+LZ4FLIB_STATIC_API size_t LZ4F_readAt(LZ4F_seekable* s, void* dst, size_t size, unsigned long long offset);
+
+
 #if defined (__cplusplus)
 }
 #endif
@@ -83,16 +83,44 @@ static U32 LZ4HC_hashPtr(const void* ptr) { return HASH_FUNCTION(LZ4_read32(ptr)
 /**************************************
 *  HC Compression
 **************************************/
-static void LZ4HC_init (LZ4HC_CCtx_internal* hc4, const BYTE* start)
+static void LZ4HC_clearTables (LZ4HC_CCtx_internal* hc4)
 {
     MEM_INIT((void*)hc4->hashTable, 0, sizeof(hc4->hashTable));
     MEM_INIT(hc4->chainTable, 0xFF, sizeof(hc4->chainTable));
+}
+
+static void LZ4HC_init (LZ4HC_CCtx_internal* hc4, const BYTE* start)
+{
+    LZ4HC_clearTables(hc4);
     hc4->nextToUpdate = 64 KB;
     hc4->base = start - 64 KB;
     hc4->end = start;
     hc4->dictBase = start - 64 KB;
     hc4->dictLimit = 64 KB;
     hc4->lowLimit = 64 KB;
+    hc4->dictCtx = NULL;
+}
+
+/* LZ4HC_newSegment() :
+ * starts a new segment at `start`, without wiping tables.
+ * Indexes resume 64 KB beyond the end of previous segment :
+ * any entry left in tables is then further than MAX_DISTANCE from any new position,
+ * which makes it behave exactly like an empty entry (0), and output identical to LZ4HC_init().
+ * Tables are only wiped when indexes grow too large.
+ * Requires tables to be valid, i.e. `hc4` was initialized at least once. */
+static void LZ4HC_newSegment (LZ4HC_CCtx_internal* hc4, const BYTE* start)
+{
+    U32 startIndex = (U32)(hc4->end - hc4->base) + 64 KB;
+    if (startIndex > 1 GB) {
+        LZ4HC_clearTables(hc4);
+        startIndex = 64 KB;
+    }
+    hc4->nextToUpdate = startIndex;
+    hc4->base = start - startIndex;
+    hc4->end = start;
+    hc4->dictBase = hc4->base;
+    hc4->dictLimit = startIndex;
+    hc4->lowLimit = startIndex;
 }
 
 
@@ -293,6 +321,39 @@ LZ4_FORCE_INLINE int LZ4HC_InsertAndGetWiderMatch (
         }   }   }   }
     }  /* while ((matchIndex>=lowLimit) && (nbAttempts)) */
 
+    if ( (hc4->dictCtx != NULL)
+      && (nbAttempts)
+      && ((U32)(ip-base) - hc4->lowLimit < MAX_DISTANCE) ) {
+        /* attached dictionary : its content virtually ends at hc4->lowLimit */
+        const LZ4HC_CCtx_internal* const dictCtx = hc4->dictCtx;
+        U32 const ipIndex = (U32)(ip - base);
+        U32 const dictEndIndex = (U32)(dictCtx->end - dictCtx->base);
+        U32 dictMatchIndex = dictCtx->hashTable[LZ4HC_hashPtr(ip)];
+        DEBUGLOG(7, "First dictionary match at index %u / %u (dictEnd)",
+                    dictMatchIndex, dictEndIndex);
+        while ( ((ipIndex - hc4->lowLimit) + (dictEndIndex - dictMatchIndex) <= MAX_DISTANCE)
+             && (nbAttempts--) ) {
+            const BYTE* const matchPtr = dictCtx->base + dictMatchIndex;
+            if (LZ4_read32(matchPtr) == pattern) {
+                int mlt;
+                int back;
+                const BYTE* vLimit = ip + (dictEndIndex - dictMatchIndex);
+                if (vLimit > iHighLimit) vLimit = iHighLimit;
+                mlt = LZ4_count(ip+MINMATCH, matchPtr+MINMATCH, vLimit) + MINMATCH;
+                if ((ip+mlt == vLimit) && (vLimit < iHighLimit) && (hc4->lowLimit == dictLimit))
+                    mlt += LZ4_count(ip+mlt, base+dictLimit, iHighLimit);
+                back = LZ4HC_countBack(ip, matchPtr, iLowLimit, dictCtx->base + dictCtx->dictLimit);
+                mlt -= back;
+                if (mlt > longest) {
+                    U32 const virtualIndex = dictMatchIndex + hc4->lowLimit - dictEndIndex;
+                    longest = mlt;
+                    *matchpos = base + virtualIndex + back;
+                    *startpos = ip + back;
+            }   }
+            dictMatchIndex -= DELTANEXTU16(dictCtx->chainTable, dictMatchIndex);
+        }
+    }
+
     return longest;
 }
 
@@ -613,22 +674,15 @@ _dest_overflow:
 }
 
 
-static int LZ4HC_compress_generic (
-    LZ4HC_CCtx_internal* const ctx,
-    const char* const src,
-    char* const dst,
-    int* const srcSizePtr,
-    int const dstCapacity,
-    int cLevel,
-    limitedOutput_directive limit
-    )
+typedef enum { lz4hc, lz4opt, lz4optbt } lz4hc_strat_e;
+typedef struct {
+    lz4hc_strat_e strat;
+    U32 nbSearches;
+    U32 targetLength;
+} cParams_t;
+
+static cParams_t LZ4HC_getCLevelParams(int cLevel)
 {
-    typedef enum { lz4hc, lz4opt } lz4hc_strat_e;
-    typedef struct {
-        lz4hc_strat_e strat;
-        U32 nbSearches;
-        U32 targetLength;
-    } cParams_t;
     static const cParams_t clTable[LZ4HC_CLEVEL_MAX+1] = {
         { lz4hc,    2, 16 },  /* 0, unused */
         { lz4hc,    2, 16 },  /* 1, unused */
@@ -641,28 +695,62 @@ static int LZ4HC_compress_generic (
         { lz4hc,  128, 16 },  /* 8 */
         { lz4hc,  256, 16 },  /* 9 */
         { lz4opt,  96, 64 },  /*10==LZ4HC_CLEVEL_OPT_MIN*/
-        { lz4opt, 512,128 },  /*11 */
-        { lz4opt,8192, LZ4_OPT_NUM },  /* 12==LZ4HC_CLEVEL_MAX */
+        { lz4optbt, 512,128 },  /*11 */
+        { lz4optbt,8192, LZ4_OPT_NUM },  /* 12==LZ4HC_CLEVEL_MAX */
     };
+    if (cLevel < 1) cLevel = LZ4HC_CLEVEL_DEFAULT;   /* note : convention is different from lz4frame, maybe something to review */
+    cLevel = MIN(LZ4HC_CLEVEL_MAX, cLevel);
+    assert(cLevel >= 0);
+    assert(cLevel <= LZ4HC_CLEVEL_MAX);
+    return clTable[cLevel];
+}
+
+static int LZ4HC_compress_generic (
+    LZ4HC_CCtx_internal* const ctx,
+    const char* const src,
+    char* const dst,
+    int* const srcSizePtr,
+    int const dstCapacity,
+    int cLevel,
+    limitedOutput_directive limit
+    )
+{
+    cParams_t const cParam = LZ4HC_getCLevelParams(cLevel);
 
     if (limit == limitedDestSize && dstCapacity < 1) return 0;         /* Impossible to store anything */
     if ((U32)*srcSizePtr > (U32)LZ4_MAX_INPUT_SIZE) return 0;          /* Unsupported input size (too large or negative) */
 
     ctx->end += *srcSizePtr;
-    if (cLevel < 1) cLevel = LZ4HC_CLEVEL_DEFAULT;   /* note : convention is different from lz4frame, maybe something to review */
-    cLevel = MIN(LZ4HC_CLEVEL_MAX, cLevel);
-    assert(cLevel >= 0);
-    assert(cLevel <= LZ4HC_CLEVEL_MAX);
-    {   cParams_t const cParam = clTable[cLevel];
-        if (cParam.strat == lz4hc)
-            return LZ4HC_compress_hashChain(ctx,
-                                src, dst, srcSizePtr, dstCapacity,
-                                cParam.nbSearches, limit);
-        assert(cParam.strat == lz4opt);
-        return LZ4HC_compress_optimal(ctx,
+    if (cParam.strat == lz4hc)
+        return LZ4HC_compress_hashChain(ctx,
                             src, dst, srcSizePtr, dstCapacity,
-                            cParam.nbSearches, cParam.targetLength, limit,
-                            cLevel == LZ4HC_CLEVEL_MAX);  /* ultra mode */
+                            cParam.nbSearches, limit);
+    assert(cParam.strat == lz4opt || cParam.strat == lz4optbt);
+    /* workspace : lent by LZ4_setWorkspaceHC(), or allocated for this call only */
+    {   LZ4HC_optWorkspace_t* const wksp = (LZ4HC_optWorkspace_t*)ctx->workspace;
+        int const useBT = (cParam.strat == lz4optbt) && (ctx->dictCtx == NULL);
+        LZ4HC_optimal_t* const opt = (ctx->workspaceSize >= sizeof(LZ4HC_optimal_t)) ?
+                                     &wksp->opt : (LZ4HC_optimal_t*)malloc(sizeof(LZ4HC_optimal_t));
+        LZ4HC_BT_t* bt = NULL;   /* NULL : hash chain */
+        int cSize = 0;
+        if (useBT && (ctx->workspaceSize >= sizeof(LZ4HC_optWorkspace_t))) {
+            bt = &wksp->bt;   /* may continue trees of previous call */
+        } else if (useBT) {
+            bt = (LZ4HC_BT_t*)malloc(sizeof(LZ4HC_BT_t));
+            if (bt != NULL) bt->owner = NULL;
+        }
+        if (bt != NULL) LZ4HC_BT_init(bt, ctx, (const BYTE*)src);
+        /* allocation failure : fail, rather than produce a different output with another match finder */
+        if ((opt != NULL) && (useBT == (bt != NULL)))
+            cSize = LZ4HC_compress_optimal(ctx,
+                                src, dst, srcSizePtr, dstCapacity,
+                                cParam.nbSearches, cParam.targetLength, limit,
+                                cParam.targetLength == LZ4_OPT_NUM,   /* ultra mode */
+                                opt, bt, ctx->favorDecSpeed);
+        if (bt != NULL) LZ4HC_BT_save(bt, ctx);
+        if ((wksp == NULL) || (opt != &wksp->opt)) free(opt);
+        if ((wksp == NULL) || (bt != &wksp->bt)) free(bt);
+        return cSize;
     }
 }
 
@@ -674,6 +762,25 @@ int LZ4_compress_HC_extStateHC (void* state, const char* src, char* dst, int src
     LZ4HC_CCtx_internal* const ctx = &((LZ4_streamHC_t*)state)->internal_donotuse;
     if (((size_t)(state)&(sizeof(void*)-1)) != 0) return 0;   /* Error : state is not aligned for pointers (32 or 64 bits) */
     LZ4HC_init (ctx, (const BYTE*)src);
+    ctx->favorDecSpeed = 0;
+    ctx->workspace = NULL;
+    ctx->workspaceSize = 0;
+    if (dstCapacity < LZ4_compressBound(srcSize))
+        return LZ4HC_compress_generic (ctx, src, dst, &srcSize, dstCapacity, compressionLevel, limitedOutput);
+    else
+        return LZ4HC_compress_generic (ctx, src, dst, &srcSize, dstCapacity, compressionLevel, noLimit);
+}
+
+int LZ4_compress_HC_extStateHC_fastReset (void* state, const char* src, char* dst, int srcSize, int dstCapacity, int compressionLevel)
+{
+    LZ4HC_CCtx_internal* const ctx = &((LZ4_streamHC_t*)state)->internal_donotuse;
+    if (((size_t)(state)&(sizeof(void*)-1)) != 0) return 0;   /* Error : state is not aligned for pointers (32 or 64 bits) */
+    if (ctx->base == NULL) {
+        LZ4HC_init (ctx, (const BYTE*)src);
+    } else {
+        LZ4HC_newSegment (ctx, (const BYTE*)src);
+        ctx->dictCtx = NULL;
+    }
     if (dstCapacity < LZ4_compressBound(srcSize))
         return LZ4HC_compress_generic (ctx, src, dst, &srcSize, dstCapacity, compressionLevel, limitedOutput);
     else
@@ -701,6 +808,9 @@ int LZ4_compress_HC_destSize(void* LZ4HC_Data, const char* source, char* dest, i
 {
     LZ4HC_CCtx_internal* const ctx = &((LZ4_streamHC_t*)LZ4HC_Data)->internal_donotuse;
     LZ4HC_init(ctx, (const BYTE*) source);
+    ctx->favorDecSpeed = 0;
+    ctx->workspace = NULL;
+    ctx->workspaceSize = 0;
     return LZ4HC_compress_generic(ctx, source, dest, sourceSizePtr, targetDestSize, cLevel, limitedDestSize);
 }
 
@@ -723,6 +833,19 @@ void LZ4_resetStreamHC (LZ4_streamHC_t* LZ4_streamHCPtr, int compressionLevel)
 {
     LZ4_STATIC_ASSERT(sizeof(LZ4HC_CCtx_internal) <= sizeof(size_t) * LZ4_STREAMHCSIZE_SIZET);   /* if compilation fails here, LZ4_STREAMHCSIZE must be increased */
     LZ4_streamHCPtr->internal_donotuse.base = NULL;
+    LZ4_streamHCPtr->internal_donotuse.dictCtx = NULL;
+    LZ4_streamHCPtr->internal_donotuse.favorDecSpeed = 0;
+    LZ4_streamHCPtr->internal_donotuse.workspace = NULL;
+    LZ4_streamHCPtr->internal_donotuse.workspaceSize = 0;
+    LZ4_setCompressionLevel(LZ4_streamHCPtr, compressionLevel);
+}
+
+void LZ4_resetStreamHC_fast (LZ4_streamHC_t* LZ4_streamHCPtr, int compressionLevel)
+{
+    LZ4HC_CCtx_internal* const ctxPtr = &LZ4_streamHCPtr->internal_donotuse;
+    /* next block is either contiguous to new segment, or becomes its own segment (empty extDict) */
+    if (ctxPtr->base != NULL) LZ4HC_newSegment(ctxPtr, ctxPtr->end);
+    ctxPtr->dictCtx = NULL;
     LZ4_setCompressionLevel(LZ4_streamHCPtr, compressionLevel);
 }
 
@@ -730,7 +853,43 @@ void LZ4_setCompressionLevel(LZ4_streamHC_t* LZ4_streamHCPtr, int compressionLev
 {
     if (compressionLevel < 1) compressionLevel = 1;
     if (compressionLevel > LZ4HC_CLEVEL_MAX) compressionLevel = LZ4HC_CLEVEL_MAX;
-    LZ4_streamHCPtr->internal_donotuse.compressionLevel = compressionLevel;
+    LZ4_streamHCPtr->internal_donotuse.compressionLevel = (short)compressionLevel;
+}
+
+void LZ4_favorDecompressionSpeed(LZ4_streamHC_t* LZ4_streamHCPtr, int favor)
+{
+    LZ4_streamHCPtr->internal_donotuse.favorDecSpeed = (favor != 0);
+}
+
+int LZ4_sizeofWorkspaceHC(int compressionLevel)
+{
+    switch (LZ4HC_getCLevelParams(compressionLevel).strat) {
+    case lz4hc :    return 0;
+    case lz4opt :   return (int)sizeof(LZ4HC_optimal_t);
+    case lz4optbt : return (int)sizeof(LZ4HC_optWorkspace_t);
+    default :       return 0;
+    }
+}
+
+void LZ4_setWorkspaceHC(LZ4_streamHC_t* LZ4_streamHCPtr, void* workspace, size_t workspaceSize)
+{
+    LZ4HC_CCtx_internal* const ctxPtr = &LZ4_streamHCPtr->internal_donotuse;
+    if ( (workspace == NULL)
+      || (((size_t)workspace & (sizeof(U32)-1)) != 0)    /* not aligned for U32 */
+      || (workspaceSize > 0xFFFFFFFFU) ) workspaceSize = 0;
+    ctxPtr->workspace = workspaceSize ? workspace : NULL;
+    ctxPtr->workspaceSize = (unsigned)workspaceSize;
+    LZ4HC_BT_invalidate(ctxPtr);
+}
+
+void LZ4_attach_HC_dictionary(LZ4_streamHC_t* working_stream, const LZ4_streamHC_t* dictionary_stream)
+{
+    LZ4HC_CCtx_internal* const ctxPtr = &working_stream->internal_donotuse;
+    if (ctxPtr->base != NULL) {
+        /* start a new segment after current one : tables don't need to be cleaned */
+        LZ4HC_newSegment(ctxPtr, ctxPtr->end);
+    }   /* else : stream will be initialized on first use, keeping dictCtx */
+    ctxPtr->dictCtx = (dictionary_stream != NULL) ? &dictionary_stream->internal_donotuse : NULL;
 }
 
 int LZ4_loadDictHC (LZ4_streamHC_t* LZ4_streamHCPtr, const char* dictionary, int dictSize)
@@ -741,6 +900,7 @@ int LZ4_loadDictHC (LZ4_streamHC_t* LZ4_streamHCPtr, const char* dictionary, int
         dictSize = 64 KB;
     }
     LZ4HC_init (ctxPtr, (const BYTE*)dictionary);
+    LZ4HC_BT_invalidate(ctxPtr);   /* new index space, which may coincide with previous one */
     ctxPtr->end = (const BYTE*)dictionary + dictSize;
     if (dictSize >= 4) LZ4HC_Insert (ctxPtr, ctxPtr->end-3);
     return dictSize;
@@ -751,7 +911,13 @@ int LZ4_loadDictHC (LZ4_streamHC_t* LZ4_streamHCPtr, const char* dictionary, int
 
 static void LZ4HC_setExternalDict(LZ4HC_CCtx_internal* ctxPtr, const BYTE* newBlock)
 {
-    if (ctxPtr->end >= ctxPtr->base + 4) LZ4HC_Insert (ctxPtr, ctxPtr->end-3);   /* Referencing remaining dictionary content */
+    if (ctxPtr->lowLimit != ctxPtr->dictLimit) ctxPtr->dictCtx = NULL;   /* attached dictionary no longer contiguous */
+
+    /* Referencing remaining dictionary content, unless next block uses binary trees, which don't read chains.
+     * Chains then miss this dictionary : should a later block use them, it would just find fewer matches. */
+    if ( (ctxPtr->end >= ctxPtr->base + 4)
+      && ((LZ4HC_getCLevelParams(ctxPtr->compressionLevel).strat != lz4optbt) || (ctxPtr->dictCtx != NULL)) )
+        LZ4HC_Insert (ctxPtr, ctxPtr->end-3);
 
     /* Only one memory segment for extDict, so any previous extDict is lost at this stage */
     ctxPtr->lowLimit  = ctxPtr->dictLimit;
@@ -769,7 +935,11 @@ static int LZ4_compressHC_continue_generic (LZ4_streamHC_t* LZ4_streamHCPtr,
 {
     LZ4HC_CCtx_internal* const ctxPtr = &LZ4_streamHCPtr->internal_donotuse;
     /* auto-init if forgotten */
-    if (ctxPtr->base == NULL) LZ4HC_init (ctxPtr, (const BYTE*) src);
+    if (ctxPtr->base == NULL) {
+        const LZ4HC_CCtx_internal* const dictCtx = ctxPtr->dictCtx;   /* preserve attached dictionary */
+        LZ4HC_init (ctxPtr, (const BYTE*) src);
+        ctxPtr->dictCtx = dictCtx;
+    }
 
     /* Check overflow */
     if ((size_t)(ctxPtr->end - ctxPtr->base) > 2 GB) {
@@ -786,9 +956,11 @@ static int LZ4_compressHC_continue_generic (LZ4_streamHC_t* LZ4_streamHCPtr,
         const BYTE* const dictBegin = ctxPtr->dictBase + ctxPtr->lowLimit;
         const BYTE* const dictEnd   = ctxPtr->dictBase + ctxPtr->dictLimit;
         if ((sourceEnd > dictBegin) && ((const BYTE*)src < dictEnd)) {
+            U32 const oldLowLimit = ctxPtr->lowLimit;
             if (sourceEnd > dictEnd) sourceEnd = dictEnd;
             ctxPtr->lowLimit = (U32)(sourceEnd - ctxPtr->dictBase);
             if (ctxPtr->dictLimit - ctxPtr->lowLimit < 4) ctxPtr->lowLimit = ctxPtr->dictLimit;
+            if (ctxPtr->lowLimit != oldLowLimit) ctxPtr->dictCtx = NULL;   /* attached dictionary no longer contiguous */
         }
     }
 
@@ -824,6 +996,7 @@ int LZ4_saveDictHC (LZ4_streamHC_t* LZ4_streamHCPtr, char* safeBuffer, int dictS
         streamPtr->end = (const BYTE*)safeBuffer + dictSize;
         streamPtr->base = streamPtr->end - endIndex;
         streamPtr->dictLimit = endIndex - dictSize;
+        if (streamPtr->lowLimit != endIndex - dictSize) streamPtr->dictCtx = NULL;
         streamPtr->lowLimit = endIndex - dictSize;
         if (streamPtr->nextToUpdate < streamPtr->dictLimit) streamPtr->nextToUpdate = streamPtr->dictLimit;
     }
@@ -857,6 +1030,9 @@ int LZ4_resetStreamStateHC(void* state, char* inputBuffer)
     if ((((size_t)state) & (sizeof(void*)-1)) != 0) return 1;   /* Error : pointer is not aligned for pointer (32 or 64 bits) */
     LZ4HC_init(ctx, (const BYTE*)inputBuffer);
     ctx->inputBuffer = (BYTE*)inputBuffer;
+    ctx->favorDecSpeed = 0;
+    ctx->workspace = NULL;
+    ctx->workspaceSize = 0;
     return 0;
 }
 
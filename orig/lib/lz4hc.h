@@ -62,6 +62,8 @@ extern "C" {
  *                      Values > LZ4HC_CLEVEL_MAX behave the same as LZ4HC_CLEVEL_MAX.
  * @return : the number of bytes written into 'dst'
  *           or 0 if compression fails.
+ *  Note : levels >= LZ4HC_CLEVEL_OPT_MIN allocate their workspace at each call (see LZ4_setWorkspaceHC()) :
+ *         they also return 0 when this allocation fails.
  */
 LZ4LIB_API int LZ4_compress_HC (const char* src, char* dst, int srcSize, int dstCapacity, int compressionLevel);
 
@@ -141,7 +143,8 @@ LZ4LIB_API int LZ4_saveDictHC (LZ4_streamHC_t* streamHCPtr, char* safeBuffer, in
 #if defined(__cplusplus) || (defined (__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) /* C99 */)
 #include <stdint.h>
 
-typedef struct
+typedef struct LZ4HC_CCtx_internal LZ4HC_CCtx_internal;
+struct LZ4HC_CCtx_internal
 {
     uint32_t   hashTable[LZ4HC_HASHTABLESIZE];
     uint16_t   chainTable[LZ4HC_MAXD];
@@ -152,12 +155,17 @@ typedef struct
     uint32_t   dictLimit;       /* below that point, need extDict */
     uint32_t   lowLimit;        /* below that point, no more dict */
     uint32_t   nextToUpdate;    /* index from which to continue dictionary update */
-    int        compressionLevel;
-} LZ4HC_CCtx_internal;
+    short      compressionLevel;
+    short      favorDecSpeed;   /* 1 : optimal parser trades a little ratio for faster decompression */
+    const LZ4HC_CCtx_internal* dictCtx;   /* attached dictionary, virtually ending at lowLimit */
+    void*      workspace;       /* optimal parser state, lent by LZ4_setWorkspaceHC() */
+    uint32_t   workspaceSize;
+};
 
 #else
 
-typedef struct
+typedef struct LZ4HC_CCtx_internal LZ4HC_CCtx_internal;
+struct LZ4HC_CCtx_internal
 {
     unsigned int   hashTable[LZ4HC_HASHTABLESIZE];
     unsigned short chainTable[LZ4HC_MAXD];
@@ -168,12 +176,16 @@ typedef struct
     unsigned int   dictLimit;        /* below that point, need extDict */
     unsigned int   lowLimit;         /* below that point, no more dict */
     unsigned int   nextToUpdate;     /* index from which to continue dictionary update */
-    int            compressionLevel;
-} LZ4HC_CCtx_internal;
+    short          compressionLevel;
+    short          favorDecSpeed;    /* 1 : optimal parser trades a little ratio for faster decompression */
+    const LZ4HC_CCtx_internal* dictCtx;   /* attached dictionary, virtually ending at lowLimit */
+    void*          workspace;        /* optimal parser state, lent by LZ4_setWorkspaceHC() */
+    unsigned int   workspaceSize;
+};
 
 #endif
 
-#define LZ4_STREAMHCSIZE       (4*LZ4HC_HASHTABLESIZE + 2*LZ4HC_MAXD + 56) /* 262200 */
+#define LZ4_STREAMHCSIZE       (4*LZ4HC_HASHTABLESIZE + 2*LZ4HC_MAXD + 72) /* 262216 */
 #define LZ4_STREAMHCSIZE_SIZET (LZ4_STREAMHCSIZE / sizeof(size_t))
 union LZ4_streamHC_u {
     size_t table[LZ4_STREAMHCSIZE_SIZET];
@@ -266,6 +278,62 @@ int LZ4_compress_HC_continue_destSize(LZ4_streamHC_t* LZ4_streamHCPtr,
  */
 void LZ4_setCompressionLevel(LZ4_streamHC_t* LZ4_streamHCPtr, int compressionLevel);
 
+/*! LZ4_favorDecompressionSpeed() : v1.8.1 (experimental)
+ *  `favor`==1 makes the optimal parser (levels >= LZ4HC_CLEVEL_OPT_MIN) account for decoding cost :
+ *  it avoids very short matches and offsets < 8, which are slower to decode,
+ *  at the cost of a slightly lower compression ratio. Output remains a regular LZ4 block.
+ *  Has no effect on lower levels. Disabled by LZ4_resetStreamHC(), preserved by LZ4_resetStreamHC_fast().
+ *  One-shot functions (LZ4_compress_HC_extStateHC(), LZ4_compress_HC_destSize()) always disable it.
+ */
+void LZ4_favorDecompressionSpeed(LZ4_streamHC_t* LZ4_streamHCPtr, int favor);
+
+/*! LZ4_sizeofWorkspaceHC() : v1.8.1 (experimental)
+ *  @return : workspace size needed by the optimal parser at `compressionLevel`,
+ *            or 0 for levels which don't need any (< LZ4HC_CLEVEL_OPT_MIN).
+ */
+int LZ4_sizeofWorkspaceHC(int compressionLevel);
+
+/*! LZ4_setWorkspaceHC() : v1.8.1 (experimental)
+ *  By default, the optimal parser allocates its workspace (~450 KB at levels 11-12)
+ *  at each compression call, and releases it before returning.
+ *  This function lends `workspace` to the stream instead, so that no allocation happens during compression.
+ *  `workspace` must be 4-bytes aligned, and remain valid, and not shared with another stream, while in use.
+ *  When `workspaceSize` < LZ4_sizeofWorkspaceHC(compressionLevel), per-call allocation is used anyway.
+ *  When per-call allocation fails, compression fails (returns 0) : output never depends on available memory.
+ *  `workspace==NULL` restores per-call allocation. Workspace content does not need initialization.
+ *  Like LZ4_favorDecompressionSpeed(), it's cleared by LZ4_resetStreamHC() and one-shot functions,
+ *  and preserved by LZ4_resetStreamHC_fast() and LZ4_compress_HC_extStateHC_fastReset().
+ */
+void LZ4_setWorkspaceHC(LZ4_streamHC_t* LZ4_streamHCPtr, void* workspace, size_t workspaceSize);
+
+/*! LZ4_compress_HC_extStateHC_fastReset() : v1.8.1 (experimental)
+ *  Same as LZ4_compress_HC_extStateHC(), but does not wipe `state` tables before each call.
+ *  Instead, each call starts a new segment beyond the reach of entries left by previous calls,
+ *  so that these entries are ignored. Tables are only wiped once every 1 GB of input.
+ *  This is much faster when compressing many small inputs with the same `state`.
+ *  Result is byte-identical to LZ4_compress_HC_extStateHC(), unless LZ4_favorDecompressionSpeed() is set on `state`, which is preserved.
+ *  `state` must have been initialized once, using LZ4_resetStreamHC() or LZ4_compress_HC_extStateHC().
+ */
+int LZ4_compress_HC_extStateHC_fastReset (void* state, const char* src, char* dst, int srcSize, int dstCapacity, int compressionLevel);
+
+/*! LZ4_resetStreamHC_fast() : v1.8.1 (experimental)
+ *  Same as LZ4_resetStreamHC(), but tables are not wiped, for the same reason as above.
+ *  Next block is compressed exactly as if the stream had been reset with LZ4_resetStreamHC().
+ *  `LZ4_streamHCPtr` must have been initialized once, using LZ4_resetStreamHC().
+ */
+void LZ4_resetStreamHC_fast(LZ4_streamHC_t* LZ4_streamHCPtr, int compressionLevel);
+
+/*! LZ4_attach_HC_dictionary() : v1.8.1 (experimental)
+ *  Makes `working_stream` use `dictionary_stream` as its dictionary, by reference :
+ *  contrary to LZ4_loadDictHC() or a copy of a pre-loaded state, no table is copied,
+ *  matches into the dictionary are searched directly within `dictionary_stream`'s tables.
+ *  `dictionary_stream` must have been prepared with LZ4_loadDictHC() only,
+ *  and must remain unmodified and valid for as long as `working_stream` uses it.
+ *  The attachment ends at the next reset, or once the dictionary falls out of the 64 KB window.
+ *  Passing NULL detaches any dictionary.
+ */
+void LZ4_attach_HC_dictionary(LZ4_streamHC_t* working_stream, const LZ4_streamHC_t* dictionary_stream);
+
 
 
 #endif   /* LZ4_HC_SLO_098092834 */
@@ -34,12 +34,15 @@
 */
 
 #define LZ4_OPT_NUM   (1<<12)
+#define TRAILING_LITERALS 3
 
+/* parser state, one entry per position.
+ * Stored as separate arrays : most loops only scan prices. */
 typedef struct {
-    int price;
-    int off;
-    int mlen;
-    int litlen;
+    int price[LZ4_OPT_NUM + TRAILING_LITERALS];
+    int mlen[LZ4_OPT_NUM + TRAILING_LITERALS];     /* 1 : literal */
+    int litlen[LZ4_OPT_NUM + TRAILING_LITERALS];
+    U16 off[LZ4_OPT_NUM + TRAILING_LITERALS];
 } LZ4HC_optimal_t;
 
 
@@ -67,6 +70,18 @@ LZ4_FORCE_INLINE int LZ4HC_sequencePrice(int litlen, int mlen)
 }
 
 
+/* decoding cost of a sequence, in bytes, only used when favoring decompression speed.
+ * LZ4_decompress_generic() decodes most sequences through a shortcut :
+ * <= 14 literals and a match of <= 18 bytes at offset >= 8 are copied with a few fixed-size copies.
+ * Any other sequence takes the generic path, with length loops and overlap handling. */
+LZ4_FORCE_INLINE int LZ4HC_decodePrice(int litlen, int mlen, int off)
+{
+    if ((litlen >= (int)RUN_MASK) || (mlen > (int)(ML_MASK-1+MINMATCH)) || (off < 8))
+        return 2;
+    return 0;
+}
+
+
 /*-*************************************
 *  Match finder
 ***************************************/
@@ -75,23 +90,194 @@ typedef struct {
     int len;
 } LZ4HC_match_t;
 
+/* Binary tree match finder :
+ * each position is inserted into a binary tree sorted by suffix, rooted at its hash bucket.
+ * A single descent both inserts current position and finds its longest match :
+ * every compared candidate narrows the search towards longer common prefixes,
+ * instead of testing all candidates of a hash chain one after the other.
+ * Since all offsets cost the same in LZ4, only the longest match is kept.
+ * Nodes store distances to their children (0 == none), indexed like chainTable,
+ * so trees only span the last 64 KB, which is also the maximum offset.
+ * Trees are kept across calls of a stream within a lent workspace, and rebuilt from history otherwise.
+ * chainTable is not maintained meanwhile : LZ4HC_Insert() catches up whenever the hash chain is used again,
+ * except for history moved into extDict (see LZ4HC_setExternalDict()). */
+#define LZ4HC_BT_LOG  16
+#define LZ4HC_BT_SIZE (1 << LZ4HC_BT_LOG)
+#define LZ4HC_BT_MASK (LZ4HC_BT_SIZE - 1)
+#define LZ4HC_BT_NODE(bt, idx) ((bt)->tree + 2*((idx) & LZ4HC_BT_MASK))   /* [0] : smaller child, [1] : larger child */
+
+typedef struct {
+    U32 hashTable[LZ4HC_HASHTABLESIZE];   /* tree roots */
+    U16 tree[2*LZ4HC_BT_SIZE];
+    U32 nextToUpdate;                     /* first position not yet inserted */
+    const LZ4HC_CCtx_internal* owner;     /* stream which built the trees, NULL if none */
+    const BYTE* end;                      /* end of input of previous call, at index `endIndex` */
+    U32 endIndex;
+} LZ4HC_BT_t;
+
+/* LZ4HC_BT_init() :
+ * prepares `bt` to insert positions preceding `src` (up to 64 KB).
+ * Trees of previous call are still valid when `src` continues the same index space :
+ * either contiguously, or as a new block after previous one moved into extDict.
+ * Positions below lowLimit, including overwritten ones, are never visited. */
+static void LZ4HC_BT_init(LZ4HC_BT_t* bt, const LZ4HC_CCtx_internal* ctx, const BYTE* src)
+{
+    U32 const startIndex = (U32)(src - ctx->base);
+    if ( (bt->owner == ctx) && (bt->endIndex == startIndex)
+      && ( (bt->end == src)
+        || ((ctx->dictLimit == startIndex) && (ctx->dictBase + startIndex == bt->end)) ) ) {
+        if (bt->nextToUpdate < ctx->lowLimit) bt->nextToUpdate = ctx->lowLimit;   /* history overwritten since */
+        return;
+    }
+    MEM_INIT(bt->hashTable, 0, sizeof(bt->hashTable));
+    bt->nextToUpdate = (ctx->lowLimit + MAX_DISTANCE > startIndex) ? ctx->lowLimit : startIndex - MAX_DISTANCE;
+}
+
+/* LZ4HC_BT_save() :
+ * records the end of input, so that next call of same stream can continue trees */
+static void LZ4HC_BT_save(LZ4HC_BT_t* bt, const LZ4HC_CCtx_internal* ctx)
+{
+    bt->owner = ctx;
+    bt->end = ctx->end;
+    bt->endIndex = (U32)(ctx->end - ctx->base);
+}
+
+/* workspace of levels >= LZ4HC_CLEVEL_OPT_MIN, see LZ4_setWorkspaceHC().
+ * Levels using the hash chain only need `opt`, which comes first. */
+typedef struct {
+    LZ4HC_optimal_t opt;
+    LZ4HC_BT_t bt;
+} LZ4HC_optWorkspace_t;
+
+/* LZ4HC_BT_invalidate() :
+ * trees of lent workspace, if any, can't be continued by next call (history was re-loaded, or workspace changed) */
+static void LZ4HC_BT_invalidate(LZ4HC_CCtx_internal* ctx)
+{
+    if (ctx->workspaceSize >= sizeof(LZ4HC_optWorkspace_t))
+        ((LZ4HC_optWorkspace_t*)ctx->workspace)->bt.owner = NULL;
+}
+
+LZ4_FORCE_INLINE const BYTE* LZ4HC_BT_ptr(const LZ4HC_CCtx_internal* ctx, U32 idx)
+{
+    return (idx < ctx->dictLimit) ? ctx->dictBase + idx : ctx->base + idx;
+}
+
+/* LZ4HC_BT_count() :
+ * nb of common bytes between `ip` and position `matchIndex`, up to `iHighLimit`.
+ * A match starting within extDict continues into prefix. */
+LZ4_FORCE_INLINE unsigned LZ4HC_BT_count(const LZ4HC_CCtx_internal* ctx,
+                                         const BYTE* ip, const BYTE* iHighLimit, U32 matchIndex)
+{
+    const U32 dictLimit = ctx->dictLimit;
+    if (matchIndex >= dictLimit) return LZ4_count(ip, ctx->base + matchIndex, iHighLimit);
+    {   const BYTE* const vLimit = MIN(iHighLimit, ip + (dictLimit - matchIndex));
+        unsigned len = LZ4_count(ip, ctx->dictBase + matchIndex, vLimit);
+        if ((ip + len == vLimit) && (vLimit < iHighLimit))
+            len += LZ4_count(ip + len, ctx->base + dictLimit, iHighLimit);
+        return len;
+    }
+}
+
+/* LZ4HC_BT_insertAndFind() :
+ * inserts position `idx` (at `ip`) into its tree, and finds its longest match on the way.
+ * Every position is inserted : skipping positions within long matches was measured to cost ratio,
+ * with no speed gain, since matchfinding is not the bottleneck then. */
+static void LZ4HC_BT_insertAndFind(LZ4HC_BT_t* bt, const LZ4HC_CCtx_internal* ctx,
+                                  U32 idx, const BYTE* ip, const BYTE* iHighLimit,
+                                  int nbCompares, LZ4HC_match_t* matchPtr)
+{
+    U32 const h = LZ4HC_hashPtr(ip);
+    U32 const lowLimit = (ctx->lowLimit + MAX_DISTANCE > idx) ? ctx->lowLimit : idx - MAX_DISTANCE;
+    U16* smallerPtr = LZ4HC_BT_NODE(bt, idx);
+    U16* largerPtr = smallerPtr + 1;
+    U32 smallerOwner = idx, largerOwner = idx;   /* node owning smallerPtr / largerPtr */
+    unsigned commonSmaller = 0, commonLarger = 0;
+    U32 matchIndex = bt->hashTable[h];
+    LZ4HC_match_t best = { 0, 0 };
+
+    bt->hashTable[h] = idx;
+    while ((nbCompares-- > 0) && (matchIndex >= lowLimit)) {
+        U16* const node = LZ4HC_BT_NODE(bt, matchIndex);
+        unsigned const common = MIN(commonSmaller, commonLarger);   /* guaranteed by tree order */
+        unsigned const mlen = common + LZ4HC_BT_count(ctx, ip + common, iHighLimit, matchIndex + common);
+        if ((int)mlen > best.len) {
+            best.len = (int)mlen;
+            best.off = (int)(idx - matchIndex);
+        }
+        if (ip + mlen >= iHighLimit) break;   /* can't tell which side : drop both subtrees */
+        if (*LZ4HC_BT_ptr(ctx, matchIndex + mlen) < ip[mlen]) {
+            /* candidate is smaller : current position goes into its larger subtree */
+            *smallerPtr = (U16)(smallerOwner - matchIndex);
+            commonSmaller = mlen;
+            smallerPtr = node + 1;
+            smallerOwner = matchIndex;
+            matchIndex = node[1] ? matchIndex - node[1] : 0;
+        } else {
+            *largerPtr = (U16)(largerOwner - matchIndex);
+            commonLarger = mlen;
+            largerPtr = node;
+            largerOwner = matchIndex;
+            matchIndex = node[0] ? matchIndex - node[0] : 0;
+    }   }
+    *smallerPtr = *largerPtr = 0;
+    *matchPtr = best;
+}
+
+/* LZ4HC_BT_update() :
+ * inserts all positions from bt->nextToUpdate up to `target` (excluded) */
+static void LZ4HC_BT_update(LZ4HC_BT_t* bt, const LZ4HC_CCtx_internal* ctx,
+                            U32 target, const BYTE* iHighLimit, int nbCompares)
+{
+    U32 const dictLimit = ctx->dictLimit;
+    U32 idx = bt->nextToUpdate;
+    while (idx < target) {
+        LZ4HC_match_t unused;
+        if (idx < dictLimit) {   /* extDict : comparisons stop at its end */
+            if (idx + MINMATCH > dictLimit) { idx = dictLimit; continue; }
+            LZ4HC_BT_insertAndFind(bt, ctx, idx, ctx->dictBase + idx, ctx->dictBase + dictLimit, nbCompares, &unused);
+        } else {
+            LZ4HC_BT_insertAndFind(bt, ctx, idx, ctx->base + idx, iHighLimit, nbCompares, &unused);
+        }
+        idx++;
+    }
+    bt->nextToUpdate = MAX(idx, bt->nextToUpdate);
+}
+
+LZ4_FORCE_INLINE
+LZ4HC_match_t LZ4HC_BT_findLongerMatch(LZ4HC_BT_t* bt, const LZ4HC_CCtx_internal* ctx,
+                        const BYTE* ip, const BYTE* const iHighLimit,
+                        int minLen, int nbSearches)
+{
+    U32 const idx = (U32)(ip - ctx->base);
+    LZ4HC_match_t match = { 0, 0 };
+    LZ4HC_BT_update(bt, ctx, idx, iHighLimit, nbSearches);
+    if (bt->nextToUpdate == idx) {   /* LZ4HC_compress_optimal() searches positions in increasing order */
+        LZ4HC_BT_insertAndFind(bt, ctx, idx, ip, iHighLimit, nbSearches, &match);
+        bt->nextToUpdate = idx + 1;
+    }   /* else : position already inserted, can't be searched again : no match */
+    if (match.len <= minLen) match.len = match.off = 0;
+    return match;
+}
+
 LZ4_FORCE_INLINE
-LZ4HC_match_t LZ4HC_FindLongerMatch(LZ4HC_CCtx_internal* const ctx,
+LZ4HC_match_t LZ4HC_FindLongerMatch(LZ4HC_CCtx_internal* const ctx, LZ4HC_BT_t* bt,
                         const BYTE* ip, const BYTE* const iHighLimit,
                         int minLen, int nbSearches)
 {
     LZ4HC_match_t match = { 0 , 0 };
     const BYTE* matchPtr = NULL;
+    if (bt != NULL) return LZ4HC_BT_findLongerMatch(bt, ctx, ip, iHighLimit, minLen, nbSearches);
     /* note : LZ4HC_InsertAndGetWiderMatch() is able to modify the starting position of a match (*startpos),
      * but this won't be the case here, as we define iLowLimit==ip,
      * so LZ4HC_InsertAndGetWiderMatch() won't be allowed to search past ip */
-    int const matchLength = LZ4HC_InsertAndGetWiderMatch(ctx,
-                                ip, ip, iHighLimit, minLen, &matchPtr, &ip,
-                                nbSearches, 1 /* patternAnalysis */);
-    if (matchLength <= minLen) return match;
-    match.len = matchLength;
-    match.off = (int)(ip-matchPtr);
-    return match;
+    {   int const matchLength = LZ4HC_InsertAndGetWiderMatch(ctx,
+                                    ip, ip, iHighLimit, minLen, &matchPtr, &ip,
+                                    nbSearches, 1 /* patternAnalysis */);
+        if (matchLength <= minLen) return match;
+        match.len = matchLength;
+        match.off = (int)(ip-matchPtr);
+        return match;
+    }
 }
 
 
@@ -104,12 +290,12 @@ static int LZ4HC_compress_optimal (
     int const nbSearches,
     size_t sufficient_len,
     limitedOutput_directive limit,
-    int const fullUpdate
+    int const fullUpdate,
+    LZ4HC_optimal_t* const opt,
+    LZ4HC_BT_t* const bt,   /* NULL : hash chain match finder */
+    int const favorDecSpeed   /* 1 : adds decoding cost to prices, trading a little ratio for faster decompression */
     )
 {
-#define TRAILING_LITERALS 3
-    LZ4HC_optimal_t opt[LZ4_OPT_NUM + TRAILING_LITERALS];   /* this uses a bit too much stack memory to my taste ... */
-
     const BYTE* ip = (const BYTE*) source;
     const BYTE* anchor = ip;
     const BYTE* const iend = ip + *srcSizePtr;
@@ -132,7 +318,7 @@ static int LZ4HC_compress_optimal (
         int best_mlen, best_off;
         int cur, last_match_pos = 0;
 
-        LZ4HC_match_t const firstMatch = LZ4HC_FindLongerMatch(ctx, ip, matchlimit, MINMATCH-1, nbSearches);
+        LZ4HC_match_t const firstMatch = LZ4HC_FindLongerMatch(ctx, bt, ip, matchlimit, MINMATCH-1, nbSearches);
         if (firstMatch.len==0) { ip++; continue; }
 
         if ((size_t)firstMatch.len > sufficient_len) {
@@ -149,12 +335,12 @@ static int LZ4HC_compress_optimal (
         {   int rPos;
             for (rPos = 0 ; rPos < MINMATCH ; rPos++) {
                 int const cost = LZ4HC_literalsPrice(llen + rPos);
-                opt[rPos].mlen = 1;
-                opt[rPos].off = 0;
-                opt[rPos].litlen = llen + rPos;
-                opt[rPos].price = cost;
+                opt->mlen[rPos] = 1;
+                opt->off[rPos] = 0;
+                opt->litlen[rPos] = llen + rPos;
+                opt->price[rPos] = cost;
                 DEBUGLOG(7, "rPos:%3i => price:%3i (litlen=%i) -- initial setup",
-                            rPos, cost, opt[rPos].litlen);
+                            rPos, cost, opt->litlen[rPos]);
         }   }
         /* set prices using initial match */
         {   int mlen = MINMATCH;
@@ -162,23 +348,23 @@ static int LZ4HC_compress_optimal (
             int const offset = firstMatch.off;
             assert(matchML < LZ4_OPT_NUM);
             for ( ; mlen <= matchML ; mlen++) {
-                int const cost = LZ4HC_sequencePrice(llen, mlen);
-                opt[mlen].mlen = mlen;
-                opt[mlen].off = offset;
-                opt[mlen].litlen = llen;
-                opt[mlen].price = cost;
+                int const cost = LZ4HC_sequencePrice(llen, mlen) + (favorDecSpeed ? LZ4HC_decodePrice(llen, mlen, offset) : 0);
+                opt->mlen[mlen] = mlen;
+                opt->off[mlen] = (U16)offset;
+                opt->litlen[mlen] = llen;
+                opt->price[mlen] = cost;
                 DEBUGLOG(7, "rPos:%3i => price:%3i (matchlen=%i) -- initial setup",
                             mlen, cost, mlen);
         }   }
         last_match_pos = firstMatch.len;
         {   int addLit;
             for (addLit = 1; addLit <= TRAILING_LITERALS; addLit ++) {
-                opt[last_match_pos+addLit].mlen = 1; /* literal */
-                opt[last_match_pos+addLit].off = 0;
-                opt[last_match_pos+addLit].litlen = addLit;
-                opt[last_match_pos+addLit].price = opt[last_match_pos].price + LZ4HC_literalsPrice(addLit);
+                opt->mlen[last_match_pos+addLit] = 1; /* literal */
+                opt->off[last_match_pos+addLit] = 0;
+                opt->litlen[last_match_pos+addLit] = addLit;
+                opt->price[last_match_pos+addLit] = opt->price[last_match_pos] + LZ4HC_literalsPrice(addLit);
                 DEBUGLOG(7, "rPos:%3i => price:%3i (litlen=%i) -- initial setup",
-                            last_match_pos+addLit, opt[last_match_pos+addLit].price, addLit);
+                            last_match_pos+addLit, opt->price[last_match_pos+addLit], addLit);
         }   }
 
         /* check further positions */
@@ -188,24 +374,24 @@ static int LZ4HC_compress_optimal (
 
             if (curPtr >= mflimit) break;
             DEBUGLOG(7, "rPos:%u[%u] vs [%u]%u",
-                    cur, opt[cur].price, opt[cur+1].price, cur+1);
+                    cur, opt->price[cur], opt->price[cur+1], cur+1);
             if (fullUpdate) {
                 /* not useful to search here if next position has same (or lower) cost */
-                if ( (opt[cur+1].price <= opt[cur].price)
+                if ( (opt->price[cur+1] <= opt->price[cur])
                   /* in some cases, next position has same cost, but cost rises sharply after, so a small match would still be beneficial */
-                  && (opt[cur+MINMATCH].price < opt[cur].price + 3/*min seq price*/) )
+                  && (opt->price[cur+MINMATCH] < opt->price[cur] + 3/*min seq price*/) )
                     continue;
             } else {
                 /* not useful to search here if next position has same (or lower) cost */
-                if (opt[cur+1].price <= opt[cur].price) continue;
+                if (opt->price[cur+1] <= opt->price[cur]) continue;
             }
 
             DEBUGLOG(7, "search at rPos:%u", cur);
             if (fullUpdate)
-                newMatch = LZ4HC_FindLongerMatch(ctx, curPtr, matchlimit, MINMATCH-1, nbSearches);
+                newMatch = LZ4HC_FindLongerMatch(ctx, bt, curPtr, matchlimit, MINMATCH-1, nbSearches);
             else
                 /* only test matches of minimum length; slightly faster, but misses a few bytes */
-                newMatch = LZ4HC_FindLongerMatch(ctx, curPtr, matchlimit, last_match_pos - cur, nbSearches);
+                newMatch = LZ4HC_FindLongerMatch(ctx, bt, curPtr, matchlimit, last_match_pos - cur, nbSearches);
             if (!newMatch.len) continue;
 
             if ( ((size_t)newMatch.len > sufficient_len)
@@ -218,18 +404,18 @@ static int LZ4HC_compress_optimal (
             }
 
             /* before match : set price with literals at beginning */
-            {   int const baseLitlen = opt[cur].litlen;
+            {   int const baseLitlen = opt->litlen[cur];
                 int litlen;
                 for (litlen = 1; litlen < MINMATCH; litlen++) {
-                    int const price = opt[cur].price - LZ4HC_literalsPrice(baseLitlen) + LZ4HC_literalsPrice(baseLitlen+litlen);
+                    int const price = opt->price[cur] - LZ4HC_literalsPrice(baseLitlen) + LZ4HC_literalsPrice(baseLitlen+litlen);
                     int const pos = cur + litlen;
-                    if (price < opt[pos].price) {
-                        opt[pos].mlen = 1; /* literal */
-                        opt[pos].off = 0;
-                        opt[pos].litlen = baseLitlen+litlen;
-                        opt[pos].price = price;
+                    if (price < opt->price[pos]) {
+                        opt->mlen[pos] = 1; /* literal */
+                        opt->off[pos] = 0;
+                        opt->litlen[pos] = baseLitlen+litlen;
+                        opt->price[pos] = price;
                         DEBUGLOG(7, "rPos:%3i => price:%3i (litlen=%i)",
-                                    pos, price, opt[pos].litlen);
+                                    pos, price, opt->litlen[pos]);
             }   }   }
 
             /* set prices using match at position = cur */
@@ -244,40 +430,43 @@ static int LZ4HC_compress_optimal (
                     int ll;
                     DEBUGLOG(7, "testing price rPos %i (last_match_pos=%i)",
                                 pos, last_match_pos);
-                    if (opt[cur].mlen == 1) {
-                        ll = opt[cur].litlen;
-                        price = ((cur > ll) ? opt[cur - ll].price : 0)
+                    if (opt->mlen[cur] == 1) {
+                        ll = opt->litlen[cur];
+                        price = ((cur > ll) ? opt->price[cur - ll] : 0)
                               + LZ4HC_sequencePrice(ll, ml);
                     } else {
                         ll = 0;
-                        price = opt[cur].price + LZ4HC_sequencePrice(0, ml);
+                        price = opt->price[cur] + LZ4HC_sequencePrice(0, ml);
                     }
+                    if (favorDecSpeed) price += LZ4HC_decodePrice(ll, ml, offset);
 
-                    if (pos > last_match_pos+TRAILING_LITERALS || price <= opt[pos].price) {
+                    /* on equal price, favorDecSpeed keeps previous solution, which ends with fewer sequences */
+                    assert((U32)favorDecSpeed <= 1);
+                    if (pos > last_match_pos+TRAILING_LITERALS || price <= opt->price[pos] - favorDecSpeed) {
                         DEBUGLOG(7, "rPos:%3i => price:%3i (matchlen=%i)",
                                     pos, price, ml);
                         assert(pos < LZ4_OPT_NUM);
                         if ( (ml == matchML)  /* last pos of last match */
                           && (last_match_pos < pos) )
                             last_match_pos = pos;
-                        opt[pos].mlen = ml;
-                        opt[pos].off = offset;
-                        opt[pos].litlen = ll;
-                        opt[pos].price = price;
+                        opt->mlen[pos] = ml;
+                        opt->off[pos] = (U16)offset;
+                        opt->litlen[pos] = ll;
+                        opt->price[pos] = price;
             }   }   }
             /* complete following positions with literals */
             {   int addLit;
                 for (addLit = 1; addLit <= TRAILING_LITERALS; addLit ++) {
-                    opt[last_match_pos+addLit].mlen = 1; /* literal */
-                    opt[last_match_pos+addLit].off = 0;
-                    opt[last_match_pos+addLit].litlen = addLit;
-                    opt[last_match_pos+addLit].price = opt[last_match_pos].price + LZ4HC_literalsPrice(addLit);
-                    DEBUGLOG(7, "rPos:%3i => price:%3i (litlen=%i)", last_match_pos+addLit, opt[last_match_pos+addLit].price, addLit);
+                    opt->mlen[last_match_pos+addLit] = 1; /* literal */
+                    opt->off[last_match_pos+addLit] = 0;
+                    opt->litlen[last_match_pos+addLit] = addLit;
+                    opt->price[last_match_pos+addLit] = opt->price[last_match_pos] + LZ4HC_literalsPrice(addLit);
+                    DEBUGLOG(7, "rPos:%3i => price:%3i (litlen=%i)", last_match_pos+addLit, opt->price[last_match_pos+addLit], addLit);
             }   }
         }  /* for (cur = 1; cur <= last_match_pos; cur++) */
 
-        best_mlen = opt[last_match_pos].mlen;
-        best_off = opt[last_match_pos].off;
+        best_mlen = opt->mlen[last_match_pos];
+        best_off = opt->off[last_match_pos];
         cur = last_match_pos - best_mlen;
 
 encode: /* cur, last_match_pos, best_mlen, best_off must be set */
@@ -289,11 +478,11 @@ encode: /* cur, last_match_pos, best_mlen, best_off must be set */
             int selected_matchLength = best_mlen;
             int selected_offset = best_off;
             while (1) {  /* from end to beginning */
-                int const next_matchLength = opt[candidate_pos].mlen;  /* can be 1, means literal */
-                int const next_offset = opt[candidate_pos].off;
+                int const next_matchLength = opt->mlen[candidate_pos];  /* can be 1, means literal */
+                int const next_offset = opt->off[candidate_pos];
                 DEBUGLOG(6, "pos %i: sequence length %i", candidate_pos, selected_matchLength);
-                opt[candidate_pos].mlen = selected_matchLength;
-                opt[candidate_pos].off = selected_offset;
+                opt->mlen[candidate_pos] = selected_matchLength;
+                opt->off[candidate_pos] = (U16)selected_offset;
                 selected_matchLength = next_matchLength;
                 selected_offset = next_offset;
                 if (next_matchLength > candidate_pos) break; /* last match elected, first match to encode */
@@ -304,8 +493,8 @@ encode: /* cur, last_match_pos, best_mlen, best_off must be set */
         /* encode all recorded sequences in order */
         {   int rPos = 0;  /* relative position (to ip) */
             while (rPos < last_match_pos) {
-                int const ml = opt[rPos].mlen;
-                int const offset = opt[rPos].off;
+                int const ml = opt->mlen[rPos];
+                int const offset = opt->off[rPos];
                 if (ml == 1) { ip++; rPos++; continue; }  /* literal; note: can end up with several literals, in which case, skip them */
                 rPos += ml;
                 assert(ml >= MINMATCH);
@@ -0,0 +1,333 @@
+/*
+ * LZ4 - minimal thread pool (internal)
+ * Copyright (C) 2011-2017, Yann Collet.
+ *
+ * BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at :
+ *  - LZ4 source repository : https://github.com/lz4/lz4
+ */
+
+/* The pool is a fixed set of workers sharing a single "batch" descriptor.
+ * LZ4_pool_run() publishes a batch, then joins the workers in claiming job numbers
+ * from a mutex-protected counter, until the batch is exhausted.
+ * Workers sleep between batches, so a pool can be kept alive across many runs
+ * (typically, one run per LZ4F_compressUpdate() call). */
+
+
+/*-************************************
+*  Memory routines
+**************************************/
+#include <stdlib.h>   /* calloc, free */
+#include <string.h>   /* memset */
+#define ALLOCATOR(s)   calloc(1,s)
+#define FREEMEM        free
+
+
+/*-************************************
+*  Includes
+**************************************/
+#include "lz4threads.h"
+
+
+/*-************************************
+*  Thread primitives
+**************************************/
+#if defined(_WIN32)
+
+#  ifndef _WIN32_WINNT
+#    define _WIN32_WINNT 0x0600   /* condition variables : Vista+ */
+#  endif
+#  include <windows.h>
+#  include <process.h>   /* _beginthreadex */
+#  define LZ4_MULTITHREAD_SUPPORTED 1
+   typedef CRITICAL_SECTION   LZ4_mutex_t;
+   typedef CONDITION_VARIABLE LZ4_cond_t;
+   typedef HANDLE             LZ4_thread_t;
+#  define LZ4_mutex_init(m)    (InitializeCriticalSection(m), 0)
+#  define LZ4_mutex_destroy(m) DeleteCriticalSection(m)
+#  define LZ4_mutex_lock(m)    EnterCriticalSection(m)
+#  define LZ4_mutex_unlock(m)  LeaveCriticalSection(m)
+#  define LZ4_cond_init(c)     (InitializeConditionVariable(c), 0)
+#  define LZ4_cond_destroy(c)  ((void)(c))
+#  define LZ4_cond_wait(c,m)   SleepConditionVariableCS((c), (m), INFINITE)
+#  define LZ4_cond_signal(c)   WakeConditionVariable(c)
+#  define LZ4_cond_broadcast(c) WakeAllConditionVariable(c)
+#  define LZ4_THREAD_FUNCTION(name)  static unsigned __stdcall name(void* arg)
+#  define LZ4_THREAD_RETURN    return 0
+   static int LZ4_thread_create(LZ4_thread_t* t, unsigned (__stdcall *f)(void*), void* arg)
+   {
+       *t = (HANDLE)_beginthreadex(NULL, 0, f, arg, 0, NULL);
+       return (*t == NULL);
+   }
+   static void LZ4_thread_join(LZ4_thread_t t) { WaitForSingleObject(t, INFINITE); CloseHandle(t); }
+
+#elif defined(LZ4_MULTITHREAD)
+
+#  include <pthread.h>
+#  define LZ4_MULTITHREAD_SUPPORTED 1
+   typedef pthread_mutex_t LZ4_mutex_t;
+   typedef pthread_cond_t  LZ4_cond_t;
+   typedef pthread_t       LZ4_thread_t;
+#  define LZ4_mutex_init(m)    pthread_mutex_init((m), NULL)
+#  define LZ4_mutex_destroy(m) pthread_mutex_destroy(m)
+#  define LZ4_mutex_lock(m)    pthread_mutex_lock(m)
+#  define LZ4_mutex_unlock(m)  pthread_mutex_unlock(m)
+#  define LZ4_cond_init(c)     pthread_cond_init((c), NULL)
+#  define LZ4_cond_destroy(c)  pthread_cond_destroy(c)
+#  define LZ4_cond_wait(c,m)   pthread_cond_wait((c), (m))
+#  define LZ4_cond_signal(c)   pthread_cond_signal(c)
+#  define LZ4_cond_broadcast(c) pthread_cond_broadcast(c)
+#  define LZ4_THREAD_FUNCTION(name)  static void* name(void* arg)
+#  define LZ4_THREAD_RETURN    return NULL
+#  define LZ4_thread_create(t, f, arg)  pthread_create((t), NULL, (f), (arg))
+#  define LZ4_thread_join(t)   pthread_join((t), NULL)
+
+#else
+#  define LZ4_MULTITHREAD_SUPPORTED 0
+#endif
+
+
+#if LZ4_MULTITHREAD_SUPPORTED
+
+/*-************************************
+*  Pool
+**************************************/
+#define LZ4_POOL_THREADS_MAX 256
+
+struct LZ4_pool_s {
+    LZ4_mutex_t mutex;
+    LZ4_cond_t  batchStart;    /* signaled when a new batch is published, or on shutdown */
+    LZ4_cond_t  batchEnd;      /* signaled when the last job of current batch completes */
+    LZ4_poolJob_f job;
+    void*    opaque;
+    unsigned nbJobs;
+    unsigned nextJob;
+    unsigned nbCompleted;
+    unsigned batchID;          /* incremented on each LZ4_pool_run() */
+    int      shutdown;
+    unsigned nbThreads;        /* calling thread included */
+    unsigned nbWorkers;        /* successfully started */
+    LZ4_poolFree_f customFree; /* NULL : FREEMEM */
+    void*    allocOpaque;      /* of customFree */
+    LZ4_thread_t workers[LZ4_POOL_THREADS_MAX];
+};
+
+static void LZ4_pool_release(LZ4_pool* pool)
+{
+    if (pool->customFree) pool->customFree(pool->allocOpaque, pool);
+    else FREEMEM(pool);
+}
+
+/* LZ4_pool_work() :
+ * claims and runs jobs from current batch, until none is left.
+ * must be invoked with mutex locked; returns with mutex locked. */
+static void LZ4_pool_work(LZ4_pool* pool)
+{
+    while (pool->nextJob < pool->nbJobs) {
+        LZ4_poolJob_f const job = pool->job;
+        void* const opaque = pool->opaque;
+        unsigned const jobNb = pool->nextJob++;
+        LZ4_mutex_unlock(&pool->mutex);
+        job(opaque, jobNb);
+        LZ4_mutex_lock(&pool->mutex);
+        if (++pool->nbCompleted == pool->nbJobs)
+            LZ4_cond_signal(&pool->batchEnd);
+    }
+}
+
+LZ4_THREAD_FUNCTION(LZ4_pool_worker)
+{
+    LZ4_pool* const pool = (LZ4_pool*)arg;
+    unsigned seenBatch;
+    LZ4_mutex_lock(&pool->mutex);
+    seenBatch = pool->batchID;
+    for (;;) {
+        while (!pool->shutdown && (pool->batchID == seenBatch))
+            LZ4_cond_wait(&pool->batchStart, &pool->mutex);
+        if (pool->shutdown) break;
+        seenBatch = pool->batchID;
+        LZ4_pool_work(pool);
+    }
+    LZ4_mutex_unlock(&pool->mutex);
+    LZ4_THREAD_RETURN;
+}
+
+LZ4_pool* LZ4_pool_create(unsigned nbThreads)
+{
+    return LZ4_pool_create_advanced(nbThreads, NULL, NULL, NULL);
+}
+
+LZ4_pool* LZ4_pool_create_advanced(unsigned nbThreads, LZ4_poolAlloc_f customAlloc, LZ4_poolFree_f customFree, void* opaque)
+{
+    LZ4_pool* pool;
+    if (nbThreads <= 1) return NULL;
+    if ((customAlloc == NULL) != (customFree == NULL)) return NULL;   /* both or none */
+    if (nbThreads > LZ4_POOL_THREADS_MAX) nbThreads = LZ4_POOL_THREADS_MAX;
+    if (customAlloc) {
+        pool = (LZ4_pool*)customAlloc(opaque, sizeof(*pool));
+        if (pool!=NULL) memset(pool, 0, sizeof(*pool));
+    } else {
+        pool = (LZ4_pool*)ALLOCATOR(sizeof(*pool));
+    }
+    if (pool==NULL) return NULL;
+    pool->customFree = customFree;
+    pool->allocOpaque = opaque;
+    if (LZ4_mutex_init(&pool->mutex)) { LZ4_pool_release(pool); return NULL; }
+    if (LZ4_cond_init(&pool->batchStart)) {
+        LZ4_mutex_destroy(&pool->mutex); LZ4_pool_release(pool); return NULL;
+    }
+    if (LZ4_cond_init(&pool->batchEnd)) {
+        LZ4_cond_destroy(&pool->batchStart); LZ4_mutex_destroy(&pool->mutex); LZ4_pool_release(pool); return NULL;
+    }
+    pool->nbThreads = nbThreads;
+    while (pool->nbWorkers < nbThreads-1) {
+        if (LZ4_thread_create(&pool->workers[pool->nbWorkers], LZ4_pool_worker, pool)) break;
+        pool->nbWorkers++;
+    }
+    if (pool->nbWorkers < nbThreads-1) { LZ4_pool_free(pool); return NULL; }
+    return pool;
+}
+
+void LZ4_pool_free(LZ4_pool* pool)
+{
+    unsigned n;
+    if (pool==NULL) return;
+    LZ4_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    LZ4_cond_broadcast(&pool->batchStart);
+    LZ4_mutex_unlock(&pool->mutex);
+    for (n=0; n<pool->nbWorkers; n++) LZ4_thread_join(pool->workers[n]);
+    LZ4_cond_destroy(&pool->batchEnd);
+    LZ4_cond_destroy(&pool->batchStart);
+    LZ4_mutex_destroy(&pool->mutex);
+    LZ4_pool_release(pool);
+}
+
+unsigned LZ4_pool_nbThreads(const LZ4_pool* pool)
+{
+    if (pool==NULL) return 1;
+    return pool->nbThreads;
+}
+
+void LZ4_pool_run(LZ4_pool* pool, LZ4_poolJob_f job, void* opaque, unsigned nbJobs)
+{
+    if (nbJobs == 0) return;
+    if ((pool==NULL) || (nbJobs==1)) {
+        unsigned n;
+        for (n=0; n<nbJobs; n++) job(opaque, n);
+        return;
+    }
+    LZ4_mutex_lock(&pool->mutex);
+    pool->job = job;
+    pool->opaque = opaque;
+    pool->nbJobs = nbJobs;
+    pool->nextJob = 0;
+    pool->nbCompleted = 0;
+    pool->batchID++;
+    LZ4_cond_broadcast(&pool->batchStart);
+    LZ4_pool_work(pool);
+    while (pool->nbCompleted < pool->nbJobs)
+        LZ4_cond_wait(&pool->batchEnd, &pool->mutex);
+    LZ4_mutex_unlock(&pool->mutex);
+}
+
+
+/*-************************************
+*  Asynchronous job
+**************************************/
+struct LZ4_async_s {
+    LZ4_poolJob_f job;
+    void*    opaque;
+    int      started;   /* 0 : thread creation failed, job runs within LZ4_async_wait() */
+    LZ4_thread_t thread;
+};
+
+LZ4_THREAD_FUNCTION(LZ4_async_worker)
+{
+    LZ4_async* const async = (LZ4_async*)arg;
+    async->job(async->opaque, 0);
+    LZ4_THREAD_RETURN;
+}
+
+LZ4_async* LZ4_async_start(LZ4_poolJob_f job, void* opaque)
+{
+    LZ4_async* const async = (LZ4_async*)ALLOCATOR(sizeof(*async));
+    if (async==NULL) return NULL;
+    async->job = job;
+    async->opaque = opaque;
+    async->started = !LZ4_thread_create(&async->thread, LZ4_async_worker, async);
+    return async;
+}
+
+void LZ4_async_wait(LZ4_async* async)
+{
+    if (async==NULL) return;
+    if (async->started) LZ4_thread_join(async->thread);
+    else async->job(async->opaque, 0);
+    FREEMEM(async);
+}
+
+#else   /* !LZ4_MULTITHREAD_SUPPORTED */
+
+LZ4_pool* LZ4_pool_create(unsigned nbThreads) { (void)nbThreads; return NULL; }
+
+LZ4_pool* LZ4_pool_create_advanced(unsigned nbThreads, LZ4_poolAlloc_f customAlloc, LZ4_poolFree_f customFree, void* opaque)
+{ (void)nbThreads; (void)customAlloc; (void)customFree; (void)opaque; return NULL; }
+
+void LZ4_pool_free(LZ4_pool* pool) { (void)pool; }
+
+unsigned LZ4_pool_nbThreads(const LZ4_pool* pool) { (void)pool; return 1; }
+
+void LZ4_pool_run(LZ4_pool* pool, LZ4_poolJob_f job, void* opaque, unsigned nbJobs)
+{
+    unsigned n;
+    (void)pool;
+    for (n=0; n<nbJobs; n++) job(opaque, n);
+}
+
+struct LZ4_async_s {
+    LZ4_poolJob_f job;
+    void* opaque;
+};
+
+LZ4_async* LZ4_async_start(LZ4_poolJob_f job, void* opaque)
+{
+    LZ4_async* const async = (LZ4_async*)ALLOCATOR(sizeof(*async));
+    if (async==NULL) return NULL;
+    async->job = job;
+    async->opaque = opaque;
+    return async;
+}
+
+void LZ4_async_wait(LZ4_async* async)
+{
+    if (async==NULL) return;
+    async->job(async->opaque, 0);
+    FREEMEM(async);
+}
+
+#endif  /* LZ4_MULTITHREAD_SUPPORTED */
@@ -0,0 +1,102 @@
+/*
+ * LZ4 - minimal thread pool (internal)
+ * Copyright (C) 2011-2017, Yann Collet.
+ *
+ * BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following disclaimer
+ *     in the documentation and/or other materials provided with the
+ *     distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * You can contact the author at :
+ *  - LZ4 source repository : https://github.com/lz4/lz4
+ */
+
+/* This header is not part of the public API.
+ * It is shared by library modules which split their work into independent jobs.
+ *
+ * Multi-threading is enabled when `LZ4_MULTITHREAD` is defined
+ * (pthreads, `-pthread` required at link stage) or on Windows (Win32 threads).
+ * Otherwise, the pool is a stub, and all jobs run serially within the calling thread.
+ */
+
+#ifndef LZ4THREADS_H_2983472
+#define LZ4THREADS_H_2983472
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#include <stddef.h>   /* size_t */
+
+typedef void (*LZ4_poolJob_f)(void* opaque, unsigned jobNb);
+
+typedef struct LZ4_pool_s LZ4_pool;
+
+/*! LZ4_pool_create() :
+ *  Starts `nbThreads-1` worker threads : the thread invoking LZ4_pool_run() is the last worker.
+ *  @return : NULL when nbThreads <= 1, when multi-threading is not supported,
+ *            or on allocation / thread creation failure.
+ *  A NULL pool is valid for all other LZ4_pool_*() functions : it runs jobs serially. */
+LZ4_pool* LZ4_pool_create(unsigned nbThreads);
+
+/*! LZ4_pool_create_advanced() :
+ *  Same as LZ4_pool_create(), pool state being allocated by `customAlloc` and released by `customFree`.
+ *  Both NULL means default allocator. Thread stacks are still allocated by the system. */
+typedef void* (*LZ4_poolAlloc_f)(void* opaque, size_t size);
+typedef void  (*LZ4_poolFree_f)(void* opaque, void* address);
+LZ4_pool* LZ4_pool_create_advanced(unsigned nbThreads, LZ4_poolAlloc_f customAlloc, LZ4_poolFree_f customFree, void* opaque);
+
+/*! LZ4_pool_free() :
+ *  Stops and joins all worker threads. Accepts NULL. */
+void LZ4_pool_free(LZ4_pool* pool);
+
+/*! LZ4_pool_nbThreads() :
+ *  @return : nb of threads which may run jobs concurrently, calling thread included (>= 1). */
+unsigned LZ4_pool_nbThreads(const LZ4_pool* pool);
+
+/*! LZ4_pool_run() :
+ *  Invokes job(opaque, n) for each n in [0, nbJobs), then returns once all jobs are completed.
+ *  Job numbers are handed out in increasing order, but may complete in any order.
+ *  Jobs must be independent : they may run concurrently, on any thread.
+ *  Not re-entrant : a given pool must be run by a single thread at a time. */
+void LZ4_pool_run(LZ4_pool* pool, LZ4_poolJob_f job, void* opaque, unsigned nbJobs);
+
+
+typedef struct LZ4_async_s LZ4_async;
+
+/*! LZ4_async_start() :
+ *  Starts job(opaque, 0) on a new thread, and returns immediately.
+ *  When multi-threading is not supported, or thread creation fails,
+ *  the job is run later, by LZ4_async_wait(), within the calling thread.
+ *  @return : NULL on allocation failure (job is then not started). */
+LZ4_async* LZ4_async_start(LZ4_poolJob_f job, void* opaque);
+
+/*! LZ4_async_wait() :
+ *  Returns once the job is completed, then releases `async`. */
+void LZ4_async_wait(LZ4_async* async);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* LZ4THREADS_H_2983472 */
@@ -46,10 +46,13 @@
 #include "xxhash.h"
 
 
+#define LZ4_STATIC_LINKING_ONLY   /* LZ4_compress_batch, LZ4_compress_lazy */
 #include "lz4.h"
 #define COMPRESSOR0 LZ4_compress_local
 static int LZ4_compress_local(const char* src, char* dst, int srcSize, int dstSize, int clevel) { (void)clevel; return LZ4_compress_default(src, dst, srcSize, dstSize); }
+#define COMPRESSOR2 LZ4_compress_lazy   /* receives lazyLevel instead of cLevel */
 #include "lz4hc.h"
+#include "lz4chunked.h"
 #define COMPRESSOR1 LZ4_compress_HC
 #define DEFAULTCOMPRESSOR COMPRESSOR0
 #define LZ4_isError(errcode) (errcode==0)
@@ -116,6 +119,10 @@ static clock_t g_time = 0;
 ***************************************/
 static U32 g_nbSeconds = NBSECONDS;
 static size_t g_blockSize = 0;
+static unsigned g_recordsMode = 0;
+static unsigned g_nbThreads = 0;
+static const char* g_dictionaryFilename = NULL;
+static unsigned g_lazyLevel = 0;
 int g_additionalParam = 0;
 
 void BMK_setNotificationLevel(unsigned level) { g_displayLevel=level; }
@@ -133,6 +140,14 @@ void BMK_SetBlockSize(size_t blockSize)
     g_blockSize = blockSize;
 }
 
+void BMK_setRecordsMode(unsigned enabled) { g_recordsMode = enabled; }
+
+void BMK_setNbThreads(unsigned nbThreads) { g_nbThreads = nbThreads; }
+
+void BMK_setDictionaryFilename(const char* dictionaryFilename) { g_dictionaryFilename = dictionaryFilename; }
+
+void BMK_setLazyLevel(unsigned lazyLevel) { g_lazyLevel = lazyLevel; }
+
 
 /* ********************************************************
 *  Bench functions
@@ -152,12 +167,21 @@ struct compressionParameters
     int (*compressionFunction)(const char* src, char* dst, int srcSize, int dstSize, int cLevel);
 };
 
+typedef struct {
+    int cLevel;
+    unsigned lazyLevel;   /* 0 : not lazy */
+    double ratio;
+    double cSpeed;   /* MB/s */
+    double dSpeed;   /* MB/s */
+} BMK_result_t;
+
 #define MIN(a,b) ((a)<(b) ? (a) : (b))
 #define MAX(a,b) ((a)>(b) ? (a) : (b))
 
 static int BMK_benchMem(const void* srcBuffer, size_t srcSize,
-                        const char* displayName, int cLevel,
-                        const size_t* fileSizes, U32 nbFiles)
+                        const char* displayName, int cLevel, unsigned lazyLevel,
+                        const size_t* fileSizes, U32 nbFiles,
+                        BMK_result_t* result)
 {
     size_t const blockSize = (g_blockSize>=32 ? g_blockSize : srcSize) + (!srcSize) /* avoid div by 0 */ ;
     U32 const maxNbBlocks = (U32) ((srcSize + (blockSize-1)) / blockSize) + nbFiles;
@@ -168,6 +192,7 @@ static int BMK_benchMem(const void* srcBuffer, size_t srcSize,
     U32 nbBlocks;
     struct compressionParameters compP;
     int cfunctionId;
+    int cParam = cLevel;
 
     /* checks */
     if (!compressedBuffer || !resultBuffer || !blockTable)
@@ -177,7 +202,9 @@ static int BMK_benchMem(const void* srcBuffer, size_t srcSize,
     if (strlen(displayName)>17) displayName += strlen(displayName)-17;   /* can only display 17 characters */
 
     /* Init */
-    if (cLevel < LZ4HC_CLEVEL_MIN) cfunctionId = 0; else cfunctionId = 1;
+    if (cLevel >= LZ4HC_CLEVEL_MIN) cfunctionId = 1;
+    else if (lazyLevel) { cfunctionId = 2; cParam = (int)lazyLevel; }   /* as LZ4F_setLazyLevel() */
+    else cfunctionId = 0;
     switch (cfunctionId)
     {
 #ifdef COMPRESSOR0
@@ -185,6 +212,9 @@ static int BMK_benchMem(const void* srcBuffer, size_t srcSize,
 #endif
 #ifdef COMPRESSOR1
     case 1 : compP.compressionFunction = COMPRESSOR1; break;
+#endif
+#ifdef COMPRESSOR2
+    case 2 : compP.compressionFunction = COMPRESSOR2; break;
 #endif
     default : compP.compressionFunction = DEFAULTCOMPRESSOR;
     }
@@ -253,7 +283,7 @@ static int BMK_benchMem(const void* srcBuffer, size_t srcSize,
                 do {
                     U32 blockNb;
                     for (blockNb=0; blockNb<nbBlocks; blockNb++) {
-                        size_t const rSize = compP.compressionFunction(blockTable[blockNb].srcPtr, blockTable[blockNb].cPtr, (int)blockTable[blockNb].srcSize, (int)blockTable[blockNb].cRoom, cLevel);
+                        size_t const rSize = compP.compressionFunction(blockTable[blockNb].srcPtr, blockTable[blockNb].cPtr, (int)blockTable[blockNb].srcSize, (int)blockTable[blockNb].cRoom, cParam);
                         if (LZ4_isError(rSize)) EXM_THROW(1, "LZ4_compress() failed");
                         blockTable[blockNb].cSize = rSize;
                     }
@@ -346,7 +376,12 @@ static int BMK_benchMem(const void* srcBuffer, size_t srcSize,
             else
                 DISPLAY("-%-3i%11i (%5.3f) %6.2f MB/s %6.1f MB/s  %s\n", cLevel, (int)cSize, ratio, cSpeed, dSpeed, displayName);
         }
-        DISPLAYLEVEL(2, "%2i#\n", cLevel);
+        DISPLAYLEVEL(2, "%2i#%s\n", cLevel, lazyLevel ? ((lazyLevel == 1) ? " lazy1" : " lazy2") : "");
+        result->cLevel = cLevel;
+        result->lazyLevel = lazyLevel;
+        result->ratio = ratio;
+        result->cSpeed = (double)srcSize / fastestC;
+        result->dSpeed = (double)srcSize / fastestD;
     }   /* Bench */
 
     /* clean up */
@@ -357,6 +392,332 @@ static int BMK_benchMem(const void* srcBuffer, size_t srcSize,
 }
 
 
+/* BMK_timeRecords() :
+ * runs `nbRecords` compressions or decompressions, either one call per record or as a single batch,
+ * until at least TIMELOOP_MICROSEC has elapsed.
+ * @return : fastest time per record, in nanoseconds */
+typedef enum { BMK_rec_compress, BMK_rec_compressBatch, BMK_rec_decompress, BMK_rec_decompressBatch,
+               BMK_rec_compressDict, BMK_rec_decompressDict } BMK_recordOp_e;
+
+typedef struct {
+    LZ4_stream_t* workStream;
+    const LZ4_stream_t* dictStream;   /* dictionary, already loaded */
+    const char* dict;
+    int dictSize;
+} BMK_dictState_t;
+
+static double BMK_timeRecords(BMK_recordOp_e op, void* state, U32 nbRecords,
+                              const char* const* srcs, const int* srcSizes, char* const* dsts, const int* dstCapacities, int* dstSizes)
+{
+    U64 const clockLoop = g_nbSeconds ? TIMELOOP_MICROSEC : 1;
+    U32 nbLoops = 0;
+    UTIL_time_t clockStart;
+
+    UTIL_sleepMilli(1);
+    UTIL_waitForNextTick();
+    clockStart = UTIL_getTime();
+    do {
+        U32 n;
+        switch (op)
+        {
+        case BMK_rec_compress:
+            for (n=0; n<nbRecords; n++) {
+                dstSizes[n] = LZ4_compress_default(srcs[n], dsts[n], srcSizes[n], dstCapacities[n]);
+                if (dstSizes[n]==0) EXM_THROW(1, "LZ4_compress_default() failed");
+            }
+            break;
+        case BMK_rec_compressBatch:
+            if (LZ4_compress_batch(state, srcs, srcSizes, dsts, dstCapacities, dstSizes, (int)nbRecords, 1))
+                EXM_THROW(1, "LZ4_compress_batch() failed");
+            break;
+        case BMK_rec_decompress:
+            for (n=0; n<nbRecords; n++) {
+                dstSizes[n] = LZ4_decompress_safe(srcs[n], dsts[n], srcSizes[n], dstCapacities[n]);
+                if (dstSizes[n]<0) EXM_THROW(1, "LZ4_decompress_safe() failed on record %u", n);
+            }
+            break;
+        case BMK_rec_decompressBatch:
+            if (LZ4_decompress_safe_batch(srcs, srcSizes, dsts, dstCapacities, dstSizes, (int)nbRecords))
+                EXM_THROW(1, "LZ4_decompress_safe_batch() failed");
+            break;
+        case BMK_rec_compressDict:
+            {   const BMK_dictState_t* const ds = (const BMK_dictState_t*)state;
+                for (n=0; n<nbRecords; n++) {
+                    LZ4_attach_dictionary(ds->workStream, ds->dictStream);
+                    dstSizes[n] = LZ4_compress_fast_continue(ds->workStream, srcs[n], dsts[n], srcSizes[n], dstCapacities[n], 1);
+                    if (dstSizes[n]==0) EXM_THROW(1, "LZ4_compress_fast_continue() failed");
+            }   }
+            break;
+        case BMK_rec_decompressDict:
+            {   const BMK_dictState_t* const ds = (const BMK_dictState_t*)state;
+                for (n=0; n<nbRecords; n++) {
+                    dstSizes[n] = LZ4_decompress_safe_usingDict(srcs[n], dsts[n], srcSizes[n], dstCapacities[n], ds->dict, ds->dictSize);
+                    if (dstSizes[n]<0) EXM_THROW(1, "LZ4_decompress_safe_usingDict() failed on record %u", n);
+            }   }
+            break;
+        }
+        nbLoops++;
+    } while (UTIL_clockSpanMicro(clockStart) < clockLoop);
+
+    return (double)UTIL_clockSpanMicro(clockStart) * 1000. / ((double)nbLoops * nbRecords);
+}
+
+/* BMK_benchRecords() :
+ * cuts `srcBuffer` into small independent records,
+ * and compares records/s of one call per record with the batch API */
+static void BMK_benchRecords(const void* srcBuffer, size_t srcSize, const char* displayName)
+{
+    static const size_t recordSizes[] = { 64, 256, 1 KB, 4 KB, 16 KB };
+    size_t const nbSizes = (g_blockSize >= 32) ? 1 : sizeof(recordSizes) / sizeof(recordSizes[0]);
+    void* const state = LZ4_createStream();
+    size_t sizeNb;
+
+    if (!state) EXM_THROW(31, "allocation error : not enough memory");
+    DISPLAYLEVEL(2, "%s : records mode, M records/s (single calls / batch) \n", displayName);
+
+    for (sizeNb = 0; sizeNb < nbSizes; sizeNb++) {
+        size_t const recordSize = (g_blockSize >= 32) ? g_blockSize : recordSizes[sizeNb];
+        if (srcSize < recordSize) {
+            DISPLAYLEVEL(2, "%6u B records : input too small \n", (U32)recordSize);
+            continue;
+        }
+
+        {   U32 const nbRecords = (U32)(srcSize / recordSize);
+            int const cRoom = LZ4_compressBound((int)recordSize);
+            const char** const srcs = (const char**)malloc(nbRecords * sizeof(*srcs));
+            char** const dsts = (char**)malloc(nbRecords * sizeof(*dsts));
+            char** const regens = (char**)malloc(nbRecords * sizeof(*regens));
+            int* const srcSizes = (int*)malloc(nbRecords * sizeof(int));
+            int* const cRooms = (int*)malloc(nbRecords * sizeof(int));
+            int* const cSizes = (int*)malloc(nbRecords * sizeof(int));
+            int* const regenSizes = (int*)malloc(nbRecords * sizeof(int));
+            char* const cBuffer = (char*)malloc((size_t)nbRecords * (size_t)cRoom);
+            char* const regenBuffer = (char*)malloc(nbRecords * recordSize);
+            double cSingle, cBatch, dSingle, dBatch;
+            size_t cSize = 0;
+            U32 n;
+
+            if (!srcs || !dsts || !regens || !srcSizes || !cRooms || !cSizes || !regenSizes || !cBuffer || !regenBuffer)
+                EXM_THROW(31, "allocation error : not enough memory");
+
+            for (n=0; n<nbRecords; n++) {
+                srcs[n] = (const char*)srcBuffer + n*recordSize;
+                srcSizes[n] = (int)recordSize;
+                dsts[n] = cBuffer + (size_t)n*(size_t)cRoom;
+                cRooms[n] = cRoom;
+                regens[n] = regenBuffer + n*recordSize;
+            }
+
+            cSingle = BMK_timeRecords(BMK_rec_compress, state, nbRecords, srcs, srcSizes, dsts, cRooms, cSizes);
+            cBatch  = BMK_timeRecords(BMK_rec_compressBatch, state, nbRecords, srcs, srcSizes, dsts, cRooms, cSizes);
+            for (n=0; n<nbRecords; n++) cSize += (size_t)cSizes[n];
+            dSingle = BMK_timeRecords(BMK_rec_decompress, state, nbRecords, (const char* const*)dsts, cSizes, regens, srcSizes, regenSizes);
+            dBatch  = BMK_timeRecords(BMK_rec_decompressBatch, state, nbRecords, (const char* const*)dsts, cSizes, regens, srcSizes, regenSizes);
+            if (memcmp(srcBuffer, regenBuffer, nbRecords * recordSize))
+                DISPLAY("!!! WARNING !!! %14s : records mode : Invalid decoded data \n", displayName);
+
+            DISPLAYLEVEL(1, "%6u B records :%9u rec ->%10u (%5.3f), comp %7.2f /%7.2f , dec %7.2f /%7.2f \n",
+                    (U32)recordSize, nbRecords, (U32)cSize, (double)(nbRecords*recordSize) / (double)(cSize + !cSize),
+                    1000. / cSingle, 1000. / cBatch, 1000. / dSingle, 1000. / dBatch);
+
+            free((void*)srcs); free(dsts); free(regens);
+            free(srcSizes); free(cRooms); free(cSizes); free(regenSizes);
+            free(cBuffer); free(regenBuffer);
+    }   }
+
+    LZ4_freeStream((LZ4_stream_t*)state);
+}
+
+
+/* BMK_loadDictionary() :
+ * loads the last 64 KB of `fileName`, which is all LZ4 can use.
+ * @return : dictionary buffer, to be freed by caller */
+static char* BMK_loadDictionary(const char* fileName, int* dictSizePtr)
+{
+    U64 const fileSize = UTIL_getFileSize(fileName);
+    size_t const dictSize = (size_t)MIN(fileSize, 64 KB);
+    char* const dict = (char*)malloc(dictSize + !dictSize);
+    FILE* const f = fopen(fileName, "rb");
+
+    if (!dict) EXM_THROW(31, "allocation error : not enough memory");
+    if (f==NULL) EXM_THROW(10, "impossible to open dictionary %s", fileName);
+    if (UTIL_fseek(f, -(long)dictSize, SEEK_END)) EXM_THROW(11, "could not read dictionary %s", fileName);
+    if (fread(dict, 1, dictSize, f) != dictSize) EXM_THROW(11, "could not read dictionary %s", fileName);
+    fclose(f);
+    *dictSizePtr = (int)dictSize;
+    return dict;
+}
+
+/* BMK_benchDictionary() :
+ * each file is a record (cut into -B# bytes pieces if set),
+ * compressed independently, first without dictionary, then with dictionary g_dictionaryFilename.
+ * Compression references the dictionary with LZ4_attach_dictionary(),
+ * decompression uses LZ4_decompress_safe_usingDict(). */
+static void BMK_benchDictionary(const void* srcBuffer, size_t srcSize, const char* displayName,
+                                const size_t* fileSizes, unsigned nbFiles)
+{
+    size_t const maxRecordSize = (g_blockSize >= 32) ? g_blockSize : srcSize;
+    BMK_dictState_t ds;
+    char* const dict = BMK_loadDictionary(g_dictionaryFilename, &ds.dictSize);
+    U32 nbRecords = 0;
+    size_t cRoom = 0, pos = 0;
+    U32 n;
+
+    for (n=0; (n<nbFiles) && (pos<srcSize); n++) {   /* last files may have been cut by memory limits */
+        size_t remaining = MIN(fileSizes[n], srcSize - pos);
+        pos += remaining;
+        while (remaining) {
+            size_t const recordSize = MIN(remaining, maxRecordSize);
+            cRoom += (size_t)LZ4_compressBound((int)recordSize);
+            remaining -= recordSize;
+            nbRecords++;
+    }   }
+    if (nbRecords == 0) EXM_THROW(12, "no data to bench");
+
+    {   const char** const srcs = (const char**)malloc(nbRecords * sizeof(*srcs));
+        char** const dsts = (char**)malloc(nbRecords * sizeof(*dsts));
+        char** const regens = (char**)malloc(nbRecords * sizeof(*regens));
+        int* const srcSizes = (int*)malloc(nbRecords * sizeof(int));
+        int* const cRooms = (int*)malloc(nbRecords * sizeof(int));
+        int* const cSizes = (int*)malloc(nbRecords * sizeof(int));
+        int* const regenSizes = (int*)malloc(nbRecords * sizeof(int));
+        char* const cBuffer = (char*)malloc(cRoom);
+        char* const regenBuffer = (char*)malloc(srcSize);
+        LZ4_stream_t* const workStream = LZ4_createStream();
+        LZ4_stream_t* const dictStream = LZ4_createStream();
+        int withDict;
+
+        if (!srcs || !dsts || !regens || !srcSizes || !cRooms || !cSizes || !regenSizes || !cBuffer || !regenBuffer
+          || !workStream || !dictStream)
+            EXM_THROW(31, "allocation error : not enough memory");
+        LZ4_loadDict(dictStream, dict, ds.dictSize);
+        ds.workStream = workStream;
+        ds.dictStream = dictStream;
+        ds.dict = dict;
+
+        {   size_t srcPos = 0, dstPos = 0;
+            U32 r = 0;
+            for (n=0; (n<nbFiles) && (srcPos<srcSize); n++) {
+                size_t remaining = MIN(fileSizes[n], srcSize - srcPos);
+                while (remaining) {
+                    size_t const recordSize = MIN(remaining, maxRecordSize);
+                    srcs[r] = (const char*)srcBuffer + srcPos;
+                    srcSizes[r] = (int)recordSize;
+                    regens[r] = regenBuffer + srcPos;
+                    dsts[r] = cBuffer + dstPos;
+                    cRooms[r] = LZ4_compressBound((int)recordSize);
+                    srcPos += recordSize;
+                    dstPos += (size_t)cRooms[r];
+                    remaining -= recordSize;
+                    r++;
+        }   }   }
+
+        DISPLAYLEVEL(2, "%s : %u records, average %u bytes, dictionary %s (%i bytes) \n",
+                        displayName, nbRecords, (U32)(srcSize / nbRecords), g_dictionaryFilename, ds.dictSize);
+
+        for (withDict=0; withDict<=1; withDict++) {
+            BMK_recordOp_e const cOp = withDict ? BMK_rec_compressDict : BMK_rec_compress;
+            BMK_recordOp_e const dOp = withDict ? BMK_rec_decompressDict : BMK_rec_decompress;
+            double const cTime = BMK_timeRecords(cOp, &ds, nbRecords, srcs, srcSizes, dsts, cRooms, cSizes);
+            double dTime;
+            size_t cSize = 0;
+            for (n=0; n<nbRecords; n++) cSize += (size_t)cSizes[n];
+            dTime = BMK_timeRecords(dOp, &ds, nbRecords, (const char* const*)dsts, cSizes, regens, srcSizes, regenSizes);
+            if (memcmp(srcBuffer, regenBuffer, srcSize))
+                DISPLAY("!!! WARNING !!! %14s : dictionary mode : Invalid decoded data \n", displayName);
+
+            DISPLAYLEVEL(1, "%s :%10u ->%10u (%5.3f),%8.1f MB/s ,%8.1f MB/s \n",
+                    withDict ? "   dictionary" : "no dictionary", (U32)srcSize, (U32)cSize,
+                    (double)srcSize / (double)(cSize + !cSize),
+                    (double)srcSize * 1000. / (cTime * nbRecords), (double)srcSize * 1000. / (dTime * nbRecords));
+        }
+
+        free((void*)srcs); free(dsts); free(regens);
+        free(srcSizes); free(cRooms); free(cSizes); free(regenSizes);
+        free(cBuffer); free(regenBuffer);
+        LZ4_freeStream(workStream);
+        LZ4_freeStream(dictStream);
+    }
+    free(dict);
+}
+
+
+/* BMK_timeChunked() :
+ * compresses (or decompresses) the whole buffer with the chunked API,
+ * until at least TIMELOOP_MICROSEC has elapsed.
+ * @return : average time per run, in microseconds */
+static double BMK_timeChunked(int decompress, const char* src, size_t srcSize,
+                              char* dst, size_t dstCapacity, int chunkSize, unsigned nbThreads, size_t* resultPtr)
+{
+    U64 const clockLoop = g_nbSeconds ? TIMELOOP_MICROSEC : 1;
+    U32 nbLoops = 0;
+    UTIL_time_t clockStart;
+
+    UTIL_sleepMilli(1);
+    UTIL_waitForNextTick();
+    clockStart = UTIL_getTime();
+    do {
+        if (decompress) {
+            *resultPtr = LZ4_decompress_chunked(src, srcSize, dst, dstCapacity, (int)nbThreads);
+            if (*resultPtr == LZ4_CHUNKED_ERROR) EXM_THROW(1, "LZ4_decompress_chunked() failed");
+        } else {
+            *resultPtr = LZ4_compress_chunked(src, srcSize, dst, dstCapacity, chunkSize, 1, (int)nbThreads);
+            if (*resultPtr == 0) EXM_THROW(1, "LZ4_compress_chunked() failed");
+        }
+        nbLoops++;
+    } while (UTIL_clockSpanMicro(clockStart) < clockLoop);
+
+    return (double)UTIL_clockSpanMicro(clockStart) / nbLoops;
+}
+
+/* BMK_benchChunked() :
+ * measures the chunked API from 1 to g_nbThreads threads (doubling at each step),
+ * and checks that compressed output doesn't depend on nb of threads.
+ * Chunk size is -B#, or, by default, small enough to provide >= 4 chunks per thread (min 64 KB) */
+static void BMK_benchChunked(const void* srcBuffer, size_t srcSize, const char* displayName)
+{
+    int const chunkSize = (g_blockSize >= LZ4_CHUNKED_CHUNKSIZE_MIN) && (g_blockSize <= LZ4_MAX_INPUT_SIZE) ?
+                          (int)g_blockSize :
+                          (int)MAX(64 KB, MIN(LZ4_CHUNKED_CHUNKSIZE_DEFAULT, srcSize / (4 * g_nbThreads)));
+    size_t const bound = LZ4_chunked_compressBound(srcSize, chunkSize);
+    char* const refBuffer = (char*)malloc(bound);
+    char* const cBuffer = (char*)malloc(bound);
+    char* const regenBuffer = (char*)malloc(srcSize);
+    double cRef = 0., dRef = 0.;
+    size_t refSize = 0;
+    unsigned nbThreads = 1;
+
+    if (!refBuffer || !cBuffer || !regenBuffer) EXM_THROW(31, "allocation error : not enough memory");
+    DISPLAYLEVEL(2, "%s : chunked mode, %u KB chunks, scaling from 1 to %u threads \n",
+                    displayName, (U32)(chunkSize >> 10), g_nbThreads);
+
+    for (;;) {
+        char* const dst = (nbThreads==1) ? refBuffer : cBuffer;
+        size_t cSize, dSize;
+        double const cTime = BMK_timeChunked(0, (const char*)srcBuffer, srcSize, dst, bound, chunkSize, nbThreads, &cSize);
+        double const dTime = BMK_timeChunked(1, dst, cSize, regenBuffer, srcSize, chunkSize, nbThreads, &dSize);
+        double const cSpeed = (double)srcSize / cTime;   /* MB/s */
+        double const dSpeed = (double)srcSize / dTime;
+        if (nbThreads==1) { refSize = cSize; cRef = cSpeed; dRef = dSpeed; }
+        else if ((cSize != refSize) || memcmp(refBuffer, cBuffer, cSize))
+            DISPLAY("!!! WARNING !!! %14s : chunked mode : output differs between 1 and %u threads \n", displayName, nbThreads);
+        if ((dSize != srcSize) || memcmp(srcBuffer, regenBuffer, srcSize))
+            DISPLAY("!!! WARNING !!! %14s : chunked mode : Invalid decoded data with %u threads \n", displayName, nbThreads);
+
+        DISPLAYLEVEL(1, "%3u threads :%10u ->%10u (%5.3f),%8.1f MB/s (x%5.2f),%8.1f MB/s (x%5.2f) \n",
+                nbThreads, (U32)srcSize, (U32)cSize, (double)srcSize / (double)cSize,
+                cSpeed, cSpeed / cRef, dSpeed, dSpeed / dRef);
+
+        if (nbThreads >= g_nbThreads) break;
+        nbThreads = MIN(nbThreads*2, g_nbThreads);
+    }
+
+    free(refBuffer);
+    free(cBuffer);
+    free(regenBuffer);
+}
+
+
 static size_t BMK_findMaxMem(U64 requiredMem)
 {
     size_t step = 64 MB;
@@ -381,6 +742,29 @@ static size_t BMK_findMaxMem(U64 requiredMem)
 }
 
 
+/*! BMK_displayPareto() :
+ *  lists levels (and lazy levels) which are not dominated by another one,
+ *  i.e. no other level compresses both better and faster (or as well, for one of them) */
+static void BMK_displayPareto(const BMK_result_t* results, int nbResults)
+{
+    int n;
+    DISPLAYLEVEL(1, "Pareto frontier (ratio vs compression speed) :");
+    for (n=0; n<nbResults; n++) {
+        int m, dominated = 0;
+        for (m=0; m<nbResults; m++) {
+            if (m==n) continue;
+            if ( (results[m].ratio >= results[n].ratio) && (results[m].cSpeed >= results[n].cSpeed)
+              && ((results[m].ratio > results[n].ratio) || (results[m].cSpeed > results[n].cSpeed)) ) {
+                dominated = 1;
+                break;
+        }   }
+        if (dominated) continue;
+        DISPLAYLEVEL(1, " -%i", results[n].cLevel);
+        if (results[n].lazyLevel) DISPLAYLEVEL(1, " --lazy=%u", results[n].lazyLevel);
+    }
+    DISPLAYLEVEL(1, "\n");
+}
+
 static void BMK_benchCLevel(void* srcBuffer, size_t benchedSize,
                             const char* displayName, int cLevel, int cLevelLast,
                             const size_t* fileSizes, unsigned nbFiles)
@@ -396,12 +780,41 @@ static void BMK_benchCLevel(void* srcBuffer, size_t benchedSize,
     if (g_displayLevel == 1 && !g_additionalParam)
         DISPLAY("bench %s %s: input %u bytes, %u seconds, %u KB blocks\n", LZ4_VERSION_STRING, LZ4_GIT_COMMIT_STRING, (U32)benchedSize, g_nbSeconds, (U32)(g_blockSize>>10));
 
+    if (g_dictionaryFilename) {
+        BMK_benchDictionary(srcBuffer, benchedSize, displayName, fileSizes, nbFiles);
+        return;
+    }
+
+    if (g_recordsMode) {
+        BMK_benchRecords(srcBuffer, benchedSize, displayName);
+        return;
+    }
+
+    if (g_nbThreads) {
+        BMK_benchChunked(srcBuffer, benchedSize, displayName);
+        return;
+    }
+
     if (cLevelLast < cLevel) cLevelLast = cLevel;
 
-    for (l=cLevel; l <= cLevelLast; l++) {
-        BMK_benchMem(srcBuffer, benchedSize,
-                     displayName, l,
-                     fileSizes, nbFiles);
+    {   int const nbLevels = cLevelLast - cLevel + 1;
+        /* a range including fast levels also benches both lazy levels, unless one was selected */
+        int const nbLazy = ((nbLevels > 1) && (cLevel < LZ4HC_CLEVEL_MIN) && !g_lazyLevel) ? 2 : 0;
+        BMK_result_t* const results = (BMK_result_t*)malloc((nbLevels + nbLazy) * sizeof(BMK_result_t));
+        unsigned lazyLevel;
+        if (!results) EXM_THROW(31, "allocation error : not enough memory");
+        for (l=cLevel; l <= cLevelLast; l++) {
+            BMK_benchMem(srcBuffer, benchedSize,
+                         displayName, l, (l < LZ4HC_CLEVEL_MIN) ? g_lazyLevel : 0,
+                         fileSizes, nbFiles, results + (l-cLevel));
+        }
+        for (lazyLevel=1; lazyLevel <= (unsigned)nbLazy; lazyLevel++) {
+            BMK_benchMem(srcBuffer, benchedSize,
+                         displayName, cLevel, lazyLevel,
+                         fileSizes, nbFiles, results + nbLevels + (lazyLevel-1));
+        }
+        if (nbLevels > 1) BMK_displayPareto(results, nbLevels + nbLazy);
+        free(results);
     }
 }
 
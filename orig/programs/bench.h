@@ -33,5 +33,9 @@ void BMK_SetNbSeconds(unsigned nbLoops);
 void BMK_SetBlockSize(size_t blockSize);
 void BMK_setAdditionalParam(int additionalParam);
 void BMK_setNotificationLevel(unsigned level);
+void BMK_setRecordsMode(unsigned enabled);   /* bench small independent records : single calls vs batch API */
+void BMK_setNbThreads(unsigned nbThreads);   /* >0 : bench chunked API, scaling from 1 to nbThreads */
+void BMK_setDictionaryFilename(const char* dictionaryFilename);   /* bench each file as a record, with and without dictionary */
+void BMK_setLazyLevel(unsigned lazyLevel);   /* 1 or 2 : levels < LZ4HC_CLEVEL_MIN bench LZ4_compress_lazy() */
 
 #endif   /* BENCH_H_125623623633 */
@@ -52,6 +52,7 @@
 #define AUTHOR "Yann Collet"
 #define WELCOME_MESSAGE "*** %s %i-bits v%s, by %s ***\n", COMPRESSOR_NAME, (int)(sizeof(void*)*8), LZ4_versionString(), AUTHOR
 #define LZ4_EXTENSION ".lz4"
+#define LZ4_DICTIONARY_DEFAULT "dictionary"
 #define LZ4CAT "lz4cat"
 #define UNLZ4 "unlz4"
 #define LZ4_LEGACY "lz4c"
@@ -140,12 +141,23 @@ static int usage_advanced(const char* exeName)
     DISPLAY( "--no-frame-crc : disable stream checksum (default:enabled) \n");
     DISPLAY( "--content-size : compressed frame includes original size (default:not present)\n");
     DISPLAY( "--[no-]sparse  : sparse mode (default:enabled on file, disabled on stdout)\n");
+    DISPLAY( "--favor-decSpeed: compressed files decompress faster, but are less compressed (levels >= 10)\n");
+    DISPLAY( "--lazy[=#]     : fast levels use lazy matching, 1 or 2 (default:2) : slower, compresses more (levels < 3)\n");
+    DISPLAY( "Dictionary builder : \n");
+    DISPLAY( "--train FILEs : create a dictionary from samples FILEs (directories are scanned)\n");
+    DISPLAY( "          dictionary is saved into -D FILE (default: %s) \n", LZ4_DICTIONARY_DEFAULT);
+    DISPLAY( "--maxdict=# : maximum dictionary size (default: 64 KB, which is also the limit) \n");
     DISPLAY( "Benchmark arguments : \n");
     DISPLAY( " -b#    : benchmark file(s), using # compression level (default : 1) \n");
     DISPLAY( " -e#    : test all compression levels from -bX to # (default : 1)\n");
     DISPLAY( " -i#    : minimum evaluation time in seconds (default : 3s) \n");
     DISPLAY( " -B#    : cut file into independent blocks of size # bytes [32+] \n");
     DISPLAY( "                     or predefined block size [4-7] (default: 7) \n");
+    DISPLAY( "--records : cut file into small records, compare records/s of single calls and batch API \n");
+    DISPLAY( "            (record sizes 64 B - 16 KB, or -B# bytes) \n");
+    DISPLAY( " -D FILE: benchmark each file as a record, with and without dictionary FILE \n");
+    DISPLAY( " -T#    : benchmark chunked API, scaling from 1 to # threads \n");
+    DISPLAY( "          (chunk size is -B# bytes, or automatic) \n");
     if (g_lz4c_legacy_commands) {
         DISPLAY( "Legacy arguments : \n");
         DISPLAY( " -c0    : fast compression \n");
@@ -271,7 +283,7 @@ static unsigned readU32FromChar(const char** stringPtr)
     return result;
 }
 
-typedef enum { om_auto, om_compress, om_decompress, om_test, om_bench } operationMode_e;
+typedef enum { om_auto, om_compress, om_decompress, om_test, om_bench, om_train } operationMode_e;
 
 int main(int argc, const char** argv)
 {
@@ -288,6 +300,7 @@ int main(int argc, const char** argv)
     const char* input_filename = NULL;
     const char* output_filename= NULL;
     const char* dictionary_filename = NULL;
+    size_t maxDictSize = 64 KB;
     char* dynNameSpace = NULL;
     const char** inFileNames = (const char**) calloc(argc, sizeof(char*));
     unsigned ifnIdx=0;
@@ -355,12 +368,37 @@ int main(int argc, const char** argv)
                 if (!strcmp(argument,  "--no-content-size")) { LZ4IO_setContentSize(0); continue; }
                 if (!strcmp(argument,  "--sparse")) { LZ4IO_setSparseFile(2); continue; }
                 if (!strcmp(argument,  "--no-sparse")) { LZ4IO_setSparseFile(0); continue; }
+                if (!strcmp(argument,  "--favor-decSpeed")) { LZ4IO_favorDecSpeed(1); continue; }
+                if (!strcmp(argument,  "--lazy")) { LZ4IO_setLazyLevel(2); BMK_setLazyLevel(2); continue; }
                 if (!strcmp(argument,  "--verbose")) { displayLevel++; continue; }
                 if (!strcmp(argument,  "--quiet")) { if (displayLevel) displayLevel--; continue; }
                 if (!strcmp(argument,  "--version")) { DISPLAY(WELCOME_MESSAGE); return 0; }
                 if (!strcmp(argument,  "--help")) { usage_advanced(exeName); goto _cleanup; }
                 if (!strcmp(argument,  "--keep")) { LZ4IO_setRemoveSrcFile(0); continue; }   /* keep source file (default) */
                 if (!strcmp(argument,  "--rm")) { LZ4IO_setRemoveSrcFile(1); continue; }
+                if (!strcmp(argument,  "--records")) { BMK_setRecordsMode(1); continue; }
+                if (!strcmp(argument,  "--train")) {
+                    mode = om_train; multiple_inputs = 1;
+#ifdef UTIL_HAS_CREATEFILELIST
+                    recursive = 1;
+#endif
+                    continue;
+                }
+                if (!strncmp(argument, "--lazy=", 7)) {
+                    unsigned lazyLevel;
+                    argument += 7;
+                    lazyLevel = readU32FromChar(&argument);
+                    if ((*argument != 0) || (lazyLevel > 2)) badusage(exeName);
+                    LZ4IO_setLazyLevel((int)lazyLevel);
+                    BMK_setLazyLevel(lazyLevel);
+                    continue;
+                }
+                if (!strncmp(argument, "--maxdict=", 10)) {
+                    argument += 10;
+                    maxDictSize = readU32FromChar(&argument);
+                    if (*argument != 0) badusage(exeName);
+                    continue;
+                }
             }
 
             while (argument[1]!=0) {
@@ -500,6 +538,16 @@ int main(int argc, const char** argv)
                     }
                     break;
 
+                    /* Nb of threads (benchmark only) */
+                case 'T':
+                    {   unsigned nbThreads;
+                        argument++;
+                        nbThreads = readU32FromChar(&argument);
+                        argument--;
+                        BMK_setNbThreads(nbThreads);
+                    }
+                    break;
+
                     /* Pause at the end (hidden option) */
                 case 'p': main_pause=1; break;
 
@@ -558,9 +606,18 @@ int main(int argc, const char** argv)
 #endif
     }
 
+    /* dictionary training */
+    if (mode == om_train) {
+        LZ4IO_setNotificationLevel(displayLevel);
+        operationResult = LZ4IO_trainDictionary(dictionary_filename ? dictionary_filename : LZ4_DICTIONARY_DEFAULT,
+                                                inFileNames, ifnIdx, maxDictSize);
+        goto _cleanup;
+    }
+
     /* benchmark and test modes */
     if (mode == om_bench) {
         BMK_setNotificationLevel(displayLevel);
+        if (dictionary_filename) BMK_setDictionaryFilename(dictionary_filename);
         operationResult = BMK_benchFiles(inFileNames, ifnIdx, cLevel, cLevelLast);
         goto _cleanup;
     }
@@ -58,6 +58,7 @@
 #include "lz4hc.h"     /* still required for legacy format */
 #include "lz4frame.h"
 #include "lz4frame_static.h"
+#include "lz4dict.h"    /* LZ4_trainFromBuffer */
 
 
 /*****************************
@@ -84,11 +85,14 @@
 #define MIN_STREAM_BUFSIZE (192 KB)
 #define LZ4IO_BLOCKSIZEID_DEFAULT 7
 #define LZ4_MAX_DICT_SIZE (64 KB)
+#define LZ4IO_SAMPLESIZE_MAX  (128 KB)   /* training : only the beginning of larger files is used */
+#define LZ4IO_SAMPLES_MAX     (256 MB)   /* training : total budget for samples */
 
 
 /**************************************
 *  Macros
 **************************************/
+#define MIN(a,b)             ( (a) < (b) ? (a) : (b) )
 #define DISPLAY(...)         fprintf(stderr, __VA_ARGS__)
 #define DISPLAYLEVEL(l, ...) if (g_displayLevel>=l) { DISPLAY(__VA_ARGS__); }
 static int g_displayLevel = 0;   /* 0 : no display  ; 1: errors  ; 2 : + result + interaction + warnings ; 3 : + progression; 4 : + information */
@@ -112,6 +116,8 @@ static int g_streamChecksum = 1;
 static int g_blockIndependence = 1;
 static int g_sparseFileSupport = 1;
 static int g_contentSizeFlag = 0;
+static int g_favorDecSpeed = 0;
+static int g_lazyLevel = 0;
 static int g_useDictionary = 0;
 static const char* g_dictionaryFilename = NULL;
 
@@ -218,6 +224,20 @@ int LZ4IO_setContentSize(int enable)
     return g_contentSizeFlag;
 }
 
+/* Default setting : 0 (disabled) */
+int LZ4IO_favorDecSpeed(int favor)
+{
+    g_favorDecSpeed = (favor!=0);
+    return g_favorDecSpeed;
+}
+
+/* Default setting : 0 (disabled) */
+int LZ4IO_setLazyLevel(int lazyLevel)
+{
+    g_lazyLevel = lazyLevel;
+    return g_lazyLevel;
+}
+
 static U32 g_removeSrcFile = 0;
 void LZ4IO_setRemoveSrcFile(unsigned flag) { g_removeSrcFile = (flag>0); }
 
@@ -539,12 +559,16 @@ static int LZ4IO_compressFilename_extRess(cRess_t ress, const char* srcFileName,
 
 
     /* Set compression parameters */
+    {   LZ4F_errorCode_t const lazyError = LZ4F_setLazyLevel(ctx, (unsigned)g_lazyLevel);
+        if (LZ4F_isError(lazyError)) EXM_THROW(29, "Invalid lazy level : %s", LZ4F_getErrorName(lazyError));
+    }
     prefs.autoFlush = 1;
     prefs.compressionLevel = compressionLevel;
     prefs.frameInfo.blockMode = (LZ4F_blockMode_t)g_blockIndependence;
     prefs.frameInfo.blockSizeID = (LZ4F_blockSizeID_t)g_blockSizeId;
     prefs.frameInfo.blockChecksumFlag = (LZ4F_blockChecksum_t)g_blockChecksum;
     prefs.frameInfo.contentChecksumFlag = (LZ4F_contentChecksum_t)g_streamChecksum;
+    prefs.favorDecSpeed = (unsigned)g_favorDecSpeed;
     if (g_contentSizeFlag) {
       U64 const fileSize = UTIL_getFileSize(srcFileName);
       prefs.frameInfo.contentSize = fileSize;   /* == 0 if input == stdin */
@@ -557,8 +581,8 @@ static int LZ4IO_compressFilename_extRess(cRess_t ress, const char* srcFileName,
     if (ferror(srcFile)) EXM_THROW(30, "Error reading %s ", srcFileName);
     filesize += readSize;
 
-    /* single-block file */
-    if (readSize < blockSize) {
+    /* single-block file (lazy level requires a context : streaming path) */
+    if ((readSize < blockSize) && !g_lazyLevel) {
         /* Compress in single pass */
         size_t cSize = LZ4F_compressFrame_usingCDict(dstBuffer, dstBufferSize, srcBuffer, readSize, ress.cdict, &prefs);
         if (LZ4F_isError(cSize)) EXM_THROW(31, "Compression failed : %s", LZ4F_getErrorName(cSize));
@@ -683,6 +707,68 @@ int LZ4IO_compressMultipleFilenames(const char** inFileNamesTable, int ifntSize,
 }
 
 
+/* ********************************************************************* */
+/* ********************** Dictionary training ************************** */
+/* ********************************************************************* */
+
+int LZ4IO_trainDictionary(const char* dictFileName, const char** srcFileNames, unsigned nbFiles, size_t maxDictSize)
+{
+    size_t bufferSize = 0;
+    size_t totalSize = 0;
+    unsigned nbSamples = 0;
+    unsigned nbFilesUsed = nbFiles;
+    unsigned u;
+    char* samples;
+    size_t* samplesSizes;
+    void* dictBuffer;
+    size_t dictSize;
+    FILE* dstFile;
+
+    if (maxDictSize > LZ4_MAX_DICT_SIZE) maxDictSize = LZ4_MAX_DICT_SIZE;
+    for (u=0; u<nbFiles; u++) {
+        U64 const fileSize = UTIL_getFileSize(srcFileNames[u]);
+        bufferSize += (size_t)MIN(fileSize, LZ4IO_SAMPLESIZE_MAX);
+        if (bufferSize >= LZ4IO_SAMPLES_MAX) { bufferSize = LZ4IO_SAMPLES_MAX; nbFilesUsed = u+1; break; }
+    }
+    samples = (char*)malloc(bufferSize ? bufferSize : 1);
+    samplesSizes = (size_t*)malloc((nbFiles ? nbFiles : 1) * sizeof(size_t));
+    dictBuffer = malloc(maxDictSize ? maxDictSize : 1);
+    if (!samples || !samplesSizes || !dictBuffer) EXM_THROW(80, "Allocation error : not enough memory");
+
+    /* load samples */
+    for (u=0; u<nbFilesUsed; u++) {
+        size_t const toRead = MIN(bufferSize - totalSize, LZ4IO_SAMPLESIZE_MAX);
+        FILE* const srcFile = LZ4IO_openSrcFile(srcFileNames[u]);
+        if (srcFile == NULL) continue;
+        samplesSizes[nbSamples] = fread(samples + totalSize, 1, toRead, srcFile);
+        fclose(srcFile);
+        if (samplesSizes[nbSamples] == 0) continue;
+        DISPLAYUPDATE(2, "\rLoading sample %u : %s        ", nbSamples+1, srcFileNames[u]);
+        totalSize += samplesSizes[nbSamples++];
+    }
+    DISPLAYLEVEL(2, "\r%79s\r", "");
+    if (nbFilesUsed < nbFiles) DISPLAYLEVEL(2, "Warning : samples budget exhausted, only %u files out of %u are used \n", nbFilesUsed, nbFiles);
+    if (nbSamples == 0) EXM_THROW(81, "Dictionary error : no sample to train from");
+    DISPLAYLEVEL(3, "Training on %u samples (%u KB) \n", nbSamples, (unsigned)(totalSize >> 10));
+
+    dictSize = LZ4_trainFromBuffer(dictBuffer, maxDictSize, samples, samplesSizes, nbSamples);
+    if (dictSize == 0) EXM_THROW(82, "Dictionary error : training failed (samples too small or too different ?)");
+
+    /* save dictionary */
+    dstFile = LZ4IO_openDstFile(dictFileName);
+    if (dstFile == NULL) EXM_THROW(83, "Dictionary error : cannot create %s", dictFileName);
+    if (fwrite(dictBuffer, 1, dictSize, dstFile) != dictSize) EXM_THROW(84, "Write error : cannot write dictionary into %s", dictFileName);
+    if (fclose(dstFile)) EXM_THROW(85, "Write error : cannot properly close %s", dictFileName);
+    DISPLAYLEVEL(2, "Dictionary of %u bytes, trained on %u samples (%u bytes), saved into %s \n",
+                    (unsigned)dictSize, nbSamples, (unsigned)totalSize, dictFileName);
+
+    free(samples);
+    free(samplesSizes);
+    free(dictBuffer);
+    return 0;
+}
+
+
 /* ********************************************************************* */
 /* ********************** LZ4 file-stream Decompression **************** */
 /* ********************************************************************* */
@@ -59,6 +59,12 @@ int LZ4IO_decompressFilename(const char* input_filename, const char* output_file
 int LZ4IO_compressMultipleFilenames(const char** inFileNamesTable, int ifntSize, const char* suffix, int compressionlevel);
 int LZ4IO_decompressMultipleFilenames(const char** inFileNamesTable, int ifntSize, const char* suffix);
 
+/* LZ4IO_trainDictionary() :
+   trains a dictionary of at most maxDictSize bytes (capped at 64 KB) from files srcFileNames,
+   each file being a sample, and saves it into dictFileName.
+   return : 0 if success, !=0 if error */
+int LZ4IO_trainDictionary(const char* dictFileName, const char** srcFileNames, unsigned nbFiles, size_t maxDictSize);
+
 
 /* ************************************************** */
 /* ****************** Parameters ******************** */
@@ -97,6 +103,12 @@ int LZ4IO_setSparseFile(int enable);
 /* Default setting : 0 (disabled) */
 int LZ4IO_setContentSize(int enable);
 
+/* Default setting : 0 (disabled) */
+int LZ4IO_favorDecSpeed(int favor);
+
+/* Default setting : 0 (disabled) ; 1 or 2 : lazy matching for levels < 3 */
+int LZ4IO_setLazyLevel(int lazyLevel);
+
 void LZ4IO_setRemoveSrcFile(unsigned flag);
 
 
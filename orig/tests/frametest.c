@@ -167,6 +167,51 @@ static unsigned FUZ_highbit(U32 v32)
 #define CHECK_V(v,f) v = f; if (LZ4F_isError(v)) goto _output_error
 #define CHECK(f)   { LZ4F_errorCode_t const CHECK_V(err_ , f); }
 
+/* FUZ_compressStream() :
+ * compresses `src` as a single frame, feeding it in random segment sizes.
+ * @return : frame size, or an error code */
+static size_t FUZ_compressStream(LZ4F_cctx* cctx, void* dst, size_t dstCapacity,
+                                 const void* src, size_t srcSize,
+                                 const LZ4F_CDict* cdict, const LZ4F_preferences_t* prefsPtr,
+                                 U32* randState)
+{
+    const BYTE* ip = (const BYTE*)src;
+    const BYTE* const iend = ip + srcSize;
+    BYTE* const ostart = (BYTE*)dst;
+    BYTE* op = ostart;
+    BYTE* const oend = ostart + dstCapacity;
+    size_t r = LZ4F_compressBegin_usingCDict(cctx, op, oend-op, cdict, prefsPtr);
+    if (LZ4F_isError(r)) return r;
+    op += r;
+    while (ip < iend) {
+        size_t const segmentSize = (FUZ_rand(randState) % (192 KB)) + 1;
+        size_t const iSize = MIN(segmentSize, (size_t)(iend-ip));
+        r = LZ4F_compressUpdate(cctx, op, oend-op, ip, iSize, NULL);
+        if (LZ4F_isError(r)) return r;
+        op += r;
+        ip += iSize;
+    }
+    r = LZ4F_compressEnd(cctx, op, oend-op, NULL);
+    if (LZ4F_isError(r)) return r;
+    op += r;
+    return op - ostart;
+}
+
+/* counting allocator, for LZ4F_CustomMem tests */
+typedef struct { unsigned nbAllocs; unsigned nbFrees; } FUZ_allocCounter;
+
+static void* FUZ_countingAlloc(void* opaque, size_t size)
+{
+    ((FUZ_allocCounter*)opaque)->nbAllocs++;
+    return malloc(size);
+}
+
+static void FUZ_countingFree(void* opaque, void* address)
+{
+    ((FUZ_allocCounter*)opaque)->nbFrees++;
+    free(address);
+}
+
 int basicTests(U32 seed, double compressibility)
 {
 #define COMPRESSIBLE_NOISE_LENGTH (2 MB)
@@ -227,6 +272,46 @@ int basicTests(U32 seed, double compressibility)
         DISPLAYLEVEL(3, "Compressed %u bytes into a %u bytes frame \n", (U32)testSize, (U32)cSize);
     }
 
+    DISPLAYLEVEL(3, "LZ4F_compressFrame, level 2 identical to level 1 : ");
+    {   size_t const srcSize = 256 KB;
+        size_t const dstCapacity = LZ4F_compressFrameBound(srcSize, NULL);
+        size_t cSizeLevel1;
+        LZ4F_preferences_t levelPrefs;
+        memset(&levelPrefs, 0, sizeof(levelPrefs));
+        levelPrefs.compressionLevel = 1;
+        CHECK_V(cSizeLevel1, LZ4F_compressFrame(compressedBuffer, dstCapacity, CNBuffer, srcSize, &levelPrefs));
+        levelPrefs.compressionLevel = 2;
+        CHECK_V(cSize, LZ4F_compressFrame(decodedBuffer, dstCapacity, CNBuffer, srcSize, &levelPrefs));
+        if ((cSize != cSizeLevel1) || memcmp(compressedBuffer, decodedBuffer, cSize)) goto _output_error;
+        DISPLAYLEVEL(3, "OK \n");
+    }
+
+    DISPLAYLEVEL(3, "LZ4F_setLazyLevel, round trip, level 2 compresses more : ");
+    {   size_t const srcSize = 256 KB;
+        size_t const dstCapacity = LZ4F_compressFrameBound(srcSize, NULL);
+        U64 const crcSrc = XXH64(CNBuffer, srcSize, 0);
+        size_t fastSize = 0;
+        unsigned lazyLevel;
+        LZ4F_preferences_t levelPrefs;
+        memset(&levelPrefs, 0, sizeof(levelPrefs));
+        levelPrefs.compressionLevel = 1;
+        CHECK( LZ4F_createCompressionContext(&cctx, LZ4F_VERSION) );
+        if (!LZ4F_isError(LZ4F_setLazyLevel(cctx, 3))) goto _output_error;
+        for (lazyLevel=0; lazyLevel<=2; lazyLevel++) {
+            CHECK( LZ4F_setLazyLevel(cctx, lazyLevel) );
+            CHECK_V(cSize, FUZ_compressStream(cctx, compressedBuffer, dstCapacity, CNBuffer, srcSize, NULL, &levelPrefs, &randState));
+            if (lazyLevel == 0) fastSize = cSize;
+            if ((lazyLevel == 2) && (cSize >= fastSize)) goto _output_error;   /* level 1 may not, on noisy data */
+            {   size_t dSize;
+                CHECK_V(dSize, LZ4F_decompressFrame(decodedBuffer, COMPRESSIBLE_NOISE_LENGTH, compressedBuffer, cSize, NULL, 0));
+                if ((dSize != srcSize) || (XXH64(decodedBuffer, dSize, 0) != crcSrc)) goto _output_error;
+            }
+            DISPLAYLEVEL(3, "%u ", (U32)cSize);
+        }
+        CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+        DISPLAYLEVEL(3, "\n");
+    }
+
     DISPLAYLEVEL(3, "LZ4F_compressFrame, using default preferences : ");
     CHECK_V(cSize, LZ4F_compressFrame(compressedBuffer, LZ4F_compressFrameBound(testSize, NULL), CNBuffer, testSize, NULL));
     DISPLAYLEVEL(3, "Compressed %u bytes into a %u bytes frame \n", (U32)testSize, (U32)cSize);
@@ -646,9 +731,701 @@ int basicTests(U32 seed, double compressibility)
             }
         }
 
+        DISPLAYLEVEL(3, "LZ4F_compressBegin_usingCDict, onto a cctx just used without dictionary : \n");
+        {   /* 64 KB period : no match for the first frame, and stale table entries, were they still used, would find plenty */
+            size_t const periodicSize = COMPRESSIBLE_NOISE_LENGTH;
+            size_t const inSize = 100 KB;
+            BYTE* const periodic = (BYTE*)malloc(periodicSize);
+            unsigned config;
+            if (periodic == NULL) goto _output_error;
+            memcpy(periodic, (const BYTE*)CNBuffer + 1 MB, 64 KB);
+            { size_t n; for (n = 64 KB; n < periodicSize; n++) periodic[n] = periodic[n - 64 KB]; }
+            CHECK( LZ4F_createCompressionContext(&cctx, LZ4F_VERSION) );
+            for (config=0; config<8; config++) {
+                LZ4F_preferences_t cParams;
+                size_t cSizeDict, decodedSize = COMPRESSIBLE_NOISE_LENGTH, compressedSize;
+                int failed = 0;
+                memset(&cParams, 0, sizeof(cParams));
+                cParams.compressionLevel = (config & 2) ? 9 : 0;
+                cParams.frameInfo.blockMode = (config & 1) ? LZ4F_blockIndependent : LZ4F_blockLinked;
+                cParams.nbWorkers = (config & 4) ? 2 : 0;   /* job contexts are reused across frames too */
+                DISPLAYLEVEL(3, "%s blocks, level %i, %u workers : ",
+                            (config & 1) ? "independent" : "linked", cParams.compressionLevel, cParams.nbWorkers);
+                /* first frame : a single large block, without dictionary */
+                cParams.frameInfo.blockSizeID = LZ4F_max4MB;
+                if (LZ4F_isError(FUZ_compressStream(cctx, compressedBuffer, cBuffSize, periodic, periodicSize, NULL, &cParams, &randState)))
+                    failed = 1;
+                /* second frame : same cctx, with dictionary */
+                cSizeDict = FUZ_compressStream(cctx, compressedBuffer, cBuffSize, periodic + 64 KB, inSize, cdict, &cParams, &randState);
+                if (LZ4F_isError(cSizeDict)) failed = 1;
+                if (!failed) {
+                    LZ4F_dctx* dctx;
+                    compressedSize = cSizeDict;
+                    CHECK( LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION) );
+                    if ( LZ4F_isError(LZ4F_decompress_usingDict(dctx, decodedBuffer, &decodedSize,
+                                                                compressedBuffer, &compressedSize,
+                                                                CNBuffer, dictSize, NULL))
+                      || (compressedSize != cSizeDict) || (decodedSize != inSize)
+                      || memcmp(decodedBuffer, periodic + 64 KB, inSize) )
+                        failed = 1;
+                    LZ4F_freeDecompressionContext(dctx);
+                }
+                if (failed) { free(periodic); goto _output_error; }
+                DISPLAYLEVEL(3, "OK \n");
+            }
+            CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+            free(periodic);
+        }
+
         LZ4F_freeCDict(cdict);
     }
 
+    DISPLAYLEVEL(3, "Multi-threaded compression, identical to single job : \n");
+    {   size_t const mtSrcSize = COMPRESSIBLE_NOISE_LENGTH/2 + 777;   /* last block is partial */
+        size_t const dictSize = 63 KB;
+        size_t const mtDstCapacity = LZ4F_compressFrameBound(mtSrcSize, NULL) + 64 KB;
+        void* const refBuffer = malloc(mtDstCapacity);
+        void* const mtBuffer = malloc(mtDstCapacity);
+        const BYTE* const mtSrc = (const BYTE*)CNBuffer + dictSize;
+        LZ4F_CDict* const cdict = LZ4F_createCDict(CNBuffer, dictSize);
+        U64 const crcSrc = XXH64(mtSrc, mtSrcSize, 0);
+        unsigned config;
+        if (!refBuffer || !mtBuffer || !cdict) {
+            free(refBuffer); free(mtBuffer); LZ4F_freeCDict(cdict);
+            goto _output_error;
+        }
+        CHECK( LZ4F_createCompressionContext(&cctx, LZ4F_VERSION) );
+        for (config=0; config<32; config++) {
+            LZ4F_blockMode_t const blockMode = (config & 1) ? LZ4F_blockIndependent : LZ4F_blockLinked;
+            unsigned const favorDecSpeed = (config >> 3) & 1;
+            int const level = (config & 2) ? (favorDecSpeed ? 11 : 9) : 0;
+            unsigned const lazyLevel = (favorDecSpeed && (level < 3)) ? 1 + ((config >> 4) & 1) : 0;   /* fast levels : lazy one instead */
+            const LZ4F_CDict* const mtDict = (config & 4) ? cdict : NULL;
+            size_t refSize, mtSize, decodedSize = COMPRESSIBLE_NOISE_LENGTH, compressedSize;
+            int failed = 0;
+            if ((config & 16) && !lazyLevel) continue;   /* bit 4 only selects lazy level */
+            DISPLAYLEVEL(3, "%s blocks, level %i%s, %s dictionary : ",
+                        (blockMode==LZ4F_blockLinked) ? "linked" : "independent", level,
+                        lazyLevel ? ((lazyLevel == 1) ? " (lazy 1)" : " (lazy 2)") : (favorDecSpeed ? " (favorDecSpeed)" : ""),
+                        mtDict ? "with" : "no");
+            CHECK( LZ4F_setLazyLevel(cctx, lazyLevel) );
+            memset(&prefs, 0, sizeof(prefs));
+            prefs.frameInfo.blockMode = blockMode;
+            prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+            prefs.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+            prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+            prefs.compressionLevel = level;
+            prefs.favorDecSpeed = favorDecSpeed;
+            prefs.nbWorkers = 1;
+            refSize = FUZ_compressStream(cctx, refBuffer, mtDstCapacity, mtSrc, mtSrcSize, mtDict, &prefs, &randState);
+            if (LZ4F_isError(refSize)) failed = 1;
+
+            prefs.nbWorkers = 4;
+            mtSize = FUZ_compressStream(cctx, mtBuffer, mtDstCapacity, mtSrc, mtSrcSize, mtDict, &prefs, &randState);
+            if (LZ4F_isError(mtSize) || (mtSize != refSize) || memcmp(mtBuffer, refBuffer, refSize)) failed = 1;
+
+            prefs.nbWorkers = 3; prefs.nbBlocksInFlight = 7;
+            mtSize = FUZ_compressStream(cctx, mtBuffer, mtDstCapacity, mtSrc, mtSrcSize, mtDict, &prefs, &randState);
+            if (LZ4F_isError(mtSize) || (mtSize != refSize) || memcmp(mtBuffer, refBuffer, refSize)) failed = 1;
+
+            prefs.nbWorkers = 2; prefs.nbBlocksInFlight = 0;
+            if (lazyLevel)   /* one-shot compression doesn't use lazy levels */
+                mtSize = FUZ_compressStream(cctx, mtBuffer, mtDstCapacity, mtSrc, mtSrcSize, mtDict, &prefs, &randState);
+            else
+                mtSize = LZ4F_compressFrame_usingCDict(mtBuffer, mtDstCapacity, mtSrc, mtSrcSize, mtDict, &prefs);
+            if (LZ4F_isError(mtSize) || (mtSize != refSize) || memcmp(mtBuffer, refBuffer, refSize)) failed = 1;
+
+            if (blockMode == LZ4F_blockIndependent) {
+                prefs.nbWorkers = 0;   /* independent blocks : also identical to single-threaded compression */
+                if (lazyLevel)
+                    mtSize = FUZ_compressStream(cctx, mtBuffer, mtDstCapacity, mtSrc, mtSrcSize, mtDict, &prefs, &randState);
+                else
+                    mtSize = LZ4F_compressFrame_usingCDict(mtBuffer, mtDstCapacity, mtSrc, mtSrcSize, mtDict, &prefs);
+                if (LZ4F_isError(mtSize) || (mtSize != refSize) || memcmp(mtBuffer, refBuffer, refSize)) failed = 1;
+            }
+
+            if (!failed) {
+                LZ4F_dctx* dctx;
+                compressedSize = refSize;
+                CHECK( LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION) );
+                if ( LZ4F_isError(LZ4F_decompress_usingDict(dctx, decodedBuffer, &decodedSize,
+                                                            refBuffer, &compressedSize,
+                                                            CNBuffer, dictSize, NULL))
+                  || (compressedSize != refSize) || (decodedSize != mtSrcSize)
+                  || (XXH64(decodedBuffer, decodedSize, 0) != crcSrc) )
+                    failed = 1;
+                LZ4F_freeDecompressionContext(dctx);
+            }
+            if (failed) {
+                free(refBuffer); free(mtBuffer); LZ4F_freeCDict(cdict);
+                goto _output_error;
+            }
+            DISPLAYLEVEL(3, "%u bytes \n", (unsigned)refSize);
+        }
+        CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+        free(refBuffer); free(mtBuffer); LZ4F_freeCDict(cdict);
+    }
+
+
+    DISPLAYLEVEL(3, "LZ4F_decompressFrame_parallel : \n");
+    {   size_t const pSrcSize = COMPRESSIBLE_NOISE_LENGTH - 1000;
+        size_t const dictSize = 1000;
+        const BYTE* const pSrc = (const BYTE*)CNBuffer + dictSize;
+        size_t const pDstCapacity = LZ4F_compressFrameBound(pSrcSize, NULL) + 64 KB;
+        BYTE* const pBuffer = (BYTE*)malloc(pDstCapacity);
+        U64 const crcSrc = XXH64(pSrc, pSrcSize, 0);
+        size_t pSize, srcSize, dSize;
+        if (pBuffer == NULL) goto _output_error;
+
+        DISPLAYLEVEL(3, "independent blocks, with checksums : ");
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+        prefs.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        prefs.frameInfo.contentSize = pSrcSize;
+        CHECK_V(pSize, LZ4F_compressFrame(pBuffer, pDstCapacity, pSrc, pSrcSize, &prefs));
+        {   unsigned nbThreads;
+            for (nbThreads=1; nbThreads<=4; nbThreads+=3) {
+                srcSize = pDstCapacity;   /* frame followed by garbage : only frame is consumed */
+                memset(decodedBuffer, 0, pSrcSize);
+                CHECK_V(dSize, LZ4F_decompressFrame_parallel(decodedBuffer, pSrcSize, pBuffer, &srcSize, NULL, 0, nbThreads));
+                if ((dSize != pSrcSize) || (srcSize != pSize)) goto _output_error;
+                if (XXH64(decodedBuffer, dSize, 0) != crcSrc) goto _output_error;
+        }   }
+        DISPLAYLEVEL(3, "OK \n");
+
+        DISPLAYLEVEL(3, "successive frames, threads kept within dctx : ");
+        {   LZ4F_dctx* pdctx;
+            unsigned n;
+            CHECK( LZ4F_createDecompressionContext(&pdctx, LZ4F_VERSION) );
+            for (n=0; n<6; n++) {
+                unsigned const nbThreads = (n < 3) ? 4 : 2;   /* changing nbThreads re-creates threads */
+                srcSize = pSize;
+                memset(decodedBuffer, 0, pSrcSize);
+                dSize = LZ4F_decompressFrame_parallel_usingDCtx(pdctx, decodedBuffer, pSrcSize, pBuffer, &srcSize, NULL, 0, nbThreads);
+                if ((dSize != pSrcSize) || (srcSize != pSize)) { LZ4F_freeDecompressionContext(pdctx); goto _output_error; }
+                if (XXH64(decodedBuffer, dSize, 0) != crcSrc) { LZ4F_freeDecompressionContext(pdctx); goto _output_error; }
+            }
+            CHECK( LZ4F_freeDecompressionContext(pdctx) );
+        }
+        DISPLAYLEVEL(3, "OK \n");
+
+        DISPLAYLEVEL(3, "corrupted block is detected : ");
+        pBuffer[pSize/2] ^= 1;
+        srcSize = pSize;
+        dSize = LZ4F_decompressFrame_parallel(decodedBuffer, pSrcSize, pBuffer, &srcSize, NULL, 0, 4);
+        if (!LZ4F_isError(dSize)) goto _output_error;
+        pBuffer[pSize/2] ^= 1;
+        DISPLAYLEVEL(3, "%s \n", LZ4F_getErrorName(dSize));
+
+        DISPLAYLEVEL(3, "dst buffer too small : ");
+        srcSize = pSize;
+        dSize = LZ4F_decompressFrame_parallel(decodedBuffer, pSrcSize-1, pBuffer, &srcSize, NULL, 0, 4);
+        if (!LZ4F_isError(dSize)) goto _output_error;
+        DISPLAYLEVEL(3, "%s \n", LZ4F_getErrorName(dSize));
+
+        DISPLAYLEVEL(3, "LZ4F_decompressFrame, one shot : ");
+        memset(decodedBuffer, 0, pSrcSize);
+        CHECK_V(dSize, LZ4F_decompressFrame(decodedBuffer, pSrcSize, pBuffer, pDstCapacity, NULL, 0));   /* trailing data is ignored */
+        if ((dSize != pSrcSize) || (XXH64(decodedBuffer, dSize, 0) != crcSrc)) goto _output_error;
+        {   size_t cut;   /* truncated frames are detected */
+            for (cut = 1; cut < 16; cut++) {
+                dSize = LZ4F_decompressFrame(decodedBuffer, pSrcSize, pBuffer, pSize - cut, NULL, 0);
+                if (!LZ4F_isError(dSize)) goto _output_error;
+        }   }
+        pBuffer[pSize/2] ^= 1;
+        dSize = LZ4F_decompressFrame(decodedBuffer, pSrcSize, pBuffer, pSize, NULL, 0);
+        pBuffer[pSize/2] ^= 1;
+        if (!LZ4F_isError(dSize)) goto _output_error;
+        DISPLAYLEVEL(3, "OK \n");
+
+        DISPLAYLEVEL(3, "LZ4F_decompressFrame_deferredCheck : ");
+        {   LZ4F_checksumJob* job;
+            memset(decodedBuffer, 0, pSrcSize);
+            CHECK_V(dSize, LZ4F_decompressFrame_deferredCheck(&job, decodedBuffer, pSrcSize, pBuffer, pSize, NULL, 0));
+            if ((dSize != pSrcSize) || (job == NULL)) goto _output_error;
+            if (XXH64(decodedBuffer, dSize, 0) != crcSrc) goto _output_error;
+            CHECK( LZ4F_checksumJob_wait(job) );
+            pBuffer[pSize-1] ^= 1;   /* corrupted content checksum : only reported by wait */
+            CHECK_V(dSize, LZ4F_decompressFrame_deferredCheck(&job, decodedBuffer, pSrcSize, pBuffer, pSize, NULL, 0));
+            pBuffer[pSize-1] ^= 1;
+            if (!LZ4F_isError(LZ4F_checksumJob_wait(job))) goto _output_error;
+            pBuffer[pSize/2] ^= 1;   /* corrupted block : reported immediately */
+            dSize = LZ4F_decompressFrame_deferredCheck(&job, decodedBuffer, pSrcSize, pBuffer, pSize, NULL, 0);
+            pBuffer[pSize/2] ^= 1;
+            if (!LZ4F_isError(dSize) || (job != NULL)) goto _output_error;
+        }
+        DISPLAYLEVEL(3, "OK \n");
+
+        /* incompressible segments, flushed : creates short and uncompressed blocks, within dictionary range */
+        {   BYTE* const noisy = (BYTE*)malloc(pSrcSize);
+            size_t const noiseSize = 20 KB;
+            LZ4F_blockMode_t blockMode;
+            if (noisy == NULL) { free(pBuffer); goto _output_error; }
+            memcpy(noisy, pSrc, pSrcSize);
+            FUZ_fillCompressibleNoiseBuffer(noisy, noiseSize, 0.0, &randState);
+            FUZ_fillCompressibleNoiseBuffer(noisy + 2*noiseSize, noiseSize, 0.0, &randState);
+            CHECK( LZ4F_createCompressionContext(&cctx, LZ4F_VERSION) );
+            for (blockMode=LZ4F_blockLinked; blockMode<=LZ4F_blockIndependent; blockMode=(LZ4F_blockMode_t)(blockMode+1)) {
+                size_t const cuts[5] = { 0, noiseSize, 2*noiseSize, 3*noiseSize, pSrcSize };
+                const BYTE* const dict = noisy + 3*noiseSize;   /* referenced by last segment */
+                LZ4F_CDict* const cdict = LZ4F_createCDict(dict, dictSize);
+                BYTE* op = pBuffer;
+                int c;
+                DISPLAYLEVEL(3, "%s blocks, with flushes and dictionary : ",
+                            (blockMode==LZ4F_blockLinked) ? "linked" : "independent");
+                memset(&prefs, 0, sizeof(prefs));
+                prefs.frameInfo.blockMode = blockMode;
+                prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+                prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+                prefs.compressionLevel = 9;   /* HC keeps referencing dictionary beyond first block */
+                CHECK_V(pSize, LZ4F_compressBegin_usingCDict(cctx, op, pDstCapacity, cdict, &prefs));
+                op += pSize;
+                for (c=0; c<4; c++) {
+                    CHECK_V(pSize, LZ4F_compressUpdate(cctx, op, pDstCapacity - (op-pBuffer), noisy + cuts[c], cuts[c+1] - cuts[c], NULL));
+                    op += pSize;
+                    CHECK_V(pSize, LZ4F_flush(cctx, op, pDstCapacity - (op-pBuffer), NULL));
+                    op += pSize;
+                }
+                CHECK_V(pSize, LZ4F_compressEnd(cctx, op, pDstCapacity - (op-pBuffer), NULL));
+                op += pSize;
+                pSize = op - pBuffer;
+                LZ4F_freeCDict(cdict);
+
+                srcSize = pSize;
+                CHECK_V(dSize, LZ4F_decompressFrame_parallel(decodedBuffer, pSrcSize, pBuffer, &srcSize, dict, dictSize, 4));
+                if ((dSize != pSrcSize) || (srcSize != pSize)) goto _output_error;
+                if (memcmp(decodedBuffer, noisy, pSrcSize)) goto _output_error;
+                memset(decodedBuffer, 0, pSrcSize);
+                CHECK_V(dSize, LZ4F_decompressFrame(decodedBuffer, pSrcSize, pBuffer, pSize, dict, dictSize));
+                if ((dSize != pSrcSize) || memcmp(decodedBuffer, noisy, pSrcSize)) goto _output_error;
+                DISPLAYLEVEL(3, "OK \n");
+            }
+            CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+            free(noisy);
+        }
+        free(pBuffer);
+    }
+
+
+    DISPLAYLEVEL(3, "directDst decompression into a ring buffer : ");
+    {   size_t const dictSize = 1000;
+        size_t const rSrcSize = COMPRESSIBLE_NOISE_LENGTH - dictSize;
+        size_t const ringSize = 64 KB + 64 KB;   /* history + max block size */
+        size_t const rDstCapacity = LZ4F_compressFrameBound(rSrcSize, NULL) + 64 KB;
+        BYTE* const rSrc = (BYTE*)malloc(rSrcSize);
+        BYTE* const rBuffer = (BYTE*)malloc(rDstCapacity);
+        BYTE* const ring = (BYTE*)malloc(ringSize);
+        LZ4F_CDict* const cdict = LZ4F_createCDict(CNBuffer, dictSize);
+        LZ4F_decompressOptions_t dOptions;
+        const BYTE* ip;
+        size_t rSize, ringPos = 0, totalOut = 0, result = 1;
+        if (!rSrc || !rBuffer || !ring || !cdict) {
+            free(rSrc); free(rBuffer); free(ring); LZ4F_freeCDict(cdict);
+            goto _output_error;
+        }
+        memcpy(rSrc, (const BYTE*)CNBuffer + dictSize, rSrcSize);
+        FUZ_fillCompressibleNoiseBuffer(rSrc + 320 KB, 64 KB, 0.0, &randState);   /* uncompressed block */
+        memcpy(rSrc + 390 KB, rSrc + 340 KB, 30 KB);   /* referenced by next block */
+
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.blockMode = LZ4F_blockLinked;
+        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        CHECK_V(rSize, LZ4F_compressFrame_usingCDict(rBuffer, rDstCapacity, rSrc, rSrcSize, cdict, &prefs));
+        LZ4F_freeCDict(cdict);
+
+        memset(&dOptions, 0, sizeof(dOptions));
+        dOptions.directDst = 1;
+        CHECK( LZ4F_createDecompressionContext(&dCtx, LZ4F_VERSION) );
+        ip = rBuffer;
+        while (ip < rBuffer + rSize) {
+            size_t const segmentSize = (FUZ_rand(&randState) % (100 KB)) + 1;
+            size_t iSize = MIN(segmentSize, (size_t)(rBuffer + rSize - ip));
+            size_t oSize;
+            if (ringSize - ringPos < 64 KB) ringPos = 0;   /* not enough room for a full block : restart at beginning of ring */
+            oSize = ringSize - ringPos;
+            CHECK_V(result, LZ4F_decompress_usingDict(dCtx, ring + ringPos, &oSize, ip, &iSize, CNBuffer, dictSize, &dOptions));
+            if ((totalOut + oSize > rSrcSize) || memcmp(ring + ringPos, rSrc + totalOut, oSize)) {
+                DISPLAYLEVEL(1, "corruption at position %u \n", (unsigned)totalOut);
+                result = 1;
+                break;
+            }
+            ringPos += oSize;
+            totalOut += oSize;
+            ip += iSize;
+        }
+        CHECK( LZ4F_freeDecompressionContext(dCtx) ); dCtx = NULL;
+        free(rSrc); free(rBuffer); free(ring);
+        if ((result != 0) || (totalOut != rSrcSize)) goto _output_error;
+        DISPLAYLEVEL(3, "OK \n");
+    }
+
+
+    DISPLAYLEVEL(3, "small input feeds, switching stableDst : ");
+    {   size_t const sSrcSize = 192 KB;
+        BYTE* const dst = (BYTE*)decodedBuffer;
+        const BYTE* ip = (const BYTE*)compressedBuffer;
+        const BYTE* iend;
+        size_t totalOut = 0, result = 1;
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.blockMode = LZ4F_blockLinked;
+        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        CHECK_V(cSize, LZ4F_compressFrame(compressedBuffer, cBuffSize, CNBuffer, sSrcSize, &prefs));
+        iend = ip + cSize;
+        CHECK( LZ4F_createDecompressionContext(&dCtx, LZ4F_VERSION) );
+        while (ip < iend) {
+            size_t const feedSize = (FUZ_rand(&randState) % 200) + 1;
+            size_t iSize = MIN(feedSize, (size_t)(iend - ip));
+            size_t oSize = sSrcSize - totalOut;
+            LZ4F_decompressOptions_t dOptions;
+            memset(&dOptions, 0, sizeof(dOptions));
+            dOptions.stableDst = FUZ_rand(&randState) & 1;
+            CHECK_V(result, LZ4F_decompress(dCtx, dst + totalOut, &oSize, ip, &iSize, &dOptions));
+            if (memcmp(dst + totalOut, (const BYTE*)CNBuffer + totalOut, oSize)) goto _output_error;
+            totalOut += oSize;
+            ip += iSize;
+            if (!dOptions.stableDst) {   /* previous output is no longer guaranteed : scramble it */
+                size_t const scrambleSize = MIN(totalOut, 64 KB);
+                memset(dst + totalOut - scrambleSize, 0xAA, scrambleSize);
+        }   }
+        CHECK( LZ4F_freeDecompressionContext(dCtx) ); dCtx = NULL;
+        if ((result != 0) || (totalOut != sSrcSize)) goto _output_error;
+        DISPLAYLEVEL(3, "OK \n");
+    }
+
+
+    DISPLAYLEVEL(3, "skipChecksums decompression option : ");
+    {   size_t const sSrcSize = 192 KB;
+        size_t corruptPos;
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.blockMode = LZ4F_blockLinked;
+        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+        prefs.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        CHECK_V(cSize, LZ4F_compressFrame(compressedBuffer, cBuffSize, CNBuffer, sSrcSize, &prefs));
+        CHECK( LZ4F_createDecompressionContext(&dCtx, LZ4F_VERSION) );
+        /* last bytes : [block checksum][endMark][content checksum] */
+        for (corruptPos = cSize-1; corruptPos > cSize-12; corruptPos -= 8) {
+            unsigned skip;
+            ((BYTE*)compressedBuffer)[corruptPos] ^= 1;
+            for (skip = 0; skip < 3; skip++) {
+                const BYTE* ip = (const BYTE*)compressedBuffer;
+                const BYTE* const iend = ip + cSize;
+                size_t totalOut = 0, result = 1;
+                unsigned callNb = 0;
+                LZ4F_decompressOptions_t dOptions;
+                memset(&dOptions, 0, sizeof(dOptions));
+                dOptions.skipChecksums = 1;
+                while (ip < iend) {   /* option is only provided on a single call : it remains active until end of frame */
+                    size_t iSize = MIN(1000, (size_t)(iend - ip));
+                    size_t oSize = sSrcSize - totalOut;
+                    /* skip==1 : first call ; skip==2 : second call, which only stores input (fast path) */
+                    int const withOption = (skip == 1) ? (callNb == 0) : (skip == 2) ? (callNb == 1) : 0;
+                    callNb++;
+                    result = LZ4F_decompress(dCtx, (BYTE*)decodedBuffer + totalOut, &oSize, ip, &iSize,
+                                             withOption ? &dOptions : NULL);
+                    if (LZ4F_isError(result)) break;
+                    totalOut += oSize;
+                    ip += iSize;
+                }
+                if (skip) {
+                    if ((result != 0) || (totalOut != sSrcSize)) goto _output_error;
+                    if (memcmp(decodedBuffer, CNBuffer, sSrcSize)) goto _output_error;
+                } else {
+                    if (!LZ4F_isError(result)) goto _output_error;
+                    LZ4F_resetDecompressionContext(dCtx);
+            }   }
+            ((BYTE*)compressedBuffer)[corruptPos] ^= 1;
+        }
+        CHECK( LZ4F_freeDecompressionContext(dCtx) ); dCtx = NULL;
+        DISPLAYLEVEL(3, "OK \n");
+    }
+
+
+    DISPLAYLEVEL(3, "Seek table and random access : \n");
+    {   size_t const dictSize = 1000;
+        size_t const sSrcSize = 1 MB + 333;
+        const BYTE* const sSrc = (const BYTE*)CNBuffer + dictSize;
+        LZ4F_CDict* const cdict = LZ4F_createCDict(CNBuffer, dictSize);
+        size_t sDstCapacity, sSize, dSize;
+        BYTE* sBuffer;
+        unsigned nbWorkers;
+
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+        prefs.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        prefs.seekTable = 1;
+        sDstCapacity = LZ4F_compressFrameBound(sSrcSize, &prefs) + 64 KB;
+        sBuffer = (BYTE*)malloc(sDstCapacity);
+        if (!sBuffer || !cdict) { free(sBuffer); LZ4F_freeCDict(cdict); goto _output_error; }
+        CHECK( LZ4F_createCompressionContext(&cctx, LZ4F_VERSION) );
+
+        for (nbWorkers=0; nbWorkers<=3; nbWorkers+=3) {
+            LZ4F_seekable* seekable;
+            unsigned n;
+            DISPLAYLEVEL(3, "%u workers : ", nbWorkers);
+            prefs.nbWorkers = nbWorkers;
+            CHECK_V(sSize, FUZ_compressStream(cctx, sBuffer, sDstCapacity, sSrc, sSrcSize, cdict, &prefs, &randState));
+
+            /* seek table is a skippable frame : regular decoders ignore it */
+            {   const BYTE* ip = sBuffer;
+                BYTE* op = (BYTE*)decodedBuffer;
+                CHECK( LZ4F_createDecompressionContext(&dCtx, LZ4F_VERSION) );
+                while (ip < sBuffer + sSize) {
+                    size_t iSize = sBuffer + sSize - ip;
+                    size_t oSize = (BYTE*)decodedBuffer + COMPRESSIBLE_NOISE_LENGTH - op;
+                    CHECK( LZ4F_decompress_usingDict(dCtx, op, &oSize, ip, &iSize, CNBuffer, dictSize, NULL) );
+                    if ((iSize == 0) && (oSize == 0)) break;
+                    ip += iSize;
+                    op += oSize;
+                }
+                CHECK( LZ4F_freeDecompressionContext(dCtx) ); dCtx = NULL;
+                if ((ip != sBuffer + sSize) || (op - (BYTE*)decodedBuffer != (ptrdiff_t)sSrcSize)) goto _output_error;
+                if (memcmp(decodedBuffer, sSrc, sSrcSize)) goto _output_error;
+            }
+
+            CHECK( LZ4F_seekableOpen(&seekable, sBuffer, sSize, CNBuffer, dictSize) );
+            if (LZ4F_seekableContentSize(seekable) != sSrcSize) { LZ4F_seekableClose(seekable); goto _output_error; }
+            for (n=0; n<300; n++) {
+                size_t const offset = FUZ_rand(&randState) % sSrcSize;
+                size_t const readSize = FUZ_rand(&randState) % (200 KB);
+                size_t const expected = MIN(readSize, sSrcSize - offset);
+                dSize = LZ4F_readAt(seekable, decodedBuffer, readSize, offset);
+                if ((dSize != expected) || memcmp(decodedBuffer, sSrc + offset, expected)) {
+                    DISPLAYLEVEL(1, "readAt(%u, %u) failed : %u \n", (unsigned)offset, (unsigned)readSize, (unsigned)dSize);
+                    LZ4F_seekableClose(seekable);
+                    goto _output_error;
+            }   }
+            if ( (LZ4F_readAt(seekable, decodedBuffer, 1000, sSrcSize - 10) != 10)
+              || memcmp(decodedBuffer, sSrc + sSrcSize - 10, 10)
+              || (LZ4F_readAt(seekable, decodedBuffer, 1000, sSrcSize) != 0) ) {
+                LZ4F_seekableClose(seekable);
+                goto _output_error;
+            }
+            LZ4F_seekableClose(seekable);
+            DISPLAYLEVEL(3, "%u bytes, OK \n", (unsigned)sSize);
+        }
+
+        DISPLAYLEVEL(3, "corrupted seek table is detected : ");
+        {   LZ4F_seekable* seekable;
+            size_t const nbBlocks = (sSrcSize / (64 KB)) + 1;
+            BYTE* const firstEntry = sBuffer + sSize - LZ4F_SEEKTABLE_SIZE(nbBlocks) + 8;
+            size_t result;
+            firstEntry[0] ^= 1;
+            result = LZ4F_seekableOpen(&seekable, sBuffer, sSize, CNBuffer, dictSize);
+            firstEntry[0] ^= 1;
+            if (!LZ4F_isError(result)) { LZ4F_seekableClose(seekable); goto _output_error; }
+            DISPLAYLEVEL(3, "%s \n", LZ4F_getErrorName(result));
+        }
+
+        DISPLAYLEVEL(3, "seek table requires independent blocks : ");
+        prefs.frameInfo.blockMode = LZ4F_blockLinked;
+        {   size_t const result = LZ4F_compressBegin(cctx, sBuffer, sDstCapacity, &prefs);
+            if (!LZ4F_isError(result)) goto _output_error;
+            DISPLAYLEVEL(3, "%s \n", LZ4F_getErrorName(result));
+        }
+
+        CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+        free(sBuffer); LZ4F_freeCDict(cdict);
+    }
+
+
+    DISPLAYLEVEL(3, "LZ4F_compressUpdateV, small records : \n");
+    {   size_t const srcSize = 512 KB;
+        size_t const halfCapacity = cBuffSize / 2;
+        BYTE* const refBuffer = (BYTE*)compressedBuffer;
+        BYTE* const vecBuffer = refBuffer + halfCapacity;
+        LZ4F_iovec_t records[40];
+        int autoFlush;
+        CHECK( LZ4F_createCompressionContext(&cctx, LZ4F_VERSION) );
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        for (autoFlush = 0; autoFlush <= 1; autoFlush++) {
+            U32 const recordSeed = FUZ_rand(&randState);
+            U32 recordState = recordSeed;
+            size_t pos, refSize, vecSize;
+            prefs.autoFlush = (unsigned)autoFlush;
+            DISPLAYLEVEL(3, "%s: ", autoFlush ? "autoFlush " : "buffered ");
+
+            /* reference : one LZ4F_compressUpdate() per record */
+            CHECK_V(refSize, LZ4F_compressBegin(cctx, refBuffer, halfCapacity, &prefs));
+            for (pos = 0; pos < srcSize; ) {
+                size_t const rNext = (FUZ_rand(&recordState) % 300) + 1;
+                size_t const rSize = MIN(rNext, srcSize - pos);
+                size_t cSize_;
+                CHECK_V(cSize_, LZ4F_compressUpdate(cctx, refBuffer + refSize, halfCapacity - refSize, (const BYTE*)CNBuffer + pos, rSize, NULL));
+                refSize += cSize_; pos += rSize;
+            }
+            {   size_t endSize; CHECK_V(endSize, LZ4F_compressEnd(cctx, refBuffer + refSize, halfCapacity - refSize, NULL)); refSize += endSize; }
+
+            /* same records, in batches */
+            recordState = recordSeed;
+            CHECK_V(vecSize, LZ4F_compressBegin(cctx, vecBuffer, halfCapacity, &prefs));
+            for (pos = 0; pos < srcSize; ) {
+                size_t nbRecords = 0;
+                size_t const maxRecords = (FUZ_rand(&randState) % 40) + 1;
+                size_t cSize_;
+                while ((nbRecords < maxRecords) && (pos < srcSize)) {
+                    size_t const rNext = (FUZ_rand(&recordState) % 300) + 1;
+                    size_t const rSize = MIN(rNext, srcSize - pos);
+                    records[nbRecords].base = (const BYTE*)CNBuffer + pos;
+                    records[nbRecords].len = rSize;
+                    nbRecords++; pos += rSize;
+                }
+                CHECK_V(cSize_, LZ4F_compressUpdateV(cctx, vecBuffer + vecSize, halfCapacity - vecSize, records, nbRecords, NULL));
+                vecSize += cSize_;
+            }
+            {   size_t endSize; CHECK_V(endSize, LZ4F_compressEnd(cctx, vecBuffer + vecSize, halfCapacity - vecSize, NULL)); vecSize += endSize; }
+
+            if ((vecSize != refSize) || memcmp(refBuffer, vecBuffer, refSize)) goto _output_error;
+            {   size_t decodedSize = srcSize;
+                size_t compressedSize = vecSize;
+                CHECK( LZ4F_createDecompressionContext(&dCtx, LZ4F_VERSION) );
+                if (LZ4F_decompress(dCtx, decodedBuffer, &decodedSize, vecBuffer, &compressedSize, NULL) != 0) goto _output_error;
+                CHECK( LZ4F_freeDecompressionContext(dCtx) ); dCtx = NULL;
+                if ((decodedSize != srcSize) || memcmp(decodedBuffer, CNBuffer, srcSize)) goto _output_error;
+            }
+            DISPLAYLEVEL(3, "%u bytes, identical to LZ4F_compressUpdate() \n", (unsigned)vecSize);
+        }
+        CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+    }
+
+
+    DISPLAYLEVEL(3, "Custom allocator and static workspace : \n");
+    {   FUZ_allocCounter counter = { 0, 0 };
+        LZ4F_CustomMem const cmem = { FUZ_countingAlloc, FUZ_countingFree, &counter };
+        LZ4F_CustomMem const badCMem = { FUZ_countingAlloc, NULL, &counter };
+        size_t const srcSize = 1 MB;
+        LZ4F_dctx* dctx;
+        unsigned firstFrameAllocs = 0;
+        int frameNb;
+
+        DISPLAYLEVEL(3, "incomplete custom allocator is rejected : ");
+        if (LZ4F_createCompressionContext_advanced(badCMem, LZ4F_VERSION) != NULL) goto _output_error;
+        if (LZ4F_createDecompressionContext_advanced(badCMem, LZ4F_VERSION) != NULL) goto _output_error;
+        DISPLAYLEVEL(3, "OK \n");
+
+        DISPLAYLEVEL(3, "no allocation after first frame : ");
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.blockSizeID = LZ4F_max256KB;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        cctx = LZ4F_createCompressionContext_advanced(cmem, LZ4F_VERSION);
+        dctx = LZ4F_createDecompressionContext_advanced(cmem, LZ4F_VERSION);
+        {   size_t const dictSize = 32 KB;
+            const BYTE* const src = (const BYTE*)CNBuffer + dictSize;
+            LZ4F_CDict* const cdict = LZ4F_createCDict(CNBuffer, dictSize);   /* default allocator */
+            if ((cctx == NULL) || (dctx == NULL) || (cdict == NULL)) goto _output_error;
+            for (frameNb = 0; frameNb < 8; frameNb++) {
+                /* frames >= 4 use a dictionary, attached over tables left by previous frame */
+                const LZ4F_CDict* const frameDict = (frameNb >= 4) ? cdict : NULL;
+                size_t dSize = srcSize;
+                prefs.compressionLevel = (frameNb & 1) ? 9 : 1;   /* HC first required at 2nd frame */
+                prefs.frameInfo.blockMode = (frameNb & 2) ? LZ4F_blockIndependent : LZ4F_blockLinked;
+                CHECK_V(cSize, FUZ_compressStream(cctx, compressedBuffer, cBuffSize, src, srcSize, frameDict, &prefs, &randState));
+                {   size_t const result = LZ4F_decompress_usingDict(dctx, decodedBuffer, &dSize, compressedBuffer, &cSize,
+                                                                    CNBuffer, frameDict ? dictSize : 0, NULL);
+                    if (result != 0) { LZ4F_freeCDict(cdict); goto _output_error; }   /* frame fully decoded */
+                }
+                if (dSize != srcSize) { LZ4F_freeCDict(cdict); goto _output_error; }
+                if (XXH64(decodedBuffer, srcSize, 1) != XXH64(src, srcSize, 1)) { LZ4F_freeCDict(cdict); goto _output_error; }
+                if (frameNb == 1) firstFrameAllocs = counter.nbAllocs;
+            }
+            LZ4F_freeCDict(cdict);
+        }
+        if (counter.nbAllocs != firstFrameAllocs) goto _output_error;
+        CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+        CHECK( LZ4F_freeDecompressionContext(dctx) );
+        if (counter.nbFrees != counter.nbAllocs) goto _output_error;
+        DISPLAYLEVEL(3, "%u allocations \n", counter.nbAllocs);
+
+        DISPLAYLEVEL(3, "thread pools use custom allocator : ");
+        prefs.compressionLevel = 1;
+        prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+        prefs.nbWorkers = 2;
+        cctx = LZ4F_createCompressionContext_advanced(cmem, LZ4F_VERSION);
+        dctx = LZ4F_createDecompressionContext_advanced(cmem, LZ4F_VERSION);
+        if ((cctx == NULL) || (dctx == NULL)) goto _output_error;
+        CHECK_V(cSize, FUZ_compressStream(cctx, compressedBuffer, cBuffSize, CNBuffer, srcSize, NULL, &prefs, &randState));
+        {   size_t readSize = cSize;
+            size_t const dSize = LZ4F_decompressFrame_parallel_usingDCtx(dctx, decodedBuffer, srcSize,
+                                                          compressedBuffer, &readSize, NULL, 0, 2);
+            if (dSize != srcSize) goto _output_error;
+            if (XXH64(decodedBuffer, srcSize, 1) != XXH64(CNBuffer, srcSize, 1)) goto _output_error;
+        }
+        CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;
+        CHECK( LZ4F_freeDecompressionContext(dctx) );
+        if (counter.nbFrees != counter.nbAllocs) goto _output_error;
+        prefs.nbWorkers = 0;
+        DISPLAYLEVEL(3, "OK \n");
+
+        DISPLAYLEVEL(3, "static workspace : ");
+        prefs.compressionLevel = 9;
+        prefs.frameInfo.blockMode = LZ4F_blockLinked;
+        {   size_t const wkspSize = LZ4F_workspaceSize(&prefs);
+            void* const cWksp = malloc(wkspSize);
+            void* const dWksp = malloc(wkspSize);
+            if (LZ4F_isError(wkspSize) || (cWksp == NULL) || (dWksp == NULL)) goto _output_error;
+            cctx = LZ4F_initStaticCCtx(cWksp, wkspSize);
+            dctx = LZ4F_initStaticDCtx(dWksp, wkspSize);
+            if ((cctx == NULL) || (dctx == NULL)) goto _output_error;
+            for (frameNb = 0; frameNb < 3; frameNb++) {
+                size_t dSize = srcSize;
+                prefs.frameInfo.blockSizeID = (frameNb == 1) ? LZ4F_max64KB : LZ4F_max256KB;
+                CHECK_V(cSize, FUZ_compressStream(cctx, compressedBuffer, cBuffSize, CNBuffer, srcSize, NULL, &prefs, &randState));
+                {   size_t const result = LZ4F_decompress(dctx, decodedBuffer, &dSize, compressedBuffer, &cSize, NULL);
+                    if (result != 0) goto _output_error;
+                }
+                if (dSize != srcSize) goto _output_error;
+                if (XXH64(decodedBuffer, srcSize, 1) != XXH64(CNBuffer, srcSize, 1)) goto _output_error;
+            }
+            CHECK( LZ4F_freeCompressionContext(cctx) ); cctx = NULL;   /* optional */
+            DISPLAYLEVEL(3, "%u bytes, OK \n", (unsigned)wkspSize);
+
+            DISPLAYLEVEL(3, "static contexts can't start threads : ");
+            cctx = LZ4F_initStaticCCtx(cWksp, wkspSize);
+            if (cctx == NULL) goto _output_error;
+            prefs.nbWorkers = 2;
+            {   size_t const result = LZ4F_compressBegin(cctx, compressedBuffer, cBuffSize, &prefs);
+                if (LZ4F_getErrorCode(result) != LZ4F_ERROR_allocation_failed) goto _output_error;
+            }
+            prefs.nbWorkers = 0;
+            cctx = NULL;
+            {   LZ4F_preferences_t iPrefs;
+                size_t readSize;
+                memset(&iPrefs, 0, sizeof(iPrefs));
+                iPrefs.frameInfo.blockMode = LZ4F_blockIndependent;
+                CHECK_V(cSize, LZ4F_compressFrame(compressedBuffer, cBuffSize, CNBuffer, srcSize, &iPrefs));
+                readSize = cSize;
+                {   size_t const result = LZ4F_decompressFrame_parallel_usingDCtx(dctx, decodedBuffer, srcSize,
+                                                                  compressedBuffer, &readSize, NULL, 0, 2);
+                    if (LZ4F_getErrorCode(result) != LZ4F_ERROR_allocation_failed) goto _output_error;
+                }
+                readSize = cSize;
+                {   size_t const result = LZ4F_decompressFrame_parallel_usingDCtx(dctx, decodedBuffer, srcSize,
+                                                                  compressedBuffer, &readSize, NULL, 0, 1);
+                    if (result != srcSize) goto _output_error;
+                }
+            }
+            DISPLAYLEVEL(3, "OK \n");
+
+            DISPLAYLEVEL(3, "workspace too small : ");
+            prefs.frameInfo.blockSizeID = LZ4F_max256KB;
+            cctx = LZ4F_initStaticCCtx(cWksp, wkspSize - 64 KB);
+            if (cctx == NULL) goto _output_error;
+            {   size_t const result = LZ4F_compressBegin(cctx, compressedBuffer, cBuffSize, &prefs);
+                if (LZ4F_getErrorCode(result) != LZ4F_ERROR_allocation_failed) goto _output_error;
+                DISPLAYLEVEL(3, "%s \n", LZ4F_getErrorName(result));
+            }
+            cctx = NULL;   /* no need to free */
+            if (LZ4F_initStaticDCtx((char*)dWksp + 1, wkspSize - 1) != NULL) goto _output_error;   /* misaligned */
+            free(cWksp); free(dWksp);
+    }   }
+
 
     DISPLAYLEVEL(3, "Skippable frame test : \n");
     {   size_t decodedBufferSize = COMPRESSIBLE_NOISE_LENGTH;
@@ -872,6 +1649,7 @@ int fuzzerTests(U32 seed, unsigned nbTests, unsigned startTest, double compressi
                 memset(&dOptions, 0, sizeof(dOptions));
                 dOptions.stableDst = FUZ_rand(&randState) & 1;
                 if (nonContiguousDst==2) dOptions.stableDst = 0;   /* overwrite mode */
+                if (nonContiguousDst==0) dOptions.directDst = FUZ_rand(&randState) & 1;   /* output is contiguous and stays in place */
                 result = LZ4F_decompress(dCtx, op, &oSize, ip, &iSize, &dOptions);
                 if (LZ4F_getErrorCode(result) == LZ4F_ERROR_contentChecksum_invalid) locateBuffDiff(srcStart, decodedBuffer, srcSize, nonContiguousDst);
                 CHECK(LZ4F_isError(result), "Decompression failed (error %i:%s)", (int)result, LZ4F_getErrorName(result));
@@ -889,6 +1667,14 @@ int fuzzerTests(U32 seed, unsigned nbTests, unsigned startTest, double compressi
                 CHECK(crcDecoded != crcOrig, "Decompression corruption");
             }
         }
+
+        /* one-shot decompression */
+        {   size_t const dSize = LZ4F_decompressFrame(decodedBuffer, srcDataLength, compressedBuffer, cSize, NULL, 0);
+            CHECK(LZ4F_isError(dSize), "One-shot decompression failed (error %i:%s)", (int)dSize, LZ4F_getErrorName(dSize));
+            if (dSize) {  /* otherwise, it's a skippable frame */
+                CHECK(dSize != srcSize, "One-shot decompression : wrong size");
+                CHECK(XXH64(decodedBuffer, dSize, 1) != crcOrig, "One-shot decompression corruption");
+        }   }
     }
 
     DISPLAYLEVEL(2, "\rAll tests completed   \n");
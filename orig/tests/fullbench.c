@@ -42,9 +42,11 @@
 #include <string.h>      /* strcmp */
 #include <time.h>        /* clock_t, clock(), CLOCKS_PER_SEC */
 
+#define LZ4_STATIC_LINKING_ONLY
+#define LZ4_HC_STATIC_LINKING_ONLY
 #include "lz4.h"
 #include "lz4hc.h"
-#include "lz4frame.h"
+#include "lz4frame_static.h"   /* LZ4F_CDict */
 
 #include "xxhash.h"
 
@@ -64,6 +66,7 @@
 #define GB *(1U<<30)
 
 #define KNUTH      2654435761U
+#define MIN(a,b)   ( (a) < (b) ? (a) : (b) )
 #define MAX_MEM    (1920 MB)
 #define DEFAULT_CHUNKSIZE   (4 MB)
 
@@ -102,6 +105,7 @@ static int g_compressionAlgo = ALL_COMPRESSORS;
 static int g_decompressionTest = 1;
 static int g_decompressionAlgo = ALL_DECOMPRESSORS;
 static int g_noPrompt = 0;
+static int g_shortOffsets = 0;   /* >0 : bench a synthetic corpus of short-offset runs, with periods up to this value */
 
 static void BMK_setBlocksize(int bsize)
 {
@@ -154,6 +158,28 @@ static size_t BMK_findMaxMem(U64 requiredMem)
 }
 
 
+/* BMK_genShortOffsets() :
+ * fills `buffer` with runs of short repeated patterns (periods 1 to `maxPeriod`, RLE-like),
+ * separated by a few random literals. Deterministic. */
+#define SYNTHETIC_SIZE (16 MB)
+static void BMK_genShortOffsets(char* buffer, size_t size, int maxPeriod)
+{
+    U32 rand32 = KNUTH;
+    size_t pos = 0;
+    while (pos < size) {
+        size_t const period = 1 + (size_t)((rand32 = rand32 * KNUTH + 1) >> 16) % (size_t)maxPeriod;
+        size_t const runLength = 32 + (size_t)((rand32 = rand32 * KNUTH + 1) >> 16) % 480;
+        size_t const nbLiterals = 1 + (size_t)((rand32 = rand32 * KNUTH + 1) >> 16) % 8;
+        size_t const runEnd = MIN(size, pos + runLength + nbLiterals);
+        size_t const patternStart = pos;
+        for ( ; (pos < runEnd) && (pos < patternStart + period + nbLiterals); pos++)
+            buffer[pos] = (char)((rand32 = rand32 * KNUTH + 1) >> 24);
+        for ( ; pos < runEnd; pos++)
+            buffer[pos] = buffer[pos - period];
+    }
+}
+
+
 /*********************************************************
 *  Benchmark function
 *********************************************************/
@@ -209,6 +235,62 @@ static int local_LZ4_compress_fast_extState0(const char* in, char* out, int inSi
     return LZ4_compress_fast_extState(&LZ4_stream, in, out, inSize, LZ4_compressBound(inSize), 0);
 }
 
+/* small records : each chunk is cut into independent records of g_recordSize bytes */
+static int g_recordSize = 64;
+static char g_recordBuffer[LZ4_COMPRESSBOUND(4 KB)];
+
+static int local_LZ4_compress_records_extState(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        total += LZ4_compress_fast_extState(&LZ4_stream, in + pos, g_recordBuffer, recordSize, (int)sizeof(g_recordBuffer), 1);
+    }
+    return total;
+}
+
+static int local_LZ4_compress_records_fastReset(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        total += LZ4_compress_fast_extState_fastReset(&LZ4_stream, in + pos, g_recordBuffer, recordSize, (int)sizeof(g_recordBuffer), 1);
+    }
+    return total;
+}
+
+/* records sharing a dictionary : first 64 KB of benched data */
+static const char* g_dictBuffer = NULL;
+static int g_dictSize = 0;
+static LZ4_stream_t LZ4_dictStream;
+
+static int local_LZ4_compress_records_loadDict(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        LZ4_resetStream(&LZ4_stream);
+        LZ4_loadDict(&LZ4_stream, g_dictBuffer, g_dictSize);
+        total += LZ4_compress_fast_continue(&LZ4_stream, in + pos, g_recordBuffer, recordSize, (int)sizeof(g_recordBuffer), 1);
+    }
+    return total;
+}
+
+static int local_LZ4_compress_records_attachDict(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        LZ4_attach_dictionary(&LZ4_stream, &LZ4_dictStream);
+        total += LZ4_compress_fast_continue(&LZ4_stream, in + pos, g_recordBuffer, recordSize, (int)sizeof(g_recordBuffer), 1);
+    }
+    return total;
+}
+
 static int local_LZ4_compress_fast_continue0(const char* in, char* out, int inSize)
 {
     return LZ4_compress_fast_continue(&LZ4_stream, in, out, inSize, LZ4_compressBound(inSize), 0);
@@ -222,6 +304,28 @@ static int local_LZ4_compress_forceDict(const char* in, char* out, int inSize)
 {
     return LZ4_compress_forceExtDict(&LZ4_stream, in, out, inSize);
 }
+
+/* match length counting kernels : 0=scalar, 1=sse2, 2=avx2, 3=avx512bw; <0 = best for this cpu */
+int LZ4_count_selectKernel(int kernel);
+
+static const char* const g_countKernelNames[] = { "scalar", "sse2", "avx2", "avx512bw" };
+
+/* overlapping match copy kernels : 0=scalar, 1=ssse3, 2=avx2; <0 = best for this cpu */
+int LZ4_copyPattern_selectKernel(int kernel);
+
+static const char* const g_patternKernelNames[] = { "scalar", "ssse3", "avx2" };
+
+/* single block specializations of LZ4_compress_generic() : 0=small, 1=small_limited, 2=large, 3=large_limited */
+int LZ4_compress_fast_extState_specialized(void* state, const char* source, char* dest, int inputSize, int maxOutputSize, int acceleration, int specialization);
+
+static int g_specialization = 0;
+static int g_specAcceleration = 1;
+static int local_LZ4_compress_specialized(const char* in, char* out, int inSize)
+{
+    return LZ4_compress_fast_extState_specialized(&LZ4_stream, in, out, inSize, LZ4_compressBound(inSize), g_specAcceleration, g_specialization);
+}
+
+static const char* const g_specializationNames[] = { "small", "small_limited", "large", "large_limited" };
 #endif
 
 
@@ -253,6 +357,31 @@ static int local_LZ4_compress_HC_continue(const char* in, char* out, int inSize)
     return LZ4_compress_HC_continue(&LZ4_streamHC, in, out, inSize, LZ4_compressBound(inSize));
 }
 
+/* small records, HC : same as above, at level g_recordLevelHC */
+static int g_recordLevelHC = 9;
+
+static int local_LZ4_compress_HC_records_extStateHC(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        total += LZ4_compress_HC_extStateHC(&LZ4_streamHC, in + pos, g_recordBuffer, recordSize, (int)sizeof(g_recordBuffer), g_recordLevelHC);
+    }
+    return total;
+}
+
+static int local_LZ4_compress_HC_records_fastReset(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        total += LZ4_compress_HC_extStateHC_fastReset(&LZ4_streamHC, in + pos, g_recordBuffer, recordSize, (int)sizeof(g_recordBuffer), g_recordLevelHC);
+    }
+    return total;
+}
+
 
 /* decompression functions */
 static int local_LZ4_decompress_fast(const char* in, char* out, int inSize, int outSize)
@@ -292,6 +421,31 @@ static int local_LZ4_decompress_safe_partial(const char* in, char* out, int inSi
     return LZ4_decompress_safe_partial(in, out, inSize, outSize - 5, outSize);
 }
 
+/* decodes all chunks, `nbLanes` (2 or 4) at a time, remaining ones one by one.
+ * @return : total nb of bytes decoded */
+static int local_LZ4_decompress_safe_lanes(const struct chunkParameters* chunks, int nbChunks, int nbLanes)
+{
+    const char* srcs[4];
+    char* dsts[4];
+    int srcSizes[4], dstCapacities[4], dstSizes[4];
+    int total = 0;
+    int chunkNb, n;
+    for (chunkNb=0; chunkNb + nbLanes <= nbChunks; chunkNb += nbLanes) {
+        for (n=0; n<nbLanes; n++) {
+            srcs[n] = chunks[chunkNb+n].compressedBuffer;
+            srcSizes[n] = chunks[chunkNb+n].compressedSize;
+            dsts[n] = chunks[chunkNb+n].origBuffer;
+            dstCapacities[n] = chunks[chunkNb+n].origSize;
+        }
+        if (nbLanes==4) LZ4_decompress_safe_x4(srcs, srcSizes, dsts, dstCapacities, dstSizes);
+        else LZ4_decompress_safe_x2(srcs, srcSizes, dsts, dstCapacities, dstSizes);
+        for (n=0; n<nbLanes; n++) total += dstSizes[n];
+    }
+    for ( ; chunkNb<nbChunks; chunkNb++)
+        total += LZ4_decompress_safe(chunks[chunkNb].compressedBuffer, chunks[chunkNb].origBuffer, chunks[chunkNb].compressedSize, chunks[chunkNb].origSize);
+    return total;
+}
+
 
 /* frame functions */
 static int local_LZ4F_compressFrame(const char* in, char* out, int inSize)
@@ -299,6 +453,111 @@ static int local_LZ4F_compressFrame(const char* in, char* out, int inSize)
     return (int)LZ4F_compressFrame(out, LZ4F_compressFrameBound(inSize, NULL), in, inSize, NULL);
 }
 
+#ifndef LZ4_DLL_IMPORT
+/* frames sharing a dictionary : one frame per record, reusing the same cctx and CDict */
+static LZ4F_cctx* g_cCtx = NULL;
+static LZ4F_CDict* g_cdict = NULL;
+static LZ4F_preferences_t g_framePrefs;
+static char g_frameBuffer[LZ4_COMPRESSBOUND(256 KB) + 64];
+
+static int local_LZ4F_compress_records_usingCDict(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        size_t hSize, cSize, eSize;
+        hSize = LZ4F_compressBegin_usingCDict(g_cCtx, g_frameBuffer, sizeof(g_frameBuffer), g_cdict, &g_framePrefs);
+        if (LZ4F_isError(hSize)) return 0;
+        cSize = LZ4F_compressUpdate(g_cCtx, g_frameBuffer + hSize, sizeof(g_frameBuffer) - hSize, in + pos, (size_t)recordSize, NULL);
+        if (LZ4F_isError(cSize)) return 0;
+        eSize = LZ4F_compressEnd(g_cCtx, g_frameBuffer + hSize + cSize, sizeof(g_frameBuffer) - (hSize + cSize), NULL);
+        if (LZ4F_isError(eSize)) return 0;
+        total += (int)(hSize + cSize + eSize);
+    }
+    return total;
+}
+
+/* one frame per chunk, fed as records of g_recordSize bytes, through LZ4F_compressUpdate() or LZ4F_compressUpdateV() */
+#define RECORDS_PER_BATCH 32
+static LZ4F_iovec_t g_recordBatch[RECORDS_PER_BATCH];
+
+static int local_LZ4F_compressUpdate_records(const char* in, char* out, int inSize)
+{
+    size_t const dstCapacity = LZ4F_compressFrameBound((size_t)inSize, &g_framePrefs);
+    size_t pos, cSize;
+    cSize = LZ4F_compressBegin(g_cCtx, out, dstCapacity, &g_framePrefs);
+    if (LZ4F_isError(cSize)) return 0;
+    for (pos = 0; pos < (size_t)inSize; pos += g_recordSize) {
+        size_t const recordSize = MIN((size_t)g_recordSize, (size_t)inSize - pos);
+        size_t const r = LZ4F_compressUpdate(g_cCtx, out + cSize, dstCapacity - cSize, in + pos, recordSize, NULL);
+        if (LZ4F_isError(r)) return 0;
+        cSize += r;
+    }
+    {   size_t const r = LZ4F_compressEnd(g_cCtx, out + cSize, dstCapacity - cSize, NULL);
+        if (LZ4F_isError(r)) return 0;
+        return (int)(cSize + r);
+    }
+}
+
+static int local_LZ4F_compressUpdateV_records(const char* in, char* out, int inSize)
+{
+    size_t const dstCapacity = LZ4F_compressFrameBound((size_t)inSize, &g_framePrefs);
+    size_t pos = 0, cSize;
+    cSize = LZ4F_compressBegin(g_cCtx, out, dstCapacity, &g_framePrefs);
+    if (LZ4F_isError(cSize)) return 0;
+    while (pos < (size_t)inSize) {
+        size_t nbRecords = 0;
+        while ((nbRecords < RECORDS_PER_BATCH) && (pos < (size_t)inSize)) {
+            size_t const recordSize = MIN((size_t)g_recordSize, (size_t)inSize - pos);
+            g_recordBatch[nbRecords].base = in + pos;
+            g_recordBatch[nbRecords].len = recordSize;
+            nbRecords++; pos += recordSize;
+        }
+        {   size_t const r = LZ4F_compressUpdateV(g_cCtx, out + cSize, dstCapacity - cSize, g_recordBatch, nbRecords, NULL);
+            if (LZ4F_isError(r)) return 0;
+            cSize += r;
+    }   }
+    {   size_t const r = LZ4F_compressEnd(g_cCtx, out + cSize, dstCapacity - cSize, NULL);
+        if (LZ4F_isError(r)) return 0;
+        return (int)(cSize + r);
+    }
+}
+
+/* frames round trip through contexts using a counting allocator, to check steady state is allocation-free */
+static unsigned g_nbAllocs = 0;
+static unsigned g_nbFrames = 0;
+static unsigned g_firstFrameAllocs = 0;
+static LZ4F_cctx* g_cCtxCounted = NULL;
+static LZ4F_dctx* g_dCtxCounted = NULL;
+static char g_frameDecoded[256 KB];
+
+static void* local_countingAlloc(void* opaque, size_t size) { (void)opaque; g_nbAllocs++; return malloc(size); }
+static void  local_countingFree(void* opaque, void* address) { (void)opaque; free(address); }
+
+static int local_LZ4F_roundTrip_records_countAllocs(const char* in, char* out, int inSize)
+{
+    int total = 0, pos;
+    (void)out;
+    for (pos = 0; pos < inSize; pos += g_recordSize) {
+        int const recordSize = MIN(g_recordSize, inSize - pos);
+        size_t hSize, cSize, eSize, srcSize, dstSize = sizeof(g_frameDecoded);
+        hSize = LZ4F_compressBegin(g_cCtxCounted, g_frameBuffer, sizeof(g_frameBuffer), &g_framePrefs);
+        if (LZ4F_isError(hSize)) return 0;
+        cSize = LZ4F_compressUpdate(g_cCtxCounted, g_frameBuffer + hSize, sizeof(g_frameBuffer) - hSize, in + pos, (size_t)recordSize, NULL);
+        if (LZ4F_isError(cSize)) return 0;
+        eSize = LZ4F_compressEnd(g_cCtxCounted, g_frameBuffer + hSize + cSize, sizeof(g_frameBuffer) - (hSize + cSize), NULL);
+        if (LZ4F_isError(eSize)) return 0;
+        srcSize = hSize + cSize + eSize;
+        if (LZ4F_decompress(g_dCtxCounted, g_frameDecoded, &dstSize, g_frameBuffer, &srcSize, NULL) != 0) return 0;
+        if (dstSize != (size_t)recordSize) return 0;
+        if (++g_nbFrames == 1) g_firstFrameAllocs = g_nbAllocs;
+        total += (int)(hSize + cSize + eSize);
+    }
+    return total;
+}
+#endif
+
 static LZ4F_decompressionContext_t g_dCtx;
 
 static int local_LZ4F_decompress(const char* in, char* out, int inSize, int outSize)
@@ -312,8 +571,121 @@ static int local_LZ4F_decompress(const char* in, char* out, int inSize, int outS
     return (int)dstSize;
 }
 
+/* streaming decompression : input is fed in 64 KB segments, and output is offered one block at a time */
+static LZ4F_decompressOptions_t g_dOptions;
+static size_t g_dstWindow;
+
+static int local_LZ4F_decompress_streaming(const char* in, char* out, int inSize, int outSize)
+{
+    const char* ip = in;
+    const char* const iend = in + inSize;
+    char* op = out;
+    char* const oend = out + outSize;
+    size_t result = 1;
+    while (ip < iend) {
+        size_t srcSize = MIN((size_t)(iend-ip), 64 KB);
+        size_t dstSize = MIN((size_t)(oend-op), g_dstWindow);
+        result = LZ4F_decompress(g_dCtx, op, &dstSize, ip, &srcSize, &g_dOptions);
+        if (LZ4F_isError(result)) { DISPLAY("Error decompressing frame : %s \n", LZ4F_getErrorName(result)); exit(8); }
+        ip += srcSize;
+        op += dstSize;
+    }
+    if (result!=0) { DISPLAY("Error decompressing frame : unfinished frame\n"); exit(8); }
+    return (int)(op - out);
+}
+
+/* network-like decompression : input is fed in pseudo-random pieces of 1 to g_feedSizeMax bytes */
+static size_t g_feedSizeMax;
+
+static int local_LZ4F_decompress_smallFeeds(const char* in, char* out, int inSize, int outSize)
+{
+    const char* ip = in;
+    const char* const iend = in + inSize;
+    char* op = out;
+    char* const oend = out + outSize;
+    size_t result = 1;
+    U32 rand32 = 2654435761U;
+    while (ip < iend) {
+        size_t const feedSize = ((rand32 >> 16) % g_feedSizeMax) + 1;
+        size_t srcSize = MIN((size_t)(iend-ip), feedSize);
+        size_t dstSize = MIN((size_t)(oend-op), g_dstWindow);
+        rand32 = rand32 * 1103515245U + 12345U;
+        result = LZ4F_decompress(g_dCtx, op, &dstSize, ip, &srcSize, &g_dOptions);
+        if (LZ4F_isError(result)) { DISPLAY("Error decompressing frame : %s \n", LZ4F_getErrorName(result)); exit(8); }
+        ip += srcSize;
+        op += dstSize;
+    }
+    if (result!=0) { DISPLAY("Error decompressing frame : unfinished frame\n"); exit(8); }
+    return (int)(op - out);
+}
+
+#ifndef LZ4_DLL_IMPORT
+static int local_LZ4F_decompressFrame(const char* in, char* out, int inSize, int outSize)
+{
+    size_t const result = LZ4F_decompressFrame(out, outSize, in, inSize, NULL, 0);
+    if (LZ4F_isError(result)) { DISPLAY("Error decompressing frame : %s \n", LZ4F_getErrorName(result)); exit(8); }
+    return (int)result;
+}
+
+/* content checksum is verified by a background job, while output is already available */
+static int local_LZ4F_decompressFrame_deferredCheck(const char* in, char* out, int inSize, int outSize)
+{
+    LZ4F_checksumJob* job;
+    size_t const result = LZ4F_decompressFrame_deferredCheck(&job, out, outSize, in, inSize, NULL, 0);
+    if (LZ4F_isError(result)) { DISPLAY("Error decompressing frame : %s \n", LZ4F_getErrorName(result)); exit(8); }
+    {   size_t const crcError = LZ4F_checksumJob_wait(job);
+        if (LZ4F_isError(crcError)) { DISPLAY("Error decompressing frame : %s \n", LZ4F_getErrorName(crcError)); exit(8); }
+    }
+    return (int)result;
+}
+
+/* many small frames (RPC messages), concatenated : frame sizes are known */
+#define RECORD_FRAME_SIZE (4 KB)
+static size_t* g_recordFrameSizes = NULL;
+
+static int local_LZ4F_decompressFrame_records(const char* in, char* out, int inSize, int outSize)
+{
+    char* const ostart = out;
+    size_t n;
+    (void)inSize;
+    for (n = 0; (int)(n * RECORD_FRAME_SIZE) < outSize; n++) {
+        size_t const dstSize = MIN(RECORD_FRAME_SIZE, (size_t)outSize - n * RECORD_FRAME_SIZE);
+        size_t const result = LZ4F_decompressFrame(out, dstSize, in, g_recordFrameSizes[n], NULL, 0);
+        if (LZ4F_isError(result)) { DISPLAY("Error decompressing frame : %s \n", LZ4F_getErrorName(result)); exit(8); }
+        in += g_recordFrameSizes[n];
+        out += result;
+    }
+    return (int)(out - ostart);
+}
+
+static int local_LZ4F_decompress_records(const char* in, char* out, int inSize, int outSize)
+{
+    char* const ostart = out;
+    size_t n;
+    (void)inSize;
+    for (n = 0; (int)(n * RECORD_FRAME_SIZE) < outSize; n++) {
+        size_t dstSize = MIN(RECORD_FRAME_SIZE, (size_t)outSize - n * RECORD_FRAME_SIZE);
+        size_t srcSize = g_recordFrameSizes[n];
+        size_t const result = LZ4F_decompress(g_dCtx, out, &dstSize, in, &srcSize, NULL);
+        if (result != 0) { DISPLAY("Error decompressing frame : unfinished frame\n"); exit(8); }
+        in += srcSize;
+        out += dstSize;
+    }
+    return (int)(out - ostart);
+}
+
+static int local_LZ4F_decompressFrame_parallel(const char* in, char* out, int inSize, int outSize)
+{
+    size_t srcSize = inSize;
+    size_t const result = LZ4F_decompressFrame_parallel(out, outSize, in, &srcSize, NULL, 0, 1);
+    if (LZ4F_isError(result)) { DISPLAY("Error decompressing frame : %s \n", LZ4F_getErrorName(result)); exit(8); }
+    if (srcSize != (size_t)inSize) { DISPLAY("Error decompressing frame : read size incorrect\n"); exit(9); }
+    return (int)result;
+}
+#endif
+
 
-#define NB_COMPRESSION_ALGORITHMS 100
+#define NB_COMPRESSION_ALGORITHMS 120
 #define NB_DECOMPRESSION_ALGORITHMS 100
 int fullSpeedBench(const char** fileNamesTable, int nbFiles)
 {
@@ -322,6 +694,10 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
     /* Init */
     { size_t const errorCode = LZ4F_createDecompressionContext(&g_dCtx, LZ4F_VERSION);
       if (LZ4F_isError(errorCode)) { DISPLAY("dctx allocation issue \n"); return 10; } }
+#ifndef LZ4_DLL_IMPORT
+    { size_t const errorCode = LZ4F_createCompressionContext(&g_cCtx, LZ4F_VERSION);
+      if (LZ4F_isError(errorCode)) { DISPLAY("cctx allocation issue \n"); return 10; } }
+#endif
 
     /* Loop for each fileName */
     while (fileIdx<nbFiles) {
@@ -329,7 +705,7 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
       struct chunkParameters* chunkP = NULL;
       char* compressed_buff=NULL;
       const char* const inFileName = fileNamesTable[fileIdx++];
-      FILE* const inFile = fopen( inFileName, "rb" );
+      FILE* const inFile = g_shortOffsets ? NULL : fopen( inFileName, "rb" );
       U64   inFileSize;
       size_t benchedSize;
       int nbChunks;
@@ -340,13 +716,13 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
       size_t errorCode;
 
       /* Check file existence */
-      if (inFile==NULL) { DISPLAY( "Pb opening %s\n", inFileName); return 11; }
+      if ((inFile==NULL) && !g_shortOffsets) { DISPLAY( "Pb opening %s\n", inFileName); return 11; }
 
       /* Memory size adjustments */
-      inFileSize = UTIL_getFileSize(inFileName);
+      inFileSize = g_shortOffsets ? SYNTHETIC_SIZE : UTIL_getFileSize(inFileName);
       if (inFileSize==0) { DISPLAY( "file is empty\n"); fclose(inFile); return 11; }
       benchedSize = BMK_findMaxMem(inFileSize*2) / 2;   /* because 2 buffers */
-      if (benchedSize==0) { DISPLAY( "not enough memory\n"); fclose(inFile); return 11; }
+      if (benchedSize==0) { DISPLAY( "not enough memory\n"); if (inFile) fclose(inFile); return 11; }
       if ((U64)benchedSize > inFileSize) benchedSize = (size_t)inFileSize;
       if (benchedSize < inFileSize)
           DISPLAY("Not enough memory for '%s' full size; testing %i MB only...\n", inFileName, (int)(benchedSize>>20));
@@ -360,7 +736,7 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
       compressed_buff = (char*)malloc((size_t)compressedBuffSize);
       if(!chunkP || !orig_buff || !compressed_buff) {
           DISPLAY("\nError: not enough memory!\n");
-          fclose(inFile);
+          if (inFile) fclose(inFile);
           free(orig_buff);
           free(compressed_buff);
           free(chunkP);
@@ -368,9 +744,14 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
       }
 
       /* Fill in src buffer */
-      DISPLAY("Loading %s...       \r", inFileName);
-      readSize = fread(orig_buff, 1, benchedSize, inFile);
-      fclose(inFile);
+      if (g_shortOffsets) {
+          BMK_genShortOffsets(orig_buff, benchedSize, g_shortOffsets);
+          readSize = benchedSize;
+      } else {
+          DISPLAY("Loading %s...       \r", inFileName);
+          readSize = fread(orig_buff, 1, benchedSize, inFile);
+          fclose(inFile);
+      }
 
       if (readSize != benchedSize) {
         DISPLAY("\nError: problem reading file '%s' !!    \n", inFileName);
@@ -417,6 +798,9 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
                 }
             }
 
+#ifndef LZ4_DLL_IMPORT
+            LZ4_count_selectKernel(-1);
+#endif
             switch(cAlgNb)
             {
             case 0 : DISPLAY("Compression functions : \n"); continue;
@@ -438,6 +822,63 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
 			case 30: compressionFunction = local_LZ4F_compressFrame; compressorName = "LZ4F_compressFrame";
                         chunkP[0].origSize = (int)benchedSize; nbChunks=1;
                         break;
+#ifndef LZ4_DLL_IMPORT
+            case 31:
+            case 32:
+            case 33:
+            case 34:
+            case 35:
+            case 36: {  static const int frameSizes[3] = { 4 KB, 64 KB, 256 KB };
+                        g_recordSize = frameSizes[(cAlgNb - 31) % 3];
+                        memset(&g_framePrefs, 0, sizeof(g_framePrefs));
+                        g_framePrefs.frameInfo.blockMode = LZ4F_blockIndependent;
+                        g_framePrefs.frameInfo.blockSizeID = (g_recordSize <= 64 KB) ? LZ4F_max64KB : LZ4F_max256KB;
+                        g_framePrefs.compressionLevel = (cAlgNb < 34) ? 0 : LZ4HC_CLEVEL_DEFAULT;
+                        g_framePrefs.autoFlush = 1;
+                        LZ4F_freeCDict(g_cdict);
+                        g_cdict = LZ4F_createCDict(orig_buff, MIN(benchedSize, 64 KB));
+                        if (g_cdict == NULL) { DISPLAY("CDict allocation issue \n"); continue; }
+                        compressionFunction = local_LZ4F_compress_records_usingCDict;
+                        compressorName = (cAlgNb < 34) ? "LZ4F_usingCDict" : "LZ4F_usingCDict(HC)";
+                        DISPLAY("   frames of %i bytes, dictionary of %i bytes \n", g_recordSize, (int)MIN(benchedSize, 64 KB));
+                        break;
+                     }
+            case 37:
+            case 38:
+            case 39: {  static const int frameSizes[3] = { 4 KB, 64 KB, 256 KB };
+                        LZ4F_CustomMem const countingCMem = { local_countingAlloc, local_countingFree, NULL };
+                        g_recordSize = frameSizes[cAlgNb - 37];
+                        memset(&g_framePrefs, 0, sizeof(g_framePrefs));
+                        g_framePrefs.frameInfo.blockSizeID = (g_recordSize <= 64 KB) ? LZ4F_max64KB : LZ4F_max256KB;
+                        g_framePrefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+                        g_nbAllocs = 0; g_nbFrames = 0; g_firstFrameAllocs = 0;
+                        g_cCtxCounted = LZ4F_createCompressionContext_advanced(countingCMem, LZ4F_VERSION);
+                        g_dCtxCounted = LZ4F_createDecompressionContext_advanced(countingCMem, LZ4F_VERSION);
+                        if ((g_cCtxCounted == NULL) || (g_dCtxCounted == NULL)) { DISPLAY("context allocation issue \n"); continue; }
+                        compressionFunction = local_LZ4F_roundTrip_records_countAllocs;
+                        compressorName = "LZ4F_roundTrip(customMem)";
+                        DISPLAY("   frames of %i bytes, compressed then decompressed \n", g_recordSize);
+                        break;
+                     }
+            case 90:
+            case 91:
+            case 92:
+            case 93:
+            case 94:
+            case 95: {  static const int updateSizes[3] = { 64, 256, 1 KB };
+                        g_recordSize = updateSizes[(cAlgNb - 90) % 3];
+                        memset(&g_framePrefs, 0, sizeof(g_framePrefs));
+                        g_framePrefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+                        if (LZ4F_compressFrameBound((size_t)g_chunkSize, &g_framePrefs) > (size_t)maxCompressedChunkSize) { DISPLAY("%2i-chunks too small for frames \n", cAlgNb); continue; }
+                        if (cAlgNb < 93) {
+                            compressionFunction = local_LZ4F_compressUpdate_records; compressorName = "LZ4F_compressUpdate";
+                        } else {
+                            compressionFunction = local_LZ4F_compressUpdateV_records; compressorName = "LZ4F_compressUpdateV";
+                        }
+                        DISPLAY("   updates of %i bytes \n", g_recordSize);
+                        break;
+                     }
+#endif
             case 40: compressionFunction = local_LZ4_saveDict; compressorName = "LZ4_saveDict";
                         if (chunkP[0].origSize < 8) { DISPLAY(" cannot bench %s with less then 8 bytes \n", compressorName); continue; }
                         LZ4_loadDict(&LZ4_stream, chunkP[0].origBuffer, chunkP[0].origSize);
@@ -446,6 +887,94 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
                         if (chunkP[0].origSize < 8) { DISPLAY(" cannot bench %s with less then 8 bytes \n", compressorName); continue; }
                         LZ4_loadDictHC(&LZ4_streamHC, chunkP[0].origBuffer, chunkP[0].origSize);
                         break;
+            case 103:
+            case 104:
+            case 105:
+            case 106:
+            case 107:
+            case 108:
+            case 109: g_recordSize = 4 KB;
+                        g_recordLevelHC = cAlgNb - 100;
+                        compressionFunction = local_LZ4_compress_HC_records_extStateHC; compressorName = "LZ4_compress_HC_extStateHC";
+                        DISPLAY("   records of %i bytes, level %i \n", g_recordSize, g_recordLevelHC);
+                        break;
+            case 113:
+            case 114:
+            case 115:
+            case 116:
+            case 117:
+            case 118:
+            case 119: g_recordSize = 4 KB;
+                        g_recordLevelHC = cAlgNb - 110;
+                        compressionFunction = local_LZ4_compress_HC_records_fastReset; initFunction = local_LZ4_resetStreamHC; compressorName = "LZ4_compress_HC_fastReset";
+                        DISPLAY("   records of %i bytes, level %i \n", g_recordSize, g_recordLevelHC);
+                        break;
+            case 70:
+            case 71:
+            case 72:
+            case 73: g_recordSize = 64 << (2 * (cAlgNb - 70));
+                        compressionFunction = local_LZ4_compress_records_extState; compressorName = "LZ4_compress_fast_extState";
+                        DISPLAY("   records of %i bytes \n", g_recordSize);
+                        break;
+            case 74:
+            case 75:
+            case 76:
+            case 77: g_recordSize = 64 << (2 * (cAlgNb - 74));
+                        compressionFunction = local_LZ4_compress_records_fastReset; initFunction = local_LZ4_resetDictT; compressorName = "LZ4_compress_fastReset";
+                        DISPLAY("   records of %i bytes \n", g_recordSize);
+                        break;
+            case 80:
+            case 81:
+            case 82:
+            case 83:
+            case 84:
+            case 85:
+            case 86:
+            case 87: g_recordSize = 64 << (2 * ((cAlgNb - 80) & 3));
+                        g_dictBuffer = orig_buff;
+                        g_dictSize = (int)MIN(benchedSize, 64 KB);
+                        if (cAlgNb < 84) {
+                            compressionFunction = local_LZ4_compress_records_loadDict; compressorName = "LZ4_compress_loadDict";
+                        } else {
+                            compressionFunction = local_LZ4_compress_records_attachDict; initFunction = local_LZ4_resetDictT; compressorName = "LZ4_compress_attachDict";
+                            LZ4_resetStream(&LZ4_dictStream);
+                            LZ4_loadDict(&LZ4_dictStream, g_dictBuffer, g_dictSize);
+                        }
+                        DISPLAY("   records of %i bytes, dictionary of %i bytes \n", g_recordSize, g_dictSize);
+                        break;
+#ifndef LZ4_DLL_IMPORT
+            case 50:
+            case 51:
+            case 52:
+            case 53: { int const kernel = cAlgNb - 50;
+                        compressionFunction = local_LZ4_compress_default_large; compressorName = "LZ4_compress_default(count)";
+                        if (LZ4_count_selectKernel(kernel) != kernel) { DISPLAY("%2i-count kernel %s not supported by this cpu \n", cAlgNb, g_countKernelNames[kernel]); continue; }
+                        DISPLAY("   count kernel : %s \n", g_countKernelNames[kernel]);
+                        break;
+                     }
+            case 54:
+            case 55:
+            case 56:
+            case 57: { int const kernel = cAlgNb - 54;
+                        compressionFunction = local_LZ4_compress_HC; compressorName = "LZ4_compress_HC(count)";
+                        if (LZ4_count_selectKernel(kernel) != kernel) { DISPLAY("%2i-count kernel %s not supported by this cpu \n", cAlgNb, g_countKernelNames[kernel]); continue; }
+                        DISPLAY("   count kernel : %s \n", g_countKernelNames[kernel]);
+                        break;
+                     }
+            case 60:
+            case 61:
+            case 62:
+            case 63:
+            case 64:
+            case 65:
+            case 66:
+            case 67: g_specialization = (cAlgNb - 60) & 3;
+                        g_specAcceleration = (cAlgNb < 64) ? 1 : 2;
+                        compressionFunction = local_LZ4_compress_specialized; compressorName = "LZ4_compress_specialized";
+                        if ((g_specialization < 2) && (g_chunkSize > 64 KB)) { DISPLAY("%2i-specialization %s requires blocks <= 64 KB (-B4) \n", cAlgNb, g_specializationNames[g_specialization]); continue; }
+                        DISPLAY("   specialization : %s, acceleration %i \n", g_specializationNames[g_specialization], g_specAcceleration);
+                        break;
+#endif
             default :
                 continue;   /* unknown ID : just skip */
             }
@@ -482,7 +1011,15 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
             if (ratio<100.)
                 DISPLAY("%2i-%-28.28s :%9i ->%9i (%5.2f%%),%7.1f MB/s\n", cAlgNb, compressorName, (int)benchedSize, (int)cSize, ratio, (double)benchedSize / bestTime / 1000000);
             else
-                DISPLAY("%2i-%-28.28s :%9i ->%9i (%5.1f%%),%7.1f MB/s\n", cAlgNb, compressorName, (int)benchedSize, (int)cSize, ratio, (double)benchedSize / bestTime / 100000);
+                DISPLAY("%2i-%-28.28s :%9i ->%9i (%5.1f%%),%7.1f MB/s\n", cAlgNb, compressorName, (int)benchedSize, (int)cSize, ratio, (double)benchedSize / bestTime / 1000000);
+#ifndef LZ4_DLL_IMPORT
+            if ((cAlgNb >= 37) && (cAlgNb <= 39)) {
+                DISPLAY("   allocations : %u for first frame, %.3f per frame afterwards (%u frames) \n",
+                        g_firstFrameAllocs, (double)(g_nbAllocs - g_firstFrameAllocs) / (g_nbFrames - (g_nbFrames>0)), g_nbFrames);
+                LZ4F_freeCompressionContext(g_cCtxCounted); g_cCtxCounted = NULL;
+                LZ4F_freeDecompressionContext(g_dCtxCounted); g_dCtxCounted = NULL;
+            }
+#endif
         }
 
         /* Prepare layout for decompression */
@@ -510,10 +1047,14 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
         for (dAlgNb=0; (dAlgNb <= NB_DECOMPRESSION_ALGORITHMS) && (g_decompressionTest); dAlgNb++) {
             const char* dName;
             int (*decompressionFunction)(const char*, char*, int, int);
+            int nbLanes = 1;
             double bestTime = 100000000.;
 
             if ((g_decompressionAlgo != ALL_DECOMPRESSORS) && (g_decompressionAlgo != dAlgNb)) continue;
 
+#ifndef LZ4_DLL_IMPORT
+            LZ4_copyPattern_selectKernel(-1);
+#endif
             switch(dAlgNb)
             {
             case 0: DISPLAY("Decompression functions : \n"); continue;
@@ -525,6 +1066,18 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
 #ifndef LZ4_DLL_IMPORT
 			case 8: decompressionFunction = local_LZ4_decompress_safe_forceExtDict; dName = "LZ4_decompress_safe_forceExtDict"; break;
 #endif
+#ifndef LZ4_DLL_IMPORT
+            case 10:
+            case 11:
+            case 12: { int const kernel = dAlgNb - 10;
+                        decompressionFunction = LZ4_decompress_safe; dName = "LZ4_decompress_safe_pattern";
+                        if (LZ4_copyPattern_selectKernel(kernel) != kernel) { DISPLAY("%2i-pattern kernel %s not supported by this cpu \n", dAlgNb, g_patternKernelNames[kernel]); continue; }
+                        DISPLAY("   pattern kernel : %s \n", g_patternKernelNames[kernel]);
+                        break;
+                     }
+#endif
+            case 13: decompressionFunction = LZ4_decompress_safe; nbLanes = 2; dName = "LZ4_decompress_safe_x2"; break;
+            case 14: decompressionFunction = LZ4_decompress_safe; nbLanes = 4; dName = "LZ4_decompress_safe_x4"; break;
 			case 9: decompressionFunction = local_LZ4F_decompress; dName = "LZ4F_decompress";
                     errorCode = LZ4F_compressFrame(compressed_buff, compressedBuffSize, orig_buff, benchedSize, NULL);
                     if (LZ4F_isError(errorCode)) {
@@ -538,6 +1091,146 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
                     chunkP[0].compressedSize = (int)errorCode;
                     nbChunks = 1;
                     break;
+            case 16:
+            case 17:
+            case 18:
+            case 19: decompressionFunction = local_LZ4F_decompress_streaming;
+                    {   LZ4F_preferences_t prefs;
+                        int const largeBlocks = (dAlgNb >= 18);
+                        memset(&prefs, 0, sizeof(prefs));
+                        prefs.frameInfo.blockMode = LZ4F_blockLinked;
+                        prefs.frameInfo.blockSizeID = largeBlocks ? LZ4F_max4MB : LZ4F_max64KB;
+                        memset(&g_dOptions, 0, sizeof(g_dOptions));
+                        g_dOptions.directDst = dAlgNb & 1;
+                        g_dstWindow = largeBlocks ? 4 MB : 64 KB;
+                        dName = largeBlocks ? (g_dOptions.directDst ? "LZ4F_decompress_4MB_direct" : "LZ4F_decompress_4MB")
+                                            : (g_dOptions.directDst ? "LZ4F_decompress_64KB_direct" : "LZ4F_decompress_64KB");
+                        errorCode = LZ4F_compressFrame(compressed_buff, compressedBuffSize, orig_buff, benchedSize, &prefs);
+                    }
+                    if (LZ4F_isError(errorCode)) {
+                        DISPLAY("Error while preparing compressed frame\n");
+                        free(orig_buff);
+                        free(compressed_buff);
+                        free(chunkP);
+                        return 1;
+                    }
+                    chunkP[0].origSize = (int)benchedSize;
+                    chunkP[0].compressedSize = (int)errorCode;
+                    nbChunks = 1;
+                    break;
+            case 20:
+            case 21: decompressionFunction = local_LZ4F_decompress_smallFeeds;
+                    memset(&g_dOptions, 0, sizeof(g_dOptions));
+                    g_dstWindow = 64 KB;
+                    g_feedSizeMax = (dAlgNb == 20) ? 16 : 100;
+                    dName = (dAlgNb == 20) ? "LZ4F_decompress_feeds1-16" : "LZ4F_decompress_feeds1-100";
+                    errorCode = LZ4F_compressFrame(compressed_buff, compressedBuffSize, orig_buff, benchedSize, NULL);
+                    if (LZ4F_isError(errorCode)) {
+                        DISPLAY("Error while preparing compressed frame\n");
+                        free(orig_buff);
+                        free(compressed_buff);
+                        free(chunkP);
+                        return 1;
+                    }
+                    chunkP[0].origSize = (int)benchedSize;
+                    chunkP[0].compressedSize = (int)errorCode;
+                    nbChunks = 1;
+                    break;
+            case 25:
+            case 26: decompressionFunction = local_LZ4F_decompress_streaming;
+                    {   LZ4F_preferences_t prefs;
+                        memset(&prefs, 0, sizeof(prefs));
+                        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+                        prefs.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+                        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+                        memset(&g_dOptions, 0, sizeof(g_dOptions));
+                        g_dOptions.skipChecksums = (dAlgNb == 26);
+                        g_dstWindow = 64 KB;
+                        dName = (dAlgNb == 26) ? "LZ4F_decompress_skipChecksums" : "LZ4F_decompress_checksums";
+                        errorCode = LZ4F_compressFrame(compressed_buff, compressedBuffSize, orig_buff, benchedSize, &prefs);
+                    }
+                    if (LZ4F_isError(errorCode)) {
+                        DISPLAY("Error while preparing compressed frame\n");
+                        free(orig_buff);
+                        free(compressed_buff);
+                        free(chunkP);
+                        return 1;
+                    }
+                    chunkP[0].origSize = (int)benchedSize;
+                    chunkP[0].compressedSize = (int)errorCode;
+                    nbChunks = 1;
+                    break;
+#ifndef LZ4_DLL_IMPORT
+            case 27: decompressionFunction = local_LZ4F_decompressFrame_deferredCheck; dName = "LZ4F_decompressFrame_deferred";
+                    {   LZ4F_preferences_t prefs;
+                        memset(&prefs, 0, sizeof(prefs));
+                        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+                        errorCode = LZ4F_compressFrame(compressed_buff, compressedBuffSize, orig_buff, benchedSize, &prefs);
+                    }
+                    if (LZ4F_isError(errorCode)) {
+                        DISPLAY("Error while preparing compressed frame\n");
+                        free(orig_buff);
+                        free(compressed_buff);
+                        free(chunkP);
+                        return 1;
+                    }
+                    chunkP[0].origSize = (int)benchedSize;
+                    chunkP[0].compressedSize = (int)errorCode;
+                    nbChunks = 1;
+                    break;
+            case 15: decompressionFunction = local_LZ4F_decompressFrame_parallel; dName = "LZ4F_decompressFrame_parallel";
+                    {   LZ4F_preferences_t prefs;
+                        memset(&prefs, 0, sizeof(prefs));
+                        prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+                        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+                        errorCode = LZ4F_compressFrame(compressed_buff, compressedBuffSize, orig_buff, benchedSize, &prefs);
+                    }
+                    if (LZ4F_isError(errorCode)) {
+                        DISPLAY("Error while preparing compressed frame\n");
+                        free(orig_buff);
+                        free(compressed_buff);
+                        free(chunkP);
+                        return 1;
+                    }
+                    chunkP[0].origSize = (int)benchedSize;
+                    chunkP[0].compressedSize = (int)errorCode;
+                    nbChunks = 1;
+                    break;
+            case 22: decompressionFunction = local_LZ4F_decompressFrame; dName = "LZ4F_decompressFrame";
+                    errorCode = LZ4F_compressFrame(compressed_buff, compressedBuffSize, orig_buff, benchedSize, NULL);
+                    if (LZ4F_isError(errorCode)) {
+                        DISPLAY("Error while preparing compressed frame\n");
+                        free(orig_buff);
+                        free(compressed_buff);
+                        free(chunkP);
+                        return 1;
+                    }
+                    chunkP[0].origSize = (int)benchedSize;
+                    chunkP[0].compressedSize = (int)errorCode;
+                    nbChunks = 1;
+                    break;
+            case 23:
+            case 24: {  size_t const nbFrames = (benchedSize + RECORD_FRAME_SIZE - 1) / RECORD_FRAME_SIZE;
+                        size_t n, pos = 0;
+                        free(g_recordFrameSizes);
+                        g_recordFrameSizes = (size_t*)malloc(nbFrames * sizeof(size_t));
+                        if (g_recordFrameSizes == NULL) { DISPLAY("allocation error \n"); continue; }
+                        for (n = 0; n < nbFrames; n++) {
+                            size_t const srcSize = MIN(RECORD_FRAME_SIZE, benchedSize - n * RECORD_FRAME_SIZE);
+                            g_recordFrameSizes[n] = LZ4F_compressFrame(compressed_buff + pos, (size_t)compressedBuffSize - pos,
+                                                                       orig_buff + n * RECORD_FRAME_SIZE, srcSize, NULL);
+                            if (LZ4F_isError(g_recordFrameSizes[n])) break;
+                            pos += g_recordFrameSizes[n];
+                        }
+                        if (n < nbFrames) { DISPLAY("%2i-not enough room for %u frames \n", dAlgNb, (unsigned)nbFrames); continue; }
+                        decompressionFunction = (dAlgNb == 23) ? local_LZ4F_decompressFrame_records : local_LZ4F_decompress_records;
+                        dName = (dAlgNb == 23) ? "LZ4F_decompressFrame_4KB" : "LZ4F_decompress_4KB";
+                        chunkP[0].origSize = (int)benchedSize;
+                        chunkP[0].compressedSize = (int)pos;
+                        nbChunks = 1;
+                        break;
+                     }
+#endif
             default :
                 continue;   /* skip if unknown ID */
             }
@@ -556,10 +1249,14 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
                 while(clock() == clockTime);
                 clockTime = clock();
                 while(BMK_GetClockSpan(clockTime) < TIMELOOP) {
-                    for (chunkNb=0; chunkNb<nbChunks; chunkNb++) {
-                        int decodedSize = decompressionFunction(chunkP[chunkNb].compressedBuffer, chunkP[chunkNb].origBuffer, chunkP[chunkNb].compressedSize, chunkP[chunkNb].origSize);
-                        if (chunkP[chunkNb].origSize != decodedSize) DISPLAY("ERROR ! %s() == %i != %i !! \n", dName, decodedSize, chunkP[chunkNb].origSize), exit(1);
-                    }
+                    if (nbLanes > 1) {
+                        int const decodedSize = local_LZ4_decompress_safe_lanes(chunkP, nbChunks, nbLanes);
+                        if (decodedSize != (int)benchedSize) DISPLAY("ERROR ! %s() == %i != %i !! \n", dName, decodedSize, (int)benchedSize), exit(1);
+                    } else {
+                        for (chunkNb=0; chunkNb<nbChunks; chunkNb++) {
+                            int decodedSize = decompressionFunction(chunkP[chunkNb].compressedBuffer, chunkP[chunkNb].origBuffer, chunkP[chunkNb].compressedSize, chunkP[chunkNb].origSize);
+                            if (chunkP[chunkNb].origSize != decodedSize) DISPLAY("ERROR ! %s() == %i != %i !! \n", dName, decodedSize, chunkP[chunkNb].origSize), exit(1);
+                    }   }
                     nb_loops++;
                 }
                 clockTime = BMK_GetClockSpan(clockTime);
@@ -584,6 +1281,11 @@ int fullSpeedBench(const char** fileNamesTable, int nbFiles)
     }
 
     LZ4F_freeDecompressionContext(g_dCtx);
+#ifndef LZ4_DLL_IMPORT
+    free(g_recordFrameSizes);
+    LZ4F_freeCompressionContext(g_cCtx);
+    LZ4F_freeCDict(g_cdict);
+#endif
     if (g_pause) { printf("press enter...\n"); (void)getchar(); }
 
     return 0;
@@ -608,6 +1310,8 @@ static int usage_advanced(void)
     DISPLAY( " -d#    : test only decompression function # [1-%i]\n", NB_DECOMPRESSION_ALGORITHMS);
     DISPLAY( " -i#    : iteration loops [1-9](default : %i)\n", NBLOOPS);
     DISPLAY( " -B#    : Block size [4-7](default : 7)\n");
+    DISPLAY( " -S#    : bench a synthetic corpus of short-offset runs, periods 1 to # (default : 15) \n");
+    DISPLAY( "          instead of files \n");
     return 0;
 }
 
@@ -700,6 +1404,17 @@ _exit_blockProperties:
                     }
                     break;
 
+                    // Synthetic short-offset corpus
+                case 'S':
+                    g_shortOffsets = 0;
+                    while ((argument[1]>= '0') && (argument[1]<= '9')) {
+                        g_shortOffsets *= 10;
+                        g_shortOffsets += argument[1] - '0';
+                        argument++;
+                    }
+                    if (g_shortOffsets == 0) g_shortOffsets = 15;
+                    break;
+
                     // Pause at the end (hidden option)
                 case 'p': BMK_setPause(); break;
 
@@ -715,6 +1430,12 @@ _exit_blockProperties:
 
     }
 
+    // Synthetic corpus replaces input files
+    if (g_shortOffsets) {
+        static const char* syntheticName[] = { "synthetic short offsets" };
+        return fullSpeedBench(syntheticName, 1);
+    }
+
     // No input filename ==> Error
     if(!input_filename) { badusage(exename); return 1; }
 
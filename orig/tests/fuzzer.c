@@ -43,8 +43,11 @@
 #include <stdio.h>      /* fgets, sscanf */
 #include <string.h>     /* strcmp */
 #include <time.h>       /* clock_t, clock, CLOCKS_PER_SEC */
+#define LZ4_STATIC_LINKING_ONLY
 #define LZ4_HC_STATIC_LINKING_ONLY
 #include "lz4hc.h"
+#include "lz4chunked.h"
+#include "lz4dict.h"
 #define XXH_STATIC_LINKING_ONLY
 #include "xxhash.h"
 
@@ -83,6 +86,9 @@ static int g_displayLevel = 2;
 
 #define MIN(a,b)   ( (a) < (b) ? (a) : (b) )
 
+/* hidden lib function : overlapping match copy kernels, 0=scalar, 1=ssse3, 2=avx2; <0 = best for this cpu */
+int LZ4_copyPattern_selectKernel(int kernel);
+
 
 /*-*******************************************************
 *  Fuzzer functions
@@ -268,7 +274,15 @@ static int FUZ_test(U32 seed, U32 nbCycles, const U32 startCycle, const double c
     char* const decodedBuffer = (char*)malloc(FUZ_MAX_DICT_SIZE + FUZ_MAX_BLOCK_SIZE);
     void* const stateLZ4   = malloc(LZ4_sizeofState());
     void* const stateLZ4HC = malloc(LZ4_sizeofStateHC());
+    LZ4_stream_t* const stateLZ4FastReset = LZ4_createStream();
+    LZ4_stream_t* const stateLZ4Attached = LZ4_createStream();   /* reused across cycles */
+    LZ4_streamLazy_t* const stateLZ4Lazy = (LZ4_streamLazy_t*)malloc(sizeof(LZ4_streamLazy_t));   /* reused across cycles */
+    LZ4_streamHC_t* const stateLZ4HCAttached = LZ4_createStreamHC();   /* reused across cycles */
+    LZ4_streamHC_t* const stateLZ4HCFastReset = LZ4_createStreamHC();   /* reused across cycles */
+    size_t const workspaceHCSize = (size_t)LZ4_sizeofWorkspaceHC(LZ4HC_CLEVEL_MAX);
+    void* const workspaceHC = malloc(workspaceHCSize);   /* lent to stateLZ4HCFastReset */
     LZ4_stream_t LZ4dict;
+    LZ4_streamLazy_t LZ4dictLazy;
     LZ4_streamHC_t LZ4dictHC;
     U32 coreRandState = seed;
     clock_t const clockStart = clock();
@@ -282,11 +296,16 @@ static int FUZ_test(U32 seed, U32 nbCycles, const U32 startCycle, const double c
 
 
     /* init */
-    if(!CNBuffer || !compressedBuffer || !decodedBuffer) {
+    if(!CNBuffer || !compressedBuffer || !decodedBuffer || !stateLZ4FastReset || !stateLZ4Attached || !stateLZ4Lazy || !stateLZ4HCAttached || !stateLZ4HCFastReset || !workspaceHC) {
         DISPLAY("Not enough memory to start fuzzer tests");
         goto _output_error;
     }
+    LZ4_resetStreamHC(stateLZ4HCAttached, 0);
+    LZ4_resetStreamHC(stateLZ4HCFastReset, 0);
+    LZ4_setWorkspaceHC(stateLZ4HCFastReset, workspaceHC, workspaceHCSize);   /* preserved by fast resets */
     memset(&LZ4dict, 0, sizeof(LZ4dict));
+    LZ4_resetStreamLazy(&LZ4dictLazy);
+    LZ4_resetStreamLazy(stateLZ4Lazy);
     {   U32 randState = coreRandState ^ PRIME3;
         FUZ_fillCompressibleNoiseBuffer(CNBuffer, COMPRESSIBLE_NOISE_LENGTH, compressibility, &randState);
     }
@@ -397,11 +416,47 @@ static int FUZ_test(U32 seed, U32 nbCycles, const U32 startCycle, const double c
         ret = LZ4_compress_HC_extStateHC(stateLZ4HC, block, compressedBuffer, blockSize, (int)compressedBufferSize, compressionLevel);
         FUZ_CHECKTEST(ret==0, "LZ4_compress_HC_extStateHC() failed");
 
+        /* Test compression HC using external state, with fast reset and lent workspace : output must be identical */
+        FUZ_DISPLAYTEST;
+        {   int const sizes[2] = { (blockSize & 4095) + 1, blockSize };   /* tables are reused across cycles */
+            int n;
+            for (n=0; n<2; n++) {
+                int const dstCapacity = (FUZ_rand(&randState) & 1) ? (int)compressedBufferSize : sizes[n]/2 + 1;
+                int const refSize = LZ4_compress_HC_extStateHC(stateLZ4HC, block, compressedBuffer, sizes[n], dstCapacity, compressionLevel);
+                U32 const crcRef = XXH32(compressedBuffer, (size_t)refSize, 0);
+                ret = LZ4_compress_HC_extStateHC_fastReset(stateLZ4HCFastReset, block, compressedBuffer, sizes[n], dstCapacity, compressionLevel);
+                FUZ_CHECKTEST(ret!=refSize, "LZ4_compress_HC_extStateHC_fastReset() size differs (%i != %i)", ret, refSize);
+                FUZ_CHECKTEST(XXH32(compressedBuffer, (size_t)ret, 0)!=crcRef, "LZ4_compress_HC_extStateHC_fastReset() output differs");
+            }
+            /* streaming, after a fast reset : first block must be identical to a fresh stream */
+            {   int const streamLevel = compressionLevel ? compressionLevel : 1;   /* LZ4_setCompressionLevel() convention */
+                int const refSize = LZ4_compress_HC(block, compressedBuffer, sizes[0], (int)compressedBufferSize, streamLevel);
+                U32 const crcRef = XXH32(compressedBuffer, (size_t)refSize, 0);
+                LZ4_resetStreamHC_fast(stateLZ4HCFastReset, streamLevel);
+                ret = LZ4_compress_HC_continue(stateLZ4HCFastReset, block, compressedBuffer, sizes[0], (int)compressedBufferSize);
+                FUZ_CHECKTEST(ret!=refSize, "LZ4_resetStreamHC_fast() : size differs (%i != %i)", ret, refSize);
+                FUZ_CHECKTEST(XXH32(compressedBuffer, (size_t)ret, 0)!=crcRef, "LZ4_resetStreamHC_fast() : output differs");
+        }   }
+
         /* Test compression using external state */
         FUZ_DISPLAYTEST;
         ret = LZ4_compress_fast_extState(stateLZ4, block, compressedBuffer, blockSize, (int)compressedBufferSize, 8);
         FUZ_CHECKTEST(ret==0, "LZ4_compress_fast_extState() failed");
 
+        /* Test compression using external state, with fast reset : output must be identical */
+        FUZ_DISPLAYTEST;
+        {   int const sizes[2] = { (blockSize & 2047) + 1, blockSize };   /* small inputs reuse the table across cycles */
+            int const acceleration = (int)(FUZ_rand(&randState) & 3) + 1;
+            int n;
+            for (n=0; n<2; n++) {
+                int const dstCapacity = (FUZ_rand(&randState) & 1) ? (int)compressedBufferSize : sizes[n]/2 + 1;
+                int const refSize = LZ4_compress_fast_extState(stateLZ4, block, compressedBuffer, sizes[n], dstCapacity, acceleration);
+                U32 const crcRef = XXH32(compressedBuffer, (size_t)refSize, 0);
+                ret = LZ4_compress_fast_extState_fastReset(stateLZ4FastReset, block, compressedBuffer, sizes[n], dstCapacity, acceleration);
+                FUZ_CHECKTEST(ret!=refSize, "LZ4_compress_fast_extState_fastReset() size differs (%i != %i)", ret, refSize);
+                FUZ_CHECKTEST(XXH32(compressedBuffer, (size_t)ret, 0)!=crcRef, "LZ4_compress_fast_extState_fastReset() output differs");
+        }   }
+
         /* Test compression */
         FUZ_DISPLAYTEST;
         ret = LZ4_compress_default(block, compressedBuffer, blockSize, (int)compressedBufferSize);
@@ -626,6 +681,112 @@ static int FUZ_test(U32 seed, U32 nbCycles, const U32 startCycle, const double c
                 FUZ_CHECKTEST(decodedBuffer[blockSize-missingBytes], "LZ4_decompress_safe_usingDict overrun specified output buffer size (-%u byte) (blockSize=%i)", missingBytes, blockSize);
         }   }
 
+        /* Compress using attached dictionary */
+        FUZ_DISPLAYTEST;
+        LZ4_loadDict(&LZ4dict, dict, dictSize);
+        LZ4_attach_dictionary(stateLZ4Attached, &LZ4dict);
+        blockContinueCompressedSize = LZ4_compress_fast_continue(stateLZ4Attached, block, compressedBuffer, blockSize, (int)compressedBufferSize, 1);
+        FUZ_CHECKTEST(blockContinueCompressedSize==0, "LZ4_compress_fast_continue using attached dictionary failed");
+
+        FUZ_DISPLAYTEST;
+        LZ4_attach_dictionary(stateLZ4Attached, &LZ4dict);
+        ret = LZ4_compress_fast_continue(stateLZ4Attached, block, compressedBuffer, blockSize, blockContinueCompressedSize-1, 1);
+        FUZ_CHECKTEST(ret>0, "LZ4_compress_fast_continue using attached dictionary should fail : one missing byte for output buffer");
+
+        FUZ_DISPLAYTEST;
+        LZ4_attach_dictionary(stateLZ4Attached, &LZ4dict);
+        ret = LZ4_compress_fast_continue(stateLZ4Attached, block, compressedBuffer, blockSize, blockContinueCompressedSize, 1);
+        FUZ_CHECKTEST(ret!=blockContinueCompressedSize, "LZ4_compress_fast_continue using attached dictionary : compressed size is different (%i != %i)", ret, blockContinueCompressedSize);
+
+        FUZ_DISPLAYTEST;
+        decodedBuffer[blockSize] = 0;
+        ret = LZ4_decompress_safe_usingDict(compressedBuffer, decodedBuffer, blockContinueCompressedSize, blockSize, dict, dictSize);
+        FUZ_CHECKTEST(ret!=blockSize, "LZ4_decompress_safe_usingDict did not regenerate original data (attached dictionary)");
+        FUZ_CHECKTEST(decodedBuffer[blockSize], "LZ4_decompress_safe_usingDict overrun specified output buffer size");
+        crcCheck = XXH32(decodedBuffer, blockSize, 0);
+        if (crcCheck!=crcOrig) FUZ_findDiff(block, decodedBuffer);
+        FUZ_CHECKTEST(crcCheck!=crcOrig, "LZ4_decompress_safe_usingDict corrupted decoded data (attached dictionary %i)", dictSize);
+
+        /* Compress using attached dictionary, onto a state just used for one-shot compression : output must be identical */
+        FUZ_DISPLAYTEST;
+        {   int const oneShotSize = (int)(FUZ_rand(&randState) % COMPRESSIBLE_NOISE_LENGTH) + 1;   /* often beyond 64 KB */
+            int const oneShotCapacity = LZ4_compressBound(oneShotSize);
+            char* const oneShotDst = (char*)malloc((size_t)oneShotCapacity);
+            FUZ_CHECKTEST(oneShotDst==NULL, "allocation failed");
+            switch (FUZ_rand(&randState) % 3)
+            {
+            case 0:  ret = LZ4_compress_fast_extState(stateLZ4Attached, (const char*)CNBuffer, oneShotDst, oneShotSize, oneShotCapacity, 1); break;
+            case 1:  ret = LZ4_compress_fast_extState_fastReset(stateLZ4Attached, (const char*)CNBuffer, oneShotDst, oneShotSize, oneShotCapacity, 1); break;
+            default: ret = LZ4_compress_lazy_extState(stateLZ4Attached, (const char*)CNBuffer, oneShotDst, oneShotSize, oneShotCapacity, 1); break;
+            }
+            free(oneShotDst);
+            FUZ_CHECKTEST(ret==0, "one-shot compression failed");
+        }
+        LZ4_attach_dictionary(stateLZ4Attached, &LZ4dict);
+        ret = LZ4_compress_fast_continue(stateLZ4Attached, block, compressedBuffer, blockSize, blockContinueCompressedSize, 1);
+        FUZ_CHECKTEST(ret!=blockContinueCompressedSize, "LZ4_compress_fast_continue using attached dictionary after one-shot compression : compressed size is different (%i != %i)", ret, blockContinueCompressedSize);
+
+        FUZ_DISPLAYTEST;
+        ret = LZ4_decompress_safe_usingDict(compressedBuffer, decodedBuffer, blockContinueCompressedSize, blockSize, dict, dictSize);
+        FUZ_CHECKTEST(ret!=blockSize, "LZ4_decompress_safe_usingDict did not regenerate original data (attached dictionary, after one-shot compression)");
+        crcCheck = XXH32(decodedBuffer, blockSize, 0);
+        FUZ_CHECKTEST(crcCheck!=crcOrig, "LZ4_decompress_safe_usingDict corrupted decoded data (attached dictionary, after one-shot compression)");
+
+        /* Compress using lazy levels */
+        FUZ_DISPLAYTEST;
+        {   int const lazyLevel = 1 + (int)(FUZ_rand(&randState) & 1);
+            ret = LZ4_compress_lazy(block, compressedBuffer, blockSize, (int)compressedBufferSize, lazyLevel);
+            FUZ_CHECKTEST(ret==0, "LZ4_compress_lazy(%i) failed", lazyLevel);
+            compressedSize = ret;
+
+            FUZ_DISPLAYTEST;
+            ret = LZ4_compress_lazy_extState(stateLZ4Lazy, block, compressedBuffer, blockSize, compressedSize-1, lazyLevel);
+            FUZ_CHECKTEST(ret>0, "LZ4_compress_lazy_extState(%i) should fail : one missing byte for output buffer", lazyLevel);
+
+            FUZ_DISPLAYTEST;
+            ret = LZ4_compress_lazy_extState(stateLZ4Lazy, block, compressedBuffer, blockSize, compressedSize, lazyLevel);
+            FUZ_CHECKTEST(ret!=compressedSize, "LZ4_compress_lazy_extState(%i) : compressed size is different (%i != %i)", lazyLevel, ret, compressedSize);
+
+            FUZ_DISPLAYTEST;
+            decodedBuffer[blockSize] = 0;
+            ret = LZ4_decompress_safe(compressedBuffer, decodedBuffer, compressedSize, blockSize);
+            FUZ_CHECKTEST(ret!=blockSize, "LZ4_decompress_safe did not regenerate original data (lazy level %i)", lazyLevel);
+            FUZ_CHECKTEST(decodedBuffer[blockSize], "LZ4_decompress_safe overrun specified output buffer size");
+            crcCheck = XXH32(decodedBuffer, blockSize, 0);
+            FUZ_CHECKTEST(crcCheck!=crcOrig, "LZ4_decompress_safe corrupted decoded data (lazy level %i)", lazyLevel);
+
+            /* External dictionary, then same dictionary attached : output must be identical */
+            FUZ_DISPLAYTEST;
+            LZ4_loadDictLazy(&LZ4dictLazy, dict, dictSize);
+            blockContinueCompressedSize = LZ4_compress_lazy_continue(&LZ4dictLazy, block, compressedBuffer, blockSize, (int)compressedBufferSize, lazyLevel);
+            FUZ_CHECKTEST(blockContinueCompressedSize==0, "LZ4_compress_lazy_continue(%i) using ExtDict failed", lazyLevel);
+
+            FUZ_DISPLAYTEST;
+            LZ4_loadDictLazy(&LZ4dictLazy, dict, dictSize);
+            ret = LZ4_compress_lazy_continue(&LZ4dictLazy, block, compressedBuffer, blockSize, blockContinueCompressedSize-1, lazyLevel);
+            FUZ_CHECKTEST(ret>0, "LZ4_compress_lazy_continue(%i) using ExtDict should fail : one missing byte for output buffer", lazyLevel);
+
+            FUZ_DISPLAYTEST;
+            LZ4_attach_dictionary(&stateLZ4Lazy->stream, &LZ4dict);
+            ret = LZ4_compress_lazy_continue(stateLZ4Lazy, block, compressedBuffer, blockSize, blockContinueCompressedSize, lazyLevel);
+            FUZ_CHECKTEST(ret!=blockContinueCompressedSize, "LZ4_compress_lazy_continue(%i) using attached dictionary : compressed size is different (%i != %i)", lazyLevel, ret, blockContinueCompressedSize);
+
+            FUZ_DISPLAYTEST;   /* long table copied from dictionary stream, instead of re-hashed */
+            LZ4_loadDictLazy(&LZ4dictLazy, dict, dictSize);
+            LZ4_attach_dictionaryLazy(stateLZ4Lazy, &LZ4dictLazy);
+            ret = LZ4_compress_lazy_continue(stateLZ4Lazy, block, compressedBuffer, blockSize, blockContinueCompressedSize, lazyLevel);
+            FUZ_CHECKTEST(ret!=blockContinueCompressedSize, "LZ4_compress_lazy_continue(%i) using attached lazy dictionary : compressed size is different (%i != %i)", lazyLevel, ret, blockContinueCompressedSize);
+
+            FUZ_DISPLAYTEST;
+            decodedBuffer[blockSize] = 0;
+            ret = LZ4_decompress_safe_usingDict(compressedBuffer, decodedBuffer, blockContinueCompressedSize, blockSize, dict, dictSize);
+            FUZ_CHECKTEST(ret!=blockSize, "LZ4_decompress_safe_usingDict did not regenerate original data (lazy level %i)", lazyLevel);
+            FUZ_CHECKTEST(decodedBuffer[blockSize], "LZ4_decompress_safe_usingDict overrun specified output buffer size");
+            crcCheck = XXH32(decodedBuffer, blockSize, 0);
+            if (crcCheck!=crcOrig) FUZ_findDiff(block, decodedBuffer);
+            FUZ_CHECKTEST(crcCheck!=crcOrig, "LZ4_decompress_safe_usingDict corrupted decoded data (lazy level %i, dict %i)", lazyLevel, dictSize);
+        }
+
         /* Compress HC using External dictionary */
         FUZ_DISPLAYTEST;
         dict -= (FUZ_rand(&randState) & 7);    /* even bigger separation */
@@ -657,6 +818,46 @@ static int FUZ_test(U32 seed, U32 nbCycles, const U32 startCycle, const double c
             FUZ_findDiff(block, decodedBuffer);
         FUZ_CHECKTEST(crcCheck!=crcOrig, "LZ4_decompress_safe_usingDict corrupted decoded data");
 
+        /* Compress HC using External dictionary, favoring decompression speed */
+        FUZ_DISPLAYTEST;
+        LZ4_resetStreamHC (&LZ4dictHC, compressionLevel);
+        LZ4_favorDecompressionSpeed(&LZ4dictHC, 1);
+        LZ4_loadDictHC(&LZ4dictHC, dict, dictSize);
+        ret = LZ4_compress_HC_continue(&LZ4dictHC, block, compressedBuffer, blockSize, (int)compressedBufferSize);
+        FUZ_CHECKTEST(ret==0, "LZ4_compress_HC_continue favoring decompression speed failed");
+        blockContinueCompressedSize = ret;
+        ret = LZ4_decompress_safe_usingDict(compressedBuffer, decodedBuffer, blockContinueCompressedSize, blockSize, dict, dictSize);
+        FUZ_CHECKTEST(ret!=blockSize, "LZ4_decompress_safe_usingDict did not regenerate original data (favorDecSpeed)");
+        crcCheck = XXH32(decodedBuffer, blockSize, 0);
+        FUZ_CHECKTEST(crcCheck!=crcOrig, "LZ4_decompress_safe_usingDict corrupted decoded data (favorDecSpeed)");
+
+        /* Compress HC using attached dictionary */
+        FUZ_DISPLAYTEST;
+        LZ4_loadDictHC(&LZ4dictHC, dict, dictSize);
+        LZ4_attach_HC_dictionary(stateLZ4HCAttached, &LZ4dictHC);
+        LZ4_setCompressionLevel(stateLZ4HCAttached, compressionLevel);
+        blockContinueCompressedSize = LZ4_compress_HC_continue(stateLZ4HCAttached, block, compressedBuffer, blockSize, (int)compressedBufferSize);
+        FUZ_CHECKTEST(blockContinueCompressedSize==0, "LZ4_compress_HC_continue using attached dictionary failed");
+
+        FUZ_DISPLAYTEST;
+        LZ4_attach_HC_dictionary(stateLZ4HCAttached, &LZ4dictHC);
+        ret = LZ4_compress_HC_continue(stateLZ4HCAttached, block, compressedBuffer, blockSize, blockContinueCompressedSize-1);
+        FUZ_CHECKTEST(ret>0, "LZ4_compress_HC_continue using attached dictionary should fail : one missing byte for output buffer");
+
+        FUZ_DISPLAYTEST;
+        LZ4_attach_HC_dictionary(stateLZ4HCAttached, &LZ4dictHC);
+        ret = LZ4_compress_HC_continue(stateLZ4HCAttached, block, compressedBuffer, blockSize, blockContinueCompressedSize);
+        FUZ_CHECKTEST(ret!=blockContinueCompressedSize, "LZ4_compress_HC_continue using attached dictionary : compressed size is different (%i != %i)", ret, blockContinueCompressedSize);
+
+        FUZ_DISPLAYTEST;
+        decodedBuffer[blockSize] = 0;
+        ret = LZ4_decompress_safe_usingDict(compressedBuffer, decodedBuffer, blockContinueCompressedSize, blockSize, dict, dictSize);
+        FUZ_CHECKTEST(ret!=blockSize, "LZ4_decompress_safe_usingDict did not regenerate original data (attached HC dictionary)");
+        FUZ_CHECKTEST(decodedBuffer[blockSize], "LZ4_decompress_safe_usingDict overrun specified output buffer size");
+        crcCheck = XXH32(decodedBuffer, blockSize, 0);
+        if (crcCheck!=crcOrig) FUZ_findDiff(block, decodedBuffer);
+        FUZ_CHECKTEST(crcCheck!=crcOrig, "LZ4_decompress_safe_usingDict corrupted decoded data (attached HC dictionary %i)", dictSize);
+
         /* Compress HC continue destSize */
         FUZ_DISPLAYTEST;
         {   int const availableSpace = (FUZ_rand(&randState) % blockSize) + 5;
@@ -707,6 +908,12 @@ _exit:
         free(decodedBuffer);
         free(stateLZ4);
         free(stateLZ4HC);
+        LZ4_freeStream(stateLZ4FastReset);
+        LZ4_freeStream(stateLZ4Attached);
+        free(stateLZ4Lazy);
+        LZ4_freeStreamHC(stateLZ4HCAttached);
+        LZ4_freeStreamHC(stateLZ4HCFastReset);
+        free(workspaceHC);
         return result;
 
 _output_error:
@@ -800,6 +1007,331 @@ static void FUZ_unitTests(int compressionLevel)
                 if (dNext + messageSize > dBufferSize) dNext = 0;
             }
         }
+
+        /* attached dictionary test : many 2-blocks messages, sharing one dictionary stream */
+        {   LZ4_stream_t* const dictState = LZ4_createStream();
+            LZ4_streamDecode_t decodeState;
+            const char* const dict = testInput;
+            int const dictSize = 64 KB;
+            U64 dictStateCrc;
+            size_t pos = dictSize;
+
+            FUZ_CHECKTEST(dictState==NULL, "LZ4_createStream() allocation failed");
+            LZ4_loadDict(dictState, dict, dictSize);
+            dictStateCrc = XXH64(dictState, sizeof(*dictState), 0);
+            LZ4_resetStream(&streamingState);
+            while (pos + 2 KB < testCompressedSize) {
+                int const size1 = (int)(FUZ_rand(&randState) & 1023) + 1;
+                int const size2 = (int)(FUZ_rand(&randState) & 1023) + 1;
+                int cSize1, cSize2;
+                LZ4_attach_dictionary(&streamingState, dictState);
+                cSize1 = LZ4_compress_fast_continue(&streamingState, testInput + pos, testCompressed, size1, LZ4_compressBound(size1), 1);
+                FUZ_CHECKTEST(cSize1==0, "LZ4_compress_fast_continue() with attached dictionary failed");
+                cSize2 = LZ4_compress_fast_continue(&streamingState, testInput + pos + size1, testCompressed + cSize1, size2, LZ4_compressBound(size2), 1);
+                FUZ_CHECKTEST(cSize2==0, "LZ4_compress_fast_continue() after attached dictionary failed");
+
+                LZ4_setStreamDecode(&decodeState, dict, dictSize);
+                result = LZ4_decompress_safe_continue(&decodeState, testCompressed, testVerify + pos, cSize1, size1);
+                FUZ_CHECKTEST(result!=size1, "attached dictionary : first block decompression failed");
+                result = LZ4_decompress_safe_continue(&decodeState, testCompressed + cSize1, testVerify + pos + size1, cSize2, size2);
+                FUZ_CHECKTEST(result!=size2, "attached dictionary : second block decompression failed");
+                FUZ_CHECKTEST(memcmp(testInput + pos, testVerify + pos, (size_t)(size1+size2)), "attached dictionary : decompression corruption");
+                pos += (size_t)(size1 + size2);
+            }
+            FUZ_CHECKTEST(XXH64(dictState, sizeof(*dictState), 0) != dictStateCrc, "attached dictionary stream was modified");
+            LZ4_freeStream(dictState);
+        }
+
+        /* dictionary training test : samples are made of pieces of a small common corpus */
+        {   unsigned const nbSamples = 256;
+            unsigned const nbTrainingSamples = 192;   /* remaining samples are used for evaluation */
+            size_t* const samplesSizes = (size_t*)malloc(nbSamples * sizeof(size_t));
+            char* const samples = (char*)malloc(nbSamples * 1 KB);
+            char dictBuffer[4 KB];
+            size_t samplesSize = 0, trainingSize = 0, dictSize;
+            int cSizeNoDict = 0, cSizeDict = 0;
+            unsigned n;
+
+            FUZ_CHECKTEST(samplesSizes==NULL || samples==NULL, "allocation failed");
+            for (n=0; n<nbSamples; n++) {
+                size_t const sampleStart = samplesSize;
+                int p;
+                for (p=0; p<4; p++) {
+                    size_t const pieceSize = (FUZ_rand(&randState) & 127) + 64;
+                    size_t const pieceStart = FUZ_rand(&randState) % (16 KB - pieceSize);
+                    memcpy(samples + samplesSize, testInput + pieceStart, pieceSize);
+                    samplesSize += pieceSize;
+                }
+                samplesSizes[n] = samplesSize - sampleStart;
+                if (n < nbTrainingSamples) trainingSize = samplesSize;
+            }
+
+            FUZ_CHECKTEST(LZ4_trainFromBuffer(dictBuffer, sizeof(dictBuffer), samples, samplesSizes, 0) != 0,
+                          "LZ4_trainFromBuffer() should fail without samples");
+            dictSize = LZ4_trainFromBuffer(dictBuffer, sizeof(dictBuffer), samples, samplesSizes, nbTrainingSamples);
+            FUZ_CHECKTEST(dictSize==0 || dictSize > sizeof(dictBuffer), "LZ4_trainFromBuffer() failed (%u)", (U32)dictSize);
+
+            {   size_t pos = trainingSize;
+                for (n=nbTrainingSamples; n<nbSamples; n++) {
+                    int const sampleSize = (int)samplesSizes[n];
+                    int cSize;
+                    cSizeNoDict += LZ4_compress_default(samples + pos, testCompressed, sampleSize, LZ4_compressBound(sampleSize));
+                    LZ4_resetStream(&streamingState);
+                    LZ4_loadDict(&streamingState, dictBuffer, (int)dictSize);
+                    cSize = LZ4_compress_fast_continue(&streamingState, samples + pos, testCompressed, sampleSize, LZ4_compressBound(sampleSize), 1);
+                    FUZ_CHECKTEST(cSize==0, "LZ4_compress_fast_continue() with trained dictionary failed");
+                    result = LZ4_decompress_safe_usingDict(testCompressed, testVerify, cSize, sampleSize, dictBuffer, (int)dictSize);
+                    FUZ_CHECKTEST(result!=sampleSize, "trained dictionary : decompression failed");
+                    FUZ_CHECKTEST(memcmp(samples + pos, testVerify, (size_t)sampleSize), "trained dictionary : decompression corruption");
+                    cSizeDict += cSize;
+                    pos += (size_t)sampleSize;
+            }   }
+            FUZ_CHECKTEST(cSizeDict >= cSizeNoDict, "trained dictionary doesn't improve compression (%i >= %i)", cSizeDict, cSizeNoDict);
+
+            free(samplesSizes);
+            free(samples);
+        }
+    }
+
+    /* LZ4 batch tests */
+    {   const char* srcs[64];
+        char* dsts[64];
+        char* regens[64];
+        int srcSizes[64], dstCapacities[64], dstSizes[64], regenCapacities[64], regenSizes[64];
+        LZ4_stream_t* const state = LZ4_createStream();
+        int const nbRecords = 64;
+        size_t srcPos = 0, dstPos = 0;
+        int n, nbErrors;
+
+        FUZ_CHECKTEST(state==NULL, "LZ4_createStream() allocation failed");
+        for (n=0; n<nbRecords; n++) {
+            int const srcSize = (int)(FUZ_rand(&randState) & 1023) + (n==nbRecords-1 ? 65 KB : 0);   /* last record takes the large path */
+            srcs[n] = testInput + srcPos;
+            srcSizes[n] = srcSize;
+            dsts[n] = testCompressed + dstPos;
+            dstCapacities[n] = LZ4_compressBound(srcSize);
+            regens[n] = testVerify + srcPos;
+            regenCapacities[n] = srcSize;
+            srcPos += (size_t)srcSize;
+            dstPos += (size_t)dstCapacities[n];
+        }
+        FUZ_CHECKTEST((srcPos > testInputSize) || (dstPos > testCompressedSize), "batch test : records exceed buffers");
+
+        nbErrors = LZ4_compress_batch(state, srcs, srcSizes, dsts, dstCapacities, dstSizes, nbRecords, 1);
+        FUZ_CHECKTEST(nbErrors!=0, "LZ4_compress_batch() failed on %i records", nbErrors);
+        for (n=0; n<nbRecords; n++) {
+            char* const refBuffer = testVerify;   /* regenerated data is only written afterwards */
+            int const refSize = LZ4_compress_default(srcs[n], refBuffer, srcSizes[n], dstCapacities[n]);
+            FUZ_CHECKTEST(refSize!=dstSizes[n], "LZ4_compress_batch() record %i : size differs from LZ4_compress_default()", n);
+            FUZ_CHECKTEST(memcmp(refBuffer, dsts[n], (size_t)refSize), "LZ4_compress_batch() record %i : content differs from LZ4_compress_default()", n);
+        }
+
+        nbErrors = LZ4_decompress_safe_batch((const char* const*)dsts, dstSizes, regens, regenCapacities, regenSizes, nbRecords);
+        FUZ_CHECKTEST(nbErrors!=0, "LZ4_decompress_safe_batch() failed on %i records", nbErrors);
+        for (n=0; n<nbRecords; n++)
+            FUZ_CHECKTEST(regenSizes[n]!=srcSizes[n], "LZ4_decompress_safe_batch() record %i : wrong size", n);
+        FUZ_CHECKTEST(memcmp(testInput, testVerify, srcPos), "LZ4_decompress_safe_batch() : corruption");
+
+        /* a malformed record is reported, others are still decoded */
+        dstSizes[3] = 0;
+        nbErrors = LZ4_decompress_safe_batch((const char* const*)dsts, dstSizes, regens, regenCapacities, regenSizes, nbRecords);
+        FUZ_CHECKTEST(nbErrors!=1 || regenSizes[3]>=0, "LZ4_decompress_safe_batch() should report 1 error");
+
+        LZ4_freeStream(state);
+    }
+
+    /* LZ4 interleaved decompression tests */
+    {   char* blocks[4];
+        const char* srcs[4];
+        char* dsts[4];
+        int srcSizes[4], dstCapacities[4], dstSizes[4], origSizes[4];
+        size_t srcPos = 0, dstPos = 0;
+        int n, round, nbErrors;
+
+        for (n=0; n<4; n++) {
+            int const origSize = (n==2) ? (int)(FUZ_rand(&randState) & 15) : (int)(FUZ_rand(&randState) % (28 KB)) + 1;   /* lane 2 is tiny */
+            int const bound = LZ4_compressBound(origSize);
+            blocks[n] = testCompressed + dstPos;
+            srcs[n] = blocks[n];
+            srcSizes[n] = LZ4_compress_default(testInput + srcPos, blocks[n], origSize, bound);
+            FUZ_CHECKTEST(srcSizes[n]==0, "LZ4_compress_default() failed");
+            dsts[n] = testVerify + srcPos;
+            dstCapacities[n] = origSizes[n] = origSize;
+            srcPos += (size_t)origSize;
+            dstPos += (size_t)bound;
+        }
+
+        nbErrors = LZ4_decompress_safe_x4(srcs, srcSizes, dsts, dstCapacities, dstSizes);
+        FUZ_CHECKTEST(nbErrors!=0, "LZ4_decompress_safe_x4() failed on %i blocks", nbErrors);
+        for (n=0; n<4; n++)
+            FUZ_CHECKTEST(dstSizes[n]!=origSizes[n], "LZ4_decompress_safe_x4() block %i : wrong size", n);
+        FUZ_CHECKTEST(memcmp(testInput, testVerify, srcPos), "LZ4_decompress_safe_x4() : corruption");
+
+        memset(testVerify, 0, srcPos);
+        nbErrors = LZ4_decompress_safe_x2(srcs+2, srcSizes+2, dsts+2, dstCapacities+2, dstSizes+2)
+                 + LZ4_decompress_safe_x2(srcs, srcSizes, dsts, dstCapacities, dstSizes);
+        FUZ_CHECKTEST(nbErrors!=0, "LZ4_decompress_safe_x2() failed on %i blocks", nbErrors);
+        FUZ_CHECKTEST(memcmp(testInput, testVerify, srcPos), "LZ4_decompress_safe_x2() : corruption");
+
+        /* malformed blocks : each lane must report exactly what LZ4_decompress_safe() reports */
+        for (round=0; round<64; round++) {
+            int refSizes[4];
+            for (n=0; n<4; n++) {
+                if (FUZ_rand(&randState) & 1)
+                    blocks[n][FUZ_rand(&randState) % (U32)srcSizes[n]] ^= (char)(FUZ_rand(&randState) | 1);
+                if ((FUZ_rand(&randState) & 7) == 0) dstCapacities[n] = origSizes[n] - (int)(FUZ_rand(&randState) & 7);
+                else dstCapacities[n] = origSizes[n];
+                if (dstCapacities[n] < 0) dstCapacities[n] = 0;
+                refSizes[n] = LZ4_decompress_safe(srcs[n], dsts[n], srcSizes[n], dstCapacities[n]);
+            }
+            LZ4_decompress_safe_x4(srcs, srcSizes, dsts, dstCapacities, dstSizes);
+            for (n=0; n<4; n++)
+                FUZ_CHECKTEST(dstSizes[n]!=refSizes[n], "LZ4_decompress_safe_x4() block %i : result %i differs from LZ4_decompress_safe() (%i)", n, dstSizes[n], refSizes[n]);
+        }
+    }
+
+    /* LZ4 chunked tests */
+    {   size_t const srcSize = testInputSize - 1000;   /* last chunk is partial */
+        int const chunkSize = 4 KB;
+        size_t const bound = LZ4_chunked_compressBound(srcSize, chunkSize);
+        char* const src = (char*)malloc(srcSize);
+        char* const cBuffer1 = (char*)malloc(bound);
+        char* const cBuffer4 = (char*)malloc(bound);
+        size_t n, cSize1, cSize4, result;
+
+        FUZ_CHECKTEST(src==NULL || cBuffer1==NULL || cBuffer4==NULL, "chunked test : allocation failed");
+        memcpy(src, testInput, srcSize);
+        for (n = 2*(size_t)chunkSize; n < 3*(size_t)chunkSize; n++) src[n] = (char)FUZ_rand(&randState);   /* incompressible chunk, stored raw */
+
+        cSize1 = LZ4_compress_chunked(src, srcSize, cBuffer1, bound, chunkSize, 1, 1);
+        FUZ_CHECKTEST(cSize1==0, "LZ4_compress_chunked() failed");
+        cSize4 = LZ4_compress_chunked(src, srcSize, cBuffer4, bound, chunkSize, 1, 4);
+        FUZ_CHECKTEST(cSize4!=cSize1, "LZ4_compress_chunked() : compressed size depends on nb of threads");
+        FUZ_CHECKTEST(memcmp(cBuffer1, cBuffer4, cSize1), "LZ4_compress_chunked() : output depends on nb of threads");
+        FUZ_CHECKTEST(LZ4_compress_chunked(src, srcSize, cBuffer4, bound-1, chunkSize, 1, 4)!=0, "LZ4_compress_chunked() should fail : dst too small");
+
+        FUZ_CHECKTEST(LZ4_chunked_getContentSize(cBuffer1, cSize1)!=srcSize, "LZ4_chunked_getContentSize() : wrong size");
+        result = LZ4_decompress_chunked(cBuffer1, cSize1, testVerify, testInputSize, 3);
+        FUZ_CHECKTEST(result!=srcSize, "LZ4_decompress_chunked() failed");
+        FUZ_CHECKTEST(memcmp(src, testVerify, srcSize), "LZ4_decompress_chunked() : corruption");
+
+        result = LZ4_decompress_chunked(cBuffer1, cSize1-1, testVerify, testInputSize, 3);
+        FUZ_CHECKTEST(result!=LZ4_CHUNKED_ERROR, "LZ4_decompress_chunked() should fail : truncated input");
+        result = LZ4_decompress_chunked(cBuffer1, cSize1, testVerify, srcSize-1, 3);
+        FUZ_CHECKTEST(result!=LZ4_CHUNKED_ERROR, "LZ4_decompress_chunked() should fail : dst too small");
+
+        free(src);
+        free(cBuffer1);
+        free(cBuffer4);
+    }
+
+    /* overlapping match copy kernels : runs of periods 1-15, each kernel must decode identically */
+    {   int const srcSize = 64 KB;
+        int pos = 0, kernel, cSize;
+        while (pos < srcSize) {
+            int const period = 1 + (int)(FUZ_rand(&randState) % 15);
+            int const runEnd = MIN(srcSize, pos + period + 17 + (int)(FUZ_rand(&randState) % 200));
+            int const patternEnd = pos + period;
+            for ( ; (pos < runEnd) && (pos < patternEnd); pos++) testInput[pos] = (char)FUZ_rand(&randState);
+            for ( ; pos < runEnd; pos++) testInput[pos] = testInput[pos - period];
+        }
+        cSize = LZ4_compress_default(testInput, testCompressed, srcSize, testCompressedSize);
+        FUZ_CHECKTEST(cSize==0, "LZ4_compress_default() failed on short offsets");
+        for (kernel = 0; kernel < 3; kernel++) {
+            int const selected = LZ4_copyPattern_selectKernel(kernel);
+            int result;
+            memset(testVerify, 0, (size_t)srcSize);
+            result = LZ4_decompress_safe(testCompressed, testVerify, cSize, srcSize);
+            FUZ_CHECKTEST(result!=srcSize, "LZ4_decompress_safe() failed with pattern kernel %i", selected);
+            FUZ_CHECKTEST(memcmp(testInput, testVerify, (size_t)srcSize), "LZ4_decompress_safe() : corruption with pattern kernel %i", selected);
+            result = LZ4_decompress_fast(testCompressed, testVerify, srcSize);
+            FUZ_CHECKTEST(result!=cSize, "LZ4_decompress_fast() failed with pattern kernel %i", selected);
+            FUZ_CHECKTEST(memcmp(testInput, testVerify, (size_t)srcSize), "LZ4_decompress_fast() : corruption with pattern kernel %i", selected);
+        }
+        LZ4_copyPattern_selectKernel(-1);
+        FUZ_fillCompressibleNoiseBuffer(testInput, testInputSize, 0.50, &randState);   /* restore test data */
+    }
+
+    /* short sequences : hand-built blocks, exercising both stages of the decoder shortcut and their fallbacks
+     * (long literals, long matches, overlapping matches, matches reaching into an external dictionary) */
+    {   int const dictSize = 64 KB;
+        int const maxRefSize = 48 KB;
+        int const minMatch = 4;
+        const char* const dict = testInput;
+        char* const ref = testInput + dictSize;   /* reference output, right after dictionary */
+        int useDict;
+        for (useDict = 0; useDict < 2; useDict++) {
+            BYTE* cp = (BYTE*)testCompressed;
+            int refSize = 0, cSize, result, n;
+            while (refSize < maxRefSize) {
+                int const ll = (FUZ_rand(&randState) & 3) ? (int)(FUZ_rand(&randState) % 15) : 15 + (int)(FUZ_rand(&randState) % 300);
+                int const ml = (FUZ_rand(&randState) & 3) ? minMatch + (int)(FUZ_rand(&randState) % 15) : minMatch + 15 + (int)(FUZ_rand(&randState) % 300);
+                int const reach = MIN(65535, refSize + ll + (useDict ? dictSize : 0));
+                int offset;
+                switch (FUZ_rand(&randState) & 3)
+                {
+                case 0:  offset = 1 + (int)(FUZ_rand(&randState) % 7); break;    /* overlapping : stage 2 can't apply */
+                case 1:  offset = 8 + (int)(FUZ_rand(&randState) % 10); break;   /* overlapping, >= 8 : stage 2 */
+                case 2:  offset = 18 + (int)(FUZ_rand(&randState) % 1000); break;
+                default: offset = reach - (int)(FUZ_rand(&randState) % 64);      /* farthest : into dictionary, if any */
+                }
+                if (offset > reach) offset = reach;
+                if (offset < 1) continue;   /* nothing to reference yet */
+                /* token, literal length, literals */
+                *cp++ = (BYTE)((MIN(ll, 15) << 4) | MIN(ml - minMatch, 15));
+                if (ll >= 15) { for (n = ll - 15; n >= 255; n -= 255) *cp++ = 255; *cp++ = (BYTE)n; }
+                for (n = 0; n < ll; n++) ref[refSize++] = (char)FUZ_rand(&randState);
+                memcpy(cp, ref + refSize - ll, (size_t)ll); cp += ll;
+                /* offset, match length, match */
+                *cp++ = (BYTE)offset; *cp++ = (BYTE)(offset >> 8);
+                if (ml - minMatch >= 15) { for (n = ml - minMatch - 15; n >= 255; n -= 255) *cp++ = 255; *cp++ = (BYTE)n; }
+                for (n = 0; n < ml; n++, refSize++) ref[refSize] = ref[refSize - offset];   /* byte per byte : overlap-safe */
+            }
+            /* last literals */
+            *cp++ = (BYTE)(15 << 4); *cp++ = 1;
+            for (n = 0; n < 16; n++) ref[refSize++] = (char)FUZ_rand(&randState);
+            memcpy(cp, ref + refSize - 16, 16); cp += 16;
+            cSize = (int)(cp - (BYTE*)testCompressed);
+
+            if (!useDict) {
+                result = LZ4_decompress_safe(testCompressed, testVerify, cSize, refSize);
+                FUZ_CHECKTEST(result!=refSize, "LZ4_decompress_safe() failed on short sequences");
+                FUZ_CHECKTEST(memcmp(ref, testVerify, (size_t)refSize), "LZ4_decompress_safe() : corruption on short sequences");
+                result = LZ4_decompress_fast(testCompressed, testVerify, refSize);
+                FUZ_CHECKTEST(result!=cSize, "LZ4_decompress_fast() failed on short sequences");
+                FUZ_CHECKTEST(memcmp(ref, testVerify, (size_t)refSize), "LZ4_decompress_fast() : corruption on short sequences");
+                result = LZ4_decompress_safe(testCompressed, testVerify, cSize-1, refSize);
+                FUZ_CHECKTEST(result>=0, "LZ4_decompress_safe() should fail : truncated input");
+            } else {
+                /* external dictionary located right after the output, as in a decoder-side ring buffer */
+                char* const dictCopy = testVerify + refSize;
+                memcpy(dictCopy, dict, (size_t)dictSize);
+                result = LZ4_decompress_safe_usingDict(testCompressed, testVerify, cSize, refSize, dictCopy, dictSize);
+                FUZ_CHECKTEST(result!=refSize, "LZ4_decompress_safe_usingDict() failed on short sequences");
+                FUZ_CHECKTEST(memcmp(ref, testVerify, (size_t)refSize), "LZ4_decompress_safe_usingDict() : corruption on short sequences");
+                FUZ_CHECKTEST(memcmp(dict, dictCopy, (size_t)dictSize), "LZ4_decompress_safe_usingDict() : dictionary overwritten");
+                result = LZ4_decompress_fast_usingDict(testCompressed, testVerify, refSize, dictCopy, dictSize);
+                FUZ_CHECKTEST(result!=cSize, "LZ4_decompress_fast_usingDict() failed on short sequences");
+                FUZ_CHECKTEST(memcmp(ref, testVerify, (size_t)refSize), "LZ4_decompress_fast_usingDict() : corruption on short sequences");
+                /* dictionary as prefix */
+                memcpy(testVerify, dict, (size_t)dictSize);
+                result = LZ4_decompress_safe_usingDict(testCompressed, testVerify + dictSize, cSize, refSize, testVerify, dictSize);
+                FUZ_CHECKTEST(result!=refSize, "LZ4_decompress_safe_usingDict() failed on short sequences, with prefix");
+                FUZ_CHECKTEST(memcmp(ref, testVerify + dictSize, (size_t)refSize), "LZ4_decompress_safe_usingDict() : corruption on short sequences, with prefix");
+                /* without its dictionary, the block references data before its start => must fail */
+                result = LZ4_decompress_safe(testCompressed, testVerify, cSize, refSize);
+                FUZ_CHECKTEST(result>=0, "LZ4_decompress_safe() should fail : offset beyond output start");
+        }   }
+
+        /* offset beyond output start, within the shortcut's reach (large dstCapacity) => must fail */
+        {   BYTE badBlock[4 + 2 + 32] = { 0x10, 'a', 0x09, 0x00,   /* 1 literal, then match at offset 9 */
+                                          0xF0, 32-15 };           /* then 32 last literals */
+            int result;
+            memset(badBlock + 6, 'b', 32);
+            result = LZ4_decompress_safe((const char*)badBlock, testVerify, (int)sizeof(badBlock), testInputSize);
+            FUZ_CHECKTEST(result>=0, "LZ4_decompress_safe() should fail : offset beyond output start");
+        }
+        FUZ_fillCompressibleNoiseBuffer(testInput, testInputSize, 0.50, &randState);   /* restore test data */
     }
 
     /* LZ4 HC streaming tests */
@@ -1017,6 +1549,46 @@ static void FUZ_unitTests(int compressionLevel)
                 if (dNext > dBufferSize) dNext = 0;
             }
         }
+
+        /* levels using binary trees, with a lent workspace : trees continue from one block to the next */
+        {   size_t const wkspSize = (size_t)LZ4_sizeofWorkspaceHC(LZ4HC_CLEVEL_MAX);
+            void* const wksp = malloc(wkspSize);
+            size_t const btRingSize = 64 KB;
+            char* const btRing = (char*)malloc(btRingSize);
+            char* const savedDict = (char*)malloc(64 KB);
+            int mode;
+            FUZ_CHECKTEST((wksp==NULL) || (btRing==NULL) || (savedDict==NULL), "allocation failed");
+            for (mode=0; mode<3; mode++) {   /* 0 : contiguous prefix ; 1 : ring buffer (extDict) ; 2 : LZ4_saveDictHC() */
+                int const btLevel = (FUZ_rand(&randState) & 1) ? LZ4HC_CLEVEL_MAX : LZ4HC_CLEVEL_MAX-1;
+                LZ4_streamDecode_t decodeState;
+                U32 iNext = 0, rNext = 0;
+                U32 messageSize = (FUZ_rand(&randState) & 16383) + 1;
+                LZ4_resetStreamHC(&sHC, btLevel);
+                LZ4_setWorkspaceHC(&sHC, wksp, wkspSize);
+                LZ4_setStreamDecode(&decodeState, NULL, 0);
+                while (iNext + messageSize <= testInputSize) {
+                    const char* src = testInput + iNext;
+                    /* occasionally, a block uses hash chains, which skipped extDict content in the meantime */
+                    LZ4_setCompressionLevel(&sHC, (FUZ_rand(&randState) & 7) ? btLevel : LZ4HC_CLEVEL_DEFAULT);
+                    if (mode == 1) {
+                        if (rNext + messageSize > btRingSize) rNext = 0;
+                        memcpy(btRing + rNext, src, messageSize);
+                        src = btRing + rNext;
+                        rNext += messageSize;
+                    }
+                    result = LZ4_compress_HC_continue(&sHC, src, testCompressed, (int)messageSize, testCompressedSize);
+                    FUZ_CHECKTEST(result==0, "LZ4_compress_HC_continue() failed at level %i, mode %i", btLevel, mode);
+                    if (mode == 2) LZ4_saveDictHC(&sHC, savedDict, 64 KB);
+                    result = LZ4_decompress_safe_continue(&decodeState, testCompressed, testVerify + iNext, result, (int)messageSize);
+                    FUZ_CHECKTEST(result!=(int)messageSize, "LZ4_decompress_safe_continue() failed at level %i, mode %i", btLevel, mode);
+                    iNext += messageSize;
+                    messageSize = (FUZ_rand(&randState) & 16383) + 1;
+                }
+                if (memcmp(testVerify, testInput, iNext)) FUZ_findDiff(testVerify, testInput);
+                FUZ_CHECKTEST(memcmp(testVerify, testInput, iNext), "corruption at level %i, mode %i", btLevel, mode);
+            }
+            free(wksp); free(btRing); free(savedDict);
+        }
     }
 
     printf("All unit tests completed successfully compressionLevel=%d \n", compressionLevel);